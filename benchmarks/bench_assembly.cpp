@@ -0,0 +1,96 @@
+#include "benchmark_utils.hpp"
+
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/utils/MatrixCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+using namespace polyfem;
+using namespace polyfem::assembler;
+using namespace polyfem::benchmark;
+using namespace polyfem::utils;
+using namespace Catch::Generators;
+
+namespace
+{
+	json assembly_args(const std::string &type, const int order)
+	{
+		json args = json::object();
+		args["materials"] = material(type);
+		args["space"]["discr_order"] = order;
+		return args;
+	}
+} // namespace
+
+TEST_CASE("linear_assembly", "[benchmark][assembly]")
+{
+	const std::string type = GENERATE(as<std::string>{}, "Laplacian", "Helmholtz", "LinearElasticity", "HookeLinearElasticity");
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	const auto state = make_state(dim, n, assembly_args(type, order));
+
+	StiffnessMatrix stiffness;
+	BENCHMARK(benchmark_name(type, dim, n, order))
+	{
+		state->assembler->assemble(state->mesh->is_volume(), state->n_bases, state->bases(), state->geom_bases(), state->ass_vals_cache, stiffness);
+		return stiffness.nonZeros();
+	};
+}
+
+TEST_CASE("nonlinear_hessian_assembly", "[benchmark][assembly]")
+{
+	const std::string type = GENERATE(as<std::string>{}, "NeoHookean", "UnconstrainedOgden", "MooneyRivlin");
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	const auto state = make_state(dim, n, assembly_args(type, order));
+	const Eigen::MatrixXd disp = displacement(*state);
+
+	SparseMatrixCache mat_cache;
+	StiffnessMatrix hessian;
+	BENCHMARK(benchmark_name(type, dim, n, order))
+	{
+		state->assembler->assemble_hessian(state->mesh->is_volume(), state->n_bases, false,
+										   state->bases(), state->geom_bases(), state->ass_vals_cache,
+										   0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+		return hessian.nonZeros();
+	};
+}
+
+TEST_CASE("assembly_vals_cache", "[benchmark][assembly]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	const auto state = make_state(dim, n, assembly_args("LinearElasticity", order));
+
+	BENCHMARK_ADVANCED(benchmark_name("AssemblyValsCache::init", dim, n, order))
+	(Catch::Benchmark::Chronometer meter)
+	{
+		std::vector<AssemblyValsCache> caches(meter.runs());
+		meter.measure([&](const int i) {
+			caches[i].init(state->mesh->is_volume(), state->bases(), state->geom_bases());
+		});
+	};
+}
+
+TEST_CASE("build_basis", "[benchmark][assembly]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	const auto state = make_state(dim, n, assembly_args("LinearElasticity", order));
+
+	BENCHMARK(benchmark_name("build_basis", dim, n, order))
+	{
+		state->build_basis();
+		return state->n_bases;
+	};
+}
@@ -0,0 +1,49 @@
+#include "benchmark_utils.hpp"
+
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/utils/RefElementSampler.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+using namespace polyfem;
+using namespace polyfem::io;
+using namespace polyfem::benchmark;
+
+TEST_CASE("evaluator_output", "[benchmark][output]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	json args = json::object();
+	args["materials"] = material("NeoHookean");
+	args["space"]["discr_order"] = order;
+	const auto state = make_state(dim, n, args);
+	const Eigen::MatrixXd sol = displacement(*state);
+
+	utils::RefElementSampler sampler;
+	sampler.init(state->mesh->is_volume(), state->mesh->n_elements(), state->args["output"]["paraview"]["vismesh_rel_area"]);
+	const int n_points = state->mesh->n_elements() * sampler.simplex_points().rows();
+
+	Eigen::MatrixXd values;
+	BENCHMARK(benchmark_name("interpolate_function", dim, n, order))
+	{
+		Evaluator::interpolate_function(
+			*state->mesh, state->problem->is_scalar(), state->bases(), state->disc_orders,
+			state->polys, state->polys_3d, sampler, n_points,
+			sol, values, /*use_sampler=*/true, /*boundary_only=*/false);
+		return values.size();
+	};
+
+	std::vector<assembler::Assembler::NamedMatrix> scalar_values;
+	BENCHMARK(benchmark_name("compute_scalar_value", dim, n, order))
+	{
+		Evaluator::compute_scalar_value(
+			*state->mesh, state->problem->is_scalar(), state->bases(), state->geom_bases(), state->disc_orders,
+			state->polys, state->polys_3d, *state->assembler, sampler, n_points,
+			sol, scalar_values, /*use_sampler=*/true, /*boundary_only=*/false);
+		return scalar_values.size();
+	};
+}
@@ -0,0 +1,97 @@
+#include "benchmark_utils.hpp"
+
+#include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/solver/forms/ContactForm.hpp>
+
+#include <polysolve/LinearSolver.hpp>
+
+#include <array>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+using namespace polyfem;
+using namespace polyfem::solver;
+using namespace polyfem::benchmark;
+
+TEST_CASE("contact_constraint_set", "[benchmark][solve]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+
+	json args = json::object();
+	args["materials"] = material("NeoHookean");
+	const auto state = make_state(dim, n, args);
+	// sets avg_mass (1 for static problems)
+	state->assemble_mass_mat();
+
+	// dhat larger than the edge length, every boundary primitive has close non-adjacent neighbors
+	const double dhat = 1.5 / n;
+	ContactForm form(
+		state->collision_mesh, dhat, state->avg_mass,
+		/*use_convergent_formulation=*/false, /*use_adaptive_barrier_stiffness=*/false,
+		/*is_time_dependent=*/false, /*enable_shape_derivatives=*/false,
+		ipc::BroadPhaseMethod::HASH_GRID, /*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/1000000);
+
+	// the form skips the build when the displacement did not change and the broad phase while it stays in the
+	// envelope (dhat per coordinate), alternate between two displacements 2 dhat apart (rigid translation)
+	std::array<Eigen::VectorXd, 2> x = {{displacement(*state, 0.1 / n), displacement(*state, 0.1 / n)}};
+	for (int i = 0; i < x[1].size(); i += dim)
+		x[1](i) += 2 * dhat;
+
+	BENCHMARK_ADVANCED(benchmark_name("ContactForm constraint set", dim, n, 1))
+	(Catch::Benchmark::Chronometer meter)
+	{
+		meter.measure([&](const int i) { form.update_quantities(0, x[i % 2]); });
+	};
+}
+
+TEST_CASE("newton_step", "[benchmark][solve]")
+{
+	const int dim = GENERATE(2, 3);
+	const int n = cells_per_side(dim, GENERATE(0, 1, 2));
+	const int order = GENERATE(1, 2);
+
+	json args = json::object();
+	args["materials"] = material("NeoHookean");
+	args["space"]["discr_order"] = order;
+	args["boundary_conditions"]["dirichlet_boundary"] = {{{"id", "all"}, {"value", std::vector<double>(dim, 0)}}};
+	std::vector<double> gravity(dim, 0);
+	gravity[1] = -1e3;
+	args["boundary_conditions"]["rhs"] = gravity;
+
+	const auto state = make_state(dim, n, args);
+	state->assemble_rhs();
+	state->assemble_mass_mat();
+
+	Eigen::MatrixXd sol = Eigen::MatrixXd::Zero(state->rhs.size(), 1);
+	state->init_nonlinear_tensor_solve(sol);
+
+	NLProblem &nl_problem = *state->solve_data.nl_problem;
+	nl_problem.use_reduced_size();
+	const Eigen::VectorXd x = nl_problem.full_to_reduced(sol);
+	nl_problem.init(x);
+
+	auto linear_solver = polysolve::LinearSolver::create(
+		state->args["solver"]["linear"]["solver"], state->args["solver"]["linear"]["precond"]);
+	linear_solver->setParameters(state->args["solver"]["linear"]);
+
+	// one iteration of the sparse Newton solver: derivatives, factorization, and the first line search trial
+	Eigen::VectorXd grad, direction;
+	StiffnessMatrix hessian;
+	BENCHMARK(benchmark_name("Newton step", dim, n, order))
+	{
+		nl_problem.solution_changed(x);
+		nl_problem.gradient(x, grad);
+		nl_problem.hessian(x, hessian);
+
+		linear_solver->analyzePattern(hessian, hessian.rows());
+		linear_solver->factorize(hessian);
+		linear_solver->solve(-grad, direction);
+
+		const Eigen::VectorXd x1 = x + direction;
+		nl_problem.solution_changed(x1);
+		return nl_problem.value(x1);
+	};
+}
@@ -0,0 +1,157 @@
+#include "benchmark_utils.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace polyfem::benchmark
+{
+	namespace
+	{
+		// the benchmarks run on one thread unless POLYFEM_BENCHMARK_THREADS is set, so that
+		// the timings are comparable between machines
+		unsigned int benchmark_threads()
+		{
+			const char *threads = std::getenv("POLYFEM_BENCHMARK_THREADS");
+			if (threads == nullptr)
+				return 1;
+			const int n = std::atoi(threads);
+			return n > 0 ? n : std::numeric_limits<unsigned int>::max();
+		}
+	} // namespace
+
+	void grid_mesh(const int dim, const int n, Eigen::MatrixXd &V, Eigen::MatrixXi &F)
+	{
+		assert(dim == 2 || dim == 3);
+		assert(n > 0);
+		const int m = n + 1;
+
+		if (dim == 2)
+		{
+			V.resize(m * m, 2);
+			for (int j = 0; j < m; ++j)
+				for (int i = 0; i < m; ++i)
+					V.row(j * m + i) << double(i) / n, double(j) / n;
+
+			F.resize(2 * n * n, 3);
+			int f = 0;
+			for (int j = 0; j < n; ++j)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					const int v0 = j * m + i;
+					F.row(f++) << v0, v0 + 1, v0 + m + 1;
+					F.row(f++) << v0, v0 + m + 1, v0 + m;
+				}
+			}
+			return;
+		}
+
+		V.resize(m * m * m, 3);
+		for (int k = 0; k < m; ++k)
+			for (int j = 0; j < m; ++j)
+				for (int i = 0; i < m; ++i)
+					V.row((k * m + j) * m + i) << double(i) / n, double(j) / n, double(k) / n;
+
+		// Kuhn subdivision: one tetrahedron per permutation of the axes, the odd
+		// permutations are flipped to keep a positive orientation
+		static const std::array<std::array<int, 3>, 6> permutations = {{{0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}}};
+
+		F.resize(6 * n * n * n, 4);
+		int f = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					const std::array<int, 3> strides = {{1, m, m * m}};
+					const int v0 = (k * m + j) * m + i;
+					const int v3 = v0 + 1 + m + m * m;
+
+					for (int p = 0; p < permutations.size(); ++p)
+					{
+						const auto &perm = permutations[p];
+						const int v1 = v0 + strides[perm[0]];
+						const int v2 = v1 + strides[perm[1]];
+
+						if (p < 3)
+							F.row(f++) << v0, v1, v2, v3;
+						else
+							F.row(f++) << v0, v2, v1, v3;
+					}
+				}
+			}
+		}
+	}
+
+	int cells_per_side(const int dim, const int level)
+	{
+		static const std::array<int, 3> sizes_2d = {{16, 64, 128}};
+		static const std::array<int, 3> sizes_3d = {{4, 8, 16}};
+		assert(level >= 0 && level < 3);
+		return dim == 2 ? sizes_2d[level] : sizes_3d[level];
+	}
+
+	std::shared_ptr<State> make_state(const int dim, const int n, const json &args)
+	{
+		Eigen::MatrixXd V;
+		Eigen::MatrixXi F;
+		grid_mesh(dim, n, V, F);
+
+		auto state = std::make_shared<State>();
+		state->init_logger("", spdlog::level::err, false);
+		state->init(args, true);
+		state->set_max_threads(benchmark_threads());
+
+		state->load_mesh(V, F);
+		state->build_basis();
+
+		return state;
+	}
+
+	json material(const std::string &type)
+	{
+		json mat = json::object();
+		mat["type"] = type;
+
+		if (type == "NeoHookean" || type == "LinearElasticity" || type == "HookeLinearElasticity" || type == "SaintVenant")
+		{
+			mat["E"] = 1e5;
+			mat["nu"] = 0.3;
+		}
+		else if (type == "MooneyRivlin")
+		{
+			mat["c1"] = 1e4;
+			mat["c2"] = 5e3;
+			mat["k"] = 1e5;
+		}
+		else if (type == "UnconstrainedOgden")
+		{
+			mat["alphas"] = {2.0};
+			mat["mus"] = {1e4};
+			mat["Ds"] = {1e-5};
+		}
+		else if (type == "Helmholtz")
+		{
+			mat["k"] = 1.0;
+		}
+
+		return mat;
+	}
+
+	Eigen::MatrixXd displacement(const State &state, const double scale)
+	{
+		const int dim = state.problem->is_scalar() ? 1 : state.mesh->dimension();
+		Eigen::MatrixXd disp(state.n_bases * dim, 1);
+		for (int i = 0; i < disp.size(); ++i)
+			disp(i) = scale * std::sin(0.1 * i);
+		return disp;
+	}
+
+	std::string benchmark_name(const std::string &name, const int dim, const int n, const int order)
+	{
+		return fmt::format("{} {}D n={} P{}", name, dim, n, order);
+	}
+} // namespace polyfem::benchmark
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <polyfem/State.hpp>
+
+#include <Eigen/Dense>
+
+#include <memory>
+#include <string>
+
+namespace polyfem::benchmark
+{
+	/// @brief Generates a regular simplicial mesh of the unit square (cube)
+	/// @param[in] dim dimension of the mesh (2 or 3)
+	/// @param[in] n number of cells per side, each cell is split into 2 triangles (6 tetrahedra)
+	/// @param[out] V vertices
+	/// @param[out] F triangles (tetrahedra)
+	void grid_mesh(const int dim, const int n, Eigen::MatrixXd &V, Eigen::MatrixXi &F);
+
+	/// @brief Number of cells per side of the generated meshes, the 3D meshes are coarser
+	/// @param[in] dim dimension of the mesh (2 or 3)
+	/// @param[in] level size level (0, 1, or 2)
+	/// @return number of cells per side
+	int cells_per_side(const int dim, const int level);
+
+	/// @brief Creates a state on a generated grid mesh and builds the bases
+	/// @param[in] dim dimension of the mesh (2 or 3)
+	/// @param[in] n number of cells per side
+	/// @param[in] args input json, the geometry is ignored
+	/// @return state with bases, ready for assembly
+	std::shared_ptr<State> make_state(const int dim, const int n, const json &args);
+
+	/// @brief Material used by the benchmarks
+	/// @param[in] type material type (e.g., NeoHookean, Laplacian)
+	/// @return material json
+	json material(const std::string &type);
+
+	/// @brief Smooth deterministic displacement of the nodes, used as solution
+	/// @param[in] state state with bases
+	/// @param[in] scale magnitude of the displacement
+	/// @return displacement of size n_bases * problem dim
+	Eigen::MatrixXd displacement(const State &state, const double scale = 1e-2);
+
+	/// @brief Name of a benchmark, reported in the json
+	/// @param[in] name base name
+	/// @param[in] dim dimension of the mesh
+	/// @param[in] n number of cells per side
+	/// @param[in] order discretization order
+	/// @return name with the size of the problem
+	std::string benchmark_name(const std::string &name, const int dim, const int n, const int order);
+} // namespace polyfem::benchmark
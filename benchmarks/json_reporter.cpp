@@ -0,0 +1,81 @@
+// Catch2 reporter writing the benchmark results as json, used to track performance regressions:
+//     polyfem_benchmarks --reporter polyfem_json --out results.json
+
+#include <polyfem/utils/par_for.hpp>
+
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/reporters/catch_reporter_streaming_base.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	class BenchmarkJsonReporter : public Catch::StreamingReporterBase
+	{
+	public:
+		BenchmarkJsonReporter(Catch::ReporterConfig &&config)
+			: StreamingReporterBase(std::move(config))
+		{
+			m_preferences.shouldReportAllAssertions = false;
+
+			results_["benchmarks"] = nlohmann::json::array();
+		}
+
+		static std::string getDescription()
+		{
+			return "Reports the benchmark statistics (in nanoseconds) as json";
+		}
+
+		void testRunStarting(Catch::TestRunInfo const &info) override
+		{
+			StreamingReporterBase::testRunStarting(info);
+
+			const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+			std::stringstream date;
+			date << std::put_time(std::gmtime(&now), "%FT%TZ");
+
+			results_["context"]["name"] = std::string(info.name);
+			results_["context"]["date"] = date.str();
+#ifdef NDEBUG
+			results_["context"]["build_type"] = "release";
+#else
+			results_["context"]["build_type"] = "debug";
+#endif
+		}
+
+		void benchmarkEnded(Catch::BenchmarkStats<> const &stats) override
+		{
+			nlohmann::json entry;
+			entry["test_case"] = currentTestCaseInfo->name;
+			entry["name"] = stats.info.name;
+			entry["samples"] = stats.info.samples;
+			entry["iterations"] = stats.info.iterations;
+			entry["threads"] = polyfem::utils::get_n_threads();
+			entry["mean"] = stats.mean.point.count();
+			entry["mean_lower_bound"] = stats.mean.lower_bound.count();
+			entry["mean_upper_bound"] = stats.mean.upper_bound.count();
+			entry["std_dev"] = stats.standardDeviation.point.count();
+			entry["outlier_variance"] = stats.outlierVariance;
+
+			results_["benchmarks"].push_back(entry);
+		}
+
+		void testRunEnded(Catch::TestRunStats const &stats) override
+		{
+			StreamingReporterBase::testRunEnded(stats);
+
+			m_stream << results_.dump(4) << std::endl;
+		}
+
+	private:
+		nlohmann::json results_;
+	};
+} // namespace
+
+CATCH_REGISTER_REPORTER("polyfem_json", BenchmarkJsonReporter)
@@ -579,9 +579,12 @@ namespace polyfem
 
 		mesh->prepare_mesh();
 
-		bases.clear();
-		pressure_bases.clear();
-		geom_bases_.clear();
+		out_geom.invalidate_volume_vis_cache();
+
+		// new vectors, the previous ones can be shared with other states
+		bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		pressure_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		geom_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
 		boundary_nodes.clear();
 		dirichlet_nodes.clear();
 		neumann_nodes.clear();
@@ -691,9 +694,13 @@ namespace polyfem
 				geom_disc_orders = mesh->orders();
 		}
 
+		// the discretization of another state is reused only for identical geometry and space, hence no p-refinement
+		const State *source = discretization_source_ != nullptr && can_share_discretization(*discretization_source_) ? discretization_source_ : nullptr;
+
+		POLYFEM_SCOPED_TIMER("Build basis");
 		igl::Timer timer;
 		timer.start();
-		if (args["space"]["use_p_ref"])
+		if (source == nullptr && args["space"]["use_p_ref"])
 		{
 			refinement::APriori::p_refine(
 				*mesh,
@@ -722,7 +729,25 @@ namespace polyfem
 		// shape optimization needs continuous geometric basis
 		const bool use_continuous_gbasis = optimization_enabled;
 
-		if (mesh->is_volume())
+		if (source != nullptr)
+		{
+			logger().info("Reusing the bases of a state with the same discretization...");
+
+			// the bases only depend on the geometry and the space, they are shared (read only), the boundary conditions are set up below
+			disc_orders = source->disc_orders;
+			bases_ = source->bases_;
+			geom_bases_ = source->geom_bases_;
+			pressure_bases_ = source->pressure_bases_;
+			n_bases = source->n_bases - source->obstacle.n_vertices();
+			n_geom_bases = source->n_geom_bases;
+			n_pressure_bases = source->n_pressure_bases;
+			mesh_nodes = source->mesh_nodes;
+			geom_mesh_nodes = source->geom_mesh_nodes;
+			pressure_mesh_nodes = source->pressure_mesh_nodes;
+			for (const auto &lb : source->total_local_boundary)
+				local_boundary.emplace_back(lb);
+		}
+		else if (mesh->is_volume())
 		{
 			const Mesh3D &tmp_mesh = *dynamic_cast<Mesh3D *>(mesh.get());
 			if (args["space"]["basis_type"] == "Spline")
@@ -734,7 +759,7 @@ namespace polyfem
 				// 	SplineBasis3d::build_bases(tmp_mesh, quadrature_order, geom_bases_, local_boundary, poly_edge_to_data);
 				// }
 
-				n_bases = basis::SplineBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, bases, local_boundary, poly_edge_to_data);
+				n_bases = basis::SplineBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, bases(), local_boundary, poly_edge_to_data);
 
 				// if (iso_parametric() && args["fit_nodes"])
 				// 	SplineBasis3d::fit_nodes(tmp_mesh, n_bases, bases);
@@ -742,15 +767,15 @@ namespace polyfem
 			else
 			{
 				if (!iso_parametric())
-					n_geom_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, geom_disc_orders, false, has_polys, !use_continuous_gbasis, geom_bases_, local_boundary, poly_edge_to_data_geom, geom_mesh_nodes);
+					n_geom_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, geom_disc_orders, false, has_polys, !use_continuous_gbasis, *geom_bases_, local_boundary, poly_edge_to_data_geom, geom_mesh_nodes);
 
-				n_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, disc_orders, args["space"]["basis_type"] == "Serendipity", has_polys, false, bases, local_boundary, poly_edge_to_data, mesh_nodes);
+				n_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, disc_orders, args["space"]["basis_type"] == "Serendipity", has_polys, false, bases(), local_boundary, poly_edge_to_data, mesh_nodes);
 			}
 
 			// if(problem->is_mixed())
 			if (mixed_assembler != nullptr)
 			{
-				n_pressure_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, int(args["space"]["pressure_discr_order"]), false, has_polys, false, pressure_bases, local_boundary, poly_edge_to_data_geom, pressure_mesh_nodes);
+				n_pressure_bases = basis::LagrangeBasis3d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, int(args["space"]["pressure_discr_order"]), false, has_polys, false, pressure_bases(), local_boundary, poly_edge_to_data_geom, pressure_mesh_nodes);
 			}
 		}
 		else
@@ -766,7 +791,7 @@ namespace polyfem
 				// 	n_bases = SplineBasis2d::build_bases(tmp_mesh, quadrature_order, geom_bases_, local_boundary, poly_edge_to_data);
 				// }
 
-				n_bases = basis::SplineBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, bases, local_boundary, poly_edge_to_data);
+				n_bases = basis::SplineBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, bases(), local_boundary, poly_edge_to_data);
 
 				// if (iso_parametric() && args["fit_nodes"])
 				// 	SplineBasis2d::fit_nodes(tmp_mesh, n_bases, bases);
@@ -774,26 +799,27 @@ namespace polyfem
 			else
 			{
 				if (!iso_parametric())
-					n_geom_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, geom_disc_orders, false, has_polys, !use_continuous_gbasis, geom_bases_, local_boundary, poly_edge_to_data_geom, geom_mesh_nodes);
+					n_geom_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, geom_disc_orders, false, has_polys, !use_continuous_gbasis, *geom_bases_, local_boundary, poly_edge_to_data_geom, geom_mesh_nodes);
 
-				n_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, disc_orders, args["space"]["basis_type"] == "Serendipity", has_polys, false, bases, local_boundary, poly_edge_to_data, mesh_nodes);
+				n_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, disc_orders, args["space"]["basis_type"] == "Serendipity", has_polys, false, bases(), local_boundary, poly_edge_to_data, mesh_nodes);
 			}
 
 			// if(problem->is_mixed())
 			if (mixed_assembler != nullptr)
 			{
-				n_pressure_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, int(args["space"]["pressure_discr_order"]), false, has_polys, false, pressure_bases, local_boundary, poly_edge_to_data_geom, pressure_mesh_nodes);
+				n_pressure_bases = basis::LagrangeBasis2d::build_bases(tmp_mesh, assembler->name(), quadrature_order, mass_quadrature_order, int(args["space"]["pressure_discr_order"]), false, has_polys, false, pressure_bases(), local_boundary, poly_edge_to_data_geom, pressure_mesh_nodes);
 			}
 		}
 
-		if (mixed_assembler != nullptr)
+		// the quadrature of shared pressure bases is already set
+		if (source == nullptr && mixed_assembler != nullptr)
 		{
-			assert(bases.size() == pressure_bases.size());
-			for (int i = 0; i < pressure_bases.size(); ++i)
+			assert(bases().size() == pressure_bases().size());
+			for (int i = 0; i < pressure_bases().size(); ++i)
 			{
 				quadrature::Quadrature b_quad;
-				bases[i].compute_quadrature(b_quad);
-				pressure_bases[i].set_quadrature([b_quad](quadrature::Quadrature &quad) { quad = b_quad; });
+				bases()[i].compute_quadrature(b_quad);
+				pressure_bases()[i].set_quadrature([b_quad](quadrature::Quadrature &quad) { quad = b_quad; });
 			}
 		}
 
@@ -812,7 +838,7 @@ namespace polyfem
 			for (int e = 0; e < gbases.size(); e++)
 			{
 				const auto &gbs = gbases[e].bases;
-				const auto &bs = bases[e].bases;
+				const auto &bs = bases()[e].bases;
 
 				Eigen::MatrixXd local_pts;
 				const int order = bs.front().order();
@@ -887,7 +913,7 @@ namespace polyfem
 
 		const int prev_b_size = local_boundary.size();
 		problem->setup_bc(*mesh, n_bases,
-						  bases, geom_bases(), pressure_bases,
+						  bases(), geom_bases(), pressure_bases(),
 						  local_boundary, boundary_nodes, local_neumann_boundary, pressure_boundary_nodes,
 						  dirichlet_nodes, neumann_nodes);
 
@@ -898,7 +924,7 @@ namespace polyfem
 			{
 				const int n_id = dirichlet_nodes[n];
 				bool found = false;
-				for (const auto &bs : bases)
+				for (const auto &bs : bases())
 				{
 					for (const auto &b : bs.bases)
 					{
@@ -928,7 +954,7 @@ namespace polyfem
 			{
 				const int n_id = neumann_nodes[n];
 				bool found = false;
-				for (const auto &bs : bases)
+				for (const auto &bs : bases())
 				{
 					for (const auto &b : bs.bases)
 					{
@@ -1009,16 +1035,28 @@ namespace polyfem
 
 		ass_vals_cache.clear();
 		mass_ass_vals_cache.clear();
-		if (n_bases <= args["solver"]["advanced"]["cache_size"])
+		pressure_ass_vals_cache.clear();
+		if (source != nullptr)
+		{
+			ass_vals_cache.init(source->ass_vals_cache, bases());
+			mass_ass_vals_cache.init(source->mass_ass_vals_cache, bases());
+			if (mixed_assembler != nullptr)
+				pressure_ass_vals_cache.init(source->pressure_ass_vals_cache, pressure_bases());
+		}
+		else
 		{
+			// the element to dof maps are always built, the assembly values only for small problems
+			// and within the memory budget, shared by the caches in order of use
+			const bool cache_values = n_bases <= args["solver"]["advanced"]["cache_size"];
+			const size_t max_memory = args["solver"]["advanced"]["cache_memory"].get<double>() * 1024 * 1024;
 			timer.start();
 			logger().info("Building cache...");
-			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
-			mass_ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, true);
+			ass_vals_cache.init(mesh->is_volume(), bases(), curret_bases, false, cache_values, max_memory);
+			mass_ass_vals_cache.init(mesh->is_volume(), bases(), curret_bases, true, cache_values, max_memory - ass_vals_cache.memory_size());
 			if (mixed_assembler != nullptr)
-				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases(), curret_bases, false, cache_values, max_memory - ass_vals_cache.memory_size() - mass_ass_vals_cache.memory_size());
 
-			logger().info(" took {}s", timer.getElapsedTime());
+			logger().info(" took {}s ({} MB)", timer.getElapsedTime(), (ass_vals_cache.memory_size() + mass_ass_vals_cache.memory_size() + pressure_ass_vals_cache.memory_size()) / (1024 * 1024));
 		}
 
 		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
@@ -1029,6 +1067,54 @@ namespace polyfem
 		}
 	}
 
+	bool State::can_share_discretization(const State &source) const
+	{
+		if (&source == this || !source.mesh || source.bases().empty())
+			return false;
+
+		// polygonal bases and continuous geometric bases (optimization) are not reused
+		if (optimization_enabled || source.optimization_enabled || mesh->has_poly() || !source.poly_edge_to_data.empty() || !source.polys.empty())
+			return false;
+
+		if (args["space"]["use_p_ref"].get<bool>() || source.args["space"]["use_p_ref"].get<bool>())
+			return false;
+
+		if (formulation() != source.formulation()
+			|| (mixed_assembler == nullptr) != (source.mixed_assembler == nullptr)
+			|| args["space"] != source.args["space"])
+			return false;
+
+		// the bases depend on the geometry: same vertices and connectivity, the nodes of curved elements are not compared
+		if (mesh->dimension() != source.mesh->dimension()
+			|| mesh->n_vertices() != source.mesh->n_vertices()
+			|| mesh->n_elements() != source.mesh->n_elements())
+			return false;
+
+		const auto is_curved = [](const Mesh &m) { return m.orders().size() > 0 && m.orders().maxCoeff() > 1; };
+		if (is_curved(*mesh) || is_curved(*source.mesh))
+			return false;
+
+		for (int v = 0; v < mesh->n_vertices(); ++v)
+		{
+			if (mesh->point(v) != source.mesh->point(v))
+				return false;
+		}
+
+		for (int e = 0; e < mesh->n_elements(); ++e)
+		{
+			if (mesh->n_cell_vertices(e) != source.mesh->n_cell_vertices(e))
+				return false;
+
+			for (int lv = 0; lv < mesh->n_cell_vertices(e); ++lv)
+			{
+				if (mesh->cell_vertex(e, lv) != source.mesh->cell_vertex(e, lv))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
 	void State::build_polygonal_basis()
 	{
 		if (!mesh)
@@ -1045,6 +1131,7 @@ namespace polyfem
 			return;
 		}
 
+		POLYFEM_SCOPED_TIMER("Compute polygonal basis");
 		igl::Timer timer;
 		timer.start();
 		logger().info("Computing polygonal basis...");
@@ -1071,8 +1158,8 @@ namespace polyfem
 					args["space"]["advanced"]["quadrature_order"],
 					args["space"]["advanced"]["mass_quadrature_order"],
 					args["space"]["advanced"]["integral_constraints"],
-					bases,
-					bases,
+					bases(),
+					bases(),
 					poly_edge_to_data,
 					polys_3d);
 			}
@@ -1087,7 +1174,7 @@ namespace polyfem
 						n_bases,
 						args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
-						bases, local_boundary, polys);
+						bases(), local_boundary, polys);
 				}
 				else if (args["space"]["poly_basis_type"] == "Wachspress")
 				{
@@ -1098,7 +1185,7 @@ namespace polyfem
 						n_bases,
 						args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
-						bases, local_boundary, polys);
+						bases(), local_boundary, polys);
 				}
 				else
 				{
@@ -1111,8 +1198,8 @@ namespace polyfem
 						args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
 						args["space"]["advanced"]["integral_constraints"],
-						bases,
-						bases,
+						bases(),
+						bases(),
 						poly_edge_to_data,
 						polys);
 				}
@@ -1138,8 +1225,8 @@ namespace polyfem
 						args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
 						args["space"]["advanced"]["integral_constraints"],
-						bases,
-						geom_bases_,
+						bases(),
+						*geom_bases_,
 						poly_edge_to_data,
 						polys_3d);
 				}
@@ -1154,7 +1241,7 @@ namespace polyfem
 						*dynamic_cast<Mesh2D *>(mesh.get()),
 						n_bases, args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
-						bases, local_boundary, polys);
+						bases(), local_boundary, polys);
 				}
 				else if (args["space"]["poly_basis_type"] == "Wachspress")
 				{
@@ -1164,7 +1251,7 @@ namespace polyfem
 						*dynamic_cast<Mesh2D *>(mesh.get()),
 						n_bases, args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
-						bases, local_boundary, polys);
+						bases(), local_boundary, polys);
 				}
 				else
 				{
@@ -1177,8 +1264,8 @@ namespace polyfem
 						args["space"]["advanced"]["quadrature_order"],
 						args["space"]["advanced"]["mass_quadrature_order"],
 						args["space"]["advanced"]["integral_constraints"],
-						bases,
-						geom_bases_,
+						bases(),
+						*geom_bases_,
 						poly_edge_to_data,
 						polys);
 				}
@@ -1195,7 +1282,7 @@ namespace polyfem
 	void State::build_collision_mesh()
 	{
 		build_collision_mesh(
-			*mesh, n_bases, bases, geom_bases(), total_local_boundary, obstacle,
+			*mesh, n_bases, bases(), geom_bases(), total_local_boundary, obstacle,
 			args, [this](const std::string &p) { return resolve_input_path(p); },
 			in_node_to_node, collision_mesh);
 	}
@@ -1351,6 +1438,7 @@ namespace polyfem
 
 		mass.resize(0, 0);
 
+		POLYFEM_SCOPED_TIMER("Assemble mass matrix");
 		igl::Timer timer;
 		timer.start();
 		logger().info("Assembling mass mat...");
@@ -1358,7 +1446,7 @@ namespace polyfem
 		if (mixed_assembler != nullptr)
 		{
 			StiffnessMatrix velocity_mass;
-			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, velocity_mass, true);
+			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases(), geom_bases(), mass_ass_vals_cache, velocity_mass, true);
 
 			std::vector<Eigen::Triplet<double>> mass_blocks;
 			mass_blocks.reserve(velocity_mass.nonZeros());
@@ -1377,7 +1465,7 @@ namespace polyfem
 		}
 		else
 		{
-			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, mass, true);
+			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases(), geom_bases(), mass_ass_vals_cache, mass, true);
 		}
 
 		assert(mass.size() > 0);
@@ -1444,6 +1532,7 @@ namespace polyfem
 			return;
 		}
 
+		POLYFEM_SCOPED_TIMER("Assemble rhs");
 		igl::Timer timer;
 		// std::string rhs_path = "";
 		// if (args["boundary_conditions"]["rhs"].is_string())
@@ -1494,7 +1583,7 @@ namespace polyfem
 				tmp.setZero();
 
 				std::shared_ptr<RhsAssembler> tmp_rhs_assembler = build_rhs_assembler(
-					n_pressure_bases, pressure_bases, pressure_ass_vals_cache);
+					n_pressure_bases, pressure_bases(), pressure_ass_vals_cache);
 
 				tmp_rhs_assembler->set_bc(std::vector<LocalBoundary>(), std::vector<int>(), n_boundary_samples(), local_neumann_boundary, tmp);
 				rhs.block(prev_size, 0, n_larger, rhs.cols()) = tmp;
@@ -1529,6 +1618,7 @@ namespace polyfem
 		// pressure.resize(0, 0);
 		stats.spectrum.setZero();
 
+		POLYFEM_SCOPED_TIMER("Solve");
 		igl::Timer timer;
 		timer.start();
 		logger().info("Solving {}", assembler->name());
@@ -28,6 +28,7 @@
 #include <polyfem/utils/Logger.hpp>
 
 #include <polyfem/io/OutData.hpp>
+#include <polyfem/io/HDF5Trajectory.hpp>
 
 #include <polysolve/LinearSolver.hpp>
 
@@ -59,6 +60,11 @@ namespace polyfem::assembler
 	class ViscousDampingPrev;
 } // namespace polyfem::assembler
 
+namespace polyfem::solver
+{
+	class FactorizationCache;
+} // namespace polyfem::solver
+
 namespace polyfem
 {
 	namespace mesh
@@ -82,6 +88,10 @@ namespace polyfem
 		/// @param[in] max_threads max number of threads
 		void set_max_threads(const unsigned int max_threads = std::numeric_limits<unsigned int>::max());
 
+		/// if false, init leaves the process wide settings (logger, profiler, and threads) untouched,
+		/// they are managed by the caller (e.g., BatchRunner)
+		bool set_global_settings = true;
+
 		/// initialize the polyfem solver with a json settings
 		/// @param[in] args input arguments
 		/// @param[in] strict_validation strict validation of input
@@ -101,12 +111,12 @@ namespace polyfem
 		/// @param[in] log_file is to write it to a file (use log_file="") to output to stdout
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
 		/// @param[in] is_quit quiets the log
-		void init_logger(const std::string &log_file, const spdlog::level::level_enum log_level, const bool is_quiet);
+		static void init_logger(const std::string &log_file, const spdlog::level::level_enum log_level, const bool is_quiet);
 
 		/// initializing the logger writes to an output stream
 		/// @param[in] os output stream
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
-		void init_logger(std::ostream &os, const spdlog::level::level_enum log_level);
+		static void init_logger(std::ostream &os, const spdlog::level::level_enum log_level);
 
 		/// change log level
 		/// @param[in] log_level 0 all message, 6 no message. 2 is info, 1 is debug
@@ -124,7 +134,7 @@ namespace polyfem
 
 	private:
 		/// initializing the logger meant for internal usage
-		void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
+		static void init_logger(const std::vector<spdlog::sink_ptr> &sinks, const spdlog::level::level_enum log_level);
 
 	public:
 		//---------------------------------------------------
@@ -147,11 +157,11 @@ namespace polyfem
 		std::shared_ptr<assembler::Problem> problem;
 
 		/// FE bases, the size is #elements
-		std::vector<basis::ElementBases> bases;
+		std::vector<basis::ElementBases> &bases() { return *bases_; }
+		const std::vector<basis::ElementBases> &bases() const { return *bases_; }
 		/// FE pressure bases for mixed elements, the size is #elements
-		std::vector<basis::ElementBases> pressure_bases;
-		/// Geometric mapping bases, if the elements are isoparametric, this list is empty
-		std::vector<basis::ElementBases> geom_bases_;
+		std::vector<basis::ElementBases> &pressure_bases() { return *pressure_bases_; }
+		const std::vector<basis::ElementBases> &pressure_bases() const { return *pressure_bases_; }
 
 		/// number of bases
 		int n_bases;
@@ -201,11 +211,16 @@ namespace polyfem
 		/// @return A constant reference to the geometry mapping bases.
 		const std::vector<basis::ElementBases> &geom_bases() const
 		{
-			return iso_parametric() ? bases : geom_bases_;
+			return iso_parametric() ? *bases_ : *geom_bases_;
 		}
 
 		/// builds the bases step 2 of solve
 		void build_basis();
+		/// @brief Reuses the discretization of another state with the same mesh and space (used by BatchRunner).
+		/// build_basis shares the bases and the assembly values of source and copies its node mappings instead of rebuilding them.
+		/// Boundary conditions, materials and the problem are still set up per state.
+		/// @param[in] source state with the same geometry and space which already called build_basis, must be alive when build_basis is called
+		void share_discretization(const State &source) { discretization_source_ = &source; }
 		/// compute rhs, step 3 of solve
 		void assemble_rhs();
 		/// assemble mass, step 4 of solve
@@ -219,7 +234,7 @@ namespace polyfem
 		/// build a RhsAssembler for the problem
 		std::shared_ptr<assembler::RhsAssembler> build_rhs_assembler() const
 		{
-			return build_rhs_assembler(n_bases, bases, mass_ass_vals_cache);
+			return build_rhs_assembler(n_bases, bases(), mass_ass_vals_cache);
 		}
 
 		/// quadrature used for projecting boundary conditions
@@ -243,6 +258,16 @@ namespace polyfem
 		void sol_to_pressure(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
 		/// builds bases for polygons, called inside build_basis
 		void build_polygonal_basis();
+		/// checks if the discretization of source can be reused by build_basis
+		bool can_share_discretization(const State &source) const;
+		/// state whose discretization is reused, see share_discretization
+		const State *discretization_source_ = nullptr;
+
+		/// FE bases, pressure bases, and geometric mapping bases (empty if the elements are isoparametric),
+		/// held by pointer so that states with the same discretization share them (see share_discretization)
+		std::shared_ptr<std::vector<basis::ElementBases>> bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		std::shared_ptr<std::vector<basis::ElementBases>> pressure_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		std::shared_ptr<std::vector<basis::ElementBases>> geom_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
 
 	public:
 		/// set the material and the problem dimension
@@ -365,6 +390,18 @@ namespace polyfem
 			const bool compute_spectrum,
 			Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
 
+		/// @brief Solve the linear problem with a solver already factorized for the system.
+		/// @param solver Linear solver, factorized by factorization.
+		/// @param factorization Factorized linear system (see FactorizationCache::update).
+		/// @param b Right-hand side, it contains the Dirichlet values.
+		/// @param[out] sol solution
+		/// @param[out] pressure pressure
+		void solve_linear_prefactorized(
+			const std::unique_ptr<polysolve::LinearSolver> &solver,
+			const solver::FactorizationCache &factorization,
+			const Eigen::VectorXd &b,
+			Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+
 	public:
 		/// @brief utility that builds the stiffness matrix and collects stats, used only for linear problems
 		/// @param[out] stiffness matrix
@@ -523,6 +560,10 @@ namespace polyfem
 		std::vector<io::SolutionFrame> solution_frames;
 		/// visualization stuff
 		io::OutGeometryData out_geom;
+		/// serializes the time steps of transient solves in a background thread, nullptr writes synchronously
+		std::shared_ptr<io::AsyncWriter> output_writer;
+		/// trajectory file of the current transient solve (output/data/trajectory)
+		std::shared_ptr<io::HDF5Trajectory> trajectory;
 		/// runtime statistics
 		io::OutRuntimeData timings;
 		/// Other statistics
@@ -565,6 +606,12 @@ namespace polyfem
 		/// @param t current time to restart at
 		void save_restart_json(const double t0, const double dt, const int t) const;
 
+		/// @brief Appends the current state of the time integrator to the trajectory file (output/data/trajectory)
+		/// @param[in] time time in secs
+		/// @param[in] t time index, the file is replaced at t = 0
+		/// @param[in] time_integrator time integrator holding u, v, and a
+		void save_trajectory(const double time, const int t, const time_integrator::ImplicitTimeIntegrator &time_integrator);
+
 		//-----------PATH management
 		/// Get the root path for the state (e.g., args["root_path"] or ".")
 		/// @return root path
@@ -5,6 +5,8 @@
 
 #include <igl/Timer.h>
 
+#include <tuple>
+
 #include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem::assembler
@@ -21,6 +23,8 @@ namespace polyfem::assembler
 			std::unique_ptr<MatrixCache> cache = nullptr;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+			TensorProductElementValues tp_vals;
+			Eigen::MatrixXd local;
 
 			LocalThreadMatStorage() = delete;
 
@@ -35,7 +39,7 @@ namespace polyfem::assembler
 			}
 
 			LocalThreadMatStorage(const LocalThreadMatStorage &other)
-				: cache(other.cache->clone()), vals(other.vals), da(other.da)
+				: cache(other.cache->clone()), vals(other.vals), da(other.da), tp_vals(other.tp_vals), local(other.local)
 			{
 			}
 
@@ -45,6 +49,8 @@ namespace polyfem::assembler
 				cache = other.cache->clone();
 				vals = other.vals;
 				da = other.da;
+				tp_vals = other.tp_vals;
+				local = other.local;
 				return *this;
 			}
 
@@ -80,18 +86,121 @@ namespace polyfem::assembler
 			}
 		};
 
-		class LocalThreadScalarStorage
+		class LocalThreadElementStorage
+		{
+		public:
+			ElementAssemblyValues vals;
+			QuadratureVector da;
+		};
+
+		class LocalThreadTripletStorage
 		{
 		public:
-			double val;
+			std::vector<Eigen::Triplet<double>> entries;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+		};
 
-			LocalThreadScalarStorage()
+		class LocalThreadBatchStorage
+		{
+		public:
+			double val = 0;
+			Eigen::MatrixXd vec;
+			std::array<ElementAssemblyValues, BATCH_SIZE> vals;
+			ElementBatch batch;
+			QuadratureVector da;
+			Eigen::VectorXd local;
+
+			LocalThreadBatchStorage(const int size = 0)
 			{
-				val = 0;
+				vec.setZero(size, 1);
 			}
 		};
+
+		// Collects in batch the elements from e (at most BATCH_SIZE, before end) which can be evaluated
+		// together: same number of bases and quadrature points, with a parameterization.
+		// Returns the number of elements of the batch, 0 if e cannot be batched (batch.vals[0] are its values).
+		int gather_batch(
+			const int e,
+			const int end,
+			const bool is_volume,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			LocalThreadBatchStorage &local_storage)
+		{
+			ElementBatch &batch = local_storage.batch;
+			batch.vals[0] = &cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals[0]);
+			batch.first = e;
+			batch.n_lanes = 0;
+			if (!batch.vals[0]->has_parameterization)
+				return 0;
+
+			const int n_loc_bases = batch.vals[0]->basis_values.size();
+			const int n_pts = batch.vals[0]->quadrature.weights.size();
+
+			batch.n_lanes = 1;
+			while (batch.n_lanes < BATCH_SIZE && e + batch.n_lanes < end)
+			{
+				const int el = e + batch.n_lanes;
+				if (int(bases[el].bases.size()) != n_loc_bases)
+					break;
+
+				const ElementAssemblyValues &vals = cache.get(el, is_volume, bases[el], gbases[el], local_storage.vals[batch.n_lanes]);
+				if (!vals.has_parameterization || vals.quadrature.weights.size() != n_pts)
+					break;
+
+				batch.vals[batch.n_lanes++] = &vals;
+			}
+
+			return batch.n_lanes;
+		}
+
+		// Scatter the local hessian of element e to the global dofs.
+		// add_value(gi, gj, value) is always called in the same order for a given element,
+		// this order is used by the scatter plan of SparseMatrixCache.
+		template <typename AddValue>
+		void scatter_local_hessian(
+			const ElementDofMap &dof_map,
+			const int e,
+			const int size,
+			const Eigen::MatrixXd &stiffness_val,
+			AddValue &&add_value)
+		{
+			const int n_loc_bases = dof_map.n_local_bases(e);
+
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				const int begin_i = dof_map.begin(e, i), end_i = dof_map.end(e, i);
+
+				for (int j = 0; j < n_loc_bases; ++j)
+				{
+					const int begin_j = dof_map.begin(e, j), end_j = dof_map.end(e, j);
+
+					for (int n = 0; n < size; ++n)
+					{
+						for (int m = 0; m < size; ++m)
+						{
+							const double local_value = stiffness_val(i * size + m, j * size + n);
+
+							for (int ii = begin_i; ii < end_i; ++ii)
+							{
+								const auto gi = dof_map.index(ii) * size + m;
+								const auto wi = dof_map.weight(ii);
+
+								for (int jj = begin_j; jj < end_j; ++jj)
+								{
+									const auto gj = dof_map.index(jj) * size + n;
+									const auto wj = dof_map.weight(jj);
+
+									add_value(gi, gj, local_value * wi * wj);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
 	} // namespace
 
 	void Assembler::set_materials(const std::vector<int> &body_ids, const json &body_params, const Units &units)
@@ -183,15 +292,75 @@ namespace polyfem::assembler
 			timer.start();
 			assert(cache.is_mass() == is_mass);
 
+			const bool use_tensor_product = has_tensor_product_kernel();
+
+			ElementDofMap tmp_dof_map;
+			const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
 			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 				LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
 				for (int e = start; e < end; ++e)
 				{
-					ElementAssemblyValues &vals = local_storage.vals;
+					if (use_tensor_product
+						&& TensorProductElementValues::is_supported(is_volume, bases[e], gbases[e])
+						&& local_storage.tp_vals.compute(e, is_mass, bases[e], gbases[e]))
+					{
+						// sum factorization, the whole local matrix is computed at once
+						assemble_tensor_product(local_storage.tp_vals, local_storage.local);
+
+						const int n_loc_bases = dof_map.n_local_bases(e);
+						assert(local_storage.local.rows() == n_loc_bases * size());
+						assert(local_storage.local.cols() == n_loc_bases * size());
+
+						for (int i = 0; i < n_loc_bases; ++i)
+						{
+							const int begin_i = dof_map.begin(e, i), end_i = dof_map.end(e, i);
+
+							for (int j = 0; j < n_loc_bases; ++j)
+							{
+								const int begin_j = dof_map.begin(e, j), end_j = dof_map.end(e, j);
+
+								for (int n = 0; n < size(); ++n)
+								{
+									for (int m = 0; m < size(); ++m)
+									{
+										const double local_value = local_storage.local(i * size() + m, j * size() + n);
+										if (std::abs(local_value) < 1e-30)
+										{
+											continue;
+										}
+
+										for (int ii = begin_i; ii < end_i; ++ii)
+										{
+											const auto gi = dof_map.index(ii) * size() + m;
+											const auto wi = dof_map.weight(ii);
+
+											for (int jj = begin_j; jj < end_j; ++jj)
+											{
+												const auto gj = dof_map.index(jj) * size() + n;
+												const auto wj = dof_map.weight(jj);
+
+												local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
+
+												if (local_storage.cache->entries_size() >= max_triplets_size)
+												{
+													local_storage.cache->prune();
+													logger().trace("cleaning memory. Current storage: {}. mat nnz: {}", local_storage.cache->capacity(), local_storage.cache->non_zeros());
+												}
+											}
+										}
+									}
+								}
+							}
+						}
+
+						continue;
+					}
+
 					// igl::Timer timer; timer.start();
 					// vals.compute(e, is_volume, bases[e], gbases[e]);
-					cache.compute(e, is_volume, bases[e], gbases[e], vals);
+					const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 					const Quadrature &quadrature = vals.quadrature;
 
@@ -203,13 +372,13 @@ namespace polyfem::assembler
 					{
 						// const AssemblyValues &values_i = vals.basis_values[i];
 						// const Eigen::MatrixXd &gradi = values_i.grad_t_m;
-						const auto &global_i = vals.basis_values[i].global;
+						const int begin_i = dof_map.begin(e, i), end_i = dof_map.end(e, i);
 
 						for (int j = 0; j <= i; ++j)
 						{
 							// const AssemblyValues &values_j = vals.basis_values[j];
 							// const Eigen::MatrixXd &gradj = values_j.grad_t_m;
-							const auto &global_j = vals.basis_values[j].global;
+							const int begin_j = dof_map.begin(e, j), end_j = dof_map.end(e, j);
 
 							const auto stiffness_val = assemble(LinearAssemblerData(vals, i, j, local_storage.da));
 							assert(stiffness_val.size() == size() * size());
@@ -225,15 +394,15 @@ namespace polyfem::assembler
 										continue;
 									}
 
-									for (size_t ii = 0; ii < global_i.size(); ++ii)
+									for (int ii = begin_i; ii < end_i; ++ii)
 									{
-										const auto gi = global_i[ii].index * size() + m;
-										const auto wi = global_i[ii].val;
+										const auto gi = dof_map.index(ii) * size() + m;
+										const auto wi = dof_map.weight(ii);
 
-										for (size_t jj = 0; jj < global_j.size(); ++jj)
+										for (int jj = begin_j; jj < end_j; ++jj)
 										{
-											const auto gj = global_j[jj].index * size() + n;
-											const auto wj = global_j[jj].val;
+											const auto gj = dof_map.index(jj) * size() + n;
+											const auto wj = dof_map.weight(jj);
 
 											local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
 											if (j < i)
@@ -406,16 +575,20 @@ namespace polyfem::assembler
 		igl::Timer timer;
 		timer.start();
 
+		ElementDofMap tmp_psi_dof_map, tmp_phi_dof_map;
+		const ElementDofMap &psi_dof_map = psi_cache.dof_map(psi_bases, tmp_psi_dof_map);
+		const ElementDofMap &phi_dof_map = phi_cache.dof_map(phi_bases, tmp_phi_dof_map);
+
 		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues psi_vals, phi_vals;
+			ElementAssemblyValues tmp_psi_vals, tmp_phi_vals;
 
 			for (int e = start; e < end; ++e)
 			{
 				// psi_vals.compute(e, is_volume, psi_bases[e], gbases[e]);
 				// phi_vals.compute(e, is_volume, phi_bases[e], gbases[e]);
-				psi_cache.compute(e, is_volume, psi_bases[e], gbases[e], psi_vals);
-				phi_cache.compute(e, is_volume, phi_bases[e], gbases[e], phi_vals);
+				const ElementAssemblyValues &psi_vals = psi_cache.get(e, is_volume, psi_bases[e], gbases[e], tmp_psi_vals);
+				const ElementAssemblyValues &phi_vals = phi_cache.get(e, is_volume, phi_bases[e], gbases[e], tmp_phi_vals);
 
 				const Quadrature &quadrature = phi_vals.quadrature;
 
@@ -426,11 +599,11 @@ namespace polyfem::assembler
 
 				for (int i = 0; i < n_psi_loc_bases; ++i)
 				{
-					const auto &global_i = psi_vals.basis_values[i].global;
+					const int begin_i = psi_dof_map.begin(e, i), end_i = psi_dof_map.end(e, i);
 
 					for (int j = 0; j < n_phi_loc_bases; ++j)
 					{
-						const auto &global_j = phi_vals.basis_values[j].global;
+						const int begin_j = phi_dof_map.begin(e, j), end_j = phi_dof_map.end(e, j);
 
 						const auto stiffness_val = assemble(MixedAssemblerData(psi_vals, phi_vals, i, j, local_storage.da));
 						assert(stiffness_val.size() == rows() * cols());
@@ -446,15 +619,15 @@ namespace polyfem::assembler
 									continue;
 								}
 
-								for (size_t ii = 0; ii < global_i.size(); ++ii)
+								for (int ii = begin_i; ii < end_i; ++ii)
 								{
-									const auto gi = global_i[ii].index * cols() + m;
-									const auto wi = global_i[ii].val;
+									const auto gi = psi_dof_map.index(ii) * cols() + m;
+									const auto wi = psi_dof_map.weight(ii);
 
-									for (size_t jj = 0; jj < global_j.size(); ++jj)
+									for (int jj = begin_j; jj < end_j; ++jj)
 									{
-										const auto gj = global_j[jj].index * rows() + n;
-										const auto wj = global_j[jj].val;
+										const auto gj = phi_dof_map.index(jj) * rows() + n;
+										const auto wj = phi_dof_map.weight(jj);
 
 										local_storage.cache->add_value(e, gj, gi, local_value * wi * wj);
 
@@ -496,32 +669,7 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement,
 		const Eigen::MatrixXd &displacement_prev) const
 	{
-		auto storage = create_thread_storage(LocalThreadScalarStorage());
-		const int n_bases = int(bases.size());
-
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues &vals = local_storage.vals;
-
-			for (int e = start; e < end; ++e)
-			{
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
-
-				const Quadrature &quadrature = vals.quadrature;
-
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-
-				const double val = compute_energy(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
-				local_storage.val += val;
-			}
-		});
-
-		double res = 0;
-		// Serially merge local storages
-		for (const LocalThreadScalarStorage &local_storage : storage)
-			res += local_storage.val;
-		return res;
+		return assemble_energy_gradient_aux(is_volume, 0, bases, gbases, cache, dt, displacement, displacement_prev, true, nullptr);
 	}
 
 	void NLAssembler::assemble_gradient(
@@ -535,67 +683,221 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement_prev,
 		Eigen::MatrixXd &rhs) const
 	{
-		rhs.resize(n_basis * size(), 1);
-		rhs.setZero();
+		assemble_energy_gradient_aux(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, false, &rhs);
+	}
+
+	double NLAssembler::assemble_energy_gradient(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		Eigen::MatrixXd &grad) const
+	{
+		return assemble_energy_gradient_aux(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, true, &grad);
+	}
 
-		auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
+	double NLAssembler::assemble_energy_gradient_aux(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const bool with_energy,
+		Eigen::MatrixXd *grad) const
+	{
+		assert(with_energy || grad != nullptr);
 
 		const int n_bases = int(bases.size());
+		const bool batched = has_batched_kernel();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap *dof_map = nullptr;
+		if (grad || batched)
+			dof_map = &cache.dof_map(bases, tmp_dof_map);
+		if (grad)
+		{
+			grad->resize(n_basis * size(), 1);
+			grad->setZero();
+		}
 
-			for (int e = start; e < end; ++e)
+		// adds the local gradient val of element e to vec
+		const auto scatter = [&](const int e, const Eigen::VectorXd &val, Eigen::MatrixXd &vec) {
+			const int n_loc_bases = dof_map->n_local_bases(e);
+			assert(val.size() == n_loc_bases * size());
+
+			for (int j = 0; j < n_loc_bases; ++j)
 			{
-				// igl::Timer timer; timer.start();
+				const int begin_j = dof_map->begin(e, j), end_j = dof_map->end(e, j);
 
-				ElementAssemblyValues &vals = local_storage.vals;
-				// vals.compute(e, is_volume, bases[e], gbases[e]);
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				for (int m = 0; m < size(); ++m)
+				{
+					const double local_value = val(j * size() + m);
+					if (std::abs(local_value) < 1e-30)
+					{
+						continue;
+					}
 
-				const Quadrature &quadrature = vals.quadrature;
+					for (int jj = begin_j; jj < end_j; ++jj)
+					{
+						const auto gj = dof_map->index(jj) * size() + m;
+						const auto wj = dof_map->weight(jj);
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+						vec(gj) += local_value * wj;
+					}
+				}
+			}
+		};
 
-				const auto val = assemble_gradient(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
-				assert(val.size() == n_loc_bases * size());
+		auto storage = create_thread_storage(LocalThreadBatchStorage(grad ? grad->size() : 0));
 
-				for (int j = 0; j < n_loc_bases; ++j)
-				{
-					const auto &global_j = vals.basis_values[j].global;
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadBatchStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			ElementBatch &batch = local_storage.batch;
 
-					// igl::Timer t1; t1.start();
-					for (int m = 0; m < size(); ++m)
-					{
-						const double local_value = val(j * size() + m);
-						if (std::abs(local_value) < 1e-30)
-						{
-							continue;
-						}
+			for (int e = start; e < end;)
+			{
+				const int n_lanes = batched ? gather_batch(e, end, is_volume, bases, gbases, cache, local_storage) : 0;
+				if (n_lanes == 0)
+				{
+					// one element at a time
+					const ElementAssemblyValues &vals = batched ? *batch.vals[0] : cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals[0]);
 
-						for (size_t jj = 0; jj < global_j.size(); ++jj)
-						{
-							const auto gj = global_j[jj].index * size() + m;
-							const auto wj = global_j[jj].val;
+					assert(MAX_QUAD_POINTS == -1 || vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+					local_storage.da = vals.det.array() * vals.quadrature.weights.array();
 
-							local_storage.vec(gj) += local_value * wj;
-						}
-					}
+					const NonLinearAssemblerData data(vals, dt, displacement, displacement_prev, local_storage.da);
+					if (with_energy)
+						local_storage.val += compute_energy(data);
+					if (grad)
+						scatter(e, assemble_gradient(data), local_storage.vec);
 
-					// t1.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
+					++e;
+					continue;
 				}
 
-				// timer.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
+				// energy and gradient of the batch are computed together
+				evaluate_batch(*dof_map, displacement, grad != nullptr, batch);
+				local_storage.val += batch.energy.head(n_lanes).sum();
+
+				if (grad)
+				{
+					local_storage.local.resize(batch.gradient.size());
+					for (int l = 0; l < n_lanes; ++l)
+					{
+						for (int k = 0; k < batch.gradient.size(); ++k)
+							local_storage.local(k) = batch.gradient[k](l);
+						scatter(e + l, local_storage.local, local_storage.vec);
+					}
+				}
+				e += n_lanes;
 			}
 		});
 
 		// Serially merge local storages
-		for (const LocalThreadVecStorage &local_storage : storage)
-			rhs += local_storage.vec;
+		double res = 0;
+		for (const LocalThreadBatchStorage &local_storage : storage)
+		{
+			res += local_storage.val;
+			if (grad)
+				*grad += local_storage.vec;
+		}
+		return res;
+	}
+
+	void NLAssembler::evaluate_batch(const ElementDofMap &dof_map, const Eigen::MatrixXd &displacement, const bool compute_gradient, ElementBatch &batch) const
+	{
+		const int dim = size();
+		const int n_loc_bases = batch.n_local_bases();
+		const int n_pts = batch.n_quadrature_points();
+		batch.dim = dim;
+
+		assert(displacement.cols() == 1);
+
+		// local displacements, one element per lane
+		batch.local_disp.resize(n_loc_bases * dim);
+		for (int l = 0; l < BATCH_SIZE; ++l)
+		{
+			const int e = batch.element(l);
+			assert(dof_map.n_local_bases(e) == n_loc_bases);
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				for (int d = 0; d < dim; ++d)
+					batch.local_disp[i * dim + d](l) = 0;
+
+				for (int k = dof_map.begin(e, i); k < dof_map.end(e, i); ++k)
+				{
+					for (int d = 0; d < dim; ++d)
+						batch.local_disp[i * dim + d](l) += dof_map.weight(k) * displacement(dof_map.index(k) * dim + d);
+				}
+			}
+		}
+
+		// quadrature weights and gradients of the bases of the lanes, in structure of arrays
+		batch.da.resize(n_pts);
+		batch.grad_t_m.resize(n_pts * n_loc_bases * dim);
+		for (int l = 0; l < BATCH_SIZE; ++l)
+		{
+			const ElementAssemblyValues &vals = batch.lane(l);
+			for (int p = 0; p < n_pts; ++p)
+				batch.da[p](l) = l < batch.n_lanes ? vals.det(p) * vals.quadrature.weights(p) : 0;
+
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				const Eigen::MatrixXd &grad_t_m = vals.basis_values[i].grad_t_m;
+				for (int c = 0; c < dim; ++c)
+					for (int p = 0; p < n_pts; ++p)
+						batch.grad_t_m[(p * n_loc_bases + i) * dim + c](l) = grad_t_m(p, c);
+			}
+		}
+
+		batch.energy.setZero();
+		if (compute_gradient)
+			batch.gradient.assign(n_loc_bases * dim, BatchScalar::Zero());
+
+		BatchScalar energy;
+		BatchMatrix stress;
+		for (int p = 0; p < n_pts; ++p)
+		{
+			const BatchScalar *grad_t_m = batch.grad_t_m.data() + p * n_loc_bases * dim;
+			const BatchScalar &da = batch.da[p];
+
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					BatchScalar &g = batch.disp_grad[d * 3 + c];
+					g.setZero();
+					for (int i = 0; i < n_loc_bases; ++i)
+						g += batch.local_disp[i * dim + d] * grad_t_m[i * dim + c];
+				}
+			}
+
+			batch.p = p;
+			compute_batched_stress(batch, energy, compute_gradient ? &stress : nullptr);
+			batch.energy += energy * da;
+
+			if (!compute_gradient)
+				continue;
+
+			// ∂ψ/∂u_id = P : (e_d ⊗ ∇φ_i)
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				for (int d = 0; d < dim; ++d)
+				{
+					BatchScalar tmp = stress[d * 3] * grad_t_m[i * dim];
+					for (int c = 1; c < dim; ++c)
+						tmp += stress[d * 3 + c] * grad_t_m[i * dim + c];
+					batch.gradient[i * dim + d] += tmp * da;
+				}
+			}
+		}
 	}
 
 	void NLAssembler::assemble_hessian(
@@ -621,32 +923,57 @@ namespace polyfem::assembler
 		mat_cache.init(n_basis * size());
 		mat_cache.set_zero();
 
-		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
-
 		const int n_bases = int(bases.size());
 		igl::Timer timer;
 		timer.start();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
 
-			for (int e = start; e < end; ++e)
+		const auto local_hessian = [&](const int e, ElementAssemblyValues &vals, QuadratureVector &da) {
+			return assemble_local_hessian(e, is_volume, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, vals, da);
+		};
+
+		SparseMatrixCache *sparse_cache = dynamic_cast<SparseMatrixCache *>(&mat_cache);
+		if (sparse_cache != nullptr && sparse_cache->has_scatter_plan(n_bases))
+		{
+			// The pattern and the per-element offsets in the compressed value array are known:
+			// write directly in the shared value array, one color of non-overlapping elements at a time.
+			auto storage = create_thread_storage(LocalThreadElementStorage());
+
+			for (const std::vector<int> &color : sparse_cache->element_colors())
 			{
-				ElementAssemblyValues &vals = local_storage.vals;
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				maybe_parallel_for(color.size(), [&](int start, int end, int thread_id) {
+					LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				const Quadrature &quadrature = vals.quadrature;
+					for (int k = start; k < end; ++k)
+					{
+						const int e = color[k];
+						const Eigen::MatrixXd stiffness_val = local_hessian(e, local_storage.vals, local_storage.da);
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+						int index = 0;
+						scatter_local_hessian(dof_map, e, size(), stiffness_val, [&](const int gi, const int gj, const double value) {
+							sparse_cache->add_value_at(e, index++, value);
+						});
+					}
+				});
+			}
 
-				auto stiffness_val = assemble_hessian(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
-				assert(stiffness_val.rows() == n_loc_bases * size());
-				assert(stiffness_val.cols() == n_loc_bases * size());
+			timer.stop();
+			logger().trace("done direct assembly {}s...", timer.getElapsedTime());
 
-				if (project_to_psd)
-					stiffness_val = ipc::project_to_psd(stiffness_val);
+			hess = mat_cache.get_matrix();
+			return;
+		}
+
+		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int e = start; e < end; ++e)
+			{
+				const Eigen::MatrixXd stiffness_val = local_hessian(e, local_storage.vals, local_storage.da);
 
 				// bool has_nan = false;
 				// for(int k = 0; k < stiffness_val.size(); ++k)
@@ -664,51 +991,15 @@ namespace polyfem::assembler
 				// 	break;
 				// }
 
-				for (int i = 0; i < n_loc_bases; ++i)
-				{
-					const auto &global_i = vals.basis_values[i].global;
+				scatter_local_hessian(dof_map, e, size(), stiffness_val, [&](const int gi, const int gj, const double value) {
+					local_storage.cache->add_value(e, gi, gj, value);
 
-					for (int j = 0; j < n_loc_bases; ++j)
-					// for(int j = 0; j <= i; ++j)
+					if (local_storage.cache->entries_size() >= max_triplets_size)
 					{
-						const auto &global_j = vals.basis_values[j].global;
-
-						for (int n = 0; n < size(); ++n)
-						{
-							for (int m = 0; m < size(); ++m)
-							{
-								const double local_value = stiffness_val(i * size() + m, j * size() + n);
-								//  if (std::abs(local_value) < 1e-30)
-								//  {
-								// 	 continue;
-								//  }
-
-								for (size_t ii = 0; ii < global_i.size(); ++ii)
-								{
-									const auto gi = global_i[ii].index * size() + m;
-									const auto wi = global_i[ii].val;
-
-									for (size_t jj = 0; jj < global_j.size(); ++jj)
-									{
-										const auto gj = global_j[jj].index * size() + n;
-										const auto wj = global_j[jj].val;
-
-										local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
-										// if (j < i) {
-										// 	local_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
-										// }
-
-										if (local_storage.cache->entries_size() >= max_triplets_size)
-										{
-											local_storage.cache->prune();
-											logger().debug("cleaning memory...");
-										}
-									}
-								}
-							}
-						}
+						local_storage.cache->prune();
+						logger().debug("cleaning memory...");
 					}
-				}
+				});
 			}
 		});
 
@@ -729,4 +1020,391 @@ namespace polyfem::assembler
 		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
 	}
 
+	Eigen::MatrixXd NLAssembler::assemble_local_hessian(
+		const int e,
+		const bool is_volume,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		ElementAssemblyValues &tmp_vals,
+		QuadratureVector &da) const
+	{
+		const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], tmp_vals);
+
+		const Quadrature &quadrature = vals.quadrature;
+
+		assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+		da = vals.det.array() * quadrature.weights.array();
+
+		Eigen::MatrixXd stiffness_val = assemble_hessian(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, da));
+		assert(stiffness_val.rows() == vals.basis_values.size() * size());
+		assert(stiffness_val.cols() == vals.basis_values.size() * size());
+
+		if (project_to_psd)
+			stiffness_val = ipc::project_to_psd(stiffness_val);
+
+		return stiffness_val;
+	}
+
+	void NLAssembler::assemble_local_hessians(
+		const bool is_volume,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		std::vector<Eigen::MatrixXd> &local_hessians) const
+	{
+		const int n_bases = int(bases.size());
+		local_hessians.resize(n_bases);
+
+		auto storage = create_thread_storage(LocalThreadElementStorage());
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int e = start; e < end; ++e)
+			{
+				local_hessians[e] = assemble_local_hessian(
+					e, is_volume, project_to_psd, bases, gbases, cache, dt,
+					displacement, displacement_prev, local_storage.vals, local_storage.da);
+			}
+		});
+	}
+
+	void NLAssembler::assemble_hessian_vector_product(
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const AssemblyValsCache &cache,
+		const std::vector<Eigen::MatrixXd> &local_hessians,
+		const Eigen::MatrixXd &v,
+		Eigen::MatrixXd &hv) const
+	{
+		assert(v.size() == n_basis * size());
+		assert(local_hessians.size() == bases.size());
+
+		hv.resize(n_basis * size(), 1);
+		hv.setZero();
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(hv.size()));
+
+		const int n_bases = int(bases.size());
+
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::VectorXd local_v, local_hv;
+
+			for (int e = start; e < end; ++e)
+			{
+				const int n_loc_bases = int(bases[e].bases.size());
+				assert(local_hessians[e].rows() == n_loc_bases * size());
+
+				// Gather the local values of v
+				local_v.setZero(n_loc_bases * size());
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					for (int m = 0; m < size(); ++m)
+					{
+						for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+							local_v(i * size() + m) += dof_map.weight(ii) * v(dof_map.index(ii) * size() + m);
+					}
+				}
+
+				local_hv.noalias() = local_hessians[e] * local_v;
+
+				// Scatter the local product
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					for (int m = 0; m < size(); ++m)
+					{
+						for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+							local_storage.vec(dof_map.index(ii) * size() + m) += dof_map.weight(ii) * local_hv(i * size() + m);
+					}
+				}
+			}
+		});
+
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+			hv += local_storage.vec;
+	}
+
+	void NLAssembler::assemble_hessian_block_diagonal(
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const AssemblyValsCache &cache,
+		const std::vector<Eigen::MatrixXd> &local_hessians,
+		StiffnessMatrix &diag) const
+	{
+		assert(local_hessians.size() == bases.size());
+
+		auto storage = create_thread_storage(LocalThreadTripletStorage());
+
+		const int n_bases = int(bases.size());
+
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadTripletStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+			for (int e = start; e < end; ++e)
+			{
+				scatter_local_hessian(dof_map, e, size(), local_hessians[e], [&](const int gi, const int gj, const double value) {
+					// Only keep the couplings between the dofs of the same node
+					if (gi / size() == gj / size())
+						local_storage.entries.emplace_back(gi, gj, value);
+				});
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (const LocalThreadTripletStorage &local_storage : storage)
+			entries.insert(entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+
+		diag.resize(n_basis * size(), n_basis * size());
+		diag.setFromTriplets(entries.begin(), entries.end());
+		diag.makeCompressed();
+	}
+
+	void NLAssembler::local_stress_grad(
+		const int e,
+		const double dt,
+		const bool project_to_psd,
+		const ElementAssemblyValues &vals,
+		const int q,
+		const Eigen::Ref<const Eigen::RowVectorXd> &grad_u_q,
+		Eigen::MatrixXd &grad_u,
+		Eigen::MatrixXd &stress,
+		Eigen::MatrixXd &stress_grad) const
+	{
+		grad_u.resize(size(), size());
+		for (int m = 0; m < size(); ++m)
+			grad_u.row(m) = grad_u_q.segment(m * size(), size());
+
+		// the assemblers with has_stress_grad do not depend on the previous displacement
+		compute_stress_grad(e, dt, vals.quadrature.points.row(q), vals.val.row(q), grad_u, grad_u, stress, stress_grad);
+		assert(stress_grad.rows() == size() * size() && stress_grad.cols() == size() * size());
+
+		if (project_to_psd)
+			stress_grad = ipc::project_to_psd(stress_grad);
+	}
+
+	void NLAssembler::assemble_displacement_gradients(
+		const bool is_volume,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const Eigen::MatrixXd &displacement,
+		std::vector<Eigen::MatrixXd> &grad_u) const
+	{
+		const int n_bases = int(bases.size());
+		grad_u.resize(n_bases);
+
+		auto storage = create_thread_storage(LocalThreadElementStorage());
+
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd local_disp;
+
+			for (int e = start; e < end; ++e)
+			{
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				dof_map.gather(e, size(), displacement, local_disp);
+
+				// grad_u(q, m * size() + k) = d u_m / d x_k at quadrature point q
+				Eigen::MatrixXd &grad = grad_u[e];
+				grad.setZero(vals.det.size(), size() * size());
+				for (int i = 0; i < local_disp.rows(); ++i)
+				{
+					const Eigen::MatrixXd &grad_t_m = vals.basis_values[i].grad_t_m;
+					for (int m = 0; m < size(); ++m)
+						grad.middleCols(m * size(), size()) += local_disp(i, m) * grad_t_m;
+				}
+			}
+		});
+	}
+
+	void NLAssembler::assemble_hessian_vector_product(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const std::vector<Eigen::MatrixXd> &grad_u,
+		const Eigen::MatrixXd &v,
+		Eigen::MatrixXd &hv) const
+	{
+		assert(v.size() == n_basis * size());
+		assert(grad_u.size() == bases.size());
+
+		hv.resize(n_basis * size(), 1);
+		hv.setZero();
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(hv.size()));
+
+		const int n_bases = int(bases.size());
+
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd local_v, local_hv, grad, stress, stress_grad;
+			Eigen::VectorXd dgrad, dstress;
+
+			for (int e = start; e < end; ++e)
+			{
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const int n_loc_bases = int(vals.basis_values.size());
+				assert(grad_u[e].rows() == vals.det.size());
+
+				// Gather the local values of v
+				local_v.setZero(n_loc_bases, size());
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					for (int m = 0; m < size(); ++m)
+					{
+						for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+							local_v(i, m) += dof_map.weight(ii) * v(dof_map.index(ii) * size() + m);
+					}
+				}
+
+				local_hv.setZero(n_loc_bases, size());
+				for (int q = 0; q < vals.det.size(); ++q)
+				{
+					// Gradient of v at q, row major
+					dgrad.setZero(size() * size());
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						for (int m = 0; m < size(); ++m)
+							dgrad.segment(m * size(), size()) += local_v(i, m) * vals.basis_values[i].grad_t_m.row(q).transpose();
+					}
+
+					local_stress_grad(e, dt, project_to_psd, vals, q, grad_u[e].row(q), grad, stress, stress_grad);
+					dstress.noalias() = stress_grad * dgrad;
+
+					const double da = vals.det(q) * vals.quadrature.weights(q);
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						for (int m = 0; m < size(); ++m)
+							local_hv(i, m) += da * dstress.segment(m * size(), size()).dot(vals.basis_values[i].grad_t_m.row(q));
+					}
+				}
+
+				// Scatter the local product
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					for (int m = 0; m < size(); ++m)
+					{
+						for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+							local_storage.vec(dof_map.index(ii) * size() + m) += dof_map.weight(ii) * local_hv(i, m);
+					}
+				}
+			}
+		});
+
+		// Serially merge local storages
+		for (const LocalThreadVecStorage &local_storage : storage)
+			hv += local_storage.vec;
+	}
+
+	void NLAssembler::assemble_hessian_block_diagonal(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const std::vector<Eigen::MatrixXd> &grad_u,
+		StiffnessMatrix &diag) const
+	{
+		assert(grad_u.size() == bases.size());
+
+		auto storage = create_thread_storage(LocalThreadTripletStorage());
+
+		const int n_bases = int(bases.size());
+
+		ElementDofMap tmp_dof_map;
+		const ElementDofMap &dof_map = cache.dof_map(bases, tmp_dof_map);
+
+		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			LocalThreadTripletStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd grad, stress, stress_grad, block;
+			// (i, j, global node, weight) for the pairs of local bases contributing to the same node
+			std::vector<std::tuple<int, int, int, double>> pairs;
+
+			for (int e = start; e < end; ++e)
+			{
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const int n_loc_bases = int(vals.basis_values.size());
+
+				pairs.clear();
+				for (int i = 0; i < n_loc_bases; ++i)
+				{
+					for (int j = 0; j < n_loc_bases; ++j)
+					{
+						for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+						{
+							for (int jj = dof_map.begin(e, j); jj < dof_map.end(e, j); ++jj)
+							{
+								if (dof_map.index(ii) == dof_map.index(jj))
+									pairs.emplace_back(i, j, dof_map.index(ii), dof_map.weight(ii) * dof_map.weight(jj));
+							}
+						}
+					}
+				}
+
+				for (int q = 0; q < vals.det.size(); ++q)
+				{
+					local_stress_grad(e, dt, project_to_psd, vals, q, grad_u[e].row(q), grad, stress, stress_grad);
+					const double da = vals.det(q) * vals.quadrature.weights(q);
+
+					for (const auto &[i, j, node, w] : pairs)
+					{
+						const auto grad_i = vals.basis_values[i].grad_t_m.row(q);
+						const auto grad_j = vals.basis_values[j].grad_t_m.row(q);
+
+						// block(m, n) = sum_kl stress_grad(m * size() + k, n * size() + l) grad_i(k) grad_j(l)
+						block.setZero(size(), size());
+						for (int m = 0; m < size(); ++m)
+						{
+							for (int n = 0; n < size(); ++n)
+								block(m, n) = grad_i * stress_grad.block(m * size(), n * size(), size(), size()) * grad_j.transpose();
+						}
+
+						for (int m = 0; m < size(); ++m)
+						{
+							for (int n = 0; n < size(); ++n)
+								local_storage.entries.emplace_back(node * size() + m, node * size() + n, da * w * block(m, n));
+						}
+					}
+				}
+			}
+		});
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (const LocalThreadTripletStorage &local_storage : storage)
+			entries.insert(entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+
+		diag.resize(n_basis * size(), n_basis * size());
+		diag.setFromTriplets(entries.begin(), entries.end());
+		diag.makeCompressed();
+	}
+
 } // namespace polyfem::assembler
@@ -4,6 +4,8 @@
 
 #include <polyfem/assembler/AssemblerData.hpp>
 #include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/assembler/ElementBatch.hpp>
+#include <polyfem/assembler/TensorProductElementValues.hpp>
 
 #include <polyfem/utils/MatrixCache.hpp>
 #include <polyfem/utils/ElasticityUtils.hpp>
@@ -94,6 +96,22 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement_prev,
 			Eigen::MatrixXd &rhs) const { log_and_throw_error("Assemble grad not implemented by {}!", name()); }
 
+		// assemble energy and its gradient (rhs), by default with two passes over the elements
+		virtual double assemble_energy_gradient(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::MatrixXd &grad) const
+		{
+			assemble_gradient(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
+			return assemble_energy(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
+		}
+
 		// assemble hessian of energy (grad)
 		virtual void assemble_hessian(
 			const bool is_volume,
@@ -108,6 +126,73 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const { log_and_throw_error("Assemble hessian not implemented by {}!", name()); }
 
+		// compute the element hessians of energy, kept to apply the hessian without assembling it
+		virtual void assemble_local_hessians(
+			const bool is_volume,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			std::vector<Eigen::MatrixXd> &local_hessians) const { log_and_throw_error("Assemble local hessians not implemented by {}!", name()); }
+
+		// assemble the product of the hessian of energy with a vector from the element hessians (see assemble_local_hessians)
+		virtual void assemble_hessian_vector_product(
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const AssemblyValsCache &cache,
+			const std::vector<Eigen::MatrixXd> &local_hessians,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const { log_and_throw_error("Assemble hessian vector product not implemented by {}!", name()); }
+
+		// assemble the diagonal blocks (one size() x size() block per node) of the hessian of energy from the element hessians
+		virtual void assemble_hessian_block_diagonal(
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const AssemblyValsCache &cache,
+			const std::vector<Eigen::MatrixXd> &local_hessians,
+			StiffnessMatrix &diag) const { log_and_throw_error("Assemble hessian block diagonal not implemented by {}!", name()); }
+
+		// true if the energy density only depends on the displacement gradient and compute_stress_grad gives its hessian,
+		// the hessian of energy can then be applied per quadrature point from the displacement gradients
+		virtual bool has_stress_grad() const { return false; }
+
+		// compute the displacement gradients at the quadrature points of every element (one row of size() x size() row major values per point)
+		virtual void assemble_displacement_gradients(
+			const bool is_volume,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const Eigen::MatrixXd &displacement,
+			std::vector<Eigen::MatrixXd> &grad_u) const { log_and_throw_error("Assemble displacement gradients not implemented by {}!", name()); }
+
+		// assemble the product of the hessian of energy with a vector on the fly from the displacement gradients (see assemble_displacement_gradients)
+		virtual void assemble_hessian_vector_product(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const std::vector<Eigen::MatrixXd> &grad_u,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const { log_and_throw_error("Assemble hessian vector product not implemented by {}!", name()); }
+
+		// assemble the diagonal blocks of the hessian of energy from the displacement gradients
+		virtual void assemble_hessian_block_diagonal(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const std::vector<Eigen::MatrixXd> &grad_u,
+			StiffnessMatrix &diag) const { log_and_throw_error("Assemble hessian block diagonal not implemented by {}!", name()); }
+
 		// plotting (eg von mises), assembler is the name of the formulation
 		virtual void compute_scalar_value(
 			const int el_id,
@@ -232,6 +317,14 @@ namespace polyfem::assembler
 		virtual bool is_linear() const override { return true; }
 
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> assemble(const LinearAssemblerData &data) const = 0;
+
+		// true if the assembler implements assemble_tensor_product
+		virtual bool has_tensor_product_kernel() const { return false; }
+
+		// computes the whole local matrix of a Lagrange hex element with sum factorization,
+		// entry (i * size() + m, j * size() + n) couples component m of basis i with component n of basis j
+		// used by assemble instead of the (i,j) loop whenever the element supports it
+		virtual void assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const { log_and_throw_error("Tensor product assembly not implemented by {}!", name()); }
 	};
 
 	// non-linear assembler (eg neohookean elasticity)
@@ -262,6 +355,18 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement_prev,
 			Eigen::MatrixXd &rhs) const override;
 
+		// assemble energy and its gradient in one pass over the elements
+		double assemble_energy_gradient(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::MatrixXd &grad) const override;
+
 		// assemble hessian of energy (grad)
 		void assemble_hessian(
 			const bool is_volume,
@@ -276,9 +381,125 @@ namespace polyfem::assembler
 			utils::MatrixCache &mat_cache,
 			StiffnessMatrix &grad) const override;
 
+		// compute the element hessians of energy (e.g., for matrix-free hessian vector products)
+		void assemble_local_hessians(
+			const bool is_volume,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			std::vector<Eigen::MatrixXd> &local_hessians) const override;
+
+		// assemble the product of the hessian of energy with a vector (matrix-free)
+		void assemble_hessian_vector_product(
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const AssemblyValsCache &cache,
+			const std::vector<Eigen::MatrixXd> &local_hessians,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const override;
+
+		// assemble the nodal diagonal blocks of the hessian of energy (e.g., for block Jacobi preconditioning)
+		void assemble_hessian_block_diagonal(
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const AssemblyValsCache &cache,
+			const std::vector<Eigen::MatrixXd> &local_hessians,
+			StiffnessMatrix &diag) const override;
+
+		// compute the displacement gradients at the quadrature points of every element
+		void assemble_displacement_gradients(
+			const bool is_volume,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const Eigen::MatrixXd &displacement,
+			std::vector<Eigen::MatrixXd> &grad_u) const override;
+
+		// assemble the product of the hessian of energy with a vector, the stress derivative is evaluated per quadrature point
+		// (and projected to psd there if requested) so that no element hessian is stored
+		void assemble_hessian_vector_product(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const std::vector<Eigen::MatrixXd> &grad_u,
+			const Eigen::MatrixXd &v,
+			Eigen::MatrixXd &hv) const override;
+
+		// assemble the nodal diagonal blocks of the hessian of energy from the displacement gradients
+		void assemble_hessian_block_diagonal(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const std::vector<Eigen::MatrixXd> &grad_u,
+			StiffnessMatrix &diag) const override;
+
 		virtual bool is_linear() const override { return false; }
 
+		// true if the assembler implements compute_batched_stress, assemble_energy and assemble_gradient then
+		// evaluate the elements with a parameterization by batches of BATCH_SIZE (one element per SIMD lane)
+		virtual bool has_batched_kernel() const { return false; }
+
+		// energy density at the quadrature point batch.p of the elements of the batch and, if stress is not null,
+		// its derivative with respect to the displacement gradient (first Piola-Kirchhoff stress)
+		virtual void compute_batched_stress(const ElementBatch &batch, BatchScalar &energy, BatchMatrix *stress) const { log_and_throw_error("Batched kernel not implemented by {}!", name()); }
+
+	private:
+		// energy (if with_energy) and gradient (if grad is not null) with a single pass over the elements
+		double assemble_energy_gradient_aux(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const bool with_energy,
+			Eigen::MatrixXd *grad) const;
+
 	protected:
+		// energy and, if compute_gradient, gradient of the elements of the batch with compute_batched_stress
+		void evaluate_batch(const basis::ElementDofMap &dof_map, const Eigen::MatrixXd &displacement, const bool compute_gradient, ElementBatch &batch) const;
+
+		// compute the local hessian of element e (projected to psd if requested), tmp_vals and da are used as scratch
+		Eigen::MatrixXd assemble_local_hessian(
+			const int e,
+			const bool is_volume,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			ElementAssemblyValues &tmp_vals,
+			QuadratureVector &da) const;
+
+		// compute the derivative of the stress (see compute_stress_grad) at quadrature point q of vals from the row major
+		// displacement gradient grad_u_q (projected to psd if requested), grad_u and stress are used as scratch
+		void local_stress_grad(
+			const int e,
+			const double dt,
+			const bool project_to_psd,
+			const ElementAssemblyValues &vals,
+			const int q,
+			const Eigen::Ref<const Eigen::RowVectorXd> &grad_u_q,
+			Eigen::MatrixXd &grad_u,
+			Eigen::MatrixXd &stress,
+			Eigen::MatrixXd &stress_grad) const;
+
 		// energy, gradient, and hessian used in newton method
 		virtual double compute_energy(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const = 0;
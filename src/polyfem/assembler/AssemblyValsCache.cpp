@@ -1,49 +1,381 @@
 #include "AssemblyValsCache.hpp"
 
+#include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
 namespace polyfem
 {
 	using namespace basis;
 
 	namespace assembler
 	{
-		void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const bool is_mass)
+		namespace
+		{
+			// ids of the reference values, unique across the caches (0 is never used)
+			std::atomic<size_t> next_reference_id(0);
+		} // namespace
+
+		void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const bool is_mass, const bool cache_values, const size_t max_memory)
 		{
 			is_mass_ = is_mass;
+			dof_map_.build(bases);
+
+			cache.reset();
+			compact.reset();
+			memory_size_ = 0;
+			if (!cache_values)
+				return;
+
 			const int n_bases = bases.size();
-			cache.resize(n_bases);
+			const int dim = is_volume ? 3 : 2;
+
+			auto values = std::make_shared<std::vector<ElementAssemblyValues>>();
+			std::shared_ptr<CompactValues> compact_values;
+
+			const auto reference_hash = [](const ElementAssemblyValues &vals) {
+				size_t hash = vals.basis_values.size();
+				const auto combine = [&hash](const auto &mat) {
+					for (Eigen::Index i = 0; i < mat.size(); ++i)
+						hash ^= std::hash<double>()(mat.data()[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				};
+
+				combine(vals.quadrature.points);
+				combine(vals.quadrature.weights);
+				for (const AssemblyValues &v : vals.basis_values)
+				{
+					combine(v.val);
+					combine(v.grad);
+				}
+				return hash;
+			};
+
+			const auto is_same_reference = [](const ReferenceValues &ref, const ElementAssemblyValues &vals) {
+				const auto same = [](const auto &a, const auto &b) { return a.rows() == b.rows() && a.cols() == b.cols() && a == b; };
+
+				if (ref.val.size() != vals.basis_values.size()
+					|| !same(ref.quadrature.points, vals.quadrature.points)
+					|| !same(ref.quadrature.weights, vals.quadrature.weights))
+					return false;
+
+				for (size_t i = 0; i < ref.val.size(); ++i)
+				{
+					if (!same(ref.val[i], vals.basis_values[i].val) || !same(ref.grad[i], vals.basis_values[i].grad))
+						return false;
+				}
+				return true;
+			};
+
+			// the jacobian is constant for affine elements (e.g., P1 geometry simplices), it is stored once
+			const auto is_affine = [](const ElementAssemblyValues &vals) {
+				for (long k = 1; k < vals.det.size(); ++k)
+				{
+					if (vals.det(k) != vals.det(0) || vals.jac_it[k] != vals.jac_it[0])
+						return false;
+				}
+				return true;
+			};
+
+			// reference values with the same hash, only used to find the shared ones
+			std::unordered_map<size_t, std::vector<int>> hash_to_references;
+			size_t full_size = 0;
+			size_t compact_size = 0;
+
+			const auto reset_compact = [&]() {
+				compact_values = std::make_shared<CompactValues>();
+				compact_values->dim = dim;
+				compact_values->point_offset.push_back(0);
+				compact_values->jac_offset.push_back(0);
+				hash_to_references.clear();
+				compact_size = 0;
+			};
+
+			// appends the values of the next element to the compact layout, false if they do not fit in max_memory
+			const auto append_compact = [&](const ElementAssemblyValues &vals) {
+				std::vector<int> &same_hash = hash_to_references[reference_hash(vals)];
+				int ref = -1;
+				for (const int r : same_hash)
+				{
+					if (is_same_reference(compact_values->references[r], vals))
+					{
+						ref = r;
+						break;
+					}
+				}
+
+				const int n_points = vals.val.rows();
+				const int n_jacs = is_affine(vals) ? 1 : n_points;
+				size_t element_size = 3 * sizeof(int) + sizeof(char) + (n_points * dim + n_jacs * (1 + dim * dim)) * sizeof(double);
+				if (ref < 0)
+				{
+					element_size += sizeof(ReferenceValues) + 2 * vals.basis_values.size() * sizeof(Eigen::MatrixXd)
+									+ (vals.quadrature.points.size() + vals.quadrature.weights.size()) * sizeof(double);
+					for (const AssemblyValues &v : vals.basis_values)
+						element_size += (v.val.size() + v.grad.size()) * sizeof(double);
+				}
+
+				if (compact_size + element_size > max_memory)
+					return false;
 
-			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-				for (int e = start; e < end; ++e)
+				if (ref < 0)
 				{
-					if (is_mass_)
+					ref = compact_values->references.size();
+					same_hash.push_back(ref);
+
+					ReferenceValues &reference = compact_values->references.emplace_back();
+					reference.id = ++next_reference_id;
+					reference.quadrature = vals.quadrature;
+					for (const AssemblyValues &v : vals.basis_values)
 					{
-						auto &quadrature = cache[e].quadrature;
-						bases[e].compute_mass_quadrature(quadrature);
-						cache[e].compute(e, is_volume, quadrature.points, bases[e], gbases[e]);
+						reference.val.push_back(v.val);
+						reference.grad.push_back(v.grad);
 					}
-					else
-						cache[e].compute(e, is_volume, bases[e], gbases[e]);
 				}
-			});
+
+				compact_values->reference.push_back(ref);
+				compact_values->has_parameterization.push_back(vals.has_parameterization);
+				compact_values->point_offset.push_back(compact_values->point_offset.back() + n_points);
+				compact_values->jac_offset.push_back(compact_values->jac_offset.back() + n_jacs);
+				for (int k = 0; k < n_points; ++k)
+				{
+					for (int d = 0; d < dim; ++d)
+						compact_values->val.push_back(vals.val(k, d));
+				}
+				for (int k = 0; k < n_jacs; ++k)
+				{
+					compact_values->det.push_back(vals.det(k));
+					compact_values->jac_it.insert(compact_values->jac_it.end(), vals.jac_it[k].data(), vals.jac_it[k].data() + dim * dim);
+				}
+				compact_size += element_size;
+				return true;
+			};
+
+			// the values are computed by blocks of elements. The layout is chosen after the first block: the compact one,
+			// unless its elements barely share reference values (e.g., polygons) and the full values fit in the budget.
+			// The full values are converted to the compact layout if they exceed the budget later, and the caching stops
+			// once the compact layout exceeds it as well, the elements after it are computed on demand
+			const int block_size = 4096;
+			std::vector<ElementAssemblyValues> block;
+			bool keep_full = false;
+			bool stop = false;
+			int e = 0;
+			reset_compact();
+			for (int block_start = 0; block_start < n_bases && !stop; block_start += block_size)
+			{
+				const int block_end = std::min(n_bases, block_start + block_size);
+				block.resize(block_end - block_start);
+
+				utils::maybe_parallel_for(block_end - block_start, [&](int start, int end, int thread_id) {
+					for (int i = start; i < end; ++i)
+					{
+						compute_values(block_start + i, is_volume, bases[block_start + i], gbases[block_start + i], block[i]);
+						block[i].release_scratch();
+					}
+				});
+
+				if (block_start == 0)
+				{
+					size_t block_full_size = 0;
+					for (; e < block_end && append_compact(block[e]); ++e)
+						block_full_size += block[e].memory_size();
+
+					if (e == block_end && 2 * compact_values->references.size() > size_t(block_end) && block_full_size <= max_memory)
+					{
+						keep_full = true;
+						reset_compact();
+						values->reserve(n_bases);
+						for (ElementAssemblyValues &vals : block)
+							values->push_back(std::move(vals));
+						full_size = block_full_size;
+					}
+					stop = e < block_end;
+					continue;
+				}
+
+				if (keep_full)
+				{
+					for (; e < block_end; ++e)
+					{
+						ElementAssemblyValues &vals = block[e - block_start];
+						const size_t size = vals.memory_size();
+						if (full_size + size > max_memory)
+							break;
+
+						full_size += size;
+						values->push_back(std::move(vals));
+					}
+
+					if (e < block_end)
+					{
+						// converts the full values one at a time to keep the peak memory low
+						keep_full = false;
+						int n_converted = 0;
+						for (ElementAssemblyValues &vals : *values)
+						{
+							if (!append_compact(vals))
+								break;
+							vals = ElementAssemblyValues();
+							++n_converted;
+						}
+						values.reset();
+
+						if (n_converted < e)
+						{
+							e = n_converted;
+							stop = true;
+							continue;
+						}
+					}
+				}
+
+				for (; e < block_end && !keep_full; ++e)
+				{
+					if (!append_compact(block[e - block_start]))
+					{
+						stop = true;
+						break;
+					}
+				}
+			}
+
+			if (keep_full)
+			{
+				cache = values;
+				memory_size_ = full_size;
+				return;
+			}
+
+			compact_values->references.shrink_to_fit();
+			compact_values->reference.shrink_to_fit();
+			compact_values->has_parameterization.shrink_to_fit();
+			compact_values->point_offset.shrink_to_fit();
+			compact_values->jac_offset.shrink_to_fit();
+			compact_values->val.shrink_to_fit();
+			compact_values->det.shrink_to_fit();
+			compact_values->jac_it.shrink_to_fit();
+
+			compact = compact_values;
+			memory_size_ = compact_size;
+			logger().debug("Assembly values cached in the compact layout for {}/{} elements ({} reference elements, {} MB)", n_cached(), n_bases, n_reference_elements(), memory_size_ / (1024 * 1024));
 		}
 
-		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		void AssemblyValsCache::init(const AssemblyValsCache &other, const std::vector<ElementBases> &bases)
 		{
-			if (cache.empty())
+			assert(other.n_cached() <= bases.size());
+
+			is_mass_ = other.is_mass_;
+			dof_map_.build(bases);
+			cache = other.cache;
+			compact = other.compact;
+			memory_size_ = other.memory_size_;
+		}
+
+		void AssemblyValsCache::compute_values(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (is_mass_)
 			{
-				if (is_mass_)
+				auto &quadrature = vals.quadrature;
+				basis.compute_mass_quadrature(quadrature);
+				vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+			}
+			else
+				vals.compute(el_index, is_volume, basis, gbasis);
+		}
+
+		void AssemblyValsCache::expand_values(const int el_index, const ElementBases &basis, ElementAssemblyValues &vals) const
+		{
+			const int dim = compact->dim;
+			const ReferenceValues &ref = compact->references[compact->reference[el_index]];
+			const int point_offset = compact->point_offset[el_index];
+			const int n_points = compact->point_offset[el_index + 1] - point_offset;
+			const int jac_offset = compact->jac_offset[el_index];
+			const bool affine = compact->jac_offset[el_index + 1] - jac_offset == 1;
+			assert(ref.val.size() == basis.bases.size());
+
+			vals.element_id = el_index;
+			vals.has_parameterization = compact->has_parameterization[el_index];
+			vals.val = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(compact->val.data() + point_offset * dim, n_points, dim);
+
+			vals.det.resize(n_points);
+			vals.jac_it.resize(n_points);
+			for (int k = 0; k < n_points; ++k)
+			{
+				const int j = jac_offset + (affine ? 0 : k);
+				vals.det(k) = compact->det[j];
+				vals.jac_it[k] = Eigen::Map<const Eigen::MatrixXd>(compact->jac_it.data() + j * dim * dim, dim, dim);
+			}
+
+			// the reference values are only copied when they change, the kernels read them from vals
+			const bool same_reference = vals.reference_id == ref.id;
+			if (!same_reference)
+			{
+				vals.quadrature = ref.quadrature;
+				vals.basis_values.resize(ref.val.size());
+				vals.reference_id = ref.id;
+			}
+
+			for (size_t i = 0; i < ref.val.size(); ++i)
+			{
+				AssemblyValues &v = vals.basis_values[i];
+				v.global = basis.bases[i].global();
+				if (!same_reference)
 				{
-					auto &quadrature = vals.quadrature;
-					basis.compute_mass_quadrature(quadrature);
-					vals.compute(el_index, is_volume, quadrature.points, basis, gbasis);
+					v.val = ref.val[i];
+					v.grad = ref.grad[i];
 				}
-				else
-					vals.compute(el_index, is_volume, basis, gbasis);
+
+				// same as ElementAssemblyValues::compute, the expanded values are identical to the computed ones
+				if (!vals.has_parameterization)
+				{
+					v.grad_t_m = v.grad;
+					continue;
+				}
+
+				v.finalize();
+				for (int k = 0; k < n_points; ++k)
+					v.grad_t_m.row(k) = v.grad.row(k) * vals.jac_it[k];
+			}
+		}
+
+		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
+		{
+			if (cache && el_index < cache->size())
+				vals = (*cache)[el_index];
+			else if (compact && el_index < compact->reference.size())
+			{
+				// vals is owned by the caller, the reference values are always copied
+				vals.reference_id = 0;
+				expand_values(el_index, basis, vals);
 			}
 			else
-				vals = cache[el_index];
+				compute_values(el_index, is_volume, basis, gbasis, vals);
+		}
+
+		const ElementAssemblyValues &AssemblyValsCache::get(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &tmp) const
+		{
+			if (cache && el_index < cache->size())
+				return (*cache)[el_index];
+
+			if (compact && el_index < compact->reference.size())
+				expand_values(el_index, basis, tmp);
+			else
+				compute_values(el_index, is_volume, basis, gbasis, tmp);
+			return tmp;
+		}
+
+		const ElementDofMap &AssemblyValsCache::dof_map(const std::vector<ElementBases> &bases, ElementDofMap &tmp) const
+		{
+			if (dof_map_.is_built_for(bases))
+			{
+				assert(dof_map_.has_same_connectivity(bases));
+				return dof_map_;
+			}
+
+			tmp.build(bases);
+			return tmp;
 		}
 	} // namespace assembler
 
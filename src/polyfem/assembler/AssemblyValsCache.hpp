@@ -1,6 +1,10 @@
 #pragma once
 
 #include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/basis/ElementDofMap.hpp>
+
+#include <limits>
+#include <memory>
 
 namespace polyfem
 {
@@ -9,19 +13,85 @@ namespace polyfem
 		class AssemblyValsCache
 		{
 		public:
-			void init(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const bool is_mass = false);
+			// builds the element to dof map and, if cache_values, the per element assembly values
+			// the values are stored in the compact layout, or in the full one if the elements barely share reference values and
+			// they fit in max_memory bytes. The caching stops when the compact layout uses max_memory bytes, the values of the
+			// other elements are computed on demand
+			void init(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const bool is_mass = false, const bool cache_values = true, const size_t max_memory = std::numeric_limits<size_t>::max());
+			// shares the (read only) assembly values of other, which must have been built for the same bases, and builds the element to dof map of bases
+			void init(const AssemblyValsCache &other, const std::vector<basis::ElementBases> &bases);
+			// copies (or computes) the values of element el_index in vals
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+			// read only view of the values of element el_index: the cached full values if any, otherwise they are
+			// expanded from the compact layout (without evaluating the bases) or computed in tmp. The reference values
+			// are only copied in tmp when they differ from the ones of the previous element expanded in it
+			const ElementAssemblyValues &get(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &tmp) const;
 
 			void clear()
 			{
-				cache.clear();
+				cache.reset();
+				compact.reset();
+				dof_map_.clear();
+				memory_size_ = 0;
 			}
 
 			inline bool is_mass() const { return is_mass_; }
+			// number of elements with cached values (in either layout), the first n_cached() elements
+			inline int n_cached() const { return cache ? cache->size() : (compact ? compact->reference.size() : 0); }
+			// true if the cached values are stored in the compact layout
+			inline bool is_compact() const { return compact != nullptr; }
+			// number of distinct reference element values stored by the compact layout
+			inline int n_reference_elements() const { return compact ? compact->references.size() : 0; }
+			// memory used by the cached values (in bytes)
+			inline size_t memory_size() const { return memory_size_; }
+
+			// compact element to dof map of the bases used in init (empty if init was not called)
+			inline const basis::ElementDofMap &dof_map() const { return dof_map_; }
+			// element to dof map of bases: the cached one if it was built from bases (same vector, see ElementDofMap::is_built_for),
+			// otherwise it is built in tmp. The owner must init or clear the cache when the bases are rebuilt
+			const basis::ElementDofMap &dof_map(const std::vector<basis::ElementBases> &bases, basis::ElementDofMap &tmp) const;
 
 		private:
-			std::vector<ElementAssemblyValues> cache;
-			bool is_mass_;
+			// values at the quadrature points of a reference element, shared by the elements with the same quadrature and local bases values
+			struct ReferenceValues
+			{
+				// unique id, see ElementAssemblyValues::reference_id
+				size_t id = 0;
+				quadrature::Quadrature quadrature;
+				std::vector<Eigen::MatrixXd> val;
+				std::vector<Eigen::MatrixXd> grad;
+			};
+
+			// compact layout: the reference values are stored once and the geometric mapping of the elements in contiguous
+			// arrays (structure of arrays), with a single jacobian for the affine elements (e.g., P1 geometry simplices)
+			struct CompactValues
+			{
+				int dim = 0;
+				std::vector<ReferenceValues> references;
+
+				// per element reference values and has_parameterization
+				std::vector<int> reference;
+				std::vector<char> has_parameterization;
+				// first point of the element in val and first jacobian in det, jac_it (n_elements + 1 entries)
+				std::vector<int> point_offset;
+				std::vector<int> jac_offset;
+
+				// img of the quadrature points (dim values per point)
+				std::vector<double> val;
+				// det and inverse transpose jacobian (dim x dim values, column major) per point, one per element if it is affine
+				std::vector<double> det;
+				std::vector<double> jac_it;
+			};
+
+			// shared between the caches initialized from each other, never modified after init
+			std::shared_ptr<const std::vector<ElementAssemblyValues>> cache;
+			std::shared_ptr<const CompactValues> compact;
+			basis::ElementDofMap dof_map_;
+			bool is_mass_ = false;
+			size_t memory_size_ = 0;
+
+			void compute_values(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+			void expand_values(const int el_index, const basis::ElementBases &basis, ElementAssemblyValues &vals) const;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -201,6 +201,7 @@ namespace polyfem
 		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis)
 		{
 			element_id = el_index;
+			reference_id = 0;
 			// const bool poly = !gbasis.has_parameterization;
 
 			basis_values.resize(basis.bases.size());
@@ -390,5 +391,27 @@ namespace polyfem
 
 			return is_volume ? is_geom_mapping_positive(dxmv, dymv, dzmv) : is_geom_mapping_positive(dxmv, dymv);
 		}
+
+		size_t ElementAssemblyValues::memory_size() const
+		{
+			const auto values_size = [](const std::vector<AssemblyValues> &values) {
+				size_t size = values.capacity() * sizeof(AssemblyValues);
+				for (const AssemblyValues &v : values)
+					size += v.global.capacity() * sizeof(Local2Global) + (v.val.size() + v.grad.size() + v.grad_t_m.size()) * sizeof(double);
+				return size;
+			};
+
+			return sizeof(ElementAssemblyValues)
+				   + values_size(basis_values) + values_size(g_basis_values_cache_)
+				   + jac_it.capacity() * sizeof(jac_it[0])
+				   + (quadrature.points.size() + quadrature.weights.size() + val.size() + det.size()) * sizeof(double);
+		}
+
+		void ElementAssemblyValues::release_scratch()
+		{
+			std::vector<AssemblyValues>().swap(g_basis_values_cache_);
+			basis_values.shrink_to_fit();
+			jac_it.shrink_to_fit();
+		}
 	} // namespace assembler
 } // namespace polyfem
@@ -30,6 +30,10 @@ namespace polyfem
 			// only poly elements have no parameterization
 			bool has_parameterization = true;
 
+			// id of the reference values of a compact AssemblyValsCache held by quadrature and basis_values (val, grad),
+			// they are not copied again for the next element with the same reference values. 0 if none, reset by compute
+			size_t reference_id = 0;
+
 			// computes the per element values at the quadrature points
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 			// computes the per element values at the local (ref el) points (pts)
@@ -37,6 +41,11 @@ namespace polyfem
 			// check if the element is flipped
 			bool is_geom_mapping_positive(const bool is_volume, const basis::ElementBases &gbasis) const;
 
+			// memory used by the values (in bytes), including the heap buffers
+			size_t memory_size() const;
+			// frees the scratch buffers of compute, the values stay valid (used for the cached values)
+			void release_scratch();
+
 		private:
 			std::vector<AssemblyValues> g_basis_values_cache_;
 
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+
+#include <Eigen/Core>
+
+#include <array>
+#include <vector>
+
+namespace polyfem::assembler
+{
+	// number of elements evaluated together by the batched kernels, one per SIMD lane of doubles
+#if defined(EIGEN_VECTORIZE_AVX512)
+	constexpr int BATCH_SIZE = 8;
+#elif defined(EIGEN_VECTORIZE_AVX)
+	constexpr int BATCH_SIZE = 4;
+#else
+	constexpr int BATCH_SIZE = 2;
+#endif
+
+	// one value per element of a batch
+	typedef Eigen::Array<double, BATCH_SIZE, 1> BatchScalar;
+	// per element dim x dim matrices stored as structure of arrays, entry (r, c) is at r * 3 + c
+	typedef std::array<BatchScalar, 9> BatchMatrix;
+
+	// elements with the same number of bases and quadrature points evaluated together,
+	// the lanes after n_lanes repeat the last element and have zero quadrature weights
+	class ElementBatch
+	{
+	public:
+		std::array<const ElementAssemblyValues *, BATCH_SIZE> vals;
+		// element of the first lane, the lanes hold consecutive elements
+		int first = 0;
+		int n_lanes = 0;
+		int dim = 0;
+
+		// quadrature point of the kernel evaluation
+		int p = 0;
+		// gradient of the displacement at p (in physical coordinates)
+		BatchMatrix disp_grad;
+
+		// results of NLAssembler::evaluate_batch
+		BatchScalar energy;
+		std::vector<BatchScalar> gradient; // R^{n_local_bases * dim}
+
+		// work buffers, the geometric values of all the quadrature points are gathered once per batch:
+		// grad_t_m[(p * n_local_bases + i) * dim + c] and da[p] = det * weight
+		std::vector<BatchScalar> local_disp;
+		std::vector<BatchScalar> grad_t_m;
+		std::vector<BatchScalar> da;
+
+		int n_local_bases() const { return vals[0]->basis_values.size(); }
+		int n_quadrature_points() const { return vals[0]->quadrature.weights.size(); }
+
+		// values of the element of lane l
+		const ElementAssemblyValues &lane(const int l) const { return *vals[l < n_lanes ? l : n_lanes - 1]; }
+		// element of lane l
+		int element(const int l) const { return first + (l < n_lanes ? l : n_lanes - 1); }
+	};
+
+	inline BatchScalar determinant(const BatchMatrix &F, const int dim)
+	{
+		if (dim == 2)
+			return F[0] * F[4] - F[1] * F[3];
+
+		return F[0] * (F[4] * F[8] - F[5] * F[7])
+			   - F[1] * (F[3] * F[8] - F[5] * F[6])
+			   + F[2] * (F[3] * F[7] - F[4] * F[6]);
+	}
+
+	// inverse transpose of F (i.e., cofactor matrix of F divided by det)
+	inline void inverse_transpose(const BatchMatrix &F, const BatchScalar &det, const int dim, BatchMatrix &F_it)
+	{
+		const BatchScalar inv_det = det.inverse();
+		if (dim == 2)
+		{
+			F_it[0] = F[4] * inv_det;
+			F_it[1] = -F[3] * inv_det;
+			F_it[3] = -F[1] * inv_det;
+			F_it[4] = F[0] * inv_det;
+			return;
+		}
+
+		F_it[0] = (F[4] * F[8] - F[5] * F[7]) * inv_det;
+		F_it[1] = (F[5] * F[6] - F[3] * F[8]) * inv_det;
+		F_it[2] = (F[3] * F[7] - F[4] * F[6]) * inv_det;
+		F_it[3] = (F[2] * F[7] - F[1] * F[8]) * inv_det;
+		F_it[4] = (F[0] * F[8] - F[2] * F[6]) * inv_det;
+		F_it[5] = (F[1] * F[6] - F[0] * F[7]) * inv_det;
+		F_it[6] = (F[1] * F[5] - F[2] * F[4]) * inv_det;
+		F_it[7] = (F[2] * F[3] - F[0] * F[5]) * inv_det;
+		F_it[8] = (F[0] * F[4] - F[1] * F[3]) * inv_det;
+	}
+} // namespace polyfem::assembler
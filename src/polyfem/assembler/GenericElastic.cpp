@@ -90,38 +90,155 @@ namespace polyfem::assembler
 	template <typename Derived>
 	Eigen::VectorXd GenericElastic<Derived>::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		const int n_bases = data.vals.basis_values.size();
-		return polyfem::gradient_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+		Eigen::VectorXd gradient;
+		Eigen::MatrixXd hessian;
+		assemble_gradient_hessian(data, false, gradient, hessian);
+		return gradient;
 	}
 
 	template <typename Derived>
 	Eigen::MatrixXd GenericElastic<Derived>::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
+		Eigen::VectorXd gradient;
+		Eigen::MatrixXd hessian;
+		assemble_gradient_hessian(data, true, gradient, hessian);
+		return hessian;
+	}
+
+	template <typename Derived>
+	void GenericElastic<Derived>::assemble_gradient_hessian(const NonLinearAssemblerData &data, const bool with_hessian, Eigen::VectorXd &gradient, Eigen::MatrixXd &hessian) const
+	{
+		const int n_bases = data.vals.basis_values.size();
+
+		if (size() == 2)
+		{
+			switch (n_bases)
+			{
+			case 3: // P1
+				assemble_gradient_hessian<2, 3>(data, with_hessian, gradient, hessian);
+				return;
+			case 4: // Q1
+				assemble_gradient_hessian<2, 4>(data, with_hessian, gradient, hessian);
+				return;
+			case 6: // P2
+				assemble_gradient_hessian<2, 6>(data, with_hessian, gradient, hessian);
+				return;
+			default:
+				assemble_gradient_hessian<2, Eigen::Dynamic>(data, with_hessian, gradient, hessian);
+				return;
+			}
+		}
+		else
+		{
+			assert(size() == 3);
+			switch (n_bases)
+			{
+			case 4: // P1
+				assemble_gradient_hessian<3, 4>(data, with_hessian, gradient, hessian);
+				return;
+			case 8: // Q1
+				assemble_gradient_hessian<3, 8>(data, with_hessian, gradient, hessian);
+				return;
+			case 10: // P2
+				assemble_gradient_hessian<3, 10>(data, with_hessian, gradient, hessian);
+				return;
+			default:
+				assemble_gradient_hessian<3, Eigen::Dynamic>(data, with_hessian, gradient, hessian);
+				return;
+			}
+		}
+	}
+
+	template <typename Derived>
+	template <int dim, int n_basis>
+	void GenericElastic<Derived>::assemble_gradient_hessian(const NonLinearAssemblerData &data, const bool with_hessian, Eigen::VectorXd &gradient, Eigen::MatrixXd &hessian) const
+	{
+		constexpr int N = n_basis == Eigen::Dynamic ? Eigen::Dynamic : dim * n_basis;
+		constexpr int dim2 = dim * dim;
+
+		// derivatives wrt the entries of the deformation gradient, F(d, c) is variable d * dim + c
+		typedef DScalar1<double, Eigen::Matrix<double, dim2, 1>> Diff1;
+		typedef DScalar2<double, Eigen::Matrix<double, dim2, 1>, Eigen::Matrix<double, dim2, dim2>> Diff2;
+
 		const int n_bases = data.vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+		assert(n_basis == Eigen::Dynamic || n_basis == n_bases);
+		assert(size() == dim);
+
+		Eigen::Matrix<double, n_basis, dim> local_disp(n_bases, dim);
+		local_disp.setZero();
+		for (int i = 0; i < n_bases; ++i)
+		{
+			const auto &bs = data.vals.basis_values[i];
+			for (size_t ii = 0; ii < bs.global.size(); ++ii)
+			{
+				for (int d = 0; d < dim; ++d)
+					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * dim + d);
+			}
+		}
+
+		Eigen::Matrix<double, n_basis, dim> local_grad(n_bases, dim);
+		local_grad.setZero();
+		Eigen::Matrix<double, N, N> local_hessian;
+		if (with_hessian)
+			local_hessian.setZero(n_bases * dim, n_bases * dim);
+
+		Eigen::Matrix<double, n_basis, dim> grad(n_bases, dim);
+		// dF / du, B(d * dim + c, i * dim + d) = ∂φᵢ/∂x_c
+		Eigen::Matrix<double, dim2, N> B(dim2, n_bases * dim);
+		Eigen::Matrix<double, dim, dim> stress;
+
+		DiffScalarBase::setVariableCount(dim2);
+
+		const int n_pts = data.da.size();
+		for (long p = 0; p < n_pts; ++p)
+		{
+			for (int i = 0; i < n_bases; ++i)
+				grad.row(i) = data.vals.basis_values[i].grad_t_m.row(p);
+
+			// Id + grad d
+			const Eigen::Matrix<double, dim, dim> F = Eigen::Matrix<double, dim, dim>::Identity() + local_disp.transpose() * grad;
+
+			Eigen::Matrix<double, dim2, dim2> stiffness;
+			if (with_hessian)
+			{
+				DefGradMatrix<Diff2> def_grad(dim, dim);
+				for (int d = 0; d < dim; ++d)
+					for (int c = 0; c < dim; ++c)
+						def_grad(d, c) = Diff2(d * dim + c, F(d, c));
+
+				const Diff2 val = derived().elastic_energy(data.vals.val.row(p), data.vals.element_id, def_grad);
+				stress = val.getGradient().reshaped(dim, dim).transpose();
+				stiffness = val.getHessian();
+			}
+			else
+			{
+				DefGradMatrix<Diff1> def_grad(dim, dim);
+				for (int d = 0; d < dim; ++d)
+					for (int c = 0; c < dim; ++c)
+						def_grad(d, c) = Diff1(d * dim + c, F(d, c));
+
+				const Diff1 val = derived().elastic_energy(data.vals.val.row(p), data.vals.element_id, def_grad);
+				stress = val.getGradient().reshaped(dim, dim).transpose();
+			}
+
+			// ∂W/∂uᵢ = ∂W/∂F ∇φᵢ
+			local_grad += data.da(p) * grad * stress.transpose();
+
+			if (with_hessian)
+			{
+				B.setZero();
+				for (int i = 0; i < n_bases; ++i)
+					for (int d = 0; d < dim; ++d)
+						for (int c = 0; c < dim; ++c)
+							B(d * dim + c, i * dim + d) = grad(i, c);
+
+				local_hessian.noalias() += data.da(p) * (B.transpose() * stiffness * B);
+			}
+		}
+
+		gradient = local_grad.transpose().reshaped();
+		if (with_hessian)
+			hessian = local_hessian;
 	}
 
 	template <typename Derived>
@@ -161,6 +278,45 @@ namespace polyfem::assembler
 		result = (hess * mat.reshaped(size() * size(), 1)).reshaped(size(), size());
 	}
 
+	template <typename Derived>
+	void GenericElastic<Derived>::compute_stress_grad(
+		const int el_id,
+		const double dt,
+		const Eigen::MatrixXd &local_pts,
+		const Eigen::MatrixXd &global_pts,
+		const Eigen::MatrixXd &grad_u_i,
+		const Eigen::MatrixXd &prev_grad_u_i,
+		Eigen::MatrixXd &stress,
+		Eigen::MatrixXd &result) const
+	{
+		typedef DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9>> Diff;
+
+		DiffScalarBase::setVariableCount(size() * size());
+		Eigen::Matrix<Diff, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> def_grad(size(), size());
+
+		Eigen::MatrixXd F = grad_u_i;
+		for (int d = 0; d < size(); ++d)
+			F(d, d) += 1.;
+
+		assert(local_pts.rows() == 1);
+		for (int i = 0; i < size(); ++i)
+			for (int j = 0; j < size(); ++j)
+				def_grad(i, j) = Diff(i + j * size(), F(i, j));
+
+		auto energy = derived().elastic_energy(global_pts, el_id, def_grad);
+
+		stress = energy.getGradient().reshaped(size(), size());
+
+		// The autodiff variables are column major, the result is row major: result(i * dim + j, k * dim + l) = ∂S_ij/∂F_kl
+		const Eigen::MatrixXd hess = energy.getHessian();
+		result.resize(size() * size(), size() * size());
+		for (int i = 0; i < size(); ++i)
+			for (int j = 0; j < size(); ++j)
+				for (int k = 0; k < size(); ++k)
+					for (int l = 0; l < size(); ++l)
+						result(i * size() + j, k * size() + l) = hess(i + j * size(), k + l * size());
+	}
+
 	template <typename Derived>
 	void GenericElastic<Derived>::compute_stress_grad_multiply_stress(
 		const int el_id,
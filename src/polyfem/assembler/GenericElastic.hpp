@@ -30,6 +30,9 @@ namespace polyfem::assembler
 		void compute_stress_grad_multiply_mat(const int el_id, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &global_pts, const Eigen::MatrixXd &grad_u_i, const Eigen::MatrixXd &mat, Eigen::MatrixXd &stress, Eigen::MatrixXd &result) const override;
 		void compute_stress_grad_multiply_stress(const int el_id, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &global_pts, const Eigen::MatrixXd &grad_u_i, Eigen::MatrixXd &stress, Eigen::MatrixXd &result) const override;
 		void compute_stress_grad_multiply_vect(const int el_id, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &global_pts, const Eigen::MatrixXd &grad_u_i, const Eigen::MatrixXd &vect, Eigen::MatrixXd &stress, Eigen::MatrixXd &result) const override;
+
+		bool has_stress_grad() const override { return true; }
+		void compute_stress_grad(const int el_id, const double dt, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &global_pts, const Eigen::MatrixXd &grad_u_i, const Eigen::MatrixXd &prev_grad_u_i, Eigen::MatrixXd &stress, Eigen::MatrixXd &result) const override;
 		/// @brief Returns this as a reference to derived class
 		Derived &derived() { return static_cast<Derived &>(*this); }
 		/// @brief Returns this as a const reference to derived class
@@ -39,6 +42,15 @@ namespace polyfem::assembler
 		virtual void add_multimaterial(const int index, const json &params, const Units &units) override = 0;
 
 	private:
+		// gradient and hessian of the energy obtained by chaining the derivatives of the energy density wrt the
+		// deformation gradient (autodiff on dim² variables only) with the gradients of the bases.
+		// n_basis is fixed for the common elements (P1/P2 simplices and Q1), Eigen::Dynamic otherwise
+		template <int dim, int n_basis>
+		void assemble_gradient_hessian(const NonLinearAssemblerData &data, const bool with_hessian, Eigen::VectorXd &gradient, Eigen::MatrixXd &hessian) const;
+
+		// dispatches to the fixed size kernel
+		void assemble_gradient_hessian(const NonLinearAssemblerData &data, const bool with_hessian, Eigen::VectorXd &gradient, Eigen::MatrixXd &hessian) const;
+
 		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const
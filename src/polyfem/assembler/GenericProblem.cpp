@@ -46,6 +46,24 @@ namespace polyfem
 
 				return j_boundary;
 			}
+
+			// rows[b] are the points on the boundary ids[b]
+			void group_by_boundary(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const std::vector<int> &ids, std::vector<std::vector<int>> &rows)
+			{
+				rows.assign(ids.size(), std::vector<int>());
+				for (long i = 0; i < global_ids.size(); ++i)
+				{
+					const int id = mesh.get_boundary_id(global_ids(i));
+					for (size_t b = 0; b < ids.size(); ++b)
+					{
+						if (id == ids[b])
+						{
+							rows[b].push_back(i);
+							break;
+						}
+					}
+				}
+			}
 		} // namespace
 
 		double TensorBCValue::eval(const RowVectorNd &pts, const int dim, const double t, const int el_id) const
@@ -70,6 +88,22 @@ namespace polyfem
 			return val;
 		}
 
+		void TensorBCValue::eval(const Eigen::MatrixXd &pts, const int dim, const double t, Eigen::VectorXd &val) const
+		{
+			value[dim].eval(pts, t, val);
+
+			if (interpolation.empty())
+			{
+			}
+			else if (interpolation.size() == 1)
+				val *= interpolation[0]->eval(t);
+			else
+			{
+				assert(dim < interpolation.size());
+				val *= interpolation[dim]->eval(t);
+			}
+		}
+
 		double ScalarBCValue::eval(const RowVectorNd &pts, const double t) const
 		{
 			assert(pts.size() == 2 || pts.size() == 3);
@@ -77,6 +111,12 @@ namespace polyfem
 			return value(x, y, z, t) * interpolation->eval(t);
 		}
 
+		void ScalarBCValue::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val) const
+		{
+			value.eval(pts, t, val);
+			val *= interpolation->eval(t);
+		}
+
 		GenericTensorProblem::GenericTensorProblem(const std::string &name)
 			: Problem(name), is_all_(false)
 		{
@@ -138,14 +178,11 @@ namespace polyfem
 				return;
 			}
 
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (int j = 0; j < pts.cols(); ++j)
 			{
-				for (int j = 0; j < pts.cols(); ++j)
-				{
-					double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-					val(i, j) = rhs_[j](x, y, z, t);
-				}
+				rhs_[j].eval(pts, t, tmp);
+				val.col(j) = tmp;
 			}
 		}
 
@@ -177,31 +214,31 @@ namespace polyfem
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			if (is_all_)
 			{
-				if (is_all_)
+				assert(displacements_.size() == 1);
+				for (int d = 0; d < val.cols(); ++d)
 				{
-					assert(displacements_.size() == 1);
-					for (int d = 0; d < val.cols(); ++d)
-					{
-						val(i, d) = displacements_[0].eval(pts.row(i), d, t);
-					}
+					displacements_[0].eval(pts, d, t, tmp);
+					val.col(d) = tmp;
 				}
-				else
-				{
-					const int id = mesh.get_boundary_id(global_ids(i));
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							for (int d = 0; d < val.cols(); ++d)
-							{
-								val(i, d) = displacements_[b].eval(pts.row(i), d, t);
-							}
+				return;
+			}
 
-							break;
-						}
-					}
+			std::vector<std::vector<int>> rows;
+			group_by_boundary(mesh, global_ids, boundary_ids_, rows);
+
+			for (size_t b = 0; b < boundary_ids_.size(); ++b)
+			{
+				if (rows[b].empty())
+					continue;
+
+				const Eigen::MatrixXd boundary_pts = pts(rows[b], Eigen::all);
+				for (int d = 0; d < val.cols(); ++d)
+				{
+					displacements_[b].eval(boundary_pts, d, t, tmp);
+					val(rows[b], d) = tmp;
 				}
 			}
 		}
@@ -210,34 +247,32 @@ namespace polyfem
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			std::vector<std::vector<int>> rows;
+
+			group_by_boundary(mesh, global_ids, neumann_boundary_ids_, rows);
+			for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
+				if (rows[b].empty())
+					continue;
 
-				for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
+				const Eigen::MatrixXd boundary_pts = pts(rows[b], Eigen::all);
+				for (int d = 0; d < val.cols(); ++d)
 				{
-					if (id == neumann_boundary_ids_[b])
-					{
-						for (int d = 0; d < val.cols(); ++d)
-						{
-							val(i, d) = forces_[b].eval(pts.row(i), d, t);
-						}
-
-						break;
-					}
+					forces_[b].eval(boundary_pts, d, t, tmp);
+					val(rows[b], d) = tmp;
 				}
+			}
 
-				for (size_t b = 0; b < pressure_boundary_ids_.size(); ++b)
-				{
-					if (id == pressure_boundary_ids_[b])
-					{
-						for (int d = 0; d < val.cols(); ++d)
-						{
-							val(i, d) = pressures_[b].eval(pts.row(i), t) * normals(i, d);
-						}
-						break;
-					}
-				}
+			group_by_boundary(mesh, global_ids, pressure_boundary_ids_, rows);
+			for (size_t b = 0; b < pressure_boundary_ids_.size(); ++b)
+			{
+				if (rows[b].empty())
+					continue;
+
+				pressures_[b].eval(pts(rows[b], Eigen::all), t, tmp);
+				for (int d = 0; d < val.cols(); ++d)
+					val(rows[b], d) = tmp.array() * normals(rows[b], d).array();
 			}
 		}
 
@@ -1129,37 +1164,34 @@ namespace polyfem
 				val.setZero();
 				return;
 			}
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
-			{
-				double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-				val(i) = rhs_(x, y, z, t);
-			}
+			Eigen::VectorXd tmp;
+			rhs_.eval(pts, t, tmp);
+			val.col(0) = tmp;
 		}
 
 		void GenericScalarProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			if (is_all_)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
-				if (is_all_)
-				{
-					assert(dirichlet_.size() == 1);
-					val(i) = dirichlet_[0].eval(pts.row(i), t);
-				}
-				else
-				{
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							val(i) = dirichlet_[b].eval(pts.row(i), t);
-							break;
-						}
-					}
-				}
+				assert(dirichlet_.size() == 1);
+				dirichlet_[0].eval(pts, t, tmp);
+				val.col(0) = tmp;
+				return;
+			}
+
+			std::vector<std::vector<int>> rows;
+			group_by_boundary(mesh, global_ids, boundary_ids_, rows);
+
+			for (size_t b = 0; b < boundary_ids_.size(); ++b)
+			{
+				if (rows[b].empty())
+					continue;
+
+				dirichlet_[b].eval(pts(rows[b], Eigen::all), t, tmp);
+				val(rows[b], 0) = tmp;
 			}
 		}
 
@@ -1167,19 +1199,17 @@ namespace polyfem
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
 
-			for (long i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			std::vector<std::vector<int>> rows;
+			group_by_boundary(mesh, global_ids, neumann_boundary_ids_, rows);
+
+			for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
+				if (rows[b].empty())
+					continue;
 
-				for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
-				{
-					if (id == neumann_boundary_ids_[b])
-					{
-						double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-						val(i) = neumann_[b].eval(pts.row(i), t);
-						break;
-					}
-				}
+				neumann_[b].eval(pts(rows[b], Eigen::all), t, tmp);
+				val(rows[b], 0) = tmp;
 			}
 		}
 
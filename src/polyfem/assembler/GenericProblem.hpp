@@ -21,6 +21,8 @@ namespace polyfem
 			}
 
 			double eval(const RowVectorNd &pts, const int dim, const double t, const int el_id = -1) const;
+			// evaluates dimension dim at every row of pts
+			void eval(const Eigen::MatrixXd &pts, const int dim, const double t, Eigen::VectorXd &val) const;
 
 		};
 
@@ -35,6 +37,8 @@ namespace polyfem
 			}
       
 			double eval(const RowVectorNd &pts, const double t) const;
+			// evaluates at every row of pts
+			void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val) const;
 		};
 
 		class GenericTensorProblem : public Problem
@@ -22,6 +22,27 @@ namespace polyfem::assembler
 		return Eigen::Matrix<double, 1, 1>::Constant(res);
 	}
 
+	void Laplacian::assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const
+	{
+		const int n_bases = vals.basis->n_bases();
+		const int n_pts = vals.da.size();
+		local.resize(n_bases, n_bases);
+
+		Eigen::MatrixXd grad, grad_t_m(n_pts, 3);
+		Eigen::VectorXd col;
+		for (int j = 0; j < n_bases; ++j)
+		{
+			vals.basis->eval_grad(j, grad);
+			for (int k = 0; k < n_pts; ++k)
+				grad_t_m.row(k) = grad.row(k) * vals.jac_it[k];
+
+			// column j: sum_q ∇φᵢ⋅∇φⱼ da
+			col.setZero(n_bases);
+			vals.integrate_grad(grad_t_m, col);
+			local.col(j) = col;
+		}
+	}
+
 	Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> Laplacian::compute_rhs(const AutodiffHessianPt &pt) const
 	{
 		Eigen::Matrix<double, 1, 1> result;
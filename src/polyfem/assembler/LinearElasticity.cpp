@@ -62,6 +62,50 @@ namespace polyfem
 			return res;
 		}
 
+		void LinearElasticity::assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const
+		{
+			assert(size() == 3);
+			const int n_bases = vals.basis->n_bases();
+			const int n_pts = vals.da.size();
+			local.resize(n_bases * size(), n_bases * size());
+
+			Eigen::VectorXd lambda(n_pts), mu(n_pts);
+			for (int k = 0; k < n_pts; ++k)
+				params_.lambda_mu(vals.quadrature.points.row(k), vals.val.row(k), vals.element_id, lambda(k), mu(k));
+
+			Eigen::MatrixXd grad, grad_t_m(n_pts, 3), flux(n_pts, 3);
+			Eigen::VectorXd col;
+			for (int j = 0; j < n_bases; ++j)
+			{
+				vals.basis->eval_grad(j, grad);
+				for (int k = 0; k < n_pts; ++k)
+					grad_t_m.row(k) = grad.row(k) * vals.jac_it[k];
+
+				for (int n = 0; n < size(); ++n)
+				{
+					// displacement φⱼ eₙ, ∇u = eₙ ∇φⱼᵀ
+					for (int m = 0; m < size(); ++m)
+					{
+						// row m of the stress mu (∇u + ∇uᵀ) + lambda tr(∇u) Id
+						for (int k = 0; k < n_pts; ++k)
+						{
+							flux.row(k).setZero();
+							if (m == n)
+								flux.row(k) += mu(k) * grad_t_m.row(k);
+							flux(k, n) += mu(k) * grad_t_m(k, m);
+							flux(k, m) += lambda(k) * grad_t_m(k, n);
+						}
+
+						col.setZero(n_bases);
+						vals.integrate_grad(flux, col);
+
+						for (int i = 0; i < n_bases; ++i)
+							local(i * size() + m, j * size() + n) = col(i);
+					}
+				}
+			}
+		}
+
 		double LinearElasticity::compute_energy(const NonLinearAssemblerData &data) const
 		{
 			return compute_energy_aux<double>(data);
@@ -102,6 +146,42 @@ namespace polyfem
 				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
 		}
 
+		void LinearElasticity::compute_batched_stress(const ElementBatch &batch, BatchScalar &energy, BatchMatrix *stress) const
+		{
+			const int dim = batch.dim;
+
+			BatchScalar lambda, mu;
+			params_.lambda_mu(batch, lambda, mu);
+
+			// eps = (∇u + ∇uᵀ) / 2
+			BatchMatrix strain;
+			BatchScalar trace = BatchScalar::Zero();
+			BatchScalar strain_norm = BatchScalar::Zero();
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					strain[d * 3 + c] = (batch.disp_grad[d * 3 + c] + batch.disp_grad[c * 3 + d]) / 2.0;
+					strain_norm += strain[d * 3 + c].square();
+				}
+				trace += strain[d * 3 + d];
+			}
+
+			// mu eps : eps + lambda/2 tr(eps)^2
+			energy = mu * strain_norm + lambda / 2.0 * trace.square();
+
+			if (stress == nullptr)
+				return;
+
+			// sigma = 2 mu eps + lambda tr(eps) Id, symmetric hence also the derivative wrt ∇u
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+					(*stress)[d * 3 + c] = 2.0 * mu * strain[d * 3 + c];
+				(*stress)[d * 3 + d] += lambda * trace;
+			}
+		}
+
 		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
 		template <typename T>
 		T LinearElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
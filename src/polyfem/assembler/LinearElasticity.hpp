@@ -22,6 +22,10 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
 
+		// computes the local matrix of a Lagrange hex element with sum factorization
+		bool has_tensor_product_kernel() const override { return true; }
+		void assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const override;
+
 		// compute elastic energy
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		// neccessary for mixing linear model with non-linear collision response
@@ -29,6 +33,10 @@ namespace polyfem::assembler
 		// compute gradient of elastic energy, as assembler
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
+		// energy and stress of a batch of elements, used by assemble_energy and assemble_gradient
+		bool has_batched_kernel() const override { return true; }
+		void compute_batched_stress(const ElementBatch &batch, BatchScalar &energy, BatchMatrix *stress) const override;
+
 		// kernel of the pde, used in kernel problem
 		Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const int dim, const AutodiffGradPt &r, const AutodiffScalarGrad &) const override;
 
@@ -19,6 +19,29 @@ namespace polyfem::assembler
 		return res;
 	}
 
+	void Mass::assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const
+	{
+		const int n_bases = vals.basis->n_bases();
+		const int n_pts = vals.da.size();
+		local.setZero(n_bases * size(), n_bases * size());
+
+		Eigen::VectorXd rho_da(n_pts);
+		for (int q = 0; q < n_pts; ++q)
+			rho_da(q) = density_(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) * vals.da(q);
+
+		Eigen::VectorXd phi;
+		Eigen::MatrixXd col;
+		for (int j = 0; j < n_bases; ++j)
+		{
+			vals.basis->eval_basis(j, phi);
+			vals.basis->integrate(phi.cwiseProduct(rho_da), col);
+
+			for (int i = 0; i < n_bases; ++i)
+				for (int d = 0; d < size(); ++d)
+					local(i * size() + d, j * size() + d) = col(i);
+		}
+	}
+
 	Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> Mass::compute_rhs(const AutodiffHessianPt &pt) const
 	{
 		assert(false);
@@ -15,6 +15,10 @@ namespace polyfem::assembler
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
 
+		// computes the local matrix of a Lagrange hex element with sum factorization
+		bool has_tensor_product_kernel() const override { return true; }
+		void assemble_tensor_product(const TensorProductElementValues &vals, Eigen::MatrixXd &local) const override;
+
 		// uses autodiff to compute the rhs for a fabricated solution
 		// in this case it just return pt.getHessian().trace()
 		// pt is the evaluation of the solution at a point
@@ -312,6 +312,26 @@ namespace polyfem::assembler
 		is_lambda_mu_ = true;
 	}
 
+	void LameParameters::lambda_mu(const ElementBatch &batch, BatchScalar &lambda, BatchScalar &mu) const
+	{
+		// single constant material, evaluated once for all the lanes
+		if (lambda_or_E_.size() == 1 && mu_or_nu_.size() == 1 && lambda_or_E_[0].is_constant() && mu_or_nu_[0].is_constant()
+			&& lambda_mat_.size() == 0 && mu_mat_.size() == 0)
+		{
+			double l, m;
+			lambda_mu(0, 0, 0, 0, 0, 0, batch.element(0), l, m);
+			lambda.setConstant(l);
+			mu.setConstant(m);
+			return;
+		}
+
+		for (int l = 0; l < BATCH_SIZE; ++l)
+		{
+			const ElementAssemblyValues &vals = batch.lane(l);
+			lambda_mu(vals.quadrature.points.row(batch.p), vals.val.row(batch.p), vals.element_id, lambda(l), mu(l));
+		}
+	}
+
 	void LameParameters::lambda_mu(double px, double py, double pz, double x, double y, double z, int el_id, double &lambda, double &mu) const
 	{
 		assert(lambda_or_E_.size() == 1 || el_id < lambda_or_E_.size());
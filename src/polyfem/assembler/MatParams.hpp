@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/Common.hpp>
+#include <polyfem/assembler/ElementBatch.hpp>
 #include <polyfem/utils/Types.hpp>
 #include <polyfem/utils/ExpressionValue.hpp>
 
@@ -81,6 +82,8 @@ namespace polyfem::assembler
 				p(0), p(1), p.size() == 3 ? p(2) : 0.0,
 				el_id, lambda, mu);
 		}
+		// lambda and mu at the quadrature point batch.p of the elements of the batch
+		void lambda_mu(const ElementBatch &batch, BatchScalar &lambda, BatchScalar &mu) const;
 
 		Eigen::MatrixXd lambda_mat_, mu_mat_;
 
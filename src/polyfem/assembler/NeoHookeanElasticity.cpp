@@ -287,6 +287,45 @@ namespace polyfem::assembler
 		return compute_energy_aux<double>(data);
 	}
 
+	void NeoHookeanElasticity::compute_batched_stress(const ElementBatch &batch, BatchScalar &energy, BatchMatrix *stress) const
+	{
+		const int dim = batch.dim;
+
+		BatchScalar lambda, mu;
+		params_.lambda_mu(batch, lambda, mu);
+
+		// F = Id + ∇u
+		BatchMatrix F = batch.disp_grad;
+		for (int d = 0; d < dim; ++d)
+			F[d * 3 + d] += 1.0;
+
+		const BatchScalar det_j = determinant(F, dim);
+		const BatchScalar log_det_j = det_j.log();
+
+		BatchScalar trace_FtF = BatchScalar::Zero();
+		for (int d = 0; d < dim; ++d)
+			for (int c = 0; c < dim; ++c)
+				trace_FtF += F[d * 3 + c].square();
+
+		// ½μ (tr(FᵀF) - d - 2ln(J)) + ½λ ln²(J)
+		energy = mu / 2.0 * (trace_FtF - double(dim) - 2.0 * log_det_j) + lambda / 2.0 * log_det_j.square();
+
+		if (stress == nullptr)
+			return;
+
+		// P = μ (F - F⁻ᵀ) + λ ln(J) F⁻ᵀ
+		BatchMatrix F_it;
+		inverse_transpose(F, det_j, dim, F_it);
+		for (int d = 0; d < dim; ++d)
+		{
+			for (int c = 0; c < dim; ++c)
+			{
+				const int k = d * 3 + c;
+				(*stress)[k] = mu * (F[k] - F_it[k]) + lambda * log_det_j * F_it[k];
+			}
+		}
+	}
+
 	// Compute ∫ ½μ (tr(FᵀF) - 3 - 2ln(J)) + ½λ ln²(J) du
 	template <typename T>
 	T NeoHookeanElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
@@ -567,6 +606,34 @@ namespace polyfem::assembler
 		result = mu * mat + FmT * mat.transpose() * FmT * (mu - lambda * std::log(def_grad.determinant())) + lambda * (FmT.array() * mat.array()).sum() * FmT;
 	}
 
+	void NeoHookeanElasticity::compute_stress_grad(
+		const int el_id,
+		const double dt,
+		const Eigen::MatrixXd &local_pts,
+		const Eigen::MatrixXd &global_pts,
+		const Eigen::MatrixXd &grad_u_i,
+		const Eigen::MatrixXd &prev_grad_u_i,
+		Eigen::MatrixXd &stress,
+		Eigen::MatrixXd &result) const
+	{
+		double lambda, mu;
+		params_.lambda_mu(local_pts, global_pts, el_id, lambda, mu);
+
+		Eigen::MatrixXd def_grad = Eigen::MatrixXd::Identity(grad_u_i.rows(), grad_u_i.cols()) + grad_u_i;
+		Eigen::MatrixXd FmT = def_grad.inverse().transpose();
+		const double log_det = std::log(def_grad.determinant());
+
+		stress = mu * (def_grad - FmT) + lambda * log_det * FmT;
+
+		// ∂S_ij/∂F_kl = mu δ_ik δ_jl + (mu - lambda log J) FmT_il FmT_kj + lambda FmT_ij FmT_kl, stored row major
+		result.resize(size() * size(), size() * size());
+		for (int i = 0; i < size(); ++i)
+			for (int j = 0; j < size(); ++j)
+				for (int k = 0; k < size(); ++k)
+					for (int l = 0; l < size(); ++l)
+						result(i * size() + j, k * size() + l) = (i == k && j == l ? mu : 0.) + (mu - lambda * log_det) * FmT(i, l) * FmT(k, j) + lambda * FmT(i, j) * FmT(k, l);
+	}
+
 	void NeoHookeanElasticity::compute_stress_grad_multiply_stress(const int el_id, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &global_pts, const Eigen::MatrixXd &grad_u_i, Eigen::MatrixXd &stress, Eigen::MatrixXd &result) const
 	{
 		double lambda, mu;
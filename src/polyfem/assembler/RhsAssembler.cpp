@@ -29,6 +29,49 @@ namespace polyfem
 					val = 0;
 				}
 			};
+
+			class LocalThreadVecStorage
+			{
+			public:
+				Eigen::MatrixXd vec;
+				ElementAssemblyValues vals;
+
+				LocalThreadVecStorage(const int size)
+				{
+					vec.setZero(size, 1);
+				}
+			};
+
+			// flattened primitives of a boundary (element, type, local and global primitive ids), identifies it independently of the container holding it
+			std::vector<int> boundary_primitives(const std::vector<LocalBoundary> &local_boundary)
+			{
+				std::vector<int> primitives;
+				for (const LocalBoundary &lb : local_boundary)
+				{
+					primitives.push_back(lb.element_id());
+					primitives.push_back(int(lb.type()));
+					primitives.push_back(lb.size());
+					for (int i = 0; i < lb.size(); ++i)
+					{
+						primitives.push_back(lb.local_primitive_id(i));
+						primitives.push_back(lb.global_primitive_id(i));
+					}
+				}
+				return primitives;
+			}
+
+			// mask of the dofs in bounday_nodes
+			Eigen::Matrix<bool, Eigen::Dynamic, 1> boundary_mask(const std::vector<int> &bounday_nodes, const int size)
+			{
+				Eigen::Matrix<bool, Eigen::Dynamic, 1> mask(size);
+				mask.setConstant(false);
+				for (int b : bounday_nodes)
+				{
+					if (b < size)
+						mask[b] = true;
+				}
+				return mask;
+			}
 		} // namespace
 
 		RhsAssembler::RhsAssembler(const Assembler &assembler, const Mesh &mesh, const Obstacle &obstacle,
@@ -65,43 +108,54 @@ namespace polyfem
 			rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
 			if (!problem_.is_rhs_zero())
 			{
-				Eigen::MatrixXd rhs_fun;
-
 				const int n_elements = int(bases_.size());
-				ElementAssemblyValues vals;
-				for (int e = 0; e < n_elements; ++e)
-				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+				basis::ElementDofMap tmp_dof_map;
+				const basis::ElementDofMap &dof_map = ass_vals_cache_.dof_map(bases_, tmp_dof_map);
 
-					const Quadrature &quadrature = vals.quadrature;
+				auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
 
-					problem_.rhs(assembler_, vals.val, t, rhs_fun);
+				maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+					LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+					Eigen::MatrixXd rhs_fun;
 
-					for (int d = 0; d < size_; ++d)
+					for (int e = start; e < end; ++e)
 					{
-						// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
-						for (int q = 0; q < quadrature.weights.size(); ++q)
-						{
-							// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
-							const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id);
-							rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
-						}
-					}
+						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
-					const int n_loc_bases_ = int(vals.basis_values.size());
-					for (int i = 0; i < n_loc_bases_; ++i)
-					{
-						const AssemblyValues &v = vals.basis_values[i];
+						const Quadrature &quadrature = vals.quadrature;
+
+						problem_.rhs(assembler_, vals.val, t, rhs_fun);
 
 						for (int d = 0; d < size_; ++d)
 						{
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
+							// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
+							for (int q = 0; q < quadrature.weights.size(); ++q)
+							{
+								// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
+								const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id);
+								rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
+							}
+						}
+
+						const int n_loc_bases_ = int(vals.basis_values.size());
+						for (int i = 0; i < n_loc_bases_; ++i)
+						{
+							const AssemblyValues &v = vals.basis_values[i];
+
+							for (int d = 0; d < size_; ++d)
+							{
+								const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+								for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+									local_storage.vec(dof_map.index(ii) * size_ + d) += rhs_value * dof_map.weight(ii);
+							}
 						}
 					}
-				}
+				});
+
+				// Serially merge local storages
+				for (const LocalThreadVecStorage &local_storage : storage)
+					rhs += local_storage.vec;
 			}
 		}
 
@@ -167,6 +221,8 @@ namespace polyfem
 			}
 			else
 			{
+				basis::ElementDofMap tmp_dof_map;
+				const basis::ElementDofMap &dof_map = ass_vals_cache_.dof_map(bases_, tmp_dof_map);
 
 				for (int e = 0; e < n_elements; ++e)
 				{
@@ -190,8 +246,8 @@ namespace polyfem
 						for (int d = 0; d < size_; ++d)
 						{
 							const double sol_value = (loc_sol.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								sol(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
+							for (int ii = dof_map.begin(e, i); ii < dof_map.end(e, i); ++ii)
+								sol(dof_map.index(ii) * size_ + d) += sol_value * dof_map.weight(ii);
 						}
 					}
 				}
@@ -226,13 +282,20 @@ namespace polyfem
 			}
 		}
 
-		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
-								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		RhsAssembler::DirichletLsqCache &RhsAssembler::dirichlet_lsq_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const
 		{
-			const int n_el = int(bases_.size());
+			std::vector<int> boundary = boundary_primitives(local_boundary);
 
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun;
-			Eigen::VectorXi global_primitive_ids;
+			if (dirichlet_lsq_cache_ != nullptr
+				&& dirichlet_lsq_cache_->resolution == resolution
+				&& dirichlet_lsq_cache_->boundary == boundary
+				&& dirichlet_lsq_cache_->boundary_nodes == bounday_nodes)
+				return *dirichlet_lsq_cache_;
+
+			auto cache = std::make_unique<DirichletLsqCache>();
+			cache->resolution = resolution;
+			cache->boundary = std::move(boundary);
+			cache->boundary_nodes = bounday_nodes;
 
 			const int actual_dim = problem_.is_scalar() ? 1 : mesh_.dimension();
 
@@ -250,165 +313,180 @@ namespace polyfem
 			}
 			assert(skipped_count <= 1);
 
-			for (int d = 0; d < size_; ++d)
-			{
-				int index = 0;
-				std::vector<int> indices;
-				indices.reserve(n_el * 10);
-				std::vector<int> tags;
-				tags.reserve(n_el * 10);
-
-				long total_size = 0;
-
-				Eigen::VectorXi global_index_to_col(n_basis_);
-				global_index_to_col.setConstant(-1);
+			// Sample the boundary and evaluate the bases, this is independent of the bc
+			const int n_lb = int(local_boundary.size());
+			std::vector<DirichletLsqCache::Element> elements(n_lb);
+			std::vector<Eigen::MatrixXd> basis_values(n_lb); // #samples x #local bases
+			std::vector<bool> has_samples(n_lb, false);
 
+			maybe_parallel_for(n_lb, [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd samples;
 				std::vector<AssemblyValues> tmp_val;
 
-				for (const auto &lb : local_boundary)
+				for (int k = start; k < end; ++k)
 				{
+					const LocalBoundary &lb = local_boundary[k];
 					const int e = lb.element_id();
-					bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, true, uv, samples, global_primitive_ids);
+					DirichletLsqCache::Element &el = elements[k];
 
-					if (!has_samples)
+					if (!utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, el.uv, samples, el.global_primitive_ids))
 						continue;
+					has_samples[k] = true;
+					assert(el.global_primitive_ids.size() == samples.rows());
+
+					gbases_[e].eval_geom_mapping(samples, el.mapped);
 
 					const basis::ElementBases &bs = bases_[e];
 					bs.evaluate_bases(samples, tmp_val);
-					const int n_local_bases = int(bs.bases.size());
-					assert(global_primitive_ids.size() == samples.rows());
+					basis_values[k].resize(samples.rows(), bs.bases.size());
+					for (int j = 0; j < bs.bases.size(); ++j)
+						basis_values[k].col(j) = tmp_val[j].val;
+				}
+			});
+
+			std::vector<int> sampled_boundary;
+			for (int k = 0; k < n_lb; ++k)
+			{
+				if (!has_samples[k])
+					continue;
+				sampled_boundary.push_back(k);
+				cache->elements.push_back(std::move(elements[k]));
+			}
+
+			cache->systems.resize(size_);
+			for (int d = 0; d < size_; ++d)
+			{
+				DirichletLsqCache::System &system = cache->systems[d];
+
+				Eigen::VectorXi global_index_to_col(n_basis_);
+				global_index_to_col.setConstant(-1);
 
-					for (int s = 0; s < samples.rows(); ++s)
+				for (int k = 0; k < sampled_boundary.size(); ++k)
+				{
+					const basis::ElementBases &bs = bases_[local_boundary[sampled_boundary[k]].element_id()];
+					const Eigen::MatrixXd &vals = basis_values[sampled_boundary[k]];
+					const Eigen::VectorXi &global_primitive_ids = cache->elements[k].global_primitive_ids;
+
+					for (int s = 0; s < vals.rows(); ++s)
 					{
 						const int tag = mesh_.get_boundary_id(global_primitive_ids(s));
 						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
 							continue;
 
-						total_size++;
+						system.rows.emplace_back(k, s);
 
-						for (int j = 0; j < n_local_bases; ++j)
+						for (int j = 0; j < vals.cols(); ++j)
 						{
-							const basis::Basis &b = bs.bases[j];
-							const double tmp = tmp_val[j].val(s);
-
-							if (fabs(tmp) < 1e-10)
+							if (fabs(vals(s, j)) < 1e-10)
 								continue;
 
-							for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+							for (const auto &g : bs.bases[j].global())
 							{
 								// pt found
-								if (is_boundary[b.global()[ii].index])
+								if (is_boundary[g.index] && global_index_to_col(g.index) == -1)
 								{
-									if (global_index_to_col(b.global()[ii].index) == -1)
-									{
-										global_index_to_col(b.global()[ii].index) = index++;
-										indices.push_back(b.global()[ii].index);
-										tags.push_back(tag);
-										assert(indices.size() == size_t(index));
-									}
+									global_index_to_col(g.index) = system.indices.size();
+									system.indices.push_back(g.index);
+									system.tags.push_back(tag);
 								}
 							}
 						}
 					}
 				}
 
-				Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, 1);
-
-				const long buffer_size = total_size * long(indices.size());
-				std::vector<Eigen::Triplet<double>> entries, entries_t;
+				std::vector<Eigen::Triplet<double>> entries_t;
+				for (int r = 0; r < system.rows.size(); ++r)
+				{
+					const auto [k, s] = system.rows[r];
+					const basis::ElementBases &bs = bases_[local_boundary[sampled_boundary[k]].element_id()];
+					const Eigen::MatrixXd &vals = basis_values[sampled_boundary[k]];
 
-				index = 0;
+					for (int j = 0; j < vals.cols(); ++j)
+					{
+						for (const auto &g : bs.bases[j].global())
+						{
+							const int item = global_index_to_col(g.index);
+							if (item != -1)
+								entries_t.emplace_back(item, r, vals(s, j) * g.val);
+						}
+					}
+				}
 
-				int global_counter = 0;
-				Eigen::MatrixXd mapped;
+				system.mat_t.resize(int(system.indices.size()), int(system.rows.size()));
+				system.mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
 
-				for (const auto &lb : local_boundary)
-				{
-					const int e = lb.element_id();
-					bool has_samples = utils::BoundarySampler::sample_boundary(lb, resolution, mesh_, false, uv, samples, global_primitive_ids);
+				const StiffnessMatrix mat = system.mat_t.transpose();
+				system.A = system.mat_t * mat;
+			}
 
-					if (!has_samples)
-						continue;
+			dirichlet_lsq_cache_ = std::move(cache);
+			return *dirichlet_lsq_cache_;
+		}
 
-					const basis::ElementBases &bs = bases_[e];
-					const basis::ElementBases &gbs = gbases_[e];
-					const int n_local_bases = int(bs.bases.size());
+		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
+								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		{
+			DirichletLsqCache &cache = dirichlet_lsq_cache(local_boundary, bounday_nodes, resolution);
 
-					gbs.eval_geom_mapping(samples, mapped);
+			// Only the bc is evaluated, the samples and the systems are reused
+			std::vector<Eigen::MatrixXd> rhs_fun(cache.elements.size());
+			maybe_parallel_for(cache.elements.size(), [&](int start, int end, int thread_id) {
+				for (int k = start; k < end; ++k)
+				{
+					const DirichletLsqCache::Element &el = cache.elements[k];
+					df(el.global_primitive_ids, el.uv, el.mapped, rhs_fun[k]);
+				}
+			});
 
-					bs.evaluate_bases(samples, tmp_val);
-					df(global_primitive_ids, uv, mapped, rhs_fun);
+			for (int d = 0; d < size_; ++d)
+			{
+				DirichletLsqCache::System &system = cache.systems[d];
+				const long total_size = system.rows.size();
 
-					for (int s = 0; s < samples.rows(); ++s)
-					{
-						const int tag = mesh_.get_boundary_id(global_primitive_ids(s));
-						if (!problem_.all_dimensions_dirichlet() && !problem_.is_dimension_dirichet(tag, d))
-							continue;
+				if (total_size <= 0)
+					continue;
 
-						for (int j = 0; j < n_local_bases; ++j)
-						{
-							const basis::Basis &b = bs.bases[j];
-							const double tmp = tmp_val[j].val(s);
+				Eigen::MatrixXd global_rhs(total_size, 1);
+				for (long r = 0; r < total_size; ++r)
+					global_rhs(r) = rhs_fun[system.rows[r].first](system.rows[r].second, d);
 
-							for (std::size_t ii = 0; ii < b.global().size(); ++ii)
-							{
-								auto item = global_index_to_col(b.global()[ii].index);
-								if (item != -1)
-								{
-									entries.push_back(Eigen::Triplet<double>(global_counter, item, tmp * b.global()[ii].val));
-									entries_t.push_back(Eigen::Triplet<double>(item, global_counter, tmp * b.global()[ii].val));
-								}
-							}
-						}
+				const double mmin = global_rhs.minCoeff();
+				const double mmax = global_rhs.maxCoeff();
 
-						global_rhs(global_counter) = rhs_fun(s, d);
-						global_counter++;
+				if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+				{
+					for (size_t i = 0; i < system.indices.size(); ++i)
+					{
+						const int tag = system.tags[i];
+						if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
+							rhs(system.indices[i] * size_ + d) = 0;
 					}
 				}
-
-				assert(global_counter == total_size);
-
-				if (total_size > 0)
+				else
 				{
-					const double mmin = global_rhs.minCoeff();
-					const double mmax = global_rhs.maxCoeff();
+					const StiffnessMatrix &A = system.A;
 
-					if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+					if (system.solver == nullptr)
 					{
-						for (size_t i = 0; i < indices.size(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = 0;
-						}
+						system.solver = LinearSolver::create(solver_, preconditioner_);
+						system.solver->setParameters(solver_params_);
+						system.solver->analyzePattern(A, A.rows());
+						system.solver->factorize(A);
 					}
-					else
-					{
-						StiffnessMatrix mat(int(total_size), int(indices.size()));
-						mat.setFromTriplets(entries.begin(), entries.end());
-
-						StiffnessMatrix mat_t(int(indices.size()), int(total_size));
-						mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
 
-						StiffnessMatrix A = mat_t * mat;
-						Eigen::VectorXd b = mat_t * global_rhs;
+					Eigen::VectorXd b = system.mat_t * global_rhs;
 
-						Eigen::VectorXd coeffs(b.rows(), 1);
-						auto solver = LinearSolver::create(solver_, preconditioner_);
-						solver->setParameters(solver_params_);
-						solver->analyzePattern(A, A.rows());
-						solver->factorize(A);
-						coeffs.setZero();
-						solver->solve(b, coeffs);
+					Eigen::VectorXd coeffs(b.rows(), 1);
+					coeffs.setZero();
+					system.solver->solve(b, coeffs);
 
-						logger().trace("RHS solve error {}", (A * coeffs - b).norm());
+					logger().trace("RHS solve error {}", (A * coeffs - b).norm());
 
-						for (long i = 0; i < coeffs.rows(); ++i)
-						{
-							const int tag = tags[i];
-							if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
-								rhs(indices[i] * size_ + d) = coeffs(i);
-						}
+					for (long i = 0; i < coeffs.rows(); ++i)
+					{
+						const int tag = system.tags[i];
+						if (problem_.all_dimensions_dirichlet() || problem_.is_dimension_dirichet(tag, d))
+							rhs(system.indices[i] * size_ + d) = coeffs(i);
 					}
 				}
 			}
@@ -485,18 +563,10 @@ namespace polyfem
 										const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
 		{
 			assert(false);
-			Eigen::MatrixXd uv, samples, rhs_fun, normals, mapped;
-			Eigen::VectorXd weights;
-
-			Eigen::VectorXi global_primitive_ids;
-			std::vector<AssemblyValues> tmp_val;
 
 			Eigen::Matrix<bool, Eigen::Dynamic, 1> is_boundary(n_basis_);
 			is_boundary.setConstant(false);
 
-			Eigen::MatrixXd areas(rhs.rows(), 1);
-			areas.setZero();
-
 			const int actual_dim = problem_.is_scalar() ? 1 : mesh_.dimension();
 
 			int skipped_count = 0;
@@ -511,52 +581,78 @@ namespace polyfem
 					skipped_count++;
 			}
 			assert(skipped_count <= 1);
-			ElementAssemblyValues vals;
 
-			for (const auto &lb : local_boundary)
-			{
-				const int e = lb.element_id();
-				bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, false, uv, samples, normals, weights, global_primitive_ids);
+			const Eigen::Matrix<bool, Eigen::Dynamic, 1> is_dirichlet_dof = boundary_mask(bounday_nodes, rhs.rows());
 
-				if (!has_samples)
-					continue;
+			// rhs and areas are stacked in the local storage
+			auto storage = create_thread_storage(LocalThreadVecStorage(2 * rhs.rows()));
 
-				const basis::ElementBases &bs = bases_[e];
-				const basis::ElementBases &gbs = gbases_[e];
+			maybe_parallel_for(local_boundary.size(), [&](int start, int end, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				ElementAssemblyValues &vals = local_storage.vals;
+				auto local_rhs = local_storage.vec.topRows(rhs.rows());
+				auto local_areas = local_storage.vec.bottomRows(rhs.rows());
 
-				vals.compute(e, mesh_.is_volume(), samples, bs, gbs);
+				Eigen::MatrixXd uv, samples, rhs_fun, normals;
+				Eigen::VectorXd weights;
+				Eigen::VectorXi global_primitive_ids;
 
-				df(global_primitive_ids, uv, vals.val, rhs_fun);
+				for (int k = start; k < end; ++k)
+				{
+					const LocalBoundary &lb = local_boundary[k];
+					const int e = lb.element_id();
+					bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, false, uv, samples, normals, weights, global_primitive_ids);
 
-				for (int d = 0; d < size_; ++d)
-					rhs_fun.col(d) = rhs_fun.col(d).array() * weights.array();
+					if (!has_samples)
+						continue;
 
-				for (int i = 0; i < lb.size(); ++i)
-				{
-					const int primitive_global_id = lb.global_primitive_id(i);
-					const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+					const basis::ElementBases &bs = bases_[e];
+					const basis::ElementBases &gbs = gbases_[e];
 
-					for (long n = 0; n < nodes.size(); ++n)
+					vals.compute(e, mesh_.is_volume(), samples, bs, gbs);
+
+					df(global_primitive_ids, uv, vals.val, rhs_fun);
+
+					for (int d = 0; d < size_; ++d)
+						rhs_fun.col(d) = rhs_fun.col(d).array() * weights.array();
+
+					for (int i = 0; i < lb.size(); ++i)
 					{
-						// const auto &b = bs.bases[nodes(n)];
-						const AssemblyValues &v = vals.basis_values[nodes(n)];
-						const double area = (weights.array() * v.val.array()).sum();
-						for (int d = 0; d < size_; ++d)
-						{
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+						const int primitive_global_id = lb.global_primitive_id(i);
+						const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
 
-							for (size_t g = 0; g < v.global.size(); ++g)
+						for (long n = 0; n < nodes.size(); ++n)
+						{
+							// const auto &b = bs.bases[nodes(n)];
+							const AssemblyValues &v = vals.basis_values[nodes(n)];
+							const double area = (weights.array() * v.val.array()).sum();
+							for (int d = 0; d < size_; ++d)
 							{
-								const int g_index = v.global[g].index * size_ + d;
-								if (problem_.all_dimensions_dirichlet() || std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) != bounday_nodes.end())
+								const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+
+								for (size_t g = 0; g < v.global.size(); ++g)
 								{
-									rhs(g_index) += rhs_value * v.global[g].val;
-									areas(g_index) += area * v.global[g].val;
+									const int g_index = v.global[g].index * size_ + d;
+									if (problem_.all_dimensions_dirichlet() || is_dirichlet_dof[g_index])
+									{
+										local_rhs(g_index, 0) += rhs_value * v.global[g].val;
+										local_areas(g_index, 0) += area * v.global[g].val;
+									}
 								}
 							}
 						}
 					}
 				}
+			});
+
+			Eigen::MatrixXd areas(rhs.rows(), 1);
+			areas.setZero();
+
+			// Serially merge local storages
+			for (const LocalThreadVecStorage &local_storage : storage)
+			{
+				rhs += local_storage.vec.topRows(rhs.rows());
+				areas += local_storage.vec.bottomRows(rhs.rows());
 			}
 
 			for (int b : bounday_nodes)
@@ -566,6 +662,66 @@ namespace polyfem
 			}
 		}
 
+		const RhsAssembler::NeumannCache &RhsAssembler::neumann_cache(const std::vector<LocalBoundary> &local_neumann_boundary, const int resolution) const
+		{
+			std::vector<int> boundary = boundary_primitives(local_neumann_boundary);
+			if (neumann_cache_ != nullptr && neumann_cache_->resolution == resolution && neumann_cache_->boundary == boundary)
+				return *neumann_cache_;
+
+			auto cache = std::make_unique<NeumannCache>();
+			cache->resolution = resolution;
+			cache->boundary = std::move(boundary);
+
+			std::vector<std::pair<int, int>> primitives; // (local boundary, primitive)
+			for (int k = 0; k < local_neumann_boundary.size(); ++k)
+			{
+				for (int i = 0; i < local_neumann_boundary[k].size(); ++i)
+					primitives.emplace_back(k, i);
+			}
+
+			std::vector<NeumannCache::Primitive> tmp(primitives.size());
+			std::vector<bool> has_samples(primitives.size(), false);
+
+			maybe_parallel_for(primitives.size(), [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd points, trafo;
+
+				for (int p = start; p < end; ++p)
+				{
+					const LocalBoundary &lb = local_neumann_boundary[primitives[p].first];
+					const int i = primitives[p].second;
+					const int e = lb.element_id();
+					NeumannCache::Primitive &primitive = tmp[p];
+
+					const int primitive_global_id = lb.global_primitive_id(i);
+					if (!utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, primitive.uv, points, primitive.normals, primitive.weights))
+						continue;
+					has_samples[p] = true;
+
+					primitive.element_id = e;
+					primitive.nodes = bases_[e].local_nodes_for_primitive(primitive_global_id, mesh_);
+					primitive.global_primitive_ids.setConstant(primitive.weights.size(), primitive_global_id);
+					primitive.vals.compute(e, mesh_.is_volume(), points, bases_[e], gbases_[e]);
+
+					primitive.mapped_normals = primitive.normals;
+					for (int n = 0; n < primitive.vals.jac_it.size(); ++n)
+					{
+						trafo = primitive.vals.jac_it[n].inverse();
+						primitive.mapped_normals.row(n) = primitive.mapped_normals.row(n) * trafo.inverse();
+						primitive.mapped_normals.row(n).normalize();
+					}
+				}
+			});
+
+			for (int p = 0; p < primitives.size(); ++p)
+			{
+				if (has_samples[p])
+					cache->primitives.push_back(std::move(tmp[p]));
+			}
+
+			neumann_cache_ = std::move(cache);
+			return *neumann_cache_;
+		}
+
 		void RhsAssembler::set_bc(
 			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
 			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
@@ -604,39 +760,33 @@ namespace polyfem
 			}
 
 			// Neumann
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun, deform_mat, trafo;
-			Eigen::VectorXi global_primitive_ids;
-			Eigen::MatrixXd points, normals;
-			Eigen::VectorXd weights;
-
-			ElementAssemblyValues vals;
-
-			for (const auto &lb : local_neumann_boundary)
-			{
-				const int e = lb.element_id();
-				const basis::ElementBases &gbs = gbases_[e];
-				const basis::ElementBases &bs = bases_[e];
+			if (local_neumann_boundary.empty())
+				return;
 
-				for (int i = 0; i < lb.size(); ++i)
-				{
-					const int primitive_global_id = lb.global_primitive_id(i);
-					const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+			const NeumannCache &cache = neumann_cache(local_neumann_boundary, resolution);
+			const Eigen::Matrix<bool, Eigen::Dynamic, 1> is_dirichlet_dof = boundary_mask(bounday_nodes, rhs.rows());
 
-					bool has_samples = utils::BoundarySampler::boundary_quadrature(lb, resolution, mesh_, i, false, uv, points, normals, weights);
+			auto storage = create_thread_storage(LocalThreadVecStorage(rhs.rows()));
 
-					if (!has_samples)
-						continue;
+			// Only the bc (and the normals if the element is deformed) is evaluated, the quadrature is reused
+			maybe_parallel_for(cache.primitives.size(), [&](int start, int end, int thread_id) {
+				LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				Eigen::MatrixXd rhs_fun, deform_mat, trafo, deformed_normals;
 
-					global_primitive_ids.setConstant(weights.size(), primitive_global_id);
-					vals.compute(e, mesh_.is_volume(), points, bs, gbs);
+				for (int p = start; p < end; ++p)
+				{
+					const NeumannCache::Primitive &primitive = cache.primitives[p];
+					const ElementAssemblyValues &vals = primitive.vals;
 
-					for (int n = 0; n < vals.jac_it.size(); ++n)
+					if (displacement.size() > 0)
 					{
-						trafo = vals.jac_it[n].inverse();
+						assert(size_ == 2 || size_ == 3);
+						deformed_normals = primitive.normals;
 
-						if (displacement.size() > 0)
+						for (int n = 0; n < vals.jac_it.size(); ++n)
 						{
-							assert(size_ == 2 || size_ == 3);
+							trafo = vals.jac_it[n].inverse();
+
 							deform_mat.resize(size_, size_);
 							deform_mat.setZero();
 							for (const auto &b : vals.basis_values)
@@ -651,24 +801,26 @@ namespace polyfem
 							}
 
 							trafo += deform_mat;
-						}
 
-						normals.row(n) = normals.row(n) * trafo.inverse();
-						normals.row(n).normalize();
+							deformed_normals.row(n) = deformed_normals.row(n) * trafo.inverse();
+							deformed_normals.row(n).normalize();
+						}
 					}
 
+					const Eigen::MatrixXd &normals = displacement.size() > 0 ? deformed_normals : primitive.mapped_normals;
+
 					// problem_.neumann_bc(mesh_, global_primitive_ids, vals.val, t, rhs_fun);
-					nf(global_primitive_ids, uv, vals.val, normals, rhs_fun);
+					nf(primitive.global_primitive_ids, primitive.uv, vals.val, normals, rhs_fun);
 
 					// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(0,1,0));
 
 					for (int d = 0; d < size_; ++d)
-						rhs_fun.col(d) = rhs_fun.col(d).array() * weights.array();
+						rhs_fun.col(d) = rhs_fun.col(d).array() * primitive.weights.array();
 
-					for (long n = 0; n < nodes.size(); ++n)
+					for (long n = 0; n < primitive.nodes.size(); ++n)
 					{
 						// const auto &b = bs.bases[nodes(n)];
-						const AssemblyValues &v = vals.basis_values[nodes(n)];
+						const AssemblyValues &v = vals.basis_values[primitive.nodes(n)];
 						for (int d = 0; d < size_; ++d)
 						{
 							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
@@ -676,17 +828,21 @@ namespace polyfem
 							for (size_t g = 0; g < v.global.size(); ++g)
 							{
 								const int g_index = v.global[g].index * size_ + d;
-								const bool is_neumann = std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) == bounday_nodes.end();
+								const bool is_neumann = !is_dirichlet_dof[g_index];
 
 								if (is_neumann)
 								{
-									rhs(g_index) += rhs_value * v.global[g].val;
+									local_storage.vec(g_index) += rhs_value * v.global[g].val;
 								}
 							}
 						}
 					}
 				}
-			}
+			});
+
+			// Serially merge local storages
+			for (const LocalThreadVecStorage &local_storage : storage)
+				rhs += local_storage.vec;
 
 			// TODO add nodal neumann
 		}
@@ -746,9 +902,8 @@ namespace polyfem
 
 					for (int e = start; e < end; ++e)
 					{
-						ElementAssemblyValues &vals = local_storage.vals;
 						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-						ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
 						const Quadrature &quadrature = vals.quadrature;
 						const Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
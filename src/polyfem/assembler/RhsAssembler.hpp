@@ -7,6 +7,10 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
 
+#include <polysolve/LinearSolver.hpp>
+
+#include <memory>
+
 namespace polyfem
 {
 	namespace assembler
@@ -85,6 +89,62 @@ namespace polyfem
 			// they are projected on the FEM bases, it inverts a linear system
 			void time_bc(const std::function<void(const mesh::Mesh &, const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const;
 
+			// Samples of the least-squares projection of the Dirichlet bc, they only depend on the mesh and the bases
+			// and are reused between calls (e.g., time steps), only the bc is evaluated again.
+			struct DirichletLsqCache
+			{
+				struct Element
+				{
+					Eigen::MatrixXd uv;
+					Eigen::MatrixXd mapped;
+					Eigen::VectorXi global_primitive_ids;
+				};
+
+				// least-squares system for one dimension, row r of mat_t^T is the sample rows[r]
+				struct System
+				{
+					std::vector<int> indices;
+					std::vector<int> tags;
+					std::vector<std::pair<int, int>> rows; // (element, sample)
+					StiffnessMatrix mat_t;
+					StiffnessMatrix A;                               // normal equations, mat_t mat_t^T
+					std::unique_ptr<polysolve::LinearSolver> solver; // factorization of A, built when first needed
+				};
+
+				// inputs the cache was built for, compared on every lookup
+				int resolution;
+				std::vector<int> boundary; // flattened local boundary
+				std::vector<int> boundary_nodes;
+
+				std::vector<Element> elements;
+				std::vector<System> systems;
+			};
+
+			// Quadrature of the Neumann boundary primitives, reused between calls (e.g., time steps)
+			struct NeumannCache
+			{
+				struct Primitive
+				{
+					int element_id;
+					Eigen::VectorXi nodes;
+					Eigen::MatrixXd uv;
+					Eigen::MatrixXd normals;        // reference normals
+					Eigen::MatrixXd mapped_normals; // normals of the undeformed element
+					Eigen::VectorXd weights;
+					Eigen::VectorXi global_primitive_ids;
+					ElementAssemblyValues vals;
+				};
+
+				// inputs the cache was built for, compared on every lookup
+				int resolution;
+				std::vector<int> boundary; // flattened local Neumann boundary
+
+				std::vector<Primitive> primitives;
+			};
+
+			DirichletLsqCache &dirichlet_lsq_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const;
+			const NeumannCache &neumann_cache(const std::vector<mesh::LocalBoundary> &local_neumann_boundary, const int resolution) const;
+
 			const Assembler &assembler_;
 			const mesh::Mesh &mesh_;
 			const mesh::Obstacle &obstacle_;
@@ -101,6 +161,10 @@ namespace polyfem
 			const std::vector<RowVectorNd> &dirichlet_nodes_position_;
 			const std::vector<int> &neumann_nodes_;
 			const std::vector<RowVectorNd> &neumann_nodes_position_;
+
+			// not thread safe, set_bc is not expected to be called concurrently
+			mutable std::unique_ptr<DirichletLsqCache> dirichlet_lsq_cache_;
+			mutable std::unique_ptr<NeumannCache> neumann_cache_;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -0,0 +1,87 @@
+#include "TensorProductElementValues.hpp"
+
+namespace polyfem
+{
+	using namespace basis;
+	using namespace quadrature;
+
+	namespace assembler
+	{
+		bool TensorProductElementValues::is_supported(const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			return is_volume
+				   && basis.has_parameterization && gbasis.has_parameterization
+				   && basis.tensor_product_order > 0 && gbasis.tensor_product_order > 0;
+		}
+
+		bool TensorProductElementValues::compute(const int el_index, const bool is_mass, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			element_id = el_index;
+
+			if (is_mass)
+				basis.compute_mass_quadrature(quadrature);
+			else
+				basis.compute_quadrature(quadrature);
+
+			this->basis = TensorProductHexBasis::get(basis.tensor_product_order, quadrature);
+			if (this->basis == nullptr)
+				return false;
+
+			const std::shared_ptr<const TensorProductHexBasis> gtp = gbasis.tensor_product_order == basis.tensor_product_order
+																		 ? this->basis
+																		 : TensorProductHexBasis::get(gbasis.tensor_product_order, quadrature);
+			assert(gtp != nullptr);
+			assert(gtp->n_bases() == gbasis.bases.size());
+
+			// geometric nodes, (possibly) weighted sum of the global nodes
+			Eigen::MatrixXd nodes = Eigen::MatrixXd::Zero(gbasis.bases.size(), 3);
+			for (int j = 0; j < gbasis.bases.size(); ++j)
+			{
+				const Basis &b = gbasis.bases[j];
+				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+					nodes.row(j) += b.global()[ii].node * b.global()[ii].val;
+			}
+
+			gtp->interpolate(nodes, val);
+
+			Eigen::MatrixXd dx, dy, dz;
+			gtp->interpolate_derivative(nodes, 0, dx);
+			gtp->interpolate_derivative(nodes, 1, dy);
+			gtp->interpolate_derivative(nodes, 2, dz);
+
+			const int n_pts = quadrature.points.rows();
+			jac_it.resize(n_pts);
+			da.resize(n_pts, 1);
+
+			Eigen::Matrix3d tmp;
+			for (int k = 0; k < n_pts; ++k)
+			{
+				tmp.row(0) = dx.row(k);
+				tmp.row(1) = dy.row(k);
+				tmp.row(2) = dz.row(k);
+
+				da(k) = tmp.determinant() * quadrature.weights(k);
+				jac_it[k] = tmp.inverse().transpose();
+			}
+
+			return true;
+		}
+
+		void TensorProductElementValues::integrate_grad(const Eigen::MatrixXd &f, Eigen::VectorXd &res) const
+		{
+			assert(f.rows() == da.size());
+			assert(f.cols() == 3);
+
+			// ∇φᵢ⋅f = ∇̂φᵢ⋅(jac_it f), the pull-back is done once per point
+			Eigen::MatrixXd flux(f.rows(), 3), tmp;
+			for (int k = 0; k < f.rows(); ++k)
+				flux.row(k) = da(k) * (jac_it[k] * f.row(k).transpose()).transpose();
+
+			for (int d = 0; d < 3; ++d)
+			{
+				basis->integrate_derivative(flux.col(d), d, tmp);
+				res += tmp.col(0);
+			}
+		}
+	} // namespace assembler
+} // namespace polyfem
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/basis/TensorProductHexBasis.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace polyfem
+{
+	namespace assembler
+	{
+		// stores per element geometric quantities for the sum-factorized kernels of Lagrange hex (Qk) elements,
+		// no per basis values are stored: they are applied with the 1D factors of the bases
+		class TensorProductElementValues
+		{
+		public:
+			// 1D factors of the bases at the quadrature points
+			std::shared_ptr<const basis::TensorProductHexBasis> basis;
+
+			quadrature::Quadrature quadrature;
+			int element_id;
+
+			// img of quadrature points through the geom mapping (global pos in the mesh)
+			Eigen::MatrixXd val; // R^{m x 3}
+
+			// inverse transpose jacobian of geom mapping, same convention as ElementAssemblyValues::jac_it
+			std::vector<Eigen::Matrix3d> jac_it;
+
+			// det of the jacobian of the geom mapping times the quadrature weights
+			QuadratureVector da; // R^{m x 1}
+
+			// true if the bases and the geometric mapping of the element are Lagrange hex bases
+			static bool is_supported(const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+
+			// computes the per element values at the (mass) quadrature points, returns false if the quadrature is not a tensor product
+			bool compute(const int el_index, const bool is_mass, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+
+			// integrates the flux f (m x 3 physical vectors) against the physical gradients of the bases,
+			// res(i) += sum_q da(q) ∇φᵢ(q)⋅f(q)
+			void integrate_grad(const Eigen::MatrixXd &f, Eigen::VectorXd &res) const;
+		};
+	} // namespace assembler
+} // namespace polyfem
@@ -35,6 +35,10 @@ namespace polyfem
 			// or directly in the object domain (harmonic bases)
 			bool has_parameterization = true;
 
+			// order k if the bases are the Lagrange hex (Qk) bases, i.e., tensor products of 1D Lagrange bases
+			// (used for sum factorization), -1 otherwise
+			int tensor_product_order = -1;
+
 			/// @brief Map the sample positions in the parametric domain to the object domain (if the element has no parameterization, e.g. harmonic bases, then the parametric domain = object domain,
 			/// and the mapping is identity)
 			///
@@ -0,0 +1,103 @@
+#include "ElementDofMap.hpp"
+
+#include <algorithm>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		void ElementDofMap::build(const std::vector<ElementBases> &bases)
+		{
+			clear();
+
+			const int n_elements = bases.size();
+			element_offsets_.resize(n_elements + 1);
+
+			int n_local_bases = 0;
+			int n_entries = 0;
+			for (int e = 0; e < n_elements; ++e)
+			{
+				element_offsets_[e] = n_local_bases;
+				n_local_bases += bases[e].bases.size();
+				for (const Basis &b : bases[e].bases)
+					n_entries += b.global().size();
+			}
+			element_offsets_[n_elements] = n_local_bases;
+
+			basis_offsets_.resize(n_local_bases + 1);
+			indices_.resize(n_entries);
+			weights_.resize(n_entries);
+
+			int local = 0;
+			int k = 0;
+			for (int e = 0; e < n_elements; ++e)
+			{
+				for (const Basis &b : bases[e].bases)
+				{
+					basis_offsets_[local++] = k;
+					for (const Local2Global &g : b.global())
+					{
+						indices_[k] = g.index;
+						weights_[k] = g.val;
+						++k;
+					}
+				}
+			}
+			basis_offsets_[n_local_bases] = k;
+
+			bases_ = &bases;
+		}
+
+		bool ElementDofMap::has_same_connectivity(const std::vector<ElementBases> &bases) const
+		{
+			if (n_elements() != int(bases.size()))
+				return false;
+
+			int local = 0;
+			for (int e = 0; e < n_elements(); ++e)
+			{
+				if (n_local_bases(e) != int(bases[e].bases.size()))
+					return false;
+
+				for (const Basis &b : bases[e].bases)
+				{
+					int k = basis_offsets_[local++];
+					if (basis_offsets_[local] - k != int(b.global().size()))
+						return false;
+
+					for (const Local2Global &g : b.global())
+					{
+						if (indices_[k] != g.index || weights_[k] != g.val)
+							return false;
+						++k;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		void ElementDofMap::gather(const int e, const int actual_dim, const Eigen::MatrixXd &fun, Eigen::MatrixXd &local) const
+		{
+			const int n_loc_bases = n_local_bases(e);
+			local.setZero(n_loc_bases, actual_dim);
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				for (int k = begin(e, i); k < end(e, i); ++k)
+				{
+					for (int d = 0; d < actual_dim; ++d)
+						local(i, d) += weights_[k] * fun(indices_[k] * actual_dim + d);
+				}
+			}
+		}
+
+		void ElementDofMap::clear()
+		{
+			element_offsets_.clear();
+			basis_offsets_.clear();
+			indices_.clear();
+			weights_.clear();
+			bases_ = nullptr;
+		}
+	} // namespace basis
+} // namespace polyfem
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		/// @brief Compact (CSR) map from the local bases of the elements to the global dofs.
+		///
+		/// The local basis i of element e is the weighted sum of the global nodes
+		/// indices[k] with weights weights[k] for k in [begin(e, i), end(e, i)).
+		/// All the entries are stored contiguously, hence the assembly loops
+		/// read three flat arrays instead of chasing one std::vector<Local2Global> per basis.
+		class ElementDofMap
+		{
+		public:
+			/// @brief Builds the map from the element bases
+			/// @param[in] bases element bases
+			void build(const std::vector<ElementBases> &bases);
+
+			void clear();
+
+			/// @brief Checks if the map has been built from bases, in constant time
+			///
+			/// The bases are identified by address, the owner of the map (e.g., the State through its
+			/// AssemblyValsCache) must rebuild or clear it when the bases are rebuilt.
+			/// @param[in] bases element bases
+			/// @return true if the map was built from bases
+			inline bool is_built_for(const std::vector<ElementBases> &bases) const { return bases_ == &bases; }
+
+			/// @brief Checks if the map has the connectivity of bases, by comparing all their global indices and weights
+			/// @param[in] bases element bases
+			/// @return true if the map can be used for bases (same global indices and weights)
+			bool has_same_connectivity(const std::vector<ElementBases> &bases) const;
+
+			inline bool empty() const { return element_offsets_.size() <= 1; }
+			inline int n_elements() const { return std::max(int(element_offsets_.size()) - 1, 0); }
+			inline int n_local_bases(const int e) const { return element_offsets_[e + 1] - element_offsets_[e]; }
+
+			/// @brief First entry of the local basis i of element e
+			inline int begin(const int e, const int i) const { return basis_offsets_[element_offsets_[e] + i]; }
+			/// @brief One past the last entry of the local basis i of element e
+			inline int end(const int e, const int i) const { return basis_offsets_[element_offsets_[e] + i + 1]; }
+
+			/// @brief Global node index of entry k
+			inline int index(const int k) const { return indices_[k]; }
+			/// @brief Weight of entry k
+			inline double weight(const int k) const { return weights_[k]; }
+
+			/// @brief Gathers the values of a global function on the local bases of element e
+			/// @param[in] e element index
+			/// @param[in] actual_dim number of values per global node (e.g., 1 for Laplace, dim for elasticity)
+			/// @param[in] fun global function, #global nodes * actual_dim
+			/// @param[out] local local values, n_local_bases(e) x actual_dim
+			void gather(const int e, const int actual_dim, const Eigen::MatrixXd &fun, Eigen::MatrixXd &local) const;
+
+		private:
+			std::vector<int> element_offsets_; ///< #elements + 1 offsets in basis_offsets_
+			std::vector<int> basis_offsets_;   ///< #local bases + 1 offsets in indices_ and weights_
+			std::vector<int> indices_;         ///< global node indices
+			std::vector<double> weights_;      ///< weights of the global nodes
+			const std::vector<ElementBases> *bases_ = nullptr; ///< bases the map was built from
+		};
+	} // namespace basis
+} // namespace polyfem
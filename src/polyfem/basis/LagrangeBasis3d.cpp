@@ -1493,6 +1493,9 @@ int LagrangeBasis3d::build_bases(
 				return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
 			});
 
+			if (!serendipity)
+				b.tensor_product_order = discr_order;
+
 			for (int j = 0; j < n_el_bases; ++j)
 			{
 				const int global_index = element_nodes_id[e][j];
@@ -0,0 +1,229 @@
+#include "TensorProductHexBasis.hpp"
+
+#include <polyfem/autogen/auto_q_bases_3d_nodes.hpp>
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		namespace
+		{
+			// values and derivatives of the 1D Lagrange bases on the equispaced nodes m / order
+			void lagrange_1d(const int order, const Eigen::VectorXd &pts, Eigen::MatrixXd &val, Eigen::MatrixXd &der)
+			{
+				const int n_bases = order + 1;
+				Eigen::VectorXd nodes(n_bases);
+				for (int m = 0; m < n_bases; ++m)
+					nodes(m) = order == 0 ? 0.5 : double(m) / order;
+
+				val.resize(pts.size(), n_bases);
+				der.resize(pts.size(), n_bases);
+
+				for (int q = 0; q < pts.size(); ++q)
+				{
+					const double x = pts(q);
+					for (int m = 0; m < n_bases; ++m)
+					{
+						double v = 1;
+						double d = 0;
+						for (int l = 0; l < n_bases; ++l)
+						{
+							if (l == m)
+								continue;
+
+							const double denom = nodes(m) - nodes(l);
+							d = (d * (x - nodes(l)) + v) / denom;
+							v *= (x - nodes(l)) / denom;
+						}
+						val(q, m) = v;
+						der(q, m) = d;
+					}
+				}
+			}
+		} // namespace
+
+		TensorProductHexBasis::TensorProductHexBasis(const int order, const Eigen::VectorXd &points_1d)
+			: order_(order)
+		{
+			assert(order >= 0);
+			lagrange_1d(order, points_1d, values_1d_, derivatives_1d_);
+			values_1d_t_ = values_1d_.transpose();
+			derivatives_1d_t_ = derivatives_1d_.transpose();
+
+			Eigen::MatrixXd nodes;
+			autogen::q_nodes_3d(order, nodes);
+			assert(nodes.rows() == n_bases());
+
+			lexicographic_.resize(nodes.rows(), 3);
+			for (int i = 0; i < nodes.rows(); ++i)
+			{
+				for (int d = 0; d < 3; ++d)
+					lexicographic_(i, d) = order == 0 ? 0 : int(std::round(nodes(i, d) * order));
+			}
+		}
+
+		std::shared_ptr<const TensorProductHexBasis> TensorProductHexBasis::get(const int order, const quadrature::Quadrature &quadrature)
+		{
+			Eigen::VectorXd points_1d;
+			if (!quadrature_points_1d(quadrature, points_1d))
+				return nullptr;
+
+			static std::mutex mutex;
+			static std::map<std::pair<int, std::vector<double>>, std::shared_ptr<const TensorProductHexBasis>> cache;
+
+			std::pair<int, std::vector<double>> key(order, std::vector<double>(points_1d.data(), points_1d.data() + points_1d.size()));
+
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = cache.find(key);
+			if (it == cache.end())
+				it = cache.emplace(key, std::make_shared<const TensorProductHexBasis>(order, points_1d)).first;
+
+			return it->second;
+		}
+
+		bool TensorProductHexBasis::quadrature_points_1d(const quadrature::Quadrature &quadrature, Eigen::VectorXd &points_1d)
+		{
+			if (quadrature.points.cols() != 3)
+				return false;
+
+			const long n_pts = quadrature.points.rows();
+			const long n = std::lround(std::cbrt(double(n_pts)));
+			if (n <= 0 || n * n * n != n_pts)
+				return false;
+
+			points_1d = quadrature.points.col(0).head(n);
+
+			// same ordering as HexQuadrature, x is the fastest index
+			for (long i = 0; i < n; ++i)
+			{
+				for (long j = 0; j < n; ++j)
+				{
+					for (long k = 0; k < n; ++k)
+					{
+						const long index = (i * n + j) * n + k;
+						if (std::abs(quadrature.points(index, 0) - points_1d(k)) > 1e-14
+							|| std::abs(quadrature.points(index, 1) - points_1d(j)) > 1e-14
+							|| std::abs(quadrature.points(index, 2) - points_1d(i)) > 1e-14)
+							return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		void TensorProductHexBasis::eval_basis(const int local_index, Eigen::VectorXd &val) const
+		{
+			const int n = n_points_1d();
+			const auto bx = values_1d_.col(lexicographic_(local_index, 0));
+			const auto by = values_1d_.col(lexicographic_(local_index, 1));
+			const auto bz = values_1d_.col(lexicographic_(local_index, 2));
+
+			val.resize(n_points());
+			for (int qz = 0; qz < n; ++qz)
+				for (int qy = 0; qy < n; ++qy)
+					for (int qx = 0; qx < n; ++qx)
+						val(qx + n * (qy + n * qz)) = bx(qx) * by(qy) * bz(qz);
+		}
+
+		void TensorProductHexBasis::eval_grad(const int local_index, Eigen::MatrixXd &grad) const
+		{
+			const int n = n_points_1d();
+			const int ix = lexicographic_(local_index, 0);
+			const int iy = lexicographic_(local_index, 1);
+			const int iz = lexicographic_(local_index, 2);
+
+			grad.resize(n_points(), 3);
+			for (int qz = 0; qz < n; ++qz)
+			{
+				for (int qy = 0; qy < n; ++qy)
+				{
+					for (int qx = 0; qx < n; ++qx)
+					{
+						const int q = qx + n * (qy + n * qz);
+						grad(q, 0) = derivatives_1d_(qx, ix) * values_1d_(qy, iy) * values_1d_(qz, iz);
+						grad(q, 1) = values_1d_(qx, ix) * derivatives_1d_(qy, iy) * values_1d_(qz, iz);
+						grad(q, 2) = values_1d_(qx, ix) * values_1d_(qy, iy) * derivatives_1d_(qz, iz);
+					}
+				}
+			}
+		}
+
+		void TensorProductHexBasis::interpolate(const Eigen::MatrixXd &coeffs, Eigen::MatrixXd &val) const
+		{
+			apply(coeffs, -1, false, val);
+		}
+
+		void TensorProductHexBasis::interpolate_derivative(const Eigen::MatrixXd &coeffs, const int d, Eigen::MatrixXd &val) const
+		{
+			assert(d >= 0 && d < 3);
+			apply(coeffs, d, false, val);
+		}
+
+		void TensorProductHexBasis::integrate(const Eigen::MatrixXd &val, Eigen::MatrixXd &res) const
+		{
+			apply(val, -1, true, res);
+		}
+
+		void TensorProductHexBasis::integrate_derivative(const Eigen::MatrixXd &val, const int d, Eigen::MatrixXd &res) const
+		{
+			assert(d >= 0 && d < 3);
+			apply(val, d, true, res);
+		}
+
+		void TensorProductHexBasis::apply(const Eigen::MatrixXd &in, const int d, const bool transpose, Eigen::MatrixXd &out) const
+		{
+			const int nb = n_bases_1d();
+			const Eigen::MatrixXd &b = transpose ? values_1d_t_ : values_1d_;
+			const Eigen::MatrixXd &db = transpose ? derivatives_1d_t_ : derivatives_1d_;
+
+			const Eigen::MatrixXd &ax = d == 0 ? db : b;
+			const Eigen::MatrixXd &ay = d == 1 ? db : b;
+			const Eigen::MatrixXd &az = d == 2 ? db : b;
+
+			assert(in.rows() == (transpose ? n_points() : n_bases()));
+			out.resize(transpose ? n_bases() : n_points(), in.cols());
+
+			Eigen::VectorXd lex(n_bases());
+			Eigen::VectorXd tmp(transpose ? n_bases() : n_points());
+
+			for (int c = 0; c < in.cols(); ++c)
+			{
+				if (transpose)
+				{
+					contract(ax, ay, az, in.col(c).data(), tmp.data());
+					for (int i = 0; i < lexicographic_.rows(); ++i)
+						out(i, c) = tmp(lexicographic_(i, 0) + nb * (lexicographic_(i, 1) + nb * lexicographic_(i, 2)));
+				}
+				else
+				{
+					for (int i = 0; i < lexicographic_.rows(); ++i)
+						lex(lexicographic_(i, 0) + nb * (lexicographic_(i, 1) + nb * lexicographic_(i, 2))) = in(i, c);
+					contract(ax, ay, az, lex.data(), out.col(c).data());
+				}
+			}
+		}
+
+		void TensorProductHexBasis::contract(const Eigen::MatrixXd &ax, const Eigen::MatrixXd &ay, const Eigen::MatrixXd &az, const double *in, double *out)
+		{
+			const int nx = ax.cols(), ny = ay.cols(), nz = az.cols();
+			const int mx = ax.rows(), my = ay.rows(), mz = az.rows();
+
+			// contract x: (mx x nx) * (nx x ny * nz)
+			const Eigen::MatrixXd t1 = ax * Eigen::Map<const Eigen::MatrixXd>(in, nx, ny * nz);
+
+			// contract y, one z slice at a time
+			Eigen::MatrixXd t2(mx * my, nz);
+			for (int iz = 0; iz < nz; ++iz)
+				Eigen::Map<Eigen::MatrixXd>(t2.col(iz).data(), mx, my).noalias() = t1.middleCols(iz * ny, ny) * ay.transpose();
+
+			// contract z: (mx * my x nz) * (nz x mz)
+			Eigen::Map<Eigen::MatrixXd>(out, mx * my, mz).noalias() = t2 * az.transpose();
+		}
+	} // namespace basis
+} // namespace polyfem
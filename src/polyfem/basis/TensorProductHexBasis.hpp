@@ -0,0 +1,94 @@
+#pragma once
+
+#include <polyfem/quadrature/Quadrature.hpp>
+
+#include <Eigen/Dense>
+
+#include <memory>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		/// @brief 1D factors of a Lagrange hex (Qk) element evaluated at the points of a tensor-product quadrature.
+		///
+		/// A Qk basis function is the product of three 1D Lagrange polynomials and the hex quadrature is the
+		/// tensor product of a 1D rule, hence interpolation and integration against the bases can be done with
+		/// three 1D contractions (sum factorization): O(k^4) operations per element instead of O(k^6).
+		///
+		/// All the inputs and outputs are in the local ordering of the element bases (the one of autogen::q_nodes_3d)
+		/// and in the ordering of the quadrature points of quadrature::HexQuadrature.
+		class TensorProductHexBasis
+		{
+		public:
+			/// @brief Builds the 1D factors
+			/// @param[in] order order k of the Qk bases
+			/// @param[in] points_1d 1D quadrature points in [0, 1]
+			TensorProductHexBasis(const int order, const Eigen::VectorXd &points_1d);
+
+			/// @brief Returns the (shared and cached) 1D factors for a given order and quadrature
+			/// @param[in] order order k of the Qk bases
+			/// @param[in] quadrature tensor-product hex quadrature
+			/// @return nullptr if the quadrature is not a tensor product
+			static std::shared_ptr<const TensorProductHexBasis> get(const int order, const quadrature::Quadrature &quadrature);
+
+			/// @brief Extracts the 1D points of a tensor-product hex quadrature
+			/// @param[in] quadrature hex quadrature
+			/// @param[out] points_1d 1D quadrature points
+			/// @return false if the quadrature is not a tensor product
+			static bool quadrature_points_1d(const quadrature::Quadrature &quadrature, Eigen::VectorXd &points_1d);
+
+			int order() const { return order_; }
+			int n_bases() const { return n_bases_1d() * n_bases_1d() * n_bases_1d(); }
+			int n_points() const { return n_points_1d() * n_points_1d() * n_points_1d(); }
+			int n_bases_1d() const { return values_1d_.cols(); }
+			int n_points_1d() const { return values_1d_.rows(); }
+
+			/// @brief Evaluates one basis function at the quadrature points
+			/// @param[in] local_index local index of the basis
+			/// @param[out] val #points vector of values
+			void eval_basis(const int local_index, Eigen::VectorXd &val) const;
+
+			/// @brief Evaluates the reference gradient of one basis function at the quadrature points
+			/// @param[in] local_index local index of the basis
+			/// @param[out] grad #points x 3 matrix of gradients
+			void eval_grad(const int local_index, Eigen::MatrixXd &grad) const;
+
+			/// @brief Interpolates nodal coefficients at the quadrature points, val(q) = sum_i coeffs(i) phi_i(q)
+			/// @param[in] coeffs #bases x k coefficients
+			/// @param[out] val #points x k values
+			void interpolate(const Eigen::MatrixXd &coeffs, Eigen::MatrixXd &val) const;
+
+			/// @brief Interpolates the reference derivative along d of nodal coefficients at the quadrature points
+			/// @param[in] coeffs #bases x k coefficients
+			/// @param[in] d reference direction (0, 1, or 2)
+			/// @param[out] val #points x k derivatives
+			void interpolate_derivative(const Eigen::MatrixXd &coeffs, const int d, Eigen::MatrixXd &val) const;
+
+			/// @brief Integrates quadrature point values against the bases, res(i) = sum_q phi_i(q) val(q)
+			/// @param[in] val #points x k values (weights included)
+			/// @param[out] res #bases x k result
+			void integrate(const Eigen::MatrixXd &val, Eigen::MatrixXd &res) const;
+
+			/// @brief Integrates quadrature point values against the reference derivative along d of the bases, res(i) = sum_q d phi_i(q) / d xi_d val(q)
+			/// @param[in] val #points x k values (weights included)
+			/// @param[in] d reference direction (0, 1, or 2)
+			/// @param[out] res #bases x k result
+			void integrate_derivative(const Eigen::MatrixXd &val, const int d, Eigen::MatrixXd &res) const;
+
+		private:
+			/// out(qx + mx * (qy + my * qz)) = sum ax(qx, ix) ay(qy, iy) az(qz, iz) in(ix + nx * (iy + ny * iz))
+			static void contract(const Eigen::MatrixXd &ax, const Eigen::MatrixXd &ay, const Eigen::MatrixXd &az, const double *in, double *out);
+
+			/// interpolation (transpose = false) or integration (transpose = true) with the derivative along d (-1 for none)
+			void apply(const Eigen::MatrixXd &in, const int d, const bool transpose, Eigen::MatrixXd &out) const;
+
+			int order_;
+			Eigen::MatrixXd values_1d_;      ///< #points_1d x #bases_1d values of the 1D bases
+			Eigen::MatrixXd derivatives_1d_; ///< #points_1d x #bases_1d derivatives of the 1D bases
+			Eigen::MatrixXd values_1d_t_;
+			Eigen::MatrixXd derivatives_1d_t_;
+			Eigen::MatrixXi lexicographic_; ///< #bases x 3 1D indices of the local bases
+		};
+	} // namespace basis
+} // namespace polyfem
@@ -0,0 +1,122 @@
+#include "AsyncWriter.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace polyfem::io
+{
+	AsyncWriter::AsyncWriter(const int max_queue_size)
+		: max_queue_size_(std::max(max_queue_size, 0))
+	{
+		if (is_async())
+			thread_ = std::thread([this]() { run(); });
+	}
+
+	AsyncWriter::~AsyncWriter()
+	{
+		if (!is_async())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		job_pushed_.notify_all();
+		thread_.join();
+
+		if (error_)
+		{
+			try
+			{
+				std::rethrow_exception(error_);
+			}
+			catch (const std::exception &e)
+			{
+				logger().error("Output job failed: {}", e.what());
+			}
+			catch (...)
+			{
+				logger().error("Output job failed");
+			}
+		}
+	}
+
+	void AsyncWriter::push(Job &&job)
+	{
+		if (!is_async())
+		{
+			job();
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			rethrow_error();
+			// backpressure: wait for the writer to catch up
+			job_done_.wait(lock, [this]() { return int(queue_.size()) < max_queue_size_; });
+			queue_.push_back(std::move(job));
+		}
+		job_pushed_.notify_one();
+	}
+
+	void AsyncWriter::flush()
+	{
+		if (!is_async())
+			return;
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		job_done_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+		rethrow_error();
+	}
+
+	void AsyncWriter::rethrow_error()
+	{
+		if (!error_)
+			return;
+
+		std::exception_ptr error = nullptr;
+		std::swap(error, error_);
+		std::rethrow_exception(error);
+	}
+
+	void AsyncWriter::run()
+	{
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				job_pushed_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+				// the pending jobs are always written, even when stopping
+				if (queue_.empty())
+					return;
+
+				job = std::move(queue_.front());
+				queue_.pop_front();
+				busy_ = true;
+			}
+			job_done_.notify_all();
+
+			std::exception_ptr error = nullptr;
+			try
+			{
+				job();
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				busy_ = false;
+				// only the first one is reported
+				if (error && !error_)
+					error_ = error;
+			}
+			job_done_.notify_all();
+		}
+	}
+} // namespace polyfem::io
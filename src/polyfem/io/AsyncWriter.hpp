@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace polyfem::io
+{
+	/// @brief Runs the output jobs (file serialization) on a background thread.
+	///
+	/// The jobs are executed in submission order. The queue is bounded: push blocks
+	/// while max_queue_size jobs are pending, so the producer (e.g., the time stepping loop)
+	/// cannot run arbitrarily far ahead of the file system and the memory held by the
+	/// pending snapshots stays bounded.
+	/// With max_queue_size == 0 no thread is started and the jobs are executed directly in push.
+	/// The first exception thrown by a background job is rethrown by the next push or flush,
+	/// the following jobs are still executed.
+	class AsyncWriter
+	{
+	public:
+		typedef std::function<void()> Job;
+
+		/// @param[in] max_queue_size maximum number of pending jobs, 0 executes the jobs synchronously
+		AsyncWriter(const int max_queue_size = 0);
+		/// waits for the pending jobs, an exception not rethrown yet is logged
+		~AsyncWriter();
+
+		AsyncWriter(const AsyncWriter &) = delete;
+		AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+		/// @brief Queues a job, blocks if the queue is full
+		/// @param[in] job job to run, it must own (or share) all the data it writes
+		/// @throws the first exception thrown by a previous job, if any
+		void push(Job &&job);
+
+		/// @brief Waits until all the queued jobs have been executed
+		/// @throws the first exception thrown by a job, if any
+		void flush();
+
+		/// @return true if the jobs are executed on the background thread
+		bool is_async() const { return max_queue_size_ > 0; }
+
+	private:
+		void run();
+		/// rethrows (and clears) error_, the mutex must be locked
+		void rethrow_error();
+
+		const int max_queue_size_;
+
+		std::deque<Job> queue_;
+		bool busy_ = false;
+		bool stop_ = false;
+		std::exception_ptr error_;
+
+		std::mutex mutex_;
+		std::condition_variable job_pushed_;
+		std::condition_variable job_done_;
+
+		std::thread thread_;
+	};
+} // namespace polyfem::io
@@ -0,0 +1,392 @@
+#include "BinaryMesh.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <cstring>
+#include <type_traits>
+#include <fstream>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POLYFEM_BINARY_MESH_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace polyfem::io
+{
+	namespace
+	{
+		static_assert(sizeof(int) == 4, "The binary mesh stores 32-bit ints");
+
+		constexpr char MAGIC[8] = {'P', 'F', 'M', 'E', 'S', 'H', '\0', '\0'};
+		constexpr uint32_t VERSION = 2;
+		/// written in native order, reads back differently on a machine with another byte order
+		constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+		constexpr size_t ALIGNMENT = 64;
+		constexpr size_t NAME_SIZE = 48;
+
+		struct FileHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+			uint32_t n_arrays;
+			uint32_t padding;
+		};
+
+		struct TableEntry
+		{
+			char name[NAME_SIZE];
+			uint32_t type;
+			uint32_t padding;
+			uint64_t rows;
+			uint64_t cols;
+			uint64_t offset;
+		};
+
+		size_t align(const size_t offset)
+		{
+			return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		}
+
+		/// array to write, the data is not owned
+		struct OutArray
+		{
+			std::string name;
+			uint32_t type;
+			uint64_t rows;
+			uint64_t cols;
+			const char *data;
+			size_t bytes;
+		};
+
+		template <typename T>
+		void to_offsets_and_values(const std::vector<std::vector<T>> &lists, std::vector<int> &offsets, std::vector<T> &values)
+		{
+			offsets.resize(lists.size() + 1);
+			offsets[0] = 0;
+			for (size_t i = 0; i < lists.size(); ++i)
+				offsets[i + 1] = offsets[i] + lists[i].size();
+
+			values.clear();
+			values.reserve(offsets.back());
+			for (const auto &l : lists)
+				values.insert(values.end(), l.begin(), l.end());
+		}
+	} // namespace
+
+	BinaryMesh::~BinaryMesh()
+	{
+		close();
+	}
+
+	bool BinaryMesh::open(const std::string &path)
+	{
+		close();
+
+#ifdef POLYFEM_BINARY_MESH_MMAP
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			logger().error("Failed to open file: {}", path);
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			::close(fd);
+			logger().error("Failed to open file: {}", path);
+			return false;
+		}
+
+		void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (mapped == MAP_FAILED)
+		{
+			logger().error("Failed to map file: {}", path);
+			return false;
+		}
+		data_ = static_cast<const char *>(mapped);
+		size_ = st.st_size;
+#else
+		std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!in.good())
+		{
+			logger().error("Failed to open file: {}", path);
+			return false;
+		}
+		buffer_.resize(in.tellg());
+		in.seekg(0);
+		in.read(buffer_.data(), buffer_.size());
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+#endif
+
+		FileHeader header;
+		if (size_ < sizeof(FileHeader))
+		{
+			logger().error("Invalid binary mesh: {}", path);
+			close();
+			return false;
+		}
+		std::memcpy(&header, data_, sizeof(FileHeader));
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+			|| header.n_arrays > (size_ - sizeof(FileHeader)) / sizeof(TableEntry))
+		{
+			logger().error("Invalid binary mesh: {}", path);
+			close();
+			return false;
+		}
+		if (header.byte_order != BYTE_ORDER_MARK)
+		{
+			logger().error("Binary mesh written with a different byte order: {}", path);
+			close();
+			return false;
+		}
+
+		for (uint32_t i = 0; i < header.n_arrays; ++i)
+		{
+			TableEntry entry;
+			std::memcpy(&entry, data_ + sizeof(FileHeader) + i * sizeof(TableEntry), sizeof(TableEntry));
+			entry.name[NAME_SIZE - 1] = '\0';
+
+			// the size of the array is compared with the remaining bytes by divisions, the products could overflow
+			const size_t scalar_size = entry.type == uint32_t(Type::Double) ? sizeof(double) : sizeof(int);
+			const uint64_t max_index = std::numeric_limits<Eigen::Index>::max();
+			if (entry.type > uint32_t(Type::Int) || entry.offset % ALIGNMENT != 0 || entry.offset > size_
+				|| entry.rows > max_index || entry.cols > max_index
+				|| (entry.rows > 0 && entry.cols > (size_ - entry.offset) / scalar_size / entry.rows))
+			{
+				logger().error("Invalid array {} in binary mesh: {}", entry.name, path);
+				close();
+				return false;
+			}
+
+			arrays_[entry.name] = {Type(entry.type), entry.rows, entry.cols, entry.offset};
+		}
+
+		return true;
+	}
+
+	void BinaryMesh::close()
+	{
+#ifdef POLYFEM_BINARY_MESH_MMAP
+		if (data_ != nullptr)
+			munmap(const_cast<char *>(data_), size_);
+#endif
+		data_ = nullptr;
+		size_ = 0;
+		buffer_.clear();
+		arrays_.clear();
+	}
+
+	std::vector<std::string> BinaryMesh::names() const
+	{
+		std::vector<std::string> res;
+		for (const auto &[name, _] : arrays_)
+			res.push_back(name);
+		return res;
+	}
+
+	const BinaryMesh::Array &BinaryMesh::array(const std::string &name, const Type type) const
+	{
+		const auto it = arrays_.find(name);
+		if (it == arrays_.end())
+			log_and_throw_error("Binary mesh has no array {}", name);
+		if (it->second.type != type)
+			log_and_throw_error("Array {} of the binary mesh has the wrong type", name);
+		return it->second;
+	}
+
+	Eigen::Map<const Eigen::MatrixXd> BinaryMesh::doubles(const std::string &name) const
+	{
+		const Array &a = array(name, Type::Double);
+		return Eigen::Map<const Eigen::MatrixXd>(reinterpret_cast<const double *>(data_ + a.offset), a.rows, a.cols);
+	}
+
+	Eigen::Map<const Eigen::MatrixXi> BinaryMesh::ints(const std::string &name) const
+	{
+		const Array &a = array(name, Type::Int);
+		return Eigen::Map<const Eigen::MatrixXi>(reinterpret_cast<const int *>(data_ + a.offset), a.rows, a.cols);
+	}
+
+	template <typename T>
+	void BinaryMesh::lists(const std::string &offsets_name, const std::string &values_name, std::vector<std::vector<T>> &lists) const
+	{
+		lists.clear();
+		if (!has(offsets_name) || !has(values_name))
+			return;
+
+		const auto offsets = ints(offsets_name);
+		const T *values;
+		Eigen::Index n_values;
+		if constexpr (std::is_same_v<T, int>)
+		{
+			const auto values_array = ints(values_name);
+			values = values_array.data();
+			n_values = values_array.size();
+		}
+		else
+		{
+			const auto values_array = doubles(values_name);
+			values = values_array.data();
+			n_values = values_array.size();
+		}
+
+		// the offsets index the values, they are checked once here
+		if (offsets.size() == 0 || offsets(0) != 0 || offsets(offsets.size() - 1) != n_values)
+			log_and_throw_error("Invalid offsets {} in the binary mesh", offsets_name);
+		for (Eigen::Index i = 0; i + 1 < offsets.size(); ++i)
+		{
+			if (offsets(i) > offsets(i + 1))
+				log_and_throw_error("Invalid offsets {} in the binary mesh", offsets_name);
+		}
+
+		lists.resize(offsets.size() - 1);
+		for (size_t i = 0; i < lists.size(); ++i)
+			lists[i].assign(values + offsets(i), values + offsets(i + 1));
+	}
+
+	template void BinaryMesh::lists<int>(const std::string &, const std::string &, std::vector<std::vector<int>> &) const;
+	template void BinaryMesh::lists<double>(const std::string &, const std::string &, std::vector<std::vector<double>> &) const;
+
+	bool BinaryMesh::load(
+		const std::string &path,
+		Eigen::MatrixXd &vertices,
+		Eigen::MatrixXi &cells,
+		std::vector<std::vector<int>> &elements,
+		std::vector<std::vector<double>> &weights,
+		std::vector<int> &body_ids,
+		std::vector<int> &boundary_ids)
+	{
+		BinaryMesh file;
+		if (!file.open(path))
+			return false;
+
+		if (!file.has("vertices") || !file.has("cells"))
+		{
+			logger().error("Binary mesh without vertices or cells: {}", path);
+			return false;
+		}
+
+		// single copy from the mapped pages to the matrices
+		vertices = file.doubles("vertices");
+		cells = file.ints("cells");
+
+		file.lists("element_offsets", "element_nodes", elements);
+		file.lists("weight_offsets", "weights", weights);
+
+		body_ids.clear();
+		if (file.has("body_ids"))
+		{
+			const auto ids = file.ints("body_ids");
+			body_ids.assign(ids.data(), ids.data() + ids.size());
+		}
+
+		boundary_ids.clear();
+		if (file.has("boundary_ids"))
+		{
+			const auto ids = file.ints("boundary_ids");
+			boundary_ids.assign(ids.data(), ids.data() + ids.size());
+		}
+
+		return true;
+	}
+
+	bool BinaryMesh::write(
+		const std::string &path,
+		const Eigen::MatrixXd &vertices,
+		const Eigen::MatrixXi &cells,
+		const std::vector<std::vector<int>> &elements,
+		const std::vector<std::vector<double>> &weights,
+		const std::vector<int> &body_ids,
+		const std::vector<int> &boundary_ids,
+		const std::map<std::string, Eigen::MatrixXd> &fields)
+	{
+		std::vector<OutArray> arrays;
+		const auto add_doubles = [&](const std::string &name, const double *data, const size_t rows, const size_t cols) {
+			arrays.push_back({name, uint32_t(Type::Double), rows, cols, reinterpret_cast<const char *>(data), rows * cols * sizeof(double)});
+		};
+		const auto add_ints = [&](const std::string &name, const int *data, const size_t rows, const size_t cols) {
+			arrays.push_back({name, uint32_t(Type::Int), rows, cols, reinterpret_cast<const char *>(data), rows * cols * sizeof(int)});
+		};
+
+		add_doubles("vertices", vertices.data(), vertices.rows(), vertices.cols());
+		add_ints("cells", cells.data(), cells.rows(), cells.cols());
+
+		if (!body_ids.empty())
+			add_ints("body_ids", body_ids.data(), body_ids.size(), 1);
+		if (!boundary_ids.empty())
+			add_ints("boundary_ids", boundary_ids.data(), boundary_ids.size(), 1);
+
+		std::vector<int> element_offsets, element_nodes;
+		if (!elements.empty())
+		{
+			to_offsets_and_values(elements, element_offsets, element_nodes);
+			add_ints("element_offsets", element_offsets.data(), element_offsets.size(), 1);
+			add_ints("element_nodes", element_nodes.data(), element_nodes.size(), 1);
+		}
+
+		std::vector<int> weight_offsets;
+		std::vector<double> flat_weights;
+		if (!weights.empty())
+		{
+			to_offsets_and_values(weights, weight_offsets, flat_weights);
+			add_ints("weight_offsets", weight_offsets.data(), weight_offsets.size(), 1);
+			add_doubles("weights", flat_weights.data(), flat_weights.size(), 1);
+		}
+
+		for (const auto &[name, field] : fields)
+			add_doubles(name, field.data(), field.rows(), field.cols());
+
+		std::ofstream out(path, std::ios::out | std::ios::binary);
+		if (!out.good())
+		{
+			logger().error("Failed to write to file: {}", path);
+			return false;
+		}
+
+		FileHeader header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.byte_order = BYTE_ORDER_MARK;
+		header.n_arrays = arrays.size();
+		header.padding = 0;
+		out.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+
+		size_t offset = align(sizeof(FileHeader) + arrays.size() * sizeof(TableEntry));
+		std::vector<size_t> offsets;
+		for (const OutArray &a : arrays)
+		{
+			if (a.name.size() >= NAME_SIZE)
+			{
+				logger().error("Array name too long for the binary mesh: {}", a.name);
+				return false;
+			}
+
+			TableEntry entry = {};
+			std::memcpy(entry.name, a.name.c_str(), a.name.size());
+			entry.type = a.type;
+			entry.rows = a.rows;
+			entry.cols = a.cols;
+			entry.offset = offset;
+			out.write(reinterpret_cast<const char *>(&entry), sizeof(TableEntry));
+
+			offsets.push_back(offset);
+			offset = align(offset + a.bytes);
+		}
+
+		const std::vector<char> zeros(ALIGNMENT, 0);
+		for (size_t i = 0; i < arrays.size(); ++i)
+		{
+			out.write(zeros.data(), offsets[i] - size_t(out.tellp()));
+			out.write(arrays[i].data, arrays[i].bytes);
+		}
+
+		return out.good();
+	}
+} // namespace polyfem::io
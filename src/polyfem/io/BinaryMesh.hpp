@@ -0,0 +1,125 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace polyfem::io
+{
+	/// @brief Native binary container for meshes and nodal fields (extension .pfmesh).
+	///
+	/// The file is a table of named arrays followed by their data, stored column-major and
+	/// 64-byte aligned, hence an array can be used in place (Eigen::Map) once the file is mapped
+	/// in memory; nothing is parsed. The mesh arrays are
+	///   "vertices" (#V x dim, double), "cells" (#C x #nodes per cell, int),
+	///   optional "body_ids" (#C, int) and "boundary_ids" (#boundary primitives, int),
+	///   optional high-order nodes as "element_offsets" (#C + 1, int) and "element_nodes" (int),
+	///   optional rational weights as "weight_offsets" (#C + 1, int) and "weights" (double).
+	/// Any other array (e.g., an initial solution) can be stored with its own name.
+	/// The header stores a version and a byte order mark, files from a machine with another byte order are rejected.
+	class BinaryMesh
+	{
+	public:
+		BinaryMesh() = default;
+		~BinaryMesh();
+
+		BinaryMesh(const BinaryMesh &) = delete;
+		BinaryMesh &operator=(const BinaryMesh &) = delete;
+
+		/// @brief Maps a file in memory
+		/// @param[in] path path of the file
+		/// @return true if the file is a valid container
+		bool open(const std::string &path);
+
+		/// unmaps the file, the maps returned by the getters become invalid
+		void close();
+
+		/// @brief Checks if the container has an array
+		/// @param[in] name name of the array
+		bool has(const std::string &name) const { return arrays_.find(name) != arrays_.end(); }
+
+		/// @return names of all the arrays
+		std::vector<std::string> names() const;
+
+		/// @brief Array of doubles, valid until the file is closed
+		/// @param[in] name name of the array
+		Eigen::Map<const Eigen::MatrixXd> doubles(const std::string &name) const;
+
+		/// @brief Array of ints, valid until the file is closed
+		/// @param[in] name name of the array
+		Eigen::Map<const Eigen::MatrixXi> ints(const std::string &name) const;
+
+		/// @brief Reads the variable-size lists stored as offsets and values (e.g., the high-order nodes)
+		/// @param[in] offsets_name name of the #lists + 1 offsets array
+		/// @param[in] values_name name of the values array
+		/// @param[out] lists lists, empty if the arrays are missing
+		/// @throws if the offsets do not start at 0, decrease, or do not end at the number of values
+		template <typename T>
+		void lists(const std::string &offsets_name, const std::string &values_name, std::vector<std::vector<T>> &lists) const;
+
+		/// @brief Reads a mesh
+		/// @param[in] path path of the file
+		/// @param[out] vertices #V x dim vertices
+		/// @param[out] cells #C x #nodes per cell connectivity
+		/// @param[out] elements high-order nodes of every cell, empty if not stored
+		/// @param[out] weights rational weights of every cell, empty if not stored
+		/// @param[out] body_ids body id of every cell, empty if not stored
+		/// @param[out] boundary_ids boundary id of every boundary primitive, empty if not stored
+		/// @return true if the mesh has been read
+		static bool load(
+			const std::string &path,
+			Eigen::MatrixXd &vertices,
+			Eigen::MatrixXi &cells,
+			std::vector<std::vector<int>> &elements,
+			std::vector<std::vector<double>> &weights,
+			std::vector<int> &body_ids,
+			std::vector<int> &boundary_ids);
+
+		/// @brief Writes a mesh and (optionally) nodal fields
+		/// @param[in] path path of the file
+		/// @param[in] vertices #V x dim vertices
+		/// @param[in] cells #C x #nodes per cell connectivity
+		/// @param[in] elements high-order nodes of every cell, can be empty
+		/// @param[in] weights rational weights of every cell, can be empty
+		/// @param[in] body_ids body id of every cell, can be empty
+		/// @param[in] boundary_ids boundary id of every boundary primitive, can be empty
+		/// @param[in] fields additional named arrays
+		/// @return true if the file has been written
+		static bool write(
+			const std::string &path,
+			const Eigen::MatrixXd &vertices,
+			const Eigen::MatrixXi &cells,
+			const std::vector<std::vector<int>> &elements,
+			const std::vector<std::vector<double>> &weights,
+			const std::vector<int> &body_ids,
+			const std::vector<int> &boundary_ids,
+			const std::map<std::string, Eigen::MatrixXd> &fields = {});
+
+	private:
+		enum class Type : uint32_t
+		{
+			Double = 0,
+			Int = 1
+		};
+
+		struct Array
+		{
+			Type type;
+			uint64_t rows;
+			uint64_t cols;
+			uint64_t offset;
+		};
+
+		const Array &array(const std::string &name, const Type type) const;
+
+		std::map<std::string, Array> arrays_;
+
+		const char *data_ = nullptr;
+		size_t size_ = 0;
+		/// used when the file cannot be mapped
+		std::vector<char> buffer_;
+	};
+} // namespace polyfem::io
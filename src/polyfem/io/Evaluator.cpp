@@ -14,10 +14,13 @@
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/AABB.h>
 #include <igl/per_face_normals.h>
 
+#include <numeric>
+
 namespace polyfem::io
 {
 	using namespace mesh;
@@ -51,6 +54,174 @@ namespace polyfem::io
 				logger().error("Invalid tensor dimensions.");
 			}
 		}
+
+		// local points of element e where interpolate_function evaluates, false if the element is skipped
+		bool interpolation_local_points(
+			const mesh::Mesh &mesh,
+			const int e,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const bool use_sampler,
+			const bool boundary_only,
+			Eigen::MatrixXd &local_pts)
+		{
+			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(e))
+				return false;
+
+			if (use_sampler)
+			{
+				Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+
+				if (mesh.is_simplex(e))
+					local_pts = sampler.simplex_points();
+				else if (mesh.is_cube(e))
+					local_pts = sampler.cube_points();
+				else
+				{
+					if (mesh.is_volume())
+						sampler.sample_polyhedron(polys_3d.at(e).first, polys_3d.at(e).second, local_pts, vis_faces_poly, vis_edges_poly);
+					else
+						sampler.sample_polygon(polys.at(e), local_pts, vis_faces_poly, vis_edges_poly);
+				}
+			}
+			else
+			{
+				if (mesh.is_volume())
+				{
+					if (mesh.is_simplex(e))
+						autogen::p_nodes_3d(disc_orders(e), local_pts);
+					else if (mesh.is_cube(e))
+						autogen::q_nodes_3d(disc_orders(e), local_pts);
+					else
+						return false;
+				}
+				else
+				{
+					if (mesh.is_simplex(e))
+						autogen::p_nodes_2d(disc_orders(e), local_pts);
+					else if (mesh.is_cube(e))
+						autogen::q_nodes_2d(disc_orders(e), local_pts);
+					else
+						return false;
+				}
+			}
+
+			return true;
+		}
+
+		// loop over the elements of interpolation_local_points, in parallel unless polygons
+		// are sampled since the polygon sampler (triangle) is not thread safe
+		void for_each_sampled_element(
+			const mesh::Mesh &mesh,
+			const int n_elements,
+			const bool use_sampler,
+			const std::function<void(int, int, int)> &partial_for)
+		{
+			if (use_sampler && mesh.has_poly())
+				partial_for(0, n_elements, /*thread_id=*/0);
+			else
+				utils::maybe_parallel_for(n_elements, partial_for);
+		}
+
+		// first output row of each element for the points of interpolation_local_points (prefix sum of the
+		// number of points per element), offsets has #elements + 1 entries and offsets.back() is the total
+		void interpolation_offsets(
+			const mesh::Mesh &mesh,
+			const int n_elements,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const bool use_sampler,
+			const bool boundary_only,
+			std::vector<int> &offsets)
+		{
+			offsets.assign(n_elements + 1, 0);
+			for_each_sampled_element(mesh, n_elements, use_sampler, [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd local_pts;
+				for (int e = start; e < end; ++e)
+				{
+					if (interpolation_local_points(mesh, e, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts))
+						offsets[e + 1] = local_pts.rows();
+				}
+			});
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		}
+
+		// quadrature used by compute_stress_at_quadrature_points, false for polygonal elements
+		bool stress_quadrature(const mesh::Mesh &mesh, const int e, const int order, quadrature::Quadrature &quadr)
+		{
+			if (mesh.is_simplex(e))
+			{
+				if (mesh.is_volume())
+				{
+					quadrature::TetQuadrature f;
+					f.get_quadrature(order, quadr);
+				}
+				else
+				{
+					quadrature::TriQuadrature f;
+					f.get_quadrature(order, quadr);
+				}
+			}
+			else if (mesh.is_cube(e))
+			{
+				if (mesh.is_volume())
+				{
+					quadrature::HexQuadrature f;
+					f.get_quadrature(order, quadr);
+				}
+				else
+				{
+					quadrature::QuadQuadrature f;
+					f.get_quadrature(order, quadr);
+				}
+			}
+			else
+				return false;
+
+			return true;
+		}
+
+		// first element with output points (offsets[e + 1] > offsets[e]), -1 if none
+		int first_non_empty(const std::vector<int> &offsets)
+		{
+			for (int e = 0; e + 1 < offsets.size(); ++e)
+			{
+				if (offsets[e + 1] > offsets[e])
+					return e;
+			}
+			return -1;
+		}
+
+		// interpolates the local values of a function (#local bases x actual_dim) and their gradient at the points of vals
+		void interpolate_local_values(
+			const ElementAssemblyValues &vals,
+			const int dim,
+			const Eigen::MatrixXd &local,
+			Eigen::MatrixXd &result,
+			Eigen::MatrixXd &result_grad)
+		{
+			const int actual_dim = local.cols();
+			assert(local.rows() == vals.basis_values.size());
+
+			result.setZero(vals.val.rows(), actual_dim);
+			result_grad.setZero(vals.val.rows(), dim * actual_dim);
+
+			for (int i = 0; i < local.rows(); ++i)
+			{
+				const auto &val = vals.basis_values[i];
+				assert(val.grad_t_m.cols() == dim);
+
+				for (int d = 0; d < actual_dim; ++d)
+				{
+					result.col(d) += local(i, d) * val.val;
+					result_grad.middleCols(d * dim, dim) += local(i, d) * val.grad_t_m;
+				}
+			}
+		}
 	} // namespace
 
 	void Evaluator::get_sidesets(
@@ -589,21 +760,7 @@ namespace polyfem::io
 		assert(!is_problem_scalar);
 		const int actual_dim = mesh.dimension();
 
-		std::vector<Eigen::MatrixXd> avg_scalar;
-
-		Eigen::MatrixXd areas(n_bases, 1);
-		areas.setZero();
-
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
-		Eigen::MatrixXd local_val;
-
-		ElementAssemblyValues vals;
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
-
+		const auto local_nodes = [&](const int i, Eigen::MatrixXd &local_pts) {
 			if (mesh.is_simplex(i))
 			{
 				if (mesh.dimension() == 3)
@@ -621,63 +778,104 @@ namespace polyfem::io
 			else
 			{
 				// not supported for polys
-				continue;
+				return false;
 			}
+			return true;
+		};
+
+		// the values at the local nodes and the area of each element, scattered to the nodes once they are all evaluated
+		std::vector<Eigen::MatrixXd> element_values(bases.size());
+		std::vector<double> element_areas(bases.size(), 0);
 
+		const auto evaluate = [&](const int i, const Eigen::MatrixXd &local_pts, ElementAssemblyValues &vals, std::vector<std::pair<std::string, Eigen::MatrixXd>> &tmp_s) {
 			vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
-			const quadrature::Quadrature &quadrature = vals.quadrature;
-			const double area = (vals.det.array() * quadrature.weights.array()).sum();
+			element_areas[i] = (vals.det.array() * vals.quadrature.weights.array()).sum();
 
-			assembler.compute_scalar_value(i, bs, gbs, local_pts, fun, tmp_s);
+			assembler.compute_scalar_value(i, bases[i], gbases[i], local_pts, fun, tmp_s);
 
 			// assembler.compute_tensor_value(i, bs, gbs, local_pts, fun, local_val);
 			// MatrixXd avg_tensor(n_points * actual_dim*actual_dim, 1);
 
-			for (size_t j = 0; j < bs.bases.size(); ++j)
+			Eigen::MatrixXd &values = element_values[i];
+			values.resize(bases[i].bases.size(), tmp_s.size());
+			for (int k = 0; k < tmp_s.size(); ++k)
+				values.col(k) = tmp_s[k].second.col(0);
+		};
+
+		// the first element gives the names of the values
+		std::vector<std::string> names;
+		int first = bases.size();
+		for (int i = 0; i < int(bases.size()); ++i)
+		{
+			Eigen::MatrixXd local_pts;
+			if (!local_nodes(i, local_pts))
+				continue;
+
+			ElementAssemblyValues vals;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+			evaluate(i, local_pts, vals, tmp_s);
+			for (const auto &[name, _] : tmp_s)
+				names.push_back(name);
+			first = i;
+			break;
+		}
+
+		struct LocalThreadStorage
+		{
+			ElementAssemblyValues vals;
+			Eigen::MatrixXd local_pts;
+			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+		};
+
+		auto storage = utils::create_thread_storage(LocalThreadStorage());
+
+		utils::maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+
+			for (int i = std::max(start, first + 1); i < end; ++i)
 			{
-				const Basis &b = bs.bases[j];
-				if (b.global().size() > 1)
+				if (!local_nodes(i, local_storage.local_pts))
 					continue;
 
-				auto &global = b.global().front();
-				areas(global.index) += area;
+				evaluate(i, local_storage.local_pts, local_storage.vals, local_storage.tmp_s);
+				assert(local_storage.tmp_s.size() == names.size());
 			}
+		});
 
-			if (avg_scalar.empty())
-			{
-				avg_scalar.resize(tmp_s.size());
-				for (auto &m : avg_scalar)
-				{
-					m.resize(n_bases, 1);
-					m.setZero();
-				}
-			}
+		Eigen::VectorXd areas = Eigen::VectorXd::Zero(n_bases);
+		std::vector<Eigen::MatrixXd> avg_scalar(names.size(), Eigen::MatrixXd::Zero(n_bases, 1));
+		for (int i = first; i < int(bases.size()); ++i)
+		{
+			// not supported for polys
+			const Eigen::MatrixXd &values = element_values[i];
+			if (values.rows() == 0)
+				continue;
 
-			for (int k = 0; k < tmp_s.size(); ++k)
+			const double area = element_areas[i];
+			for (size_t j = 0; j < bases[i].bases.size(); ++j)
 			{
-				local_val = tmp_s[k].second;
+				const Basis &b = bases[i].bases[j];
+				if (b.global().size() > 1)
+					continue;
 
-				for (size_t j = 0; j < bs.bases.size(); ++j)
-				{
-					const Basis &b = bs.bases[j];
-					if (b.global().size() > 1)
-						continue;
+				auto &global = b.global().front();
+				areas(global.index) += area;
 
-					auto &global = b.global().front();
-					avg_scalar[k](global.index) += local_val(j) * area;
-				}
+				for (int k = 0; k < names.size(); ++k)
+					avg_scalar[k](global.index) += values(j, k) * area;
 			}
 		}
+		element_values.clear();
 
 		for (auto &m : avg_scalar)
 		{
 			m.array() /= areas.array();
 		}
 
-		result_scalar.resize(tmp_s.size());
-		for (int k = 0; k < tmp_s.size(); ++k)
+		result_scalar.resize(names.size());
+		for (int k = 0; k < names.size(); ++k)
 		{
-			result_scalar[k].first = tmp_s[k].first;
+			result_scalar[k].first = names[k];
 			interpolate_function(mesh, 1, bases, disc_orders, polys, polys_3d, sampler, n_points,
 								 avg_scalar[k], result_scalar[k].second, use_sampler, boundary_only);
 		}
@@ -798,70 +996,45 @@ namespace polyfem::io
 		const int actual_dim = mesh.dimension();
 		assert(!is_problem_scalar);
 
-		Eigen::MatrixXd local_val, local_stress, local_mises;
-
-		int num_quadr_pts = 0;
-		result.resize(disc_orders.sum(), actual_dim == 2 ? 3 : 6);
-		result.setZero();
-		von_mises.resize(disc_orders.sum(), 1);
-		von_mises.setZero();
-		for (int e = 0; e < mesh.n_elements(); ++e)
-		{
-			// Compute quadrature points for element
+		// output rows of each element (prefix sum of the number of quadrature points)
+		std::vector<int> offsets(mesh.n_elements() + 1, 0);
+		utils::maybe_parallel_for(mesh.n_elements(), [&](int start, int end, int thread_id) {
 			quadrature::Quadrature quadr;
-			if (mesh.is_simplex(e))
-			{
-				if (mesh.is_volume())
-				{
-					quadrature::TetQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
-				}
-				else
-				{
-					quadrature::TriQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
-				}
-			}
-			else if (mesh.is_cube(e))
+			for (int e = start; e < end; ++e)
 			{
-				if (mesh.is_volume())
-				{
-					quadrature::HexQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
-				}
-				else
-				{
-					quadrature::QuadQuadrature f;
-					f.get_quadrature(disc_orders(e), quadr);
-				}
-			}
-			else
-			{
-				continue;
+				if (stress_quadrature(mesh, e, disc_orders(e), quadr))
+					offsets[e + 1] = quadr.points.rows();
 			}
+		});
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		result.setZero(offsets.back(), actual_dim == 2 ? 3 : 6);
+		von_mises.setZero(offsets.back(), 1);
 
+		utils::maybe_parallel_for(mesh.n_elements(), [&](int start, int end, int thread_id) {
+			quadrature::Quadrature quadr;
+			Eigen::MatrixXd local_stress;
 			std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s, tmp_t;
 
-			assembler.compute_scalar_value(e, bases[e], gbases[e], quadr.points, fun, tmp_s);
-			assembler.compute_tensor_value(e, bases[e], gbases[e], quadr.points, fun, tmp_t);
+			for (int e = start; e < end; ++e)
+			{
+				if (offsets[e + 1] == offsets[e])
+					continue;
 
-			local_mises = tmp_s[0].second;
-			local_val = tmp_t[0].second;
+				stress_quadrature(mesh, e, disc_orders(e), quadr);
 
-			if (num_quadr_pts + local_val.rows() >= result.rows())
-			{
-				result.conservativeResize(
-					std::max(num_quadr_pts + local_val.rows() + 1, 2 * result.rows()),
-					result.cols());
-				von_mises.conservativeResize(result.rows(), von_mises.cols());
+				assembler.compute_scalar_value(e, bases[e], gbases[e], quadr.points, fun, tmp_s);
+				assembler.compute_tensor_value(e, bases[e], gbases[e], quadr.points, fun, tmp_t);
+
+				const Eigen::MatrixXd &local_mises = tmp_s[0].second;
+				const Eigen::MatrixXd &local_val = tmp_t[0].second;
+				assert(local_val.rows() == offsets[e + 1] - offsets[e]);
+
+				flattened_tensor_coeffs(local_val, local_stress);
+				result.block(offsets[e], 0, local_stress.rows(), local_stress.cols()) = local_stress;
+				von_mises.block(offsets[e], 0, local_mises.rows(), local_mises.cols()) = local_mises;
 			}
-			flattened_tensor_coeffs(local_val, local_stress);
-			result.block(num_quadr_pts, 0, local_stress.rows(), local_stress.cols()) = local_stress;
-			von_mises.block(num_quadr_pts, 0, local_mises.rows(), local_mises.cols()) = local_mises;
-			num_quadr_pts += local_val.rows();
-		}
-		result.conservativeResize(num_quadr_pts, result.cols());
-		von_mises.conservativeResize(num_quadr_pts, von_mises.cols());
+		});
 	}
 
 	void Evaluator::interpolate_function(
@@ -906,74 +1079,106 @@ namespace polyfem::io
 			return;
 		}
 
-		std::vector<AssemblyValues> tmp;
-
 		result.resize(n_points, actual_dim);
 
-		int index = 0;
+		std::vector<int> offsets;
+		interpolation_offsets(mesh, basis.size(), disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets);
+		assert(offsets.back() <= n_points);
 
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
+		auto storage = utils::create_thread_storage(std::vector<AssemblyValues>());
 
-		for (int i = 0; i < int(basis.size()); ++i)
-		{
-			const ElementBases &bs = basis[i];
+		for_each_sampled_element(mesh, basis.size(), use_sampler, [&](int start, int end, int thread_id) {
+			std::vector<AssemblyValues> &tmp = utils::get_local_thread_storage(storage, thread_id);
 			Eigen::MatrixXd local_pts;
 
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
-
-			if (use_sampler)
+			for (int i = start; i < end; ++i)
 			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
+				if (offsets[i + 1] == offsets[i])
+					continue;
+
+				const ElementBases &bs = basis[i];
+				interpolation_local_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+
+				Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
+				bs.evaluate_bases(local_pts, tmp);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
+					const Basis &b = bs.bases[j];
+
+					for (int d = 0; d < actual_dim; ++d)
+					{
+						for (size_t ii = 0; ii < b.global().size(); ++ii)
+							local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					}
 				}
+
+				result.block(offsets[i], 0, local_res.rows(), actual_dim) = local_res;
 			}
+		});
+	}
 
-			Eigen::MatrixXd local_res = Eigen::MatrixXd::Zero(local_pts.rows(), actual_dim);
-			bs.evaluate_bases(local_pts, tmp);
-			for (size_t j = 0; j < bs.bases.size(); ++j)
+	void Evaluator::build_interpolation_matrix(
+		const mesh::Mesh &mesh,
+		const std::vector<basis::ElementBases> &bases,
+		const Eigen::VectorXi &disc_orders,
+		const std::map<int, Eigen::MatrixXd> &polys,
+		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+		const utils::RefElementSampler &sampler,
+		const int n_points,
+		const int n_nodes,
+		StiffnessMatrix &interpolation,
+		const bool use_sampler,
+		const bool boundary_only)
+	{
+		std::vector<int> offsets;
+		interpolation_offsets(mesh, bases.size(), disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets);
+		assert(offsets.back() <= n_points);
+
+		struct LocalThreadStorage
+		{
+			std::vector<AssemblyValues> tmp;
+			std::vector<Eigen::Triplet<double>> entries;
+		};
+
+		auto storage = utils::create_thread_storage(LocalThreadStorage());
+
+		for_each_sampled_element(mesh, bases.size(), use_sampler, [&](int start, int end, int thread_id) {
+			LocalThreadStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+			Eigen::MatrixXd local_pts;
+
+			for (int i = start; i < end; ++i)
 			{
-				const Basis &b = bs.bases[j];
+				if (offsets[i + 1] == offsets[i])
+					continue;
 
-				for (int d = 0; d < actual_dim; ++d)
+				const ElementBases &bs = bases[i];
+				interpolation_local_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+
+				bs.evaluate_bases(local_pts, local_storage.tmp);
+				for (size_t j = 0; j < bs.bases.size(); ++j)
 				{
+					const Basis &b = bs.bases[j];
+
 					for (size_t ii = 0; ii < b.global().size(); ++ii)
-						local_res.col(d) += b.global()[ii].val * tmp[j].val * fun(b.global()[ii].index * actual_dim + d);
+					{
+						for (int q = 0; q < local_pts.rows(); ++q)
+						{
+							const double val = b.global()[ii].val * local_storage.tmp[j].val(q);
+							if (val != 0)
+								local_storage.entries.emplace_back(offsets[i] + q, b.global()[ii].index, val);
+						}
+					}
 				}
 			}
+		});
 
-			result.block(index, 0, local_res.rows(), actual_dim) = local_res;
-			index += local_res.rows();
-		}
+		std::vector<Eigen::Triplet<double>> entries;
+		for (const LocalThreadStorage &local_storage : storage)
+			entries.insert(entries.end(), local_storage.entries.begin(), local_storage.entries.end());
+
+		interpolation.resize(n_points, n_nodes);
+		interpolation.setFromTriplets(entries.begin(), entries.end());
+		interpolation.makeCompressed();
 	}
 
 	void Evaluator::interpolate_at_local_vals(
@@ -1014,36 +1219,35 @@ namespace polyfem::io
 		assert(local_pts.cols() == mesh.dimension());
 		assert(fun.cols() == 1);
 
-		const ElementBases &gbs = gbases[el_index];
 		const ElementBases &bs = bases[el_index];
 
 		ElementAssemblyValues vals;
-		vals.compute(el_index, mesh.is_volume(), local_pts, bs, gbs);
-
-		result.resize(vals.val.rows(), actual_dim);
-		result.setZero();
-
-		result_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
-		result_grad.setZero();
-
-		const int n_loc_bases = int(vals.basis_values.size());
+		vals.compute(el_index, mesh.is_volume(), local_pts, bs, gbases[el_index]);
 
-		for (int i = 0; i < n_loc_bases; ++i)
+		Eigen::MatrixXd local = Eigen::MatrixXd::Zero(bs.bases.size(), actual_dim);
+		for (int i = 0; i < local.rows(); ++i)
 		{
-			const auto &val = vals.basis_values[i];
-
-			for (size_t ii = 0; ii < val.global.size(); ++ii)
+			for (const Local2Global &g : bs.bases[i].global())
 			{
 				for (int d = 0; d < actual_dim; ++d)
-				{
-					result.col(d) += val.global[ii].val * fun(val.global[ii].index * actual_dim + d) * val.val;
-					result_grad.block(0, d * val.grad_t_m.cols(), result_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * fun(val.global[ii].index * actual_dim + d) * val.grad_t_m;
-				}
+					local(i, d) += g.val * fun(g.index * actual_dim + d);
 			}
 		}
+
+		interpolate_local_values(vals, mesh.dimension(), local, result, result_grad);
 	}
 
-	void Evaluator::interpolate_at_local_vals(const int el_index, const int dim, const int actual_dim, const assembler::ElementAssemblyValues &vals, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result, Eigen::MatrixXd &result_grad)
+	void Evaluator::interpolate_at_local_vals(
+		const mesh::Mesh &mesh,
+		const int actual_dim,
+		const std::vector<basis::ElementBases> &bases,
+		const basis::ElementDofMap &dof_map,
+		const std::vector<basis::ElementBases> &gbases,
+		const int el_index,
+		const Eigen::MatrixXd &local_pts,
+		const Eigen::MatrixXd &fun,
+		Eigen::MatrixXd &result,
+		Eigen::MatrixXd &result_grad)
 	{
 		if (fun.size() <= 0)
 		{
@@ -1051,29 +1255,35 @@ namespace polyfem::io
 			return;
 		}
 
-		assert(fun.cols() == 1);
-
-		result.resize(vals.val.rows(), actual_dim);
-		result.setZero();
+		assert(local_pts.cols() == mesh.dimension());
 
-		result_grad.resize(vals.val.rows(), dim * actual_dim);
-		result_grad.setZero();
+		ElementAssemblyValues vals;
+		vals.compute(el_index, mesh.is_volume(), local_pts, bases[el_index], gbases[el_index]);
 
-		const int n_loc_bases = int(vals.basis_values.size());
+		interpolate_at_local_vals(el_index, mesh.dimension(), actual_dim, dof_map, vals, fun, result, result_grad);
+	}
 
-		for (int i = 0; i < n_loc_bases; ++i)
+	void Evaluator::interpolate_at_local_vals(
+		const int el_index,
+		const int dim,
+		const int actual_dim,
+		const basis::ElementDofMap &dof_map,
+		const assembler::ElementAssemblyValues &vals,
+		const Eigen::MatrixXd &fun,
+		Eigen::MatrixXd &result,
+		Eigen::MatrixXd &result_grad)
+	{
+		if (fun.size() <= 0)
 		{
-			const auto &val = vals.basis_values[i];
-
-			for (size_t ii = 0; ii < val.global.size(); ++ii)
-			{
-				for (int d = 0; d < actual_dim; ++d)
-				{
-					result.col(d) += val.global[ii].val * fun(val.global[ii].index * actual_dim + d) * val.val;
-					result_grad.block(0, d * val.grad_t_m.cols(), result_grad.rows(), val.grad_t_m.cols()) += val.global[ii].val * fun(val.global[ii].index * actual_dim + d) * val.grad_t_m;
-				}
-			}
+			logger().error("Solve the problem first!");
+			return;
 		}
+
+		assert(fun.cols() == 1);
+
+		Eigen::MatrixXd local;
+		dof_map.gather(el_index, actual_dim, fun, local);
+		interpolate_local_values(vals, dim, local, result, result_grad);
 	}
 
 	bool Evaluator::check_scalar_value(
@@ -1183,75 +1393,52 @@ namespace polyfem::io
 
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_s;
+		std::vector<int> offsets;
+		interpolation_offsets(mesh, bases.size(), disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets);
+		assert(offsets.back() <= n_points);
 
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
+		const int first = first_non_empty(offsets);
+		if (first < 0)
+			return;
 
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
+		const auto local_values = [&](const int i, Eigen::MatrixXd &local_pts, std::vector<assembler::Assembler::NamedMatrix> &tmp) {
+			interpolation_local_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+			assembler.compute_scalar_value(i, bases[i], gbases[i], local_pts, fun, tmp);
 
-			if (use_sampler)
+			for (int k = 0; k < tmp.size(); ++k)
 			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
+				assert(local_pts.rows() == tmp[k].second.rows());
+				result[k].second.block(offsets[i], 0, tmp[k].second.rows(), tmp[k].second.cols()) = tmp[k].second;
 			}
+		};
 
-			assembler.compute_scalar_value(i, bs, gbs, local_pts, fun, tmp_s);
+		// the first element gives the names of the values
+		{
+			Eigen::MatrixXd local_pts;
+			std::vector<assembler::Assembler::NamedMatrix> tmp;
+			interpolation_local_points(mesh, first, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+			assembler.compute_scalar_value(first, bases[first], gbases[first], local_pts, fun, tmp);
 
-			if (result.empty())
+			result.resize(tmp.size());
+			for (int k = 0; k < tmp.size(); ++k)
 			{
-				result.resize(tmp_s.size());
-				for (int k = 0; k < tmp_s.size(); ++k)
-				{
-					result[k].first = tmp_s[k].first;
-					result[k].second.resize(n_points, 1);
-				}
+				result[k].first = tmp[k].first;
+				result[k].second.resize(n_points, 1);
 			}
 
-			for (int k = 0; k < tmp_s.size(); ++k)
+			local_values(first, local_pts, tmp);
+		}
+
+		for_each_sampled_element(mesh, bases.size(), use_sampler, [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd local_pts;
+			std::vector<assembler::Assembler::NamedMatrix> tmp;
+
+			for (int i = start; i < end; ++i)
 			{
-				assert(local_pts.rows() == tmp_s[k].second.rows());
-				result[k].second.block(index, 0, tmp_s[k].second.rows(), 1) = tmp_s[k].second;
+				if (i != first && offsets[i + 1] > offsets[i])
+					local_values(i, local_pts, tmp);
 			}
-			index += local_pts.rows();
-		}
+		});
 	}
 
 	void Evaluator::compute_tensor_value(
@@ -1281,75 +1468,52 @@ namespace polyfem::io
 		const int actual_dim = mesh.dimension();
 		assert(!is_problem_scalar);
 
-		int index = 0;
-
-		Eigen::MatrixXi vis_faces_poly, vis_edges_poly;
-		std::vector<std::pair<std::string, Eigen::MatrixXd>> tmp_t;
+		std::vector<int> offsets;
+		interpolation_offsets(mesh, bases.size(), disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, offsets);
+		assert(offsets.back() <= n_points);
 
-		for (int i = 0; i < int(bases.size()); ++i)
-		{
-			if (boundary_only && mesh.is_volume() && !mesh.is_boundary_element(i))
-				continue;
+		const int first = first_non_empty(offsets);
+		if (first < 0)
+			return;
 
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
-			Eigen::MatrixXd local_pts;
+		const auto local_values = [&](const int i, Eigen::MatrixXd &local_pts, std::vector<assembler::Assembler::NamedMatrix> &tmp) {
+			interpolation_local_points(mesh, i, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+			assembler.compute_tensor_value(i, bases[i], gbases[i], local_pts, fun, tmp);
 
-			if (use_sampler)
+			for (int k = 0; k < tmp.size(); ++k)
 			{
-				if (mesh.is_simplex(i))
-					local_pts = sampler.simplex_points();
-				else if (mesh.is_cube(i))
-					local_pts = sampler.cube_points();
-				else
-				{
-					if (mesh.is_volume())
-						sampler.sample_polyhedron(polys_3d.at(i).first, polys_3d.at(i).second, local_pts, vis_faces_poly, vis_edges_poly);
-					else
-						sampler.sample_polygon(polys.at(i), local_pts, vis_faces_poly, vis_edges_poly);
-				}
-			}
-			else
-			{
-				if (mesh.is_volume())
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_3d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_3d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
-				else
-				{
-					if (mesh.is_simplex(i))
-						autogen::p_nodes_2d(disc_orders(i), local_pts);
-					else if (mesh.is_cube(i))
-						autogen::q_nodes_2d(disc_orders(i), local_pts);
-					else
-						continue;
-				}
+				assert(local_pts.rows() == tmp[k].second.rows());
+				result[k].second.block(offsets[i], 0, tmp[k].second.rows(), tmp[k].second.cols()) = tmp[k].second;
 			}
+		};
 
-			assembler.compute_tensor_value(i, bs, gbs, local_pts, fun, tmp_t);
+		// the first element gives the names of the values
+		{
+			Eigen::MatrixXd local_pts;
+			std::vector<assembler::Assembler::NamedMatrix> tmp;
+			interpolation_local_points(mesh, first, disc_orders, polys, polys_3d, sampler, use_sampler, boundary_only, local_pts);
+			assembler.compute_tensor_value(first, bases[first], gbases[first], local_pts, fun, tmp);
 
-			if (result.empty())
+			result.resize(tmp.size());
+			for (int k = 0; k < tmp.size(); ++k)
 			{
-				result.resize(tmp_t.size());
-				for (int k = 0; k < tmp_t.size(); ++k)
-				{
-					result[k].first = tmp_t[k].first;
-					result[k].second.resize(n_points, actual_dim * actual_dim);
-				}
+				result[k].first = tmp[k].first;
+				result[k].second.resize(n_points, actual_dim * actual_dim);
 			}
 
-			for (int k = 0; k < tmp_t.size(); ++k)
+			local_values(first, local_pts, tmp);
+		}
+
+		for_each_sampled_element(mesh, bases.size(), use_sampler, [&](int start, int end, int thread_id) {
+			Eigen::MatrixXd local_pts;
+			std::vector<assembler::Assembler::NamedMatrix> tmp;
+
+			for (int i = start; i < end; ++i)
 			{
-				assert(local_pts.rows() == tmp_t[k].second.rows());
-				result[k].second.block(index, 0, tmp_t[k].second.rows(), tmp_t[k].second.cols()) = tmp_t[k].second;
+				if (i != first && offsets[i + 1] > offsets[i])
+					local_values(i, local_pts, tmp);
 			}
-			index += local_pts.rows();
-		}
+		});
 	}
 
 	Eigen::MatrixXd Evaluator::get_bases_position(
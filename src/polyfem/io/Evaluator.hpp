@@ -3,6 +3,7 @@
 #include <Eigen/Core>
 
 #include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/basis/ElementDofMap.hpp>
 #include <polyfem/assembler/Assembler.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/mesh/MeshNodes.hpp>
@@ -107,6 +108,32 @@ namespace polyfem::io
 			const bool use_sampler,
 			const bool boundary_only);
 
+		/// builds the sparse operator evaluating nodal values at the points of interpolate_function,
+		/// interpolate_function(fun) = interpolation * unflatten(fun, actual_dim) for any fun
+		/// @param[in] mesh mesh
+		/// @param[in] bases bases
+		/// @param[in] disc_orders discretization orders
+		/// @param[in] polys polygons
+		/// @param[in] polys_3d polyhedra
+		/// @param[in] sampler sampler for the local element
+		/// @param[in] n_points number of evaluation points (rows of the output)
+		/// @param[in] n_nodes number of nodes (columns of the output)
+		/// @param[out] interpolation n_points x n_nodes operator
+		/// @param[in] use_sampler uses the sampler or not
+		/// @param[in] boundary_only interpolates only at boundary elements
+		static void build_interpolation_matrix(
+			const mesh::Mesh &mesh,
+			const std::vector<basis::ElementBases> &bases,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const int n_points,
+			const int n_nodes,
+			StiffnessMatrix &interpolation,
+			const bool use_sampler,
+			const bool boundary_only);
+
 		/// interpolate solution and gradient at element (calls interpolate_at_local_vals with sol)
 		/// @param[in] mesh mesh
 		/// @param[in] is_problem_scalar if problem is scalar
@@ -150,10 +177,44 @@ namespace polyfem::io
 			Eigen::MatrixXd &result,
 			Eigen::MatrixXd &result_grad);
 
+		/// interpolate the function fun and its gradient at in element el_index for the local_pts in the reference element using bases bases
+		/// the local values of fun are gathered with dof_map (use it when interpolating on many elements)
+		/// @param[in] mesh mesh
+		/// @param[in] actual_dim is the size of the problem (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] bases bases
+		/// @param[in] dof_map element to dof map of bases
+		/// @param[in] gbases geom bases
+		/// @param[in] el_index element index
+		/// @param[in] local_pts points in the reference element
+		/// @param[in] fun function to used
+		/// @param[out] result output
+		/// @param[out] result_grad output gradients
+		static void interpolate_at_local_vals(
+			const mesh::Mesh &mesh,
+			const int actual_dim,
+			const std::vector<basis::ElementBases> &bases,
+			const basis::ElementDofMap &dof_map,
+			const std::vector<basis::ElementBases> &gbases,
+			const int el_index,
+			const Eigen::MatrixXd &local_pts,
+			const Eigen::MatrixXd &fun,
+			Eigen::MatrixXd &result,
+			Eigen::MatrixXd &result_grad);
+
+		/// interpolate the function fun and its gradient at the points of the assembly values vals of element el_index
+		/// @param[in] el_index element index
+		/// @param[in] dim dimension of the mesh
+		/// @param[in] actual_dim is the size of the problem (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] dof_map element to dof map of the bases of vals
+		/// @param[in] vals assembly values of element el_index
+		/// @param[in] fun function to used
+		/// @param[out] result output
+		/// @param[out] result_grad output gradients
 		static void interpolate_at_local_vals(
-			const int el_index, 
+			const int el_index,
 			const int dim,
 			const int actual_dim,
+			const basis::ElementDofMap &dof_map,
 			const assembler::ElementAssemblyValues &vals,
 			const Eigen::MatrixXd &fun,
 			Eigen::MatrixXd &result,
@@ -0,0 +1,170 @@
+#include "HDF5Trajectory.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <h5pp/h5pp.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace polyfem::io
+{
+	namespace
+	{
+		/// target size of the chunks, few steps of small problems are stored together
+		constexpr hsize_t CHUNK_BYTES = 1 << 20;
+
+		/// converts a possibly negative step index to an index in [0, n_steps), -1 if out of range
+		hsize_t step_index(const int step, const hsize_t n_steps)
+		{
+			const long long index = step < 0 ? (long long)n_steps + step : step;
+			if (index < 0 || index >= (long long)n_steps)
+				return std::numeric_limits<hsize_t>::max();
+			return index;
+		}
+	} // namespace
+
+	HDF5Trajectory::HDF5Trajectory(const std::string &path, const int compression, const int n_kept_steps)
+		: path_(path), compression_(std::clamp(compression, 0, 9))
+	{
+		if (n_kept_steps <= 0)
+			return;
+
+		file_ = std::make_unique<h5pp::File>(path_, h5pp::FileAccess::READWRITE);
+
+		const hsize_t n_steps = file_->getDatasetDimensions("t").front();
+		const hsize_t n_kept = n_kept_steps;
+		if (n_steps < n_kept)
+			log_and_throw_error("The trajectory {} has {} steps, unable to append after step {}!", path_, n_steps, n_kept_steps - 1);
+
+		// the steps after the kept ones belong to a run that is not continued
+		if (n_steps > n_kept)
+		{
+			file_->resizeDataset("t", std::vector<hsize_t>{n_kept});
+			for (const std::string name : {"u", "v", "a"})
+				file_->resizeDataset(name, std::vector<hsize_t>{n_kept, file_->getDatasetDimensions(name).back()});
+		}
+
+		n_steps_ = n_kept_steps;
+	}
+
+	HDF5Trajectory::~HDF5Trajectory() = default;
+
+	void HDF5Trajectory::append(const double t, const Eigen::VectorXd &u, const Eigen::VectorXd &v, const Eigen::VectorXd &a)
+	{
+		if (file_ == nullptr)
+			file_ = std::make_unique<h5pp::File>(path_, h5pp::FileAccess::REPLACE);
+
+		append_row("t", Eigen::VectorXd::Constant(1, t));
+		append_row("u", u);
+		append_row("v", v);
+		append_row("a", a);
+
+		++n_steps_;
+
+		// the step is on disk before anything refers to it (e.g., the restart file of the step)
+		H5Fflush(file_->openFileHandle(), H5F_SCOPE_LOCAL);
+	}
+
+	void HDF5Trajectory::append_row(const std::string &name, const Eigen::VectorXd &values)
+	{
+		// "t" is a vector, the other fields are #steps x #dofs matrices
+		const bool is_vector = name == "t";
+		const hsize_t size = values.size();
+
+		if (n_steps_ == 0)
+		{
+			const hsize_t chunk_steps = std::max<hsize_t>(1, CHUNK_BYTES / (sizeof(double) * std::max<hsize_t>(size, 1)));
+
+			h5pp::Options options;
+			options.linkPath = name;
+			options.h5Layout = H5D_CHUNKED;
+			if (is_vector)
+			{
+				options.dataDims = std::vector<hsize_t>{1};
+				options.dsetMaxDims = std::vector<hsize_t>{H5S_UNLIMITED};
+				options.dsetChunkDims = std::vector<hsize_t>{chunk_steps};
+			}
+			else
+			{
+				options.dataDims = std::vector<hsize_t>{1, size};
+				options.dsetMaxDims = std::vector<hsize_t>{H5S_UNLIMITED, size};
+				options.dsetChunkDims = std::vector<hsize_t>{chunk_steps, size};
+			}
+			if (compression_ > 0)
+				options.compression = compression_;
+
+			file_->writeDataset(values, options);
+		}
+		else
+		{
+			// explicit dimensions, the values are one more row along the steps axis
+			const std::vector<hsize_t> dims = is_vector ? std::vector<hsize_t>{1} : std::vector<hsize_t>{1, size};
+			file_->appendToDataset(values, name, 0, dims);
+		}
+	}
+
+	int HDF5Trajectory::n_steps(const std::string &path)
+	{
+		try
+		{
+			h5pp::File file(path, h5pp::FileAccess::READONLY);
+			return file.getDatasetDimensions("t").front();
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Unable to read the trajectory {}: {}", path, e.what());
+			return -1;
+		}
+	}
+
+	bool HDF5Trajectory::read_step(const std::string &path, const std::string &field, const int step, Eigen::MatrixXd &data)
+	{
+		try
+		{
+			h5pp::File file(path, h5pp::FileAccess::READONLY);
+			const std::vector<hsize_t> dims = file.getDatasetDimensions(field);
+			assert(dims.size() == 2);
+
+			const hsize_t index = step_index(step, dims[0]);
+			if (index >= dims[0])
+			{
+				logger().error("Step {} is not in the trajectory {} ({} steps)", step, path, dims[0]);
+				return false;
+			}
+
+			// only the chunk(s) of the requested step are read
+			data = file.readHyperslab<Eigen::RowVectorXd>(field, h5pp::Hyperslab({index, 0}, {1, dims[1]})).transpose();
+			return true;
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Unable to read {} from the trajectory {}: {}", field, path, e.what());
+			return false;
+		}
+	}
+
+	bool HDF5Trajectory::read_time(const std::string &path, const int step, double &t)
+	{
+		try
+		{
+			h5pp::File file(path, h5pp::FileAccess::READONLY);
+			const std::vector<hsize_t> dims = file.getDatasetDimensions("t");
+
+			const hsize_t index = step_index(step, dims[0]);
+			if (index >= dims[0])
+			{
+				logger().error("Step {} is not in the trajectory {} ({} steps)", step, path, dims[0]);
+				return false;
+			}
+
+			t = file.readHyperslab<Eigen::VectorXd>("t", h5pp::Hyperslab({index}, {1}))(0);
+			return true;
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Unable to read the time from the trajectory {}: {}", path, e.what());
+			return false;
+		}
+	}
+} // namespace polyfem::io
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <memory>
+#include <string>
+
+namespace h5pp
+{
+	class File;
+}
+
+namespace polyfem::io
+{
+	/// @brief Trajectory of a transient simulation stored in a single HDF5 file.
+	///
+	/// The file contains the datasets "u", "v", and "a" (#steps x #dofs) and "t" (#steps).
+	/// The datasets are chunked and grow by one row per appended step, optionally compressed.
+	class HDF5Trajectory
+	{
+	public:
+		/// @param[in] path path of the file
+		/// @param[in] compression deflate level from 0 (no compression) to 9
+		/// @param[in] n_kept_steps number of steps of the existing file to keep and append to (e.g., when restarting from it),
+		///            the later steps are dropped. If 0 the file is replaced when the first step is appended.
+		HDF5Trajectory(const std::string &path, const int compression = 0, const int n_kept_steps = 0);
+		~HDF5Trajectory();
+
+		/// @brief Appends a step to the trajectory, the file is flushed before returning
+		/// @param[in] t time of the step
+		/// @param[in] u solution
+		/// @param[in] v velocity
+		/// @param[in] a acceleration
+		void append(const double t, const Eigen::VectorXd &u, const Eigen::VectorXd &v, const Eigen::VectorXd &a);
+
+		/// @return number of steps in the trajectory
+		int n_steps() const { return n_steps_; }
+
+		/// @brief Number of steps stored in a trajectory file
+		/// @param[in] path path of the file
+		/// @return number of steps, -1 if the file cannot be read
+		static int n_steps(const std::string &path);
+
+		/// @brief Reads one step of a trajectory file
+		/// @param[in] path path of the file
+		/// @param[in] field "u", "v", or "a"
+		/// @param[in] step index of the step, negative indices count from the end (-1 is the last step)
+		/// @param[out] data #dofs x 1 values of the field
+		/// @return true if the step has been read
+		static bool read_step(const std::string &path, const std::string &field, const int step, Eigen::MatrixXd &data);
+
+		/// @brief Reads the time of one step of a trajectory file
+		/// @param[in] path path of the file
+		/// @param[in] step index of the step, negative indices count from the end (-1 is the last step)
+		/// @param[out] t time of the step
+		/// @return true if the time has been read
+		static bool read_time(const std::string &path, const int step, double &t);
+
+	private:
+		void append_row(const std::string &name, const Eigen::VectorXd &row);
+
+		std::string path_;
+		int compression_;
+		int n_steps_ = 0;
+
+		std::unique_ptr<h5pp::File> file_;
+	};
+} // namespace polyfem::io
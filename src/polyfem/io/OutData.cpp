@@ -60,7 +60,7 @@ namespace polyfem::io
 			else
 				return;
 
-			const std::vector<basis::ElementBases> &bases = state.bases;
+			const std::vector<basis::ElementBases> &bases = state.bases();
 			const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 
 			Eigen::MatrixXd uv, samples, gtmp, rhs_fun, deform_mat, trafo;
@@ -925,7 +925,7 @@ namespace polyfem::io
 			return;
 		}
 		const int n_bases = state.n_bases;
-		const std::vector<basis::ElementBases> &bases = state.bases;
+		const std::vector<basis::ElementBases> &bases = state.bases();
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const mesh::Mesh &mesh = *state.mesh;
 		const Eigen::VectorXi &in_node_to_node = state.in_node_to_node;
@@ -1152,7 +1152,7 @@ namespace polyfem::io
 			vtm.add_dataset("Wireframe", "data", path_stem + "_wire" + opts.file_extension());
 		if (opts.points)
 			vtm.add_dataset("Points", "data", path_stem + "_points" + opts.file_extension());
-		vtm.save(base_path + ".vtm");
+		write([vtm = std::move(vtm), path = base_path + ".vtm"]() mutable { vtm.save(path); });
 	}
 
 	void OutGeometryData::save_volume(
@@ -1167,8 +1167,8 @@ namespace polyfem::io
 	{
 		const Eigen::VectorXi &disc_orders = state.disc_orders;
 		const auto &density = state.mass_matrix_assembler->density();
-		const std::vector<basis::ElementBases> &bases = state.bases;
-		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases;
+		const std::vector<basis::ElementBases> &bases = state.bases();
+		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases();
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const std::map<int, Eigen::MatrixXd> &polys = state.polys;
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d = state.polys_3d;
@@ -1178,19 +1178,15 @@ namespace polyfem::io
 		const mesh::Obstacle &obstacle = state.obstacle;
 		const assembler::Problem &problem = *state.problem;
 
-		Eigen::MatrixXd points;
-		Eigen::MatrixXi tets;
-		Eigen::MatrixXi el_id;
-		Eigen::MatrixXd discr;
-		std::vector<std::vector<int>> elements;
-
-		if (opts.use_sampler)
-			build_vis_mesh(mesh, disc_orders, gbases,
-						   state.polys, state.polys_3d, opts.boundary_only,
-						   points, tets, el_id, discr);
-		else
-			build_high_order_vis_mesh(mesh, disc_orders, bases,
-									  points, elements, el_id, discr);
+		// the vis mesh and the interpolation operators are rebuilt only if the discretization changed,
+		// the copies are extended with the obstacle below
+		const VolumeVisCache &vis = volume_vis_cache(state, opts);
+		Eigen::MatrixXd points = vis.points;
+		Eigen::MatrixXi tets = vis.tets;
+		const Eigen::MatrixXi &el_id = vis.el_id;
+		Eigen::MatrixXd discr = vis.discr;
+		std::vector<std::vector<int>> elements = vis.elements;
+		const int actual_dim = problem.is_scalar() ? 1 : mesh.dimension();
 
 		Eigen::MatrixXd fun, exact_fun, err, node_fun;
 
@@ -1209,6 +1205,10 @@ namespace polyfem::io
 			Eigen::MatrixXd res_grad_p(grid_points_to_elements.size(), problem_dim);
 			res_grad_p.setConstant(std::numeric_limits<double>::quiet_NaN());
 
+			basis::ElementDofMap tmp_dof_map, tmp_pressure_dof_map;
+			const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
+			const basis::ElementDofMap &pressure_dof_map = state.mixed_assembler != nullptr ? state.pressure_ass_vals_cache.dof_map(pressure_bases, tmp_pressure_dof_map) : tmp_pressure_dof_map;
+
 			for (int i = 0; i < grid_points_to_elements.size(); ++i)
 			{
 				const int el_id = grid_points_to_elements(i);
@@ -1220,7 +1220,7 @@ namespace polyfem::io
 				for (int d = 1; d < bc.cols(); ++d)
 					pt(d - 1) = bc(d);
 				Evaluator::interpolate_at_local_vals(
-					mesh, problem.is_scalar(), bases, gbases,
+					mesh, problem_dim, bases, dof_map, gbases,
 					el_id, pt, sol, tmp, tmp_grad);
 
 				res.row(i) = tmp;
@@ -1229,7 +1229,7 @@ namespace polyfem::io
 				if (state.mixed_assembler != nullptr)
 				{
 					Evaluator::interpolate_at_local_vals(
-						mesh, 1, pressure_bases, gbases,
+						mesh, 1, pressure_bases, pressure_dof_map, gbases,
 						el_id, pt, pressure, tmp_p, tmp_grad_p);
 					res_p.row(i) = tmp_p;
 					res_grad_p.row(i) = tmp_grad_p;
@@ -1255,18 +1255,11 @@ namespace polyfem::io
 			}
 		}
 
-		Evaluator::interpolate_function(
-			mesh, problem.is_scalar(), bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			points.rows(), sol, fun, opts.use_sampler, opts.boundary_only);
+		interpolate_volume(vis.interpolation, actual_dim, sol, fun);
 
 		{
 			Eigen::MatrixXd tmp = Eigen::VectorXd::LinSpaced(sol.size(), 0, sol.size() - 1);
-
-			Evaluator::interpolate_function(
-				mesh, problem.is_scalar(), bases, state.disc_orders,
-				state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), tmp, node_fun, opts.use_sampler, opts.boundary_only);
+			interpolate_volume(vis.interpolation, actual_dim, tmp, node_fun);
 		}
 
 		if (obstacle.n_vertices() > 0)
@@ -1351,10 +1344,8 @@ namespace polyfem::io
 		if (state.mixed_assembler != nullptr)
 		{
 			Eigen::MatrixXd interp_p;
-			Evaluator::interpolate_function(
-				mesh, 1, // FIXME: state.disc_orders should use pressure discr orders, works only with sampler
-				pressure_bases, state.disc_orders, state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), pressure, interp_p, opts.use_sampler, opts.boundary_only);
+			// FIXME: state.disc_orders should use pressure discr orders, works only with sampler
+			interpolate_volume(vis.pressure_interpolation, 1, pressure, interp_p);
 
 			if (obstacle.n_vertices() > 0)
 			{
@@ -1591,10 +1582,7 @@ namespace polyfem::io
 			Eigen::MatrixXd traction_forces, traction_forces_fun;
 			compute_traction_forces(state, sol, traction_forces, false);
 
-			Evaluator::interpolate_function(
-				mesh, problem.is_scalar(), bases, state.disc_orders,
-				state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), traction_forces, traction_forces_fun, opts.use_sampler, opts.boundary_only);
+			interpolate_volume(vis.interpolation, actual_dim, traction_forces, traction_forces_fun);
 
 			if (obstacle.n_vertices() > 0)
 			{
@@ -1610,10 +1598,7 @@ namespace polyfem::io
 			Eigen::MatrixXd potential_grad, potential_grad_fun;
 			state.assembler->assemble_gradient(mesh.is_volume(), state.n_bases, bases, gbases, state.ass_vals_cache, dt, sol, sol, potential_grad);
 
-			Evaluator::interpolate_function(
-				mesh, problem.is_scalar(), bases, state.disc_orders,
-				state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), potential_grad, potential_grad_fun, opts.use_sampler, opts.boundary_only);
+			interpolate_volume(vis.interpolation, actual_dim, potential_grad, potential_grad_fun);
 
 			if (obstacle.n_vertices() > 0)
 			{
@@ -1669,10 +1654,13 @@ namespace polyfem::io
 				}
 			}
 
-			if (elements.empty())
-				writer.write_mesh(path, points, tets);
-			else
-				writer.write_mesh(path, points, elements, true, disc_orders.maxCoeff() == 1);
+			write([tmpw, path, points = std::move(points), tets = std::move(tets), elements = std::move(elements),
+				   is_linear = disc_orders.maxCoeff() == 1]() {
+				if (elements.empty())
+					tmpw->write_mesh(path, points, tets);
+				else
+					tmpw->write_mesh(path, points, elements, true, is_linear);
+			});
 		}
 		else
 		{
@@ -1682,6 +1670,64 @@ namespace polyfem::io
 		}
 	}
 
+	const OutGeometryData::VolumeVisCache &OutGeometryData::volume_vis_cache(const State &state, const ExportOptions &opts) const
+	{
+		// the mesh and the bases invalidate the cache when they change (see invalidate_volume_vis_cache)
+		if (volume_vis_cache_.valid && volume_vis_cache_.use_sampler == opts.use_sampler && volume_vis_cache_.boundary_only == opts.boundary_only)
+			return volume_vis_cache_;
+
+		POLYFEM_SCOPED_TIMER("Building the visualization mesh");
+
+		const mesh::Mesh &mesh = *state.mesh;
+		VolumeVisCache &vis = volume_vis_cache_;
+		vis.elements.clear();
+		vis.tets.resize(0, 0);
+
+		if (opts.use_sampler)
+			build_vis_mesh(mesh, state.disc_orders, state.geom_bases(),
+						   state.polys, state.polys_3d, opts.boundary_only,
+						   vis.points, vis.tets, vis.el_id, vis.discr);
+		else
+			build_high_order_vis_mesh(mesh, state.disc_orders, state.bases(),
+									  vis.points, vis.elements, vis.el_id, vis.discr);
+
+		Evaluator::build_interpolation_matrix(
+			mesh, state.bases(), state.disc_orders,
+			state.polys, state.polys_3d, ref_element_sampler,
+			vis.points.rows(), state.n_bases - state.obstacle.n_vertices(), vis.interpolation,
+			opts.use_sampler, opts.boundary_only);
+
+		vis.pressure_interpolation.resize(0, 0);
+		if (state.mixed_assembler != nullptr)
+			Evaluator::build_interpolation_matrix(
+				mesh, state.pressure_bases(), state.disc_orders,
+				state.polys, state.polys_3d, ref_element_sampler,
+				vis.points.rows(), state.n_pressure_bases, vis.pressure_interpolation,
+				opts.use_sampler, opts.boundary_only);
+
+		vis.use_sampler = opts.use_sampler;
+		vis.boundary_only = opts.boundary_only;
+		vis.valid = true;
+
+		return vis;
+	}
+
+	void OutGeometryData::interpolate_volume(const StiffnessMatrix &interpolation, const int actual_dim, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result)
+	{
+		if (fun.size() <= 0)
+		{
+			logger().error("Solve the problem first!");
+			return;
+		}
+
+		// fun is flattened node by node, fun(node * actual_dim + d)
+		assert(fun.size() >= interpolation.cols() * actual_dim);
+		typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrixXd;
+		const Eigen::Map<const RowMajorMatrixXd> nodal(fun.data(), interpolation.cols(), actual_dim);
+
+		result = interpolation * nodal;
+	}
+
 	void OutGeometryData::save_volume_vector_field(
 		const State &state,
 		const Eigen::MatrixXd &points,
@@ -1691,10 +1737,9 @@ namespace polyfem::io
 		paraviewo::ParaviewWriter &writer) const
 	{
 		Eigen::MatrixXd inerpolated_field;
-		Evaluator::interpolate_function(
-			*state.mesh, state.problem->is_scalar(), state.bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			points.rows(), field, inerpolated_field, opts.use_sampler, opts.boundary_only);
+		interpolate_volume(
+			volume_vis_cache(state, opts).interpolation, state.problem->is_scalar() ? 1 : state.mesh->dimension(),
+			field, inerpolated_field);
 
 		if (state.obstacle.n_vertices() > 0)
 		{
@@ -1725,8 +1770,8 @@ namespace polyfem::io
 
 		const Eigen::VectorXi &disc_orders = state.disc_orders;
 		const auto &density = state.mass_matrix_assembler->density();
-		const std::vector<basis::ElementBases> &bases = state.bases;
-		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases;
+		const std::vector<basis::ElementBases> &bases = state.bases();
+		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases();
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const assembler::Assembler &assembler = *state.assembler;
 		const assembler::Problem &problem = *state.problem;
@@ -1754,6 +1799,10 @@ namespace polyfem::io
 		if (!problem.is_scalar())
 			actual_dim = mesh.dimension();
 
+		basis::ElementDofMap tmp_dof_map, tmp_pressure_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
+		const basis::ElementDofMap &pressure_dof_map = state.mixed_assembler != nullptr ? state.pressure_ass_vals_cache.dof_map(pressure_bases, tmp_pressure_dof_map) : tmp_pressure_dof_map;
+
 		discr.resize(boundary_vis_vertices.rows(), 1);
 		fun.resize(boundary_vis_vertices.rows(), actual_dim);
 		interp_p.resize(boundary_vis_vertices.rows(), 1);
@@ -1772,13 +1821,13 @@ namespace polyfem::io
 
 			const int el_index = boundary_vis_elements_ids(i);
 			Evaluator::interpolate_at_local_vals(
-				mesh, problem.is_scalar(), bases, gbases,
+				mesh, actual_dim, bases, dof_map, gbases,
 				el_index, boundary_vis_local_vertices.row(i), sol, lsol, lgrad);
 			assert(lsol.size() == actual_dim);
 			if (state.mixed_assembler != nullptr)
 			{
 				Evaluator::interpolate_at_local_vals(
-					mesh, 1, pressure_bases, gbases,
+					mesh, 1, pressure_bases, pressure_dof_map, gbases,
 					el_index, boundary_vis_local_vertices.row(i), pressure, lp, lpgrad);
 				assert(lp.size() == 1);
 				interp_p(i) = lp(0);
@@ -1901,7 +1950,9 @@ namespace polyfem::io
 			solution_frames.back().solution = fun;
 
 		if (opts.solve_export_to_file)
-			writer.write_mesh(export_surface, boundary_vis_vertices, boundary_vis_elements);
+			write([tmpw, export_surface, points = std::move(boundary_vis_vertices), elements = std::move(boundary_vis_elements)]() {
+				tmpw->write_mesh(export_surface, points, elements);
+			});
 		else
 		{
 			solution_frames.back().name = export_surface;
@@ -1993,10 +2044,11 @@ namespace polyfem::io
 			// Write the solution last so it is the default for warp-by-vector
 			writer.add_field("solution", surface_displacements);
 
-			writer.write_mesh(
-				export_surface.substr(0, export_surface.length() - 4) + "_contact.vtu",
-				collision_mesh.rest_positions(),
-				problem_dim == 3 ? collision_mesh.faces() : collision_mesh.edges());
+			write([tmpw, path = export_surface.substr(0, export_surface.length() - 4) + "_contact.vtu",
+				   points = Eigen::MatrixXd(collision_mesh.rest_positions()),
+				   elements = Eigen::MatrixXi(problem_dim == 3 ? collision_mesh.faces() : collision_mesh.edges())]() {
+				tmpw->write_mesh(path, points, elements);
+			});
 		}
 	}
 
@@ -2146,7 +2198,7 @@ namespace polyfem::io
 
 		Eigen::MatrixXd fun;
 		Evaluator::interpolate_function(
-			mesh, problem.is_scalar(), state.bases, state.disc_orders,
+			mesh, problem.is_scalar(), state.bases(), state.disc_orders,
 			state.polys, state.polys_3d, ref_element_sampler,
 			pts_index, sol, fun, /*use_sampler*/ true, false);
 
@@ -2175,7 +2227,7 @@ namespace polyfem::io
 		{
 			std::vector<assembler::Assembler::NamedMatrix> scalar_val;
 			Evaluator::compute_scalar_value(
-				mesh, problem.is_scalar(), state.bases, gbases,
+				mesh, problem.is_scalar(), state.bases(), gbases,
 				state.disc_orders, state.polys, state.polys_3d,
 				*state.assembler,
 				ref_element_sampler, pts_index, sol, scalar_val, /*use_sampler*/ true, false);
@@ -2185,7 +2237,9 @@ namespace polyfem::io
 		// Write the solution last so it is the default for warp-by-vector
 		writer.add_field("solution", fun);
 
-		writer.write_mesh(name, points, edges);
+		write([tmpw, name, points = std::move(points), edges = std::move(edges)]() {
+			tmpw->write_mesh(name, points, edges);
+		});
 	}
 
 	void OutGeometryData::save_points(
@@ -2240,7 +2294,9 @@ namespace polyfem::io
 			writer.add_field("sidesets", b_sidesets);
 			// Write the solution last so it is the default for warp-by-vector
 			writer.add_field("solution", fun);
-			writer.write_mesh(path, points, cells, false, false);
+			write([tmpw, path, points = std::move(points), cells = std::move(cells)]() {
+				tmpw->write_mesh(path, points, cells, false, false);
+			});
 		}
 	}
 
@@ -2249,12 +2305,21 @@ namespace polyfem::io
 		const std::function<std::string(int)> &vtu_names,
 		int time_steps, double t0, double dt, int skip_frame) const
 	{
-		paraviewo::PVDWriter::save_pvd(name, vtu_names, time_steps, t0, dt, skip_frame);
+		write([=]() { paraviewo::PVDWriter::save_pvd(name, vtu_names, time_steps, t0, dt, skip_frame); });
+	}
+
+	void OutGeometryData::write(AsyncWriter::Job &&job) const
+	{
+		if (async_writer_)
+			async_writer_->push(std::move(job));
+		else
+			job();
 	}
 
 	void OutGeometryData::init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area)
 	{
 		ref_element_sampler.init(mesh.is_volume(), mesh.n_elements(), vismesh_rel_area);
+		invalidate_volume_vis_cache();
 	}
 
 	void OutGeometryData::build_grid(const polyfem::mesh::Mesh &mesh, const double spacing)
@@ -2805,6 +2870,9 @@ namespace polyfem::io
 
 		j["peak_memory"] = getPeakRSS() / (1024 * 1024);
 
+		if (args["output"]["advanced"]["profile"])
+			j["profile"] = utils::Profiler::get().to_json();
+
 		const int actual_dim = problem.is_scalar() ? 1 : mesh.dimension();
 
 		std::vector<double> mmin(actual_dim);
@@ -12,6 +12,8 @@
 #include <paraviewo/VTUWriter.hpp>
 #include <paraviewo/HDF5VTUWriter.hpp>
 
+#include <polyfem/io/AsyncWriter.hpp>
+
 #include <polyfem/utils/RefElementSampler.hpp>
 
 #include <Eigen/Dense>
@@ -108,6 +110,9 @@ namespace polyfem::io
 		/// @param[in] vismesh_rel_area relative sampling size
 		void init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area);
 
+		/// @brief drops the visualization mesh of save_volume, to call whenever the mesh or the bases change
+		void invalidate_volume_vis_cache() { volume_vis_cache_ = VolumeVisCache(); }
+
 		/// @brief builds the grid to export the solution
 		/// @param[in] mesh mesh
 		/// @param[in] spacing grid spacing, <=0 mean no grid
@@ -260,7 +265,18 @@ namespace polyfem::io
 		void save_pvd(const std::string &name, const std::function<std::string(int)> &vtu_names,
 					  int time_steps, double t0, double dt, int skip_frame = 1) const;
 
+		/// sets the writer used to serialize the files, the fields are still evaluated by the caller
+		/// @param[in] writer background writer, nullptr writes synchronously
+		void set_async_writer(const std::shared_ptr<AsyncWriter> &writer) { async_writer_ = writer; }
+
 	private:
+		/// writer used to serialize the files, nullptr writes synchronously
+		std::shared_ptr<AsyncWriter> async_writer_;
+
+		/// runs job on the async writer if any, otherwise runs it directly
+		/// @param[in] job job writing the file(s), it must own all its data
+		void write(AsyncWriter::Job &&job) const;
+
 		/// used to sample the solution
 		utils::RefElementSampler ref_element_sampler;
 
@@ -352,6 +368,43 @@ namespace polyfem::io
 			const std::string &name,
 			const Eigen::VectorXd &field,
 			paraviewo::ParaviewWriter &writer) const;
+
+		/// @brief visualization mesh and interpolation operators of save_volume,
+		/// rebuilt only when the discretization, the geometry, or the sampling options change
+		struct VolumeVisCache
+		{
+			/// false once the mesh or the bases changed (see invalidate_volume_vis_cache)
+			bool valid = false;
+			/// options used to build the cache
+			bool use_sampler = false;
+			bool boundary_only = false;
+
+			Eigen::MatrixXd points;
+			Eigen::MatrixXi tets;
+			std::vector<std::vector<int>> elements;
+			Eigen::MatrixXi el_id;
+			Eigen::MatrixXd discr;
+
+			/// #points x #nodes operator from nodal values of the bases to the visualization points
+			StiffnessMatrix interpolation;
+			/// #points x #pressure nodes operator for the pressure bases (mixed formulations only)
+			StiffnessMatrix pressure_interpolation;
+		};
+
+		/// @brief returns the visualization mesh of save_volume, rebuilding it if needed
+		/// @param[in] state state to get the data
+		/// @param[in] opts export options
+		/// @return cached visualization mesh and interpolation operators
+		const VolumeVisCache &volume_vis_cache(const State &state, const ExportOptions &opts) const;
+
+		/// @brief interpolates nodal values at the visualization points (same as Evaluator::interpolate_function)
+		/// @param[in] interpolation interpolation operator
+		/// @param[in] actual_dim is the size of the problem (e.g., 1 for Laplace, dim for elasticity)
+		/// @param[in] fun nodal values, at least #nodes x actual_dim entries
+		/// @param[out] result #points x actual_dim values
+		static void interpolate_volume(const StiffnessMatrix &interpolation, const int actual_dim, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result);
+
+		mutable VolumeVisCache volume_vis_cache_;
 	};
 
 	/// @brief stores all runtime data
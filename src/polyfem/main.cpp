@@ -5,6 +5,10 @@
 #include <h5pp/h5pp.h>
 
 #include <polyfem/State.hpp>
+#include <polyfem/state/BatchRunner.hpp>
+
+#include <polyfem/io/BinaryMesh.hpp>
+#include <polyfem/io/MshReader.hpp>
 
 #include <polyfem/solver/AdjointNLProblem.hpp>
 #include <polyfem/solver/NonlinearSolver.hpp>
@@ -58,6 +62,16 @@ int optimization_simulation(const CLI::App &command_line,
 							const spdlog::level::level_enum &log_level,
 							json &opt_args);
 
+int batch_simulation(const CLI::App &command_line,
+					 const std::vector<std::string> &json_files,
+					 const std::string output_dir,
+					 const size_t max_threads,
+					 const bool is_strict,
+					 const bool fallback_solver,
+					 const spdlog::level::level_enum &log_level);
+
+int convert_mesh(const std::string &msh_file, const std::string &binary_file);
+
 int main(int argc, char **argv)
 {
 	using namespace polyfem;
@@ -74,9 +88,15 @@ int main(int argc, char **argv)
 	std::string json_file = "";
 	command_line.add_option("-j,--json", json_file, "Simulation JSON file")->check(CLI::ExistingFile);
 
+	std::vector<std::string> batch_files;
+	command_line.add_option("--batch", batch_files, "Simulation JSON files solved together on a shared thread pool")->check(CLI::ExistingFile);
+
 	std::string hdf5_file = "";
 	command_line.add_option("--hdf5", hdf5_file, "Simulation hdf5 file")->check(CLI::ExistingFile);
 
+	std::vector<std::string> convert_mesh_files;
+	command_line.add_option("--convert_mesh", convert_mesh_files, "Converts a MSH mesh to the binary mesh format (in.msh out.pfmesh)")->expected(2);
+
 	std::string output_dir = "";
 	command_line.add_option("-o,--output_dir", output_dir, "Directory for output files")->check(CLI::ExistingDirectory | CLI::NonexistentPath);
 
@@ -105,6 +125,13 @@ int main(int argc, char **argv)
 
 	CLI11_PARSE(command_line, argc, argv);
 
+	if (!convert_mesh_files.empty())
+		return convert_mesh(convert_mesh_files[0], convert_mesh_files[1]);
+
+	if (!batch_files.empty())
+		return batch_simulation(command_line, batch_files, output_dir, max_threads,
+								is_strict, fallback_solver, log_level);
+
 	json in_args = json({});
 
 	if (!json_file.empty())
@@ -126,6 +153,34 @@ int main(int argc, char **argv)
 								  is_strict, fallback_solver, log_level, in_args);
 }
 
+int convert_mesh(const std::string &msh_file, const std::string &binary_file)
+{
+	Eigen::MatrixXd vertices;
+	Eigen::MatrixXi cells;
+	std::vector<std::vector<int>> elements;
+	std::vector<std::vector<double>> weights;
+	std::vector<int> body_ids;
+	std::vector<std::string> node_data_name;
+	std::vector<std::vector<double>> node_data;
+
+	if (!io::MshReader::load(msh_file, vertices, cells, elements, weights, body_ids, node_data_name, node_data))
+	{
+		logger().error("Failed to load MSH mesh: {}", msh_file);
+		return EXIT_FAILURE;
+	}
+
+	// the node data of the MSH file are stored as fields
+	std::map<std::string, Eigen::MatrixXd> fields;
+	for (size_t i = 0; i < node_data_name.size(); ++i)
+		fields[node_data_name[i]] = Eigen::Map<const Eigen::VectorXd>(node_data[i].data(), node_data[i].size());
+
+	if (!io::BinaryMesh::write(binary_file, vertices, cells, elements, weights, body_ids, {}, fields))
+		return EXIT_FAILURE;
+
+	logger().info("Converted {} to {}", msh_file, binary_file);
+	return EXIT_SUCCESS;
+}
+
 int forward_simulation(const CLI::App &command_line,
 					   const std::string &hdf5_file,
 					   const std::string output_dir,
@@ -212,6 +267,53 @@ int forward_simulation(const CLI::App &command_line,
 	return EXIT_SUCCESS;
 }
 
+int batch_simulation(const CLI::App &command_line,
+					 const std::vector<std::string> &json_files,
+					 const std::string output_dir,
+					 const size_t max_threads,
+					 const bool is_strict,
+					 const bool fallback_solver,
+					 const spdlog::level::level_enum &log_level)
+{
+	BatchRunner runner(max_threads, log_level);
+
+	for (const std::string &json_file : json_files)
+	{
+		json in_args;
+		if (!load_json(json_file, in_args))
+			log_and_throw_error(fmt::format("unable to open {} file", json_file));
+
+		// the threads and the logger are set by the runner
+		json tmp = json::object();
+		// one output directory per run
+		if (has_arg(command_line, "output_dir"))
+			tmp["/output/directory"_json_pointer] = std::filesystem::absolute(std::filesystem::path(output_dir) / std::filesystem::path(json_file).stem());
+		if (has_arg(command_line, "enable_overwrite_solver"))
+			tmp["/solver/linear/enable_overwrite_solver"_json_pointer] = fallback_solver;
+		assert(tmp.is_object());
+		in_args.merge_patch(tmp);
+
+		runner.add(in_args, is_strict);
+	}
+
+	const int n_failed = runner.run([](State &state, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure) {
+		state.compute_errors(sol);
+
+		logger().info("total time: {}s", state.timings.total_time());
+
+		state.save_json(sol);
+		state.export_data(sol, pressure);
+	});
+
+	if (n_failed > 0)
+	{
+		logger().error("{}/{} simulations failed", n_failed, runner.size());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
 int optimization_simulation(const CLI::App &command_line,
 							const size_t max_threads,
 							const bool is_strict,
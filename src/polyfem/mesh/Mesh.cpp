@@ -7,6 +7,7 @@
 
 #include <polyfem/mesh/MeshUtils.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/io/BinaryMesh.hpp>
 #include <polyfem/io/MshReader.hpp>
 
 #include <polyfem/utils/Logger.hpp>
@@ -228,6 +229,47 @@ namespace polyfem::mesh
 
 			return mesh;
 		}
+		else if (StringUtils::endswith(lowername, ".pfmesh"))
+		{
+			Eigen::MatrixXd vertices;
+			Eigen::MatrixXi cells;
+			std::vector<std::vector<int>> elements;
+			std::vector<std::vector<double>> weights;
+			std::vector<int> body_ids, boundary_ids;
+
+			// mapped file, the arrays are copied once and nothing is parsed
+			if (!BinaryMesh::load(path, vertices, cells, elements, weights, body_ids, boundary_ids))
+			{
+				logger().error("Failed to load binary mesh: {}", path);
+				return nullptr;
+			}
+
+			const int dim = vertices.cols();
+			std::unique_ptr<Mesh> mesh = create(vertices, cells, non_conforming);
+
+			// same as MSH, only tris and tets have high-order nodes
+			if (!elements.empty() && ((dim == 2 && cells.cols() == 3) || (dim == 3 && cells.cols() == 4)))
+				mesh->attach_higher_order_nodes(vertices, elements);
+			if (!weights.empty())
+			{
+				mesh->set_cell_weights(weights);
+				for (const auto &w : weights)
+				{
+					if (!w.empty())
+					{
+						mesh->set_is_rational(true);
+						break;
+					}
+				}
+			}
+
+			if (!body_ids.empty())
+				mesh->set_body_ids(body_ids);
+			if (!boundary_ids.empty())
+				mesh->set_boundary_ids(boundary_ids);
+
+			return mesh;
+		}
 		else
 		{
 			GEO::Mesh tmp;
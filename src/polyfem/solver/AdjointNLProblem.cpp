@@ -102,6 +102,21 @@ namespace polyfem::solver
 		return composite_form_->is_step_valid(x0, x1);
 	}
 
+	double AdjointNLProblem::value_and_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv)
+	{
+		// the gradient requires the adjoint solves, there is nothing to share with the value
+		const double val = value(x);
+		gradient(x, gradv);
+		return val;
+	}
+
+	double AdjointNLProblem::value_with_validity(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1, bool &valid)
+	{
+		const double val = value(x1);
+		valid = is_step_valid(x0, x1);
+		return val;
+	}
+
 	bool AdjointNLProblem::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
 		return composite_form_->is_step_collision_free(x0, x1);
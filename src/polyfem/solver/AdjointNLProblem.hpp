@@ -27,6 +27,8 @@ namespace polyfem::solver
 		void hessian(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
 		void save_to_file(const Eigen::VectorXd &x0) override;
 		bool is_step_valid(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
+		double value_and_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) override;
+		double value_with_validity(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1, bool &valid) override;
 		bool is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
 		double max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
 
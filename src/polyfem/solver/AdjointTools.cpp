@@ -162,8 +162,10 @@ namespace polyfem::solver
 		Eigen::VectorXd &one_form)
 	{
 		const int dim = state.mesh->dimension();
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
 		const auto &gbases = state.geom_bases();
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
 
 		one_form.setZero(dim * dim);
 		auto storage = utils::create_thread_storage(LocalThreadVecStorage(one_form.size()));
@@ -182,7 +184,7 @@ namespace polyfem::solver
 				state.assembler->compute_stiffness_value(vals, quadrature.points, sol, stiffnesses);
 				stiffnesses.array().colwise() *= local_storage.da.array();
 
-				io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
+				io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, adjoint, p, grad_p);
 
 				for (int a = 0; a < dim; a++)
 					for (int b = 0; b < dim; b++)
@@ -205,8 +207,10 @@ namespace polyfem::solver
 		const SpatialIntegralType spatial_integral_type,
 		const int cur_step) // current time step
 	{
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
 		const auto &gbases = state.geom_bases();
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
 
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
@@ -235,7 +239,7 @@ namespace polyfem::solver
 
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
@@ -282,7 +286,7 @@ namespace polyfem::solver
 
 						assembler::ElementAssemblyValues &vals = local_storage.vals;
 						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
-						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 						// normal = normal * vals.jac_it[0]; // assuming linear geometry
 
@@ -340,7 +344,9 @@ namespace polyfem::solver
 		const int cur_time_step)
 	{
 		const auto &gbases = state.geom_bases();
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
 
@@ -377,7 +383,7 @@ namespace polyfem::solver
 
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, state.mesh->is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
@@ -575,7 +581,9 @@ namespace polyfem::solver
 		const int cur_time_step)
 	{
 		const auto &gbases = state.geom_bases();
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
 
@@ -604,7 +612,7 @@ namespace polyfem::solver
 
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					state.ass_vals_cache.compute(e, state.mesh->is_volume(), bases[e], gbases[e], vals);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
@@ -685,7 +693,7 @@ namespace polyfem::solver
 			cur_nu(state.boundary_nodes).setZero();
 
 			{
-				state.solve_data.inertia_form->force_shape_derivative(state.mesh->is_volume(), state.n_geom_bases, state.bases, state.geom_bases(), *(state.mass_matrix_assembler), state.mass_ass_vals_cache, velocity, cur_nu, mass_term);
+				state.solve_data.inertia_form->force_shape_derivative(state.mesh->is_volume(), state.n_geom_bases, state.bases(), state.geom_bases(), *(state.mass_matrix_assembler), state.mass_ass_vals_cache, velocity, cur_nu, mass_term);
 				state.solve_data.elastic_form->force_shape_derivative(state.n_geom_bases, state.diff_cached.u(i), state.diff_cached.u(i), cur_p, elasticity_term);
 				state.solve_data.body_form->force_shape_derivative(state.n_geom_bases, t0 + i * dt, state.diff_cached.u(i - 1), cur_p, rhs_term);
 
@@ -728,7 +736,7 @@ namespace polyfem::solver
 			}
 		}
 		sum_alpha_p(state.boundary_nodes).setZero();
-		state.solve_data.inertia_form->force_shape_derivative(state.mesh->is_volume(), state.n_geom_bases, state.bases, state.geom_bases(), *(state.mass_matrix_assembler), state.mass_ass_vals_cache, state.diff_cached.v(0), sum_alpha_p, mass_term);
+		state.solve_data.inertia_form->force_shape_derivative(state.mesh->is_volume(), state.n_geom_bases, state.bases(), state.geom_bases(), *(state.mass_matrix_assembler), state.mass_ass_vals_cache, state.diff_cached.v(0), sum_alpha_p, mass_term);
 
 		one_form += mass_term;
 
@@ -754,7 +762,7 @@ namespace polyfem::solver
 		const int time_steps = state.args["time"]["time_steps"];
 		const int bdf_order = get_bdf_order(state);
 
-		one_form.setZero(state.bases.size() * 2);
+		one_form.setZero(state.bases().size() * 2);
 
 		auto storage = utils::create_thread_storage(LocalThreadVecStorage(one_form.size()));
 
@@ -916,8 +924,10 @@ namespace polyfem::solver
 		const int cur_step,
 		Eigen::VectorXd &term)
 	{
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
 		const auto &gbases = state.geom_bases();
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
 
 		const int dim = state.mesh->dimension();
 		const int actual_dim = state.problem->is_scalar() ? 1 : dim;
@@ -956,7 +966,7 @@ namespace polyfem::solver
 
 					const int n_loc_bases_ = int(vals.basis_values.size());
 
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 					params["elem"] = e;
 					params["body_id"] = state.mesh->get_body_id(e);
@@ -1038,7 +1048,7 @@ namespace polyfem::solver
 
 						assembler::ElementAssemblyValues &vals = local_storage.vals;
 						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
-						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, solution, u, grad_u);
+						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, solution, u, grad_u);
 
 						// normal = normal * vals.jac_it[0]; // assuming linear geometry
 
@@ -0,0 +1,171 @@
+#include "CompositeHessian.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/Timer.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace polyfem::solver
+{
+	void CompositeHessian::set_removed_dofs(const int full_size, const std::vector<int> &removed_dofs)
+	{
+		if (full_size == full_size_ && removed_dofs == removed_dofs_)
+			return;
+
+		assert(std::is_sorted(removed_dofs.begin(), removed_dofs.end()));
+
+		full_size_ = full_size;
+		removed_dofs_ = removed_dofs;
+
+		indices_.resize(full_size);
+		int index = 0;
+		size_t k = 0;
+		for (int i = 0; i < full_size; ++i)
+		{
+			if (k < removed_dofs.size() && removed_dofs[k] == i)
+			{
+				++k;
+				indices_[i] = -1;
+			}
+			else
+				indices_[i] = index++;
+		}
+
+		// the maps are not valid anymore
+		pattern_.resize(0, 0);
+		terms_.clear();
+	}
+
+	void CompositeHessian::assemble(std::vector<StiffnessMatrix> &terms, StiffnessMatrix &result)
+	{
+		assert(full_size_ >= 0);
+		const int size = full_size_ - removed_dofs_.size();
+
+		bool build = terms.size() != terms_.size() || pattern_.rows() != size;
+		for (int i = 0; i < terms.size(); ++i)
+		{
+			StiffnessMatrix &term = terms[i];
+			assert(term.size() == 0 || (term.rows() == full_size_ && term.cols() == full_size_));
+			term.makeCompressed();
+
+			if (build || utils::has_sparsity_pattern(term, full_size_, terms_[i].outer, terms_[i].inner))
+				continue;
+
+			// the pattern of the term changed (e.g., new contact constraints), rebuild the union only if needed
+			if (!map_term(term, terms_[i]))
+				build = true;
+		}
+
+		if (build)
+			build_pattern(terms);
+
+		if (!same_pattern(result, pattern_))
+			result = pattern_;
+
+		{
+			POLYFEM_SCOPED_TIMER("accumulate hessians");
+
+			double *values = result.valuePtr();
+			std::fill(values, values + result.nonZeros(), 0.0);
+
+			for (int i = 0; i < terms.size(); ++i)
+			{
+				const double *term_values = terms[i].valuePtr();
+				const std::vector<long> &map = terms_[i].map;
+				assert(map.size() == terms[i].nonZeros());
+
+				for (long k = 0; k < map.size(); ++k)
+				{
+					if (map[k] >= 0)
+						values[map[k]] += term_values[k];
+				}
+			}
+		}
+	}
+
+	bool CompositeHessian::map_term(const StiffnessMatrix &term, Term &mapping) const
+	{
+		const StorageIndex *outer = term.outerIndexPtr();
+		const StorageIndex *inner = term.innerIndexPtr();
+		const StorageIndex *pattern_outer = pattern_.outerIndexPtr();
+		const StorageIndex *pattern_inner = pattern_.innerIndexPtr();
+
+		mapping.map.resize(term.nonZeros());
+		for (int c = 0; c < term.outerSize(); ++c)
+		{
+			const int rc = indices_[c];
+			for (StorageIndex k = outer[c]; k < outer[c + 1]; ++k)
+			{
+				const int rr = indices_[inner[k]];
+				if (rc < 0 || rr < 0)
+				{
+					mapping.map[k] = -1;
+					continue;
+				}
+
+				const StorageIndex *begin = pattern_inner + pattern_outer[rc];
+				const StorageIndex *end = pattern_inner + pattern_outer[rc + 1];
+				const StorageIndex *it = std::lower_bound(begin, end, StorageIndex(rr));
+				if (it == end || *it != rr)
+					return false;
+
+				mapping.map[k] = it - pattern_inner;
+			}
+		}
+
+		mapping.outer.assign(outer, outer + term.outerSize() + 1);
+		mapping.inner.assign(inner, inner + term.nonZeros());
+		return true;
+	}
+
+	void CompositeHessian::build_pattern(const std::vector<StiffnessMatrix> &terms)
+	{
+		POLYFEM_SCOPED_TIMER("build hessian pattern");
+
+		const int size = full_size_ - removed_dofs_.size();
+
+		long n_entries = 0;
+		for (const StiffnessMatrix &term : terms)
+			n_entries += term.nonZeros();
+
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(n_entries);
+		for (const StiffnessMatrix &term : terms)
+		{
+			for (int c = 0; c < term.outerSize(); ++c)
+			{
+				if (indices_[c] < 0)
+					continue;
+
+				for (StiffnessMatrix::InnerIterator it(term, c); it; ++it)
+				{
+					if (indices_[it.row()] >= 0)
+						entries.emplace_back(indices_[it.row()], indices_[c], 0.0);
+				}
+			}
+		}
+
+		pattern_.resize(size, size);
+		pattern_.setFromTriplets(entries.begin(), entries.end());
+		pattern_.makeCompressed();
+		++n_pattern_builds_;
+
+		terms_.resize(terms.size());
+		for (int i = 0; i < terms.size(); ++i)
+		{
+			if (!map_term(terms[i], terms_[i]))
+				log_and_throw_error("Hessian term {} is not contained in the union pattern!", i);
+		}
+	}
+
+	bool CompositeHessian::same_pattern(const StiffnessMatrix &a, const StiffnessMatrix &b)
+	{
+		return a.rows() == b.rows() && a.cols() == b.cols()
+			   && a.isCompressed() && b.isCompressed()
+			   && a.nonZeros() == b.nonZeros()
+			   && std::equal(a.outerIndexPtr(), a.outerIndexPtr() + a.outerSize() + 1, b.outerIndexPtr())
+			   && std::equal(a.innerIndexPtr(), a.innerIndexPtr() + a.nonZeros(), b.innerIndexPtr());
+	}
+} // namespace polyfem::solver
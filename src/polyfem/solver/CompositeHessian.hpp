@@ -0,0 +1,54 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <vector>
+
+namespace polyfem::solver
+{
+	/// @brief Sums sparse matrices (e.g., the Hessians of the forms) into the union of their sparsity patterns.
+	///
+	/// The union pattern and the map of every entry of every term into it are kept between calls.
+	/// When the pattern of a term does not change (or still fits in the union) only the values are accumulated,
+	/// without allocating or merging patterns. Rows and columns can be removed on the fly (e.g., Dirichlet dofs).
+	class CompositeHessian
+	{
+	public:
+		/// @brief Set the rows and columns removed from the sum
+		/// @param full_size Size of the terms
+		/// @param removed_dofs Sorted dofs removed from the result, which has size full_size - removed_dofs.size()
+		void set_removed_dofs(const int full_size, const std::vector<int> &removed_dofs);
+
+		/// @brief Sum the terms into result
+		/// @param terms Matrices of size full_size x full_size, compressed if they are not
+		/// @param result Sum of the terms without the removed rows and columns, its storage is reused if it has the union pattern
+		void assemble(std::vector<StiffnessMatrix> &terms, StiffnessMatrix &result);
+
+		/// @brief Number of times the union pattern has been built
+		int n_pattern_builds() const { return n_pattern_builds_; }
+
+	private:
+		typedef StiffnessMatrix::StorageIndex StorageIndex;
+
+		struct Term
+		{
+			std::vector<StorageIndex> outer; ///< Column pointers of the term when mapped
+			std::vector<StorageIndex> inner; ///< Row indices of the term when mapped
+			std::vector<long> map;           ///< Position of each entry of the term in the union, -1 if removed
+		};
+
+		/// @brief Map the entries of term into the current union, false if one of them is missing
+		bool map_term(const StiffnessMatrix &term, Term &mapping) const;
+		void build_pattern(const std::vector<StiffnessMatrix> &terms);
+
+		static bool same_pattern(const StiffnessMatrix &a, const StiffnessMatrix &b);
+
+		int full_size_ = -1;
+		std::vector<int> removed_dofs_;
+		std::vector<int> indices_; ///< Full to result index, -1 if removed
+
+		StiffnessMatrix pattern_; ///< Union pattern (values are not used)
+		std::vector<Term> terms_;
+		int n_pattern_builds_ = 0;
+	};
+} // namespace polyfem::solver
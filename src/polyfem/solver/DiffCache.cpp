@@ -0,0 +1,183 @@
+#include "DiffCache.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#endif
+
+namespace polyfem::solver
+{
+    namespace
+    {
+        typedef StiffnessMatrix::StorageIndex StorageIndex;
+
+        void write_jacobian(const std::string &path, const StiffnessMatrix &mat)
+        {
+            std::ofstream file(path, std::ios::binary);
+            if (!file.good())
+                log_and_throw_error("Unable to write the adjoint Jacobian to {}!", path);
+
+            const int64_t header[3] = {mat.rows(), mat.cols(), mat.nonZeros()};
+            file.write(reinterpret_cast<const char *>(header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(mat.outerIndexPtr()), sizeof(StorageIndex) * (mat.outerSize() + 1));
+            file.write(reinterpret_cast<const char *>(mat.innerIndexPtr()), sizeof(StorageIndex) * mat.nonZeros());
+            file.write(reinterpret_cast<const char *>(mat.valuePtr()), sizeof(double) * mat.nonZeros());
+
+            if (!file.good())
+                log_and_throw_error("Unable to write the adjoint Jacobian to {}!", path);
+        }
+
+        void read_jacobian(const std::string &path, StiffnessMatrix &mat)
+        {
+            std::ifstream file(path, std::ios::binary);
+            int64_t header[3];
+            file.read(reinterpret_cast<char *>(header), sizeof(header));
+            if (!file.good())
+                log_and_throw_error("Unable to read the adjoint Jacobian from {}!", path);
+
+            mat.resize(header[0], header[1]);
+            mat.resizeNonZeros(header[2]);
+            file.read(reinterpret_cast<char *>(mat.outerIndexPtr()), sizeof(StorageIndex) * (mat.outerSize() + 1));
+            file.read(reinterpret_cast<char *>(mat.innerIndexPtr()), sizeof(StorageIndex) * header[2]);
+            file.read(reinterpret_cast<char *>(mat.valuePtr()), sizeof(double) * header[2]);
+
+            if (!file.good())
+                log_and_throw_error("Unable to read the adjoint Jacobian from {}!", path);
+        }
+
+        long process_id()
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            return static_cast<long>(getpid());
+#elif defined(_WIN32)
+            return static_cast<long>(_getpid());
+#else
+            return 0;
+#endif
+        }
+    } // namespace
+
+    DiffCache::JacobianFiles::JacobianFiles(JacobianFiles &&other) noexcept
+        : dir_(std::move(other.dir_)), paths_(std::move(other.paths_))
+    {
+        other.dir_.clear();
+        other.paths_.clear();
+    }
+
+    DiffCache::JacobianFiles &DiffCache::JacobianFiles::operator=(JacobianFiles &&other) noexcept
+    {
+        if (this != &other)
+        {
+            remove();
+            dir_ = std::move(other.dir_);
+            paths_ = std::move(other.paths_);
+            other.dir_.clear();
+            other.paths_.clear();
+        }
+        return *this;
+    }
+
+    void DiffCache::JacobianFiles::reset(const int n)
+    {
+        remove();
+        paths_.assign(n, "");
+    }
+
+    void DiffCache::JacobianFiles::write(const int step, const std::string &parent_dir, const StiffnessMatrix &mat)
+    {
+        assert(step < paths_.size());
+        if (dir_.empty())
+        {
+            // unique between the caches of a process and between processes sharing the directory
+            static std::atomic<int> counter(0);
+            const std::filesystem::path parent = parent_dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(parent_dir);
+            const std::filesystem::path dir = parent / fmt::format("polyfem_adjoint_{}_{}", process_id(), counter++);
+            std::filesystem::create_directories(dir);
+            dir_ = dir.string();
+        }
+
+        const std::string path = (std::filesystem::path(dir_) / fmt::format("gradu_h_{}.bin", step)).string();
+        write_jacobian(path, mat);
+        paths_[step] = path;
+    }
+
+    const std::string &DiffCache::JacobianFiles::path(const int step) const
+    {
+        static const std::string empty;
+        return step < paths_.size() ? paths_[step] : empty;
+    }
+
+    int DiffCache::JacobianFiles::count() const
+    {
+        return std::count_if(paths_.begin(), paths_.end(), [](const std::string &path) { return !path.empty(); });
+    }
+
+    void DiffCache::JacobianFiles::remove()
+    {
+        std::error_code ec;
+        for (std::string &path : paths_)
+        {
+            if (path.empty())
+                continue;
+            std::filesystem::remove(path, ec);
+            path.clear();
+        }
+
+        if (!dir_.empty())
+        {
+            std::filesystem::remove(dir_, ec);
+            dir_.clear();
+        }
+    }
+
+    const StiffnessMatrix &DiffCache::gradu_h(const int step) const
+    {
+        assert(step < size());
+        const std::string &path = gradu_h_files_.path(step);
+        if (path.empty())
+            return gradu_h_[step];
+
+        if (loaded_step_ != step)
+        {
+            read_jacobian(path, loaded_gradu_h_);
+            loaded_step_ = step;
+        }
+        return loaded_gradu_h_;
+    }
+
+    int DiffCache::n_jacobians_on_disk() const
+    {
+        return gradu_h_files_.count();
+    }
+
+    void DiffCache::store_jacobian(const int step, const StiffnessMatrix &gradu_h)
+    {
+        StiffnessMatrix &stored = gradu_h_[step];
+        stored = gradu_h;
+        stored.makeCompressed();
+
+        const double memory = stored.nonZeros() * (sizeof(double) + sizeof(StorageIndex)) + (stored.outerSize() + 1) * sizeof(StorageIndex);
+        if (max_jacobian_memory_ < 0 || jacobian_memory_ + memory <= max_jacobian_memory_)
+        {
+            jacobian_memory_ += memory;
+            return;
+        }
+
+        // over budget: the jacobian is read back during the backward sweep
+        gradu_h_files_.write(step, jacobian_dir_, stored);
+        stored.resize(0, 0);
+        stored.data().squeeze();
+
+        if (loaded_step_ == step)
+            loaded_step_ = -1;
+    }
+} // namespace polyfem::solver
@@ -1,18 +1,37 @@
 #pragma once
 
 #include <polyfem/Common.hpp>
+#include <polyfem/utils/Types.hpp>
 
 #include <ipc/ipc.hpp>
 
+#include <string>
+#include <vector>
+
 namespace polyfem::solver
 {
     class DiffCache
     {
     public:
-        void init(const int ndof, const int n_time_steps = 0)
+        DiffCache() = default;
+        DiffCache(const DiffCache &) = delete;
+        DiffCache &operator=(const DiffCache &) = delete;
+        DiffCache(DiffCache &&) = default;
+        DiffCache &operator=(DiffCache &&) = default;
+
+        /// @param max_jacobian_memory maximum memory (in bytes) used by the Jacobians of a transient simulation, negative for no limit
+        /// @param jacobian_dir directory where the Jacobians exceeding max_jacobian_memory are written (system temporary directory if empty)
+        void init(const int ndof, const int n_time_steps = 0, const double max_jacobian_memory = -1, const std::string &jacobian_dir = "")
         {
             cur_size_ = 0;
             n_time_steps_ = n_time_steps;
+
+            max_jacobian_memory_ = max_jacobian_memory;
+            jacobian_dir_ = jacobian_dir;
+            jacobian_memory_ = 0;
+            gradu_h_files_.reset(n_time_steps + 1);
+            loaded_step_ = -1;
+            loaded_gradu_h_.resize(0, 0);
             
             u_.setZero(ndof, n_time_steps + 1);
             if (n_time_steps_ > 0)
@@ -60,7 +79,7 @@ namespace polyfem::solver
             v_.col(cur_step) = v;
             acc_.col(cur_step) = acc;
 
-            gradu_h_[cur_step] = gradu_h;
+            store_jacobian(cur_step, gradu_h);
             // gradu_h_prev_[cur_step] = gradu_h_prev;
 
             contact_set_[cur_step] = contact_set;
@@ -82,13 +101,46 @@ namespace polyfem::solver
         void cache_disp_grad(const Eigen::MatrixXd &disp_grad) { disp_grad_ = disp_grad; }
         Eigen::MatrixXd disp_grad() const { assert(disp_grad_.size() > 0); return disp_grad_; }
 
-        const StiffnessMatrix &gradu_h(const int step) const { assert(step < size()); return gradu_h_[step]; }
+        /// @brief Jacobian of step, read back from disk if it exceeded the memory budget (valid until the next call)
+        const StiffnessMatrix &gradu_h(const int step) const;
+
+        /// @brief Number of Jacobians written to disk
+        int n_jacobians_on_disk() const;
         // const StiffnessMatrix &gradu_h_prev(const int step) const { assert(step < size()); return gradu_h_prev_[step]; }
 
         const ipc::CollisionConstraints &contact_set(const int step) const { assert(step < size()); return contact_set_[step]; }
         const ipc::FrictionConstraints &friction_constraint_set(const int step) const { assert(step < size()); return friction_constraint_set_[step]; }
 
     private:
+        /// @brief Files of the Jacobians written to disk, in a directory unique to the owner (process id and counter).
+        /// They are removed with the owner, also when it is reset or overwritten by a move.
+        class JacobianFiles
+        {
+        public:
+            JacobianFiles() = default;
+            JacobianFiles(const JacobianFiles &) = delete;
+            JacobianFiles &operator=(const JacobianFiles &) = delete;
+            JacobianFiles(JacobianFiles &&other) noexcept;
+            JacobianFiles &operator=(JacobianFiles &&other) noexcept;
+            ~JacobianFiles() { remove(); }
+
+            /// @brief Removes the files and makes room for n steps
+            void reset(const int n);
+            /// @brief Writes the Jacobian of step in a subdirectory of parent_dir (created on the first write)
+            void write(const int step, const std::string &parent_dir, const StiffnessMatrix &mat);
+            /// @brief Path of the Jacobian of step, empty if it is in memory
+            const std::string &path(const int step) const;
+            int count() const;
+
+        private:
+            void remove();
+
+            std::string dir_;
+            std::vector<std::string> paths_;
+        };
+
+        /// @brief Keep the Jacobian of step in memory if it fits in the budget, otherwise write it to disk
+        void store_jacobian(const int step, const StiffnessMatrix &gradu_h);
 
         int n_time_steps_ = 0;
         int cur_size_ = 0;
@@ -102,6 +154,12 @@ namespace polyfem::solver
         Eigen::VectorXi bdf_order_; // BDF orders used at each time step in forward simulation
         
         std::vector<StiffnessMatrix> gradu_h_; // gradient of force at time T wrt. u  at time T
+        JacobianFiles gradu_h_files_; // files of the jacobians not kept in memory
+        double max_jacobian_memory_ = -1;
+        double jacobian_memory_ = 0;
+        std::string jacobian_dir_;
+        mutable StiffnessMatrix loaded_gradu_h_; // last jacobian read from disk, the backward sweep uses each step twice in a row
+        mutable int loaded_step_ = -1;
         // std::vector<StiffnessMatrix> gradu_h_prev_; // gradient of force at time T wrt. u at time (T-1) in transient simulations
 
         std::vector<ipc::CollisionConstraints> contact_set_;
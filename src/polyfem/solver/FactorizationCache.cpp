@@ -0,0 +1,45 @@
+#include "FactorizationCache.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <polysolve/FEMSolver.hpp>
+
+#include <cassert>
+
+namespace polyfem::solver
+{
+	FactorizationCache::FactorizationCache(const int precond_num, const std::string &save_path)
+		: precond_num_(precond_num), save_path_(save_path)
+	{
+	}
+
+	bool FactorizationCache::update(
+		polysolve::LinearSolver &solver,
+		const double coeff,
+		const std::vector<int> &boundary_nodes,
+		const std::function<void(StiffnessMatrix &)> &build_matrix)
+	{
+		if (solver_ == &solver && coeff == coeff_ && boundary_nodes == boundary_nodes_)
+			return false;
+
+		logger().debug("Factorizing the system matrix (coefficient {})", coeff);
+
+		build_matrix(A_);
+		// prefactorize replaces the Dirichlet rows, the original matrix is needed by the solves
+		StiffnessMatrix A = A_;
+		polysolve::prefactorize(solver, A, boundary_nodes, precond_num_, save_path_);
+
+		solver_ = &solver;
+		coeff_ = coeff;
+		boundary_nodes_ = boundary_nodes;
+		++n_factorizations_;
+
+		return true;
+	}
+
+	void FactorizationCache::solve(polysolve::LinearSolver &solver, const Eigen::VectorXd &b, Eigen::VectorXd &x) const
+	{
+		assert(solver_ == &solver);
+		polysolve::dirichlet_solve_prefactorized(solver, A_, b, boundary_nodes_, x);
+	}
+} // namespace polyfem::solver
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <polyfem/utils/Types.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace polysolve
+{
+	class LinearSolver;
+} // namespace polysolve
+
+namespace polyfem::solver
+{
+	/// @brief Factorization of a linear system with Dirichlet nodes whose matrix only depends on a scalar coefficient
+	/// (e.g., the time integrator coefficient, which changes with dt or while the BDF order ramps up).
+	///
+	/// The system is only refactorized when the coefficient, the Dirichlet nodes, or the solver change.
+	class FactorizationCache
+	{
+	public:
+		/// @param precond_num number of dofs passed to the solver analysis
+		/// @param save_path path where the factorized matrix is saved, nothing is saved if empty
+		FactorizationCache(const int precond_num, const std::string &save_path = "");
+
+		/// @brief Factorizes the system with the solver unless it already holds it
+		/// @param solver linear solver, it must not factorize another system between the calls (see invalidate)
+		/// @param coeff coefficient the system matrix depends on
+		/// @param boundary_nodes Dirichlet nodes
+		/// @param build_matrix builds the system matrix of coeff, only called when refactorizing
+		/// @return true if the system has been factorized
+		bool update(
+			polysolve::LinearSolver &solver,
+			const double coeff,
+			const std::vector<int> &boundary_nodes,
+			const std::function<void(StiffnessMatrix &)> &build_matrix);
+
+		/// @brief Solves the factorized system, the Dirichlet values are the entries of b at the boundary nodes
+		/// @param solver linear solver passed to the last update
+		/// @param b right hand side
+		/// @param x solution
+		void solve(polysolve::LinearSolver &solver, const Eigen::VectorXd &b, Eigen::VectorXd &x) const;
+
+		/// System matrix of the factorization, without the Dirichlet rows replaced
+		const StiffnessMatrix &matrix() const { return A_; }
+
+		/// Forgets the factorization, e.g., when the solver has factorized another system
+		void invalidate() { solver_ = nullptr; }
+
+		/// Number of factorizations done by update
+		int n_factorizations() const { return n_factorizations_; }
+
+	private:
+		const int precond_num_;
+		const std::string save_path_;
+
+		const polysolve::LinearSolver *solver_ = nullptr;
+		double coeff_ = 0;
+		std::vector<int> boundary_nodes_;
+		StiffnessMatrix A_;
+
+		int n_factorizations_ = 0;
+	};
+} // namespace polyfem::solver
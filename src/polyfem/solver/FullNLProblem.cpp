@@ -106,16 +106,90 @@ namespace polyfem::solver
 		}
 	}
 
+	double FullNLProblem::value_and_gradient(const TVector &x, TVector &grad)
+	{
+		double val = 0;
+		grad = TVector::Zero(x.size());
+		TVector tmp;
+		for (auto &f : forms_)
+		{
+			if (!f->enabled())
+				continue;
+			val += f->value_and_gradient(x, tmp);
+			grad += tmp;
+		}
+		return val;
+	}
+
+	double FullNLProblem::value_with_validity(const TVector &x0, const TVector &x1, bool &valid)
+	{
+		double val = 0;
+		valid = true;
+		for (auto &f : forms_)
+		{
+			if (!f->enabled())
+				continue;
+			bool form_valid;
+			val += f->value_with_validity(x0, x1, form_valid);
+			valid = valid && form_valid;
+		}
+		return val;
+	}
+
 	void FullNLProblem::hessian(const TVector &x, THessian &hessian)
 	{
-		hessian.resize(x.size(), x.size());
+		full_hessian_.set_removed_dofs(x.size(), std::vector<int>());
+		assemble_hessian(x, full_hessian_, hessian);
+	}
+
+	void FullNLProblem::assemble_hessian(const TVector &x, CompositeHessian &assembler, THessian &hessian)
+	{
+		// one term per form so that the sparsity patterns are compared to the ones of the same form
+		form_hessians_.resize(forms_.size());
+		for (int i = 0; i < forms_.size(); ++i)
+		{
+			if (forms_[i]->enabled())
+				forms_[i]->second_derivative(x, form_hessians_[i]);
+			else
+				form_hessians_[i].resize(0, 0);
+		}
+
+		assembler.assemble(form_hessians_, hessian);
+	}
+
+	void FullNLProblem::init_hessian_vector_product(const TVector &x)
+	{
+		for (auto &f : forms_)
+			if (f->enabled())
+				f->init_second_derivative_vector_product(x);
+	}
+
+	void FullNLProblem::hessian_vector_product(const TVector &v, TVector &hv)
+	{
+		hv = TVector::Zero(v.size());
+		for (auto &f : forms_)
+		{
+			if (!f->enabled())
+				continue;
+			TVector tmp;
+			f->second_derivative_vector_product(v, tmp);
+			hv += tmp;
+		}
+	}
+
+	void FullNLProblem::hessian_block_diagonal(THessian &diag)
+	{
+		diag.resize(0, 0);
 		for (auto &f : forms_)
 		{
 			if (!f->enabled())
 				continue;
 			THessian tmp;
-			f->second_derivative(x, tmp);
-			hessian += tmp;
+			f->second_derivative_block_diagonal(tmp);
+			if (diag.size() == 0)
+				diag = tmp;
+			else
+				diag += tmp;
 		}
 	}
 
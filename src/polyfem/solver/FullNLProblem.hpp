@@ -1,5 +1,6 @@
 #pragma once
 
+#include <polyfem/solver/CompositeHessian.hpp>
 #include <polyfem/solver/forms/Form.hpp>
 
 #include <cppoptlib/problem.h>
@@ -26,6 +27,18 @@ namespace polyfem::solver
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian);
 
+		/// @brief Compute the value and the gradient at x, sharing the work between both in the forms
+		virtual double value_and_gradient(const TVector &x, TVector &gradv);
+		/// @brief Compute the value at x1 and if the step from x0 to x1 is valid, sharing the work between both in the forms
+		virtual double value_with_validity(const TVector &x0, const TVector &x1, bool &valid);
+
+		/// @brief Prepare the products of the Hessian at x with vectors (matrix-free when supported by the forms)
+		virtual void init_hessian_vector_product(const TVector &x);
+		/// @brief Compute the product of the Hessian (at the x given to init_hessian_vector_product) with v
+		virtual void hessian_vector_product(const TVector &v, TVector &hv);
+		/// @brief Compute the block diagonal of the Hessian (at the x given to init_hessian_vector_product)
+		virtual void hessian_block_diagonal(THessian &diag);
+
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) const;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1) const;
 		virtual double max_step_size(const TVector &x0, const TVector &x1) const;
@@ -49,6 +62,13 @@ namespace polyfem::solver
 		virtual bool stop(const TVector &x) { return false; }
 
 	protected:
+		/// @brief Sum the Hessians of the enabled forms with the given assembler (which may remove rows and columns)
+		void assemble_hessian(const TVector &x, CompositeHessian &assembler, THessian &hessian);
+
 		std::vector<std::shared_ptr<Form>> forms_;
+
+	private:
+		CompositeHessian full_hessian_;          ///< Assembler of the full size Hessian
+		std::vector<THessian> form_hessians_; ///< Hessian of each form, reused across calls
 	};
 } // namespace polyfem::solver
@@ -1,6 +1,7 @@
 #include "NLProblem.hpp"
 
 #include <polyfem/io/OBJWriter.hpp>
+#include <polyfem/utils/Logger.hpp>
 
 /*
 m \frac{\partial^2 u}{\partial t^2} = \psi = \text{div}(\sigma[u])\newline
@@ -31,6 +32,7 @@ namespace polyfem::solver
 		  n_boundary_samples_(0),
 		  t_(0)
 	{
+		init_free_dofs();
 		use_reduced_size();
 	}
 
@@ -53,30 +55,71 @@ namespace polyfem::solver
 	{
 		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
 		assert(boundary_nodes.size() == 0 || (boundary_nodes.front() >= 0 && boundary_nodes.back() < full_size_));
+		init_free_dofs();
 		use_reduced_size();
 	}
 
+	void NLProblem::init_free_dofs() const
+	{
+		assert(std::is_sorted(boundary_nodes_.begin(), boundary_nodes_.end()));
+		if (boundary_nodes_.size() != full_size_ - reduced_size_)
+			log_and_throw_error("The number of Dirichlet nodes changed from {} to {}, the problem must be rebuilt!", full_size_ - reduced_size_, boundary_nodes_.size());
+
+		free_dofs_boundary_nodes_ = boundary_nodes_;
+		// the Dirichlet values are computed at the boundary nodes
+		boundary_values_valid_ = false;
+
+		free_dofs_.clear();
+		free_dofs_.reserve(reduced_size_);
+		size_t k = 0;
+		for (int i = 0; i < full_size_; ++i)
+		{
+			if (k < boundary_nodes_.size() && boundary_nodes_[k] == i)
+			{
+				++k;
+				continue;
+			}
+
+			free_dofs_.push_back(i);
+		}
+		assert(int(free_dofs_.size()) == reduced_size_);
+	}
+
+	const std::vector<int> &NLProblem::free_dofs() const
+	{
+		// the boundary nodes are owned by the caller, they can change (with the same count) between two solves
+		if (free_dofs_boundary_nodes_ != boundary_nodes_)
+			init_free_dofs();
+		return free_dofs_;
+	}
+
 	void NLProblem::init_lagging(const TVector &x)
 	{
-		FullNLProblem::init_lagging(reduced_to_full(x));
+		reduced_to_full(x, full_x0_);
+		FullNLProblem::init_lagging(full_x0_);
 	}
 
 	void NLProblem::update_lagging(const TVector &x, const int iter_num)
 	{
-		FullNLProblem::update_lagging(reduced_to_full(x), iter_num);
+		reduced_to_full(x, full_x0_);
+		FullNLProblem::update_lagging(full_x0_, iter_num);
 	}
 
 	void NLProblem::update_quantities(const double t, const TVector &x)
 	{
 		t_ = t;
-		const TVector full = reduced_to_full(x);
+		boundary_values_valid_ = false;
+
+		reduced_to_full(x, full_x0_);
 		for (auto &f : forms_)
-			f->update_quantities(t, full);
+			f->update_quantities(t, full_x0_);
 	}
 
 	void NLProblem::line_search_begin(const TVector &x0, const TVector &x1)
 	{
-		FullNLProblem::line_search_begin(reduced_to_full(x0), reduced_to_full(x1));
+		reduced_to_full(x0, full_x0_);
+		reduced_to_full(x1, full_x1_);
+		FullNLProblem::line_search_begin(full_x0_, full_x1_);
 	}
 
 	double NLProblem::max_step_size(const TVector &x0, const TVector &x1) const
@@ -97,33 +140,83 @@ namespace polyfem::solver
 	double NLProblem::value(const TVector &x)
 	{
 		// TODO: removed fearure const bool only_elastic
-		return FullNLProblem::value(reduced_to_full(x));
+		reduced_to_full(x, full_x0_);
+		return FullNLProblem::value(full_x0_);
 	}
 
 	void NLProblem::gradient(const TVector &x, TVector &grad)
 	{
-		TVector full_grad;
-		FullNLProblem::gradient(reduced_to_full(x), full_grad);
-		grad = full_to_reduced(full_grad);
+		reduced_to_full(x, full_x0_);
+		FullNLProblem::gradient(full_x0_, full_grad_);
+		full_to_reduced(full_grad_, grad);
+	}
+
+	double NLProblem::value_and_gradient(const TVector &x, TVector &grad)
+	{
+		reduced_to_full(x, full_x0_);
+		const double val = FullNLProblem::value_and_gradient(full_x0_, full_grad_);
+		full_to_reduced(full_grad_, grad);
+		return val;
+	}
+
+	double NLProblem::value_with_validity(const TVector &x0, const TVector &x1, bool &valid)
+	{
+		reduced_to_full(x0, full_x0_);
+		reduced_to_full(x1, full_x1_);
+		return FullNLProblem::value_with_validity(full_x0_, full_x1_, valid);
 	}
 
 	void NLProblem::hessian(const TVector &x, THessian &hessian)
 	{
-		THessian full_hessian;
-		FullNLProblem::hessian(reduced_to_full(x), full_hessian);
-		assert(full_hessian.rows() == full_size());
-		assert(full_hessian.cols() == full_size());
-		utils::full_to_reduced_matrix(full_size(), current_size(), boundary_nodes_, full_hessian, hessian);
+		reduced_to_full(x, full_x0_);
+
+		// the Dirichlet rows and columns are dropped while summing the forms
+		if (current_size() == full_size())
+			reduced_hessian_.set_removed_dofs(full_size(), std::vector<int>());
+		else
+			reduced_hessian_.set_removed_dofs(full_size(), boundary_nodes_);
+		assemble_hessian(full_x0_, reduced_hessian_, hessian);
+	}
+
+	void NLProblem::init_hessian_vector_product(const TVector &x)
+	{
+		reduced_to_full(x, full_x0_);
+		FullNLProblem::init_hessian_vector_product(full_x0_);
+	}
+
+	void NLProblem::hessian_vector_product(const TVector &v, TVector &hv)
+	{
+		// v is a direction: the Dirichlet dofs are not perturbed
+		if (full_size() == current_size() || v.size() == full_size())
+			full_x0_ = v;
+		else
+		{
+			full_x0_.setZero(full_size());
+			scatter_reduced(v, full_x0_);
+		}
+		FullNLProblem::hessian_vector_product(full_x0_, full_grad_);
+		full_to_reduced(full_grad_, hv);
+	}
+
+	void NLProblem::hessian_block_diagonal(THessian &diag)
+	{
+		THessian full_diag;
+		FullNLProblem::hessian_block_diagonal(full_diag);
+		assert(full_diag.rows() == full_size());
+		assert(full_diag.cols() == full_size());
+		utils::full_to_reduced_matrix(full_size(), current_size(), boundary_nodes_, full_diag, diag);
 	}
 
 	void NLProblem::solution_changed(const TVector &newX)
 	{
-		FullNLProblem::solution_changed(reduced_to_full(newX));
+		reduced_to_full(newX, full_x0_);
+		FullNLProblem::solution_changed(full_x0_);
 	}
 
 	void NLProblem::post_step(const int iter_num, const TVector &x)
 	{
-		FullNLProblem::post_step(iter_num, reduced_to_full(x));
+		reduced_to_full(x, full_x0_);
+		FullNLProblem::post_step(iter_num, full_x0_);
 
 		// TODO: add me back
 		// if (state_.args["output"]["advanced"]["save_nl_solve_sequence"])
@@ -138,98 +231,83 @@ namespace polyfem::solver
 
 	void NLProblem::set_apply_DBC(const TVector &x, const bool val)
 	{
-		TVector full = reduced_to_full(x);
+		reduced_to_full(x, full_x0_);
 		for (auto &form : forms_)
-			form->set_apply_DBC(full, val);
+			form->set_apply_DBC(full_x0_, val);
 	}
 
 	NLProblem::TVector NLProblem::full_to_reduced(const TVector &full) const
 	{
 		TVector reduced;
-		full_to_reduced_aux(boundary_nodes_, full_size(), current_size(), full, reduced);
+		full_to_reduced(full, reduced);
 		return reduced;
 	}
 
 	NLProblem::TVector NLProblem::reduced_to_full(const TVector &reduced) const
 	{
 		TVector full;
-		reduced_to_full_aux(boundary_nodes_, full_size(), current_size(), reduced, boundary_values(), full);
+		reduced_to_full(reduced, full);
 		return full;
 	}
 
-	Eigen::MatrixXd NLProblem::boundary_values() const
+	void NLProblem::full_to_reduced(const TVector &full, TVector &reduced) const
 	{
-		Eigen::MatrixXd result = Eigen::MatrixXd::Zero(full_size(), 1);
-		// rhs_assembler->set_bc(*local_boundary_, boundary_nodes_, n_boundary_samples_, local_neumann_boundary_, result, t_);
-		rhs_assembler_->set_bc(*local_boundary_, boundary_nodes_, n_boundary_samples_, std::vector<mesh::LocalBoundary>(), result, Eigen::MatrixXd(), t_);
-		return result;
-	}
-
-	template <class FullMat, class ReducedMat>
-	void NLProblem::full_to_reduced_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced)
-	{
-		using namespace polyfem;
-
 		// Reduced is already at the full size
-		if (full_size == reduced_size || full.size() == reduced_size)
+		if (full_size() == current_size() || full.size() == current_size())
 		{
 			reduced = full;
 			return;
 		}
 
-		assert(full.size() == full_size);
-		assert(full.cols() == 1);
-		reduced.resize(reduced_size, 1);
-
-		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
-
-		long j = 0;
-		size_t k = 0;
-		for (int i = 0; i < full.size(); ++i)
-		{
-			if (k < boundary_nodes.size() && boundary_nodes[k] == i)
-			{
-				++k;
-				continue;
-			}
-
-			reduced(j++) = full(i);
-		}
-		assert(j == reduced.size());
+		assert(full.size() == full_size());
+		const std::vector<int> &dofs = free_dofs();
+		reduced.resize(reduced_size());
+		for (int j = 0; j < int(dofs.size()); ++j)
+			reduced(j) = full(dofs[j]);
 	}
 
-	template <class ReducedMat, class FullMat>
-	void NLProblem::reduced_to_full_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const ReducedMat &reduced, const Eigen::MatrixXd &rhs, FullMat &full)
+	void NLProblem::reduced_to_full(const TVector &reduced, TVector &full) const
 	{
-		using namespace polyfem;
-
 		// Full is already at the reduced size
-		if (full_size == reduced_size || full_size == reduced.size())
+		if (full_size() == current_size() || reduced.size() == full_size())
 		{
 			full = reduced;
 			return;
 		}
 
-		assert(reduced.size() == reduced_size);
-		assert(reduced.cols() == 1);
-		full.resize(full_size, 1);
+		// updates the free dofs first, they invalidate the boundary values if the boundary nodes changed
+		free_dofs();
+		const Eigen::MatrixXd &rhs = boundary_values();
+		full.resize(full_size());
+		for (const int i : boundary_nodes_)
+			full(i) = rhs(i);
+		scatter_reduced(reduced, full);
+	}
 
-		assert(std::is_sorted(boundary_nodes.begin(), boundary_nodes.end()));
+	void NLProblem::scatter_reduced(const TVector &reduced, TVector &full) const
+	{
+		assert(reduced.size() == reduced_size());
+		assert(full.size() == full_size());
+		const std::vector<int> &dofs = free_dofs();
+		for (int j = 0; j < int(dofs.size()); ++j)
+			full(dofs[j]) = reduced(j);
+	}
 
-		long j = 0;
-		size_t k = 0;
-		for (int i = 0; i < full.size(); ++i)
+	const Eigen::MatrixXd &NLProblem::boundary_values() const
+	{
+		if (!boundary_values_valid_)
 		{
-			if (k < boundary_nodes.size() && boundary_nodes[k] == i)
-			{
-				++k;
-				full(i) = rhs(i);
-				continue;
-			}
-
-			full(i) = reduced(j++);
+			boundary_values_ = compute_boundary_values();
+			boundary_values_valid_ = true;
 		}
+		return boundary_values_;
+	}
 
-		assert(j == reduced.size());
+	Eigen::MatrixXd NLProblem::compute_boundary_values() const
+	{
+		Eigen::MatrixXd result = Eigen::MatrixXd::Zero(full_size(), 1);
+		// rhs_assembler->set_bc(*local_boundary_, boundary_nodes_, n_boundary_samples_, local_neumann_boundary_, result, t_);
+		rhs_assembler_->set_bc(*local_boundary_, boundary_nodes_, n_boundary_samples_, std::vector<mesh::LocalBoundary>(), result, Eigen::MatrixXd(), t_);
+		return result;
 	}
 } // namespace polyfem::solver
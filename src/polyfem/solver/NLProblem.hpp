@@ -6,6 +6,11 @@
 
 namespace polyfem::solver
 {
+	/// @brief Nonlinear problem on the dofs without the Dirichlet boundary nodes (reduced size) or on all of them (full size).
+	///
+	/// The evaluations (value, gradient, hessian, ...) convert the reduced iterates into member buffers, they are not reentrant:
+	/// the same problem must not be evaluated concurrently. The const methods use local vectors, except for the Dirichlet
+	/// values and free dofs which are computed on first use after update_quantities or a change of the boundary nodes.
 	class NLProblem : public FullNLProblem
 	{
 	public:
@@ -32,6 +37,13 @@ namespace polyfem::solver
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian) override;
 
+		double value_and_gradient(const TVector &x, TVector &gradv) override;
+		double value_with_validity(const TVector &x0, const TVector &x1, bool &valid) override;
+
+		void init_hessian_vector_product(const TVector &x) override;
+		void hessian_vector_product(const TVector &v, TVector &hv) override;
+		void hessian_block_diagonal(THessian &diag) override;
+
 		bool is_step_valid(const TVector &x0, const TVector &x1) const override;
 		bool is_step_collision_free(const TVector &x0, const TVector &x1) const override;
 		double max_step_size(const TVector &x0, const TVector &x1) const override;
@@ -57,10 +69,17 @@ namespace polyfem::solver
 		virtual TVector full_to_reduced(const TVector &full) const;
 		virtual TVector reduced_to_full(const TVector &reduced) const;
 
+		/// @brief Same as full_to_reduced, writing into reduced (resized only if needed)
+		void full_to_reduced(const TVector &full, TVector &reduced) const;
+		/// @brief Same as reduced_to_full, writing into full (resized only if needed)
+		void reduced_to_full(const TVector &reduced, TVector &full) const;
+
 		void set_apply_DBC(const TVector &x, const bool val);
 
 	protected:
-		virtual Eigen::MatrixXd boundary_values() const;
+		/// @brief Dirichlet values at the current time, computed once per time and reused until update_quantities
+		const Eigen::MatrixXd &boundary_values() const;
+		virtual Eigen::MatrixXd compute_boundary_values() const;
 
 		const std::vector<int> &boundary_nodes_;
 
@@ -84,10 +103,23 @@ namespace polyfem::solver
 		const int n_boundary_samples_;
 		double t_;
 
-		template <class FullMat, class ReducedMat>
-		static void full_to_reduced_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced);
+		mutable std::vector<int> free_dofs_;                ///< Full indices of the reduced dofs
+		mutable std::vector<int> free_dofs_boundary_nodes_; ///< Boundary nodes used to build free_dofs_
+
+		CompositeHessian reduced_hessian_; ///< Assembler of the Hessian without the Dirichlet dofs
+
+		mutable Eigen::MatrixXd boundary_values_;   ///< Cached Dirichlet values at t_
+		mutable bool boundary_values_valid_ = false; ///< Whether boundary_values_ is up to date
+
+		/// Buffers of the full size vectors, reused across the (non const) evaluations
+		TVector full_x0_, full_x1_, full_grad_;
+
+		/// @brief Builds free_dofs_ from boundary_nodes_, their number must not change
+		void init_free_dofs() const;
+		/// @brief free_dofs_, rebuilt if boundary_nodes_ changed since the last call
+		const std::vector<int> &free_dofs() const;
 
-		template <class ReducedMat, class FullMat>
-		static void reduced_to_full_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const ReducedMat &reduced, const Eigen::MatrixXd &rhs, FullMat &full);
+		/// @brief Writes the reduced dofs into the free entries of full, the Dirichlet entries are left untouched
+		void scatter_reduced(const TVector &reduced, TVector &full) const;
 	};
 } // namespace polyfem::solver
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+#include "NonlinearSolver.hpp"
+#include <polysolve/LinearSolver.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/Timer.hpp>
+
+#include <Eigen/SparseCholesky>
+
+namespace cppoptlib
+{
+	/// @brief Inexact (truncated) Newton method using matrix-free Hessian-vector products.
+	/// The Newton system is solved with a block Jacobi preconditioned conjugate gradient,
+	/// so the Hessian is never assembled (only its nodal diagonal blocks): the elastic products are
+	/// evaluated per quadrature point from the displacement gradients stored once per Newton iteration.
+	/// Contact, friction and Rayleigh damping still apply an assembled Hessian.
+	template <typename ProblemType>
+	class NewtonKrylovSolver : public NonlinearSolver<ProblemType>
+	{
+	public:
+		using Superclass = NonlinearSolver<ProblemType>;
+		using typename Superclass::Scalar;
+		using typename Superclass::TVector;
+
+		NewtonKrylovSolver(const json &solver_params, const double dt, const double characteristic_length);
+
+		std::string name() const override { return "Newton-Krylov"; }
+
+	protected:
+		bool compute_update_direction(ProblemType &objFunc, const TVector &x, const TVector &grad, TVector &direction) override;
+
+		void init_hessian_operator(ProblemType &objFunc, const TVector &x);
+		bool solve_linear_system(ProblemType &objFunc, const TVector &grad, TVector &direction);
+
+		void apply_preconditioner(const TVector &r, TVector &z) const;
+
+		// ====================================================================
+		//                        Solver parameters
+		// ====================================================================
+
+		int max_krylov_iterations;
+		double krylov_tolerance; ///< Relative residual tolerance of the linear solve
+
+		// ====================================================================
+		//                           Solver state
+		// ====================================================================
+
+		void reset(const int ndof) override;
+
+		virtual int default_descent_strategy() override { return force_psd_projection ? 1 : 0; }
+		void increase_descent_strategy() override;
+
+		using Superclass::descent_strategy_name;
+		std::string descent_strategy_name(int descent_strategy) const override;
+
+		spdlog::level::level_enum log_level() const
+		{
+			return this->descent_strategy == 2 ? spdlog::level::warn : spdlog::level::debug;
+		}
+
+		bool force_psd_projection = false; ///< Whether to force the Hessian to be positive semi-definite
+
+		Eigen::SimplicialLDLT<polyfem::StiffnessMatrix> block_jacobi; ///< Factorization of the block diagonal of the Hessian
+		bool use_block_jacobi = false;                                ///< If false, use the inverse of the (absolute) diagonal
+		TVector inv_diagonal;                                         ///< Jacobi preconditioner fallback
+
+		// ====================================================================
+		//                            Solver info
+		// ====================================================================
+
+		void update_solver_info(const double energy) override;
+
+		json internal_solver_info = json::array();
+
+		// ====================================================================
+		//                                END
+		// ====================================================================
+	};
+
+} // namespace cppoptlib
+
+#include "NewtonKrylovSolver.tpp"
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "NewtonKrylovSolver.hpp"
+
+namespace cppoptlib
+{
+	template <typename ProblemType>
+	NewtonKrylovSolver<ProblemType>::NewtonKrylovSolver(
+		const json &solver_params, const double dt, const double characteristic_length)
+		: Superclass(solver_params, dt, characteristic_length)
+	{
+		force_psd_projection = solver_params["force_psd_projection"];
+		max_krylov_iterations = solver_params["krylov"]["max_iterations"];
+		krylov_tolerance = solver_params["krylov"]["tolerance"];
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	std::string NewtonKrylovSolver<ProblemType>::descent_strategy_name(int descent_strategy) const
+	{
+		switch (descent_strategy)
+		{
+		case 0:
+			return "Newton-Krylov";
+		case 1:
+			return "projected Newton-Krylov";
+		case 2:
+			return "gradient descent";
+		default:
+			throw std::invalid_argument("invalid descent strategy");
+		}
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void NewtonKrylovSolver<ProblemType>::increase_descent_strategy()
+	{
+		this->descent_strategy++;
+		assert(this->descent_strategy <= 2);
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void NewtonKrylovSolver<ProblemType>::reset(const int ndof)
+	{
+		Superclass::reset(ndof);
+		internal_solver_info = json::array();
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	bool NewtonKrylovSolver<ProblemType>::compute_update_direction(
+		ProblemType &objFunc,
+		const TVector &x,
+		const TVector &grad,
+		TVector &direction)
+	{
+		if (this->descent_strategy == 2)
+		{
+			direction = -grad;
+			return true;
+		}
+
+		init_hessian_operator(objFunc, x);
+
+		if (!solve_linear_system(objFunc, grad, direction))
+			// solve_linear_system will increase descent_strategy if needed
+			return compute_update_direction(objFunc, x, grad, direction);
+
+		if (grad.dot(direction) >= 0)
+		{
+			increase_descent_strategy();
+			polyfem::logger().log(
+				log_level(), "[{}] direction is not a descent direction (Δx⋅g={}≥0); reverting to {}",
+				name(), direction.dot(grad), descent_strategy_name());
+			return compute_update_direction(objFunc, x, grad, direction);
+		}
+
+		return true;
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void NewtonKrylovSolver<ProblemType>::init_hessian_operator(ProblemType &objFunc, const TVector &x)
+	{
+		POLYFEM_SCOPED_TIMER("assembly time", this->assembly_time);
+
+		if (this->descent_strategy == 1)
+			objFunc.set_project_to_psd(true);
+		else if (this->descent_strategy == 0)
+			objFunc.set_project_to_psd(false);
+		else
+			assert(false);
+
+		objFunc.init_hessian_vector_product(x);
+
+		polyfem::StiffnessMatrix diag;
+		objFunc.hessian_block_diagonal(diag);
+
+		// The preconditioner has to be positive definite for CG
+		block_jacobi.compute(diag);
+		use_block_jacobi = block_jacobi.info() == Eigen::Success && (block_jacobi.vectorD().array() > 0).all();
+		if (!use_block_jacobi)
+		{
+			polyfem::logger().trace("[{}] block Jacobi preconditioner is not positive definite, using Jacobi", name());
+			inv_diagonal = diag.diagonal().cwiseAbs();
+			for (int i = 0; i < inv_diagonal.size(); ++i)
+				inv_diagonal(i) = inv_diagonal(i) > 0 ? 1 / inv_diagonal(i) : 1;
+		}
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void NewtonKrylovSolver<ProblemType>::apply_preconditioner(const TVector &r, TVector &z) const
+	{
+		if (use_block_jacobi)
+			z = block_jacobi.solve(r);
+		else
+			z = inv_diagonal.cwiseProduct(r);
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	bool NewtonKrylovSolver<ProblemType>::solve_linear_system(
+		ProblemType &objFunc, const TVector &grad, TVector &direction)
+	{
+		POLYFEM_SCOPED_TIMER("linear solve", this->inverting_time);
+
+		// Preconditioned CG on H Δx = -g, stopped at the first direction of negative curvature
+		direction.setZero(grad.size());
+		TVector r = -grad;
+		TVector z, p, Hp;
+		apply_preconditioner(r, z);
+		p = z;
+		double rz = r.dot(z);
+
+		const double tol = krylov_tolerance * grad.norm();
+		int iter = 0;
+		bool negative_curvature = false;
+		for (; iter < max_krylov_iterations && r.norm() > tol; ++iter)
+		{
+			objFunc.hessian_vector_product(p, Hp);
+
+			const double pHp = p.dot(Hp);
+			if (!(pHp > 0))
+			{
+				negative_curvature = true;
+				break;
+			}
+
+			const double alpha = rz / pHp;
+			direction += alpha * p;
+			r -= alpha * Hp;
+
+			apply_preconditioner(r, z);
+			const double rz_new = r.dot(z);
+			p = z + (rz_new / rz) * p;
+			rz = rz_new;
+		}
+
+		if (negative_curvature && iter == 0)
+		{
+			increase_descent_strategy();
+
+			// warn if using gradient descent
+			polyfem::logger().log(
+				log_level(), "[{}] Hessian has negative (or nan) curvature; reverting to {}",
+				name(), this->descent_strategy_name());
+
+			return false;
+		}
+
+		const double residual = r.norm();
+		if (std::isnan(residual))
+		{
+			increase_descent_strategy();
+			polyfem::logger().log(
+				log_level(), "[{}] nan linear solve residual; reverting to {}",
+				name(), this->descent_strategy_name());
+			return false;
+		}
+
+		polyfem::logger().trace(
+			"[{}] CG iterations {} relative residual {}{}", name(), iter,
+			residual / grad.norm(), negative_curvature ? " (negative curvature)" : "");
+
+		json info;
+		info["iterations"] = iter;
+		info["relative_residual"] = residual / grad.norm();
+		info["negative_curvature"] = negative_curvature;
+		info["block_jacobi"] = use_block_jacobi;
+		internal_solver_info.push_back(info);
+
+		return true;
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void NewtonKrylovSolver<ProblemType>::update_solver_info(const double energy)
+	{
+		Superclass::update_solver_info(energy);
+		this->solver_info["internal_solver"] = internal_solver_info;
+	}
+} // namespace cppoptlib
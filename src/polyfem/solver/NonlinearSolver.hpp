@@ -101,11 +101,13 @@ namespace cppoptlib
 		polyfem::json solver_info;
 
 		double total_time;
+		/// time of the gradient before the first iteration, the gradients of the iterations are in obj_fun_time
 		double grad_time;
 		double assembly_time;
 		double inverting_time;
 		double line_search_time;
 		double constraint_set_update_time;
+		/// time of the fused energy and gradient evaluations of the iterations
 		double obj_fun_time;
 
 		ErrorCode m_error_code;
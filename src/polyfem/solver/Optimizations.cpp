@@ -228,7 +228,7 @@ namespace polyfem::solver
 		}
 		else if (type == "per-body-to-per-node")
 		{
-			map = std::make_shared<PerBody2PerNode>(*(states[args["state"]]->mesh), states[args["state"]]->bases, states[args["state"]]->n_bases);
+			map = std::make_shared<PerBody2PerNode>(*(states[args["state"]]->mesh), states[args["state"]]->bases(), states[args["state"]]->n_bases);
 		}
 		else if (type == "E-nu-to-lambda-mu")
 		{
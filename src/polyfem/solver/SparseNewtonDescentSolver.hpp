@@ -28,6 +28,7 @@ namespace cppoptlib
 		bool compute_update_direction(ProblemType &objFunc, const TVector &x, const TVector &grad, TVector &direction) override;
 
 		void assemble_hessian(ProblemType &objFunc, const TVector &x, polyfem::StiffnessMatrix &hessian);
+		void analyze_pattern(const polyfem::StiffnessMatrix &hessian);
 		bool solve_linear_system(const polyfem::StiffnessMatrix &hessian, const TVector &grad, TVector &direction);
 		bool check_direction(const polyfem::StiffnessMatrix &hessian, const TVector &grad, const TVector &direction);
 
@@ -63,6 +64,13 @@ namespace cppoptlib
 		bool force_psd_projection = false;                      ///< Whether to force the Hessian to be positive semi-definite
 		double reg_weight = 0;                                  ///< Regularization Coefficients
 
+		bool reuse_analyzed_pattern = true; ///< Whether to skip the symbolic analysis when the Hessian pattern is unchanged
+		bool has_analyzed_pattern = false;  ///< Whether the linear solver holds a valid symbolic analysis
+
+		/// Sparsity pattern of the Hessian passed to the last analyzePattern
+		int analyzed_rows = -1;
+		std::vector<polyfem::StiffnessMatrix::StorageIndex> analyzed_outer, analyzed_inner;
+
 		// ====================================================================
 		//                            Solver info
 		// ====================================================================
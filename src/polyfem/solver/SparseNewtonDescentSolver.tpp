@@ -15,6 +15,7 @@ namespace cppoptlib
 		linear_solver->setParameters(linear_solver_params);
 
 		force_psd_projection = solver_params["force_psd_projection"];
+		reuse_analyzed_pattern = solver_params["reuse_symbolic_factorization"];
 	}
 
 	// =======================================================================
@@ -123,13 +124,32 @@ namespace cppoptlib
 
 	// =======================================================================
 
+	template <typename ProblemType>
+	void SparseNewtonDescentSolver<ProblemType>::analyze_pattern(const polyfem::StiffnessMatrix &hessian)
+	{
+		// The pattern of the Hessian is usually the same between Newton iterations (and time steps),
+		// so we only redo the symbolic analysis (e.g., fill-reducing ordering) when it changes.
+		if (reuse_analyzed_pattern && has_analyzed_pattern
+			&& polyfem::utils::has_sparsity_pattern(hessian, analyzed_rows, analyzed_outer, analyzed_inner))
+		{
+			polyfem::logger().trace("Reusing symbolic analysis of the Hessian");
+			return;
+		}
+
+		linear_solver->analyzePattern(hessian, hessian.rows());
+		analyzed_rows = hessian.rows();
+		polyfem::utils::sparsity_pattern(hessian, analyzed_outer, analyzed_inner);
+		has_analyzed_pattern = true;
+	}
+
+	// =======================================================================
+
 	template <typename ProblemType>
 	bool SparseNewtonDescentSolver<ProblemType>::solve_linear_system(
 		const polyfem::StiffnessMatrix &hessian, const TVector &grad, TVector &direction)
 	{
 		POLYFEM_SCOPED_TIMER("linear solve", this->inverting_time);
-		// TODO: get the correct size
-		linear_solver->analyzePattern(hessian, hessian.rows());
+		analyze_pattern(hessian);
 
 		try
 		{
@@ -137,6 +157,9 @@ namespace cppoptlib
 		}
 		catch (const std::runtime_error &err)
 		{
+			// Do not trust the state of the linear solver after a failed factorization
+			has_analyzed_pattern = false;
+
 			increase_descent_strategy();
 
 			// warn if using gradient descent
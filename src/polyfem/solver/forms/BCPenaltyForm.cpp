@@ -95,6 +95,16 @@ namespace polyfem::solver
 		hessian = masked_lumped_mass_;
 	}
 
+	void BCPenaltyForm::second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		hv = masked_lumped_mass_ * v;
+	}
+
+	void BCPenaltyForm::second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const
+	{
+		diag = utils::block_diagonal(masked_lumped_mass_, 1);
+	}
+
 	void BCPenaltyForm::update_quantities(const double t, const Eigen::VectorXd &)
 	{
 		if (is_time_dependent_)
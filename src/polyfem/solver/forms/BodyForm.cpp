@@ -122,6 +122,9 @@ namespace polyfem::solver
 		const int n_elements = int(bases.size());
 		term.setZero(n_verts * dim, 1);
 
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = rhs_assembler_.ass_vals_cache().dof_map(bases, tmp_dof_map);
+
 		auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
 
 		utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
@@ -129,8 +132,7 @@ namespace polyfem::solver
 
 			for (int e = start; e < end; ++e)
 			{
-				assembler::ElementAssemblyValues &vals = local_storage.vals;
-				rhs_assembler_.ass_vals_cache().compute(e, rhs_assembler_.mesh().is_volume(), bases[e], gbases[e], vals);
+				const assembler::ElementAssemblyValues &vals = rhs_assembler_.ass_vals_cache().get(e, rhs_assembler_.mesh().is_volume(), bases[e], gbases[e], local_storage.vals);
 				assembler::ElementAssemblyValues &gvals = local_storage.gvals;
 				gvals.compute(e, rhs_assembler_.mesh().is_volume(), vals.quadrature.points, gbases[e], gbases[e]);
 
@@ -138,7 +140,7 @@ namespace polyfem::solver
 				local_storage.da = vals.det.array() * quadrature.weights.array();
 
 				Eigen::MatrixXd p, grad_p;
-				io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, adjoint, p, grad_p);
+				io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, adjoint, p, grad_p);
 
 				Eigen::MatrixXd rhs_function;
 				rhs_assembler_.problem().rhs(rhs_assembler_.assembler(), vals.val, t, rhs_function);
@@ -257,7 +259,7 @@ namespace polyfem::solver
 					rhs_assembler_.problem().neumann_bc(rhs_assembler_.mesh(), global_ids, uv, vals.val, normals, t, neumann_val);
 
 					Eigen::MatrixXd p, grad_p;
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, adjoint_zeroed, p, grad_p);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, adjoint_zeroed, p, grad_p);
 
 					const Eigen::VectorXi geom_nodes = gbases[e].local_nodes_for_primitive(global_primitive_id, rhs_assembler_.mesh());
 
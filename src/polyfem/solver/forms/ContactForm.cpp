@@ -26,18 +26,22 @@ namespace polyfem::solver
 							 const bool enable_shape_derivatives,
 							 const ipc::BroadPhaseMethod broad_phase_method,
 							 const double ccd_tolerance,
-							 const int ccd_max_iterations)
+							 const int ccd_max_iterations,
+							 const double dmin)
 		: collision_mesh_(collision_mesh),
 		  dhat_(dhat),
+		  dmin_(dmin),
 		  use_adaptive_barrier_stiffness_(use_adaptive_barrier_stiffness),
 		  avg_mass_(avg_mass),
 		  is_time_dependent_(is_time_dependent),
 		  enable_shape_derivatives_(enable_shape_derivatives),
 		  broad_phase_method_(broad_phase_method),
 		  ccd_tolerance_(ccd_tolerance),
-		  ccd_max_iterations_(ccd_max_iterations)
+		  ccd_max_iterations_(ccd_max_iterations),
+		  envelope_margin_(dhat)
 	{
 		assert(dhat_ > 0);
+		assert(dmin_ >= 0);
 		assert(ccd_tolerance > 0);
 
 		prev_distance_ = -1;
@@ -124,17 +128,40 @@ namespace polyfem::solver
 	void ContactForm::update_constraint_set(const Eigen::MatrixXd &displaced_surface)
 	{
 		// Store the previous value used to compute the constraint set to avoid duplicate computation.
-		static Eigen::MatrixXd cached_displaced_surface;
-		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
+		if (cached_displaced_surface_.size() == displaced_surface.size() && cached_displaced_surface_ == displaced_surface)
 			return;
 
 		if (use_cached_candidates_)
+		{
 			constraint_set_.build(
-				candidates_, collision_mesh_, displaced_surface, dhat_);
+				line_search_candidates(), collision_mesh_, displaced_surface, dhat_, dmin_);
+		}
 		else
+		{
+			if (!is_inside_envelope(displaced_surface))
+			{
+				// Pairs closer than dmin + dhat after moving at most envelope_margin_ per coordinate
+				// have overlapping boxes inflated by (dhat + dmin) / 2 + envelope_margin_.
+				POLYFEM_SCOPED_TIMER("contact envelope broad phase");
+				envelope_candidates_.build(
+					collision_mesh_, displaced_surface,
+					/*inflation_radius=*/(dhat_ + dmin_) / 2 + envelope_margin_,
+					broad_phase_method_);
+				envelope_displaced_surface_ = displaced_surface;
+			}
+
 			constraint_set_.build(
-				collision_mesh_, displaced_surface, dhat_, dmin_, broad_phase_method_);
-		cached_displaced_surface = displaced_surface;
+				envelope_candidates_, collision_mesh_, displaced_surface, dhat_, dmin_);
+		}
+		cached_displaced_surface_ = displaced_surface;
+	}
+
+	bool ContactForm::is_inside_envelope(const Eigen::MatrixXd &displaced_surface) const
+	{
+		if (envelope_displaced_surface_.rows() != displaced_surface.rows() || envelope_displaced_surface_.cols() != displaced_surface.cols())
+			return false;
+
+		return (displaced_surface - envelope_displaced_surface_).lpNorm<Eigen::Infinity>() <= envelope_margin_;
 	}
 
 	double ContactForm::value_unweighted(const Eigen::VectorXd &x) const
@@ -176,7 +203,7 @@ namespace polyfem::solver
 
 		double max_step;
 		if (use_cached_candidates_ && broad_phase_method_ != ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE_GPU)
-			max_step = candidates_.compute_collision_free_stepsize(
+			max_step = line_search_candidates().compute_collision_free_stepsize(
 				collision_mesh_, V0, V1, dmin_, ccd_tolerance_, ccd_max_iterations_);
 		else
 			max_step = ipc::compute_collision_free_stepsize(
@@ -204,12 +231,20 @@ namespace polyfem::solver
 
 	void ContactForm::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
-		candidates_.build(
-			collision_mesh_,
-			compute_displaced_surface(x0),
-			compute_displaced_surface(x1),
-			/*inflation_radius=*/dhat_ / 2,
-			broad_phase_method_);
+		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
+		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
+
+		// The envelope is convex (box around each vertex), if both ends are inside so is the whole step
+		// and the envelope candidates contain every pair that can get closer than dhat during the step.
+		line_search_in_envelope_ = is_inside_envelope(V0) && is_inside_envelope(V1);
+
+		if (!line_search_in_envelope_)
+		{
+			candidates_.build(
+				collision_mesh_, V0, V1,
+				/*inflation_radius=*/dhat_ / 2,
+				broad_phase_method_);
+		}
 
 		use_cached_candidates_ = true;
 	}
@@ -218,6 +253,7 @@ namespace polyfem::solver
 	{
 		candidates_.clear();
 		use_cached_candidates_ = false;
+		line_search_in_envelope_ = false;
 	}
 
 	void ContactForm::post_step(const int iter_num, const Eigen::VectorXd &x)
@@ -267,7 +303,7 @@ namespace polyfem::solver
 
 		bool is_valid;
 		if (use_cached_candidates_)
-			is_valid = candidates_.is_step_collision_free(
+			is_valid = line_search_candidates().is_step_collision_free(
 				collision_mesh_, displaced0, displaced1, dmin_,
 				ccd_tolerance_, ccd_max_iterations_);
 		else
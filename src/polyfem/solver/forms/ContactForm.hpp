@@ -41,6 +41,7 @@ namespace polyfem::solver
 		/// @param broad_phase_method Broad phase method to use for distance and CCD evaluations
 		/// @param ccd_tolerance Continuous collision detection tolerance
 		/// @param ccd_max_iterations Continuous collision detection maximum iterations
+		/// @param dmin Minimum distance between elements
 		ContactForm(const ipc::CollisionMesh &collision_mesh,
 					const double dhat,
 					const double avg_mass,
@@ -50,7 +51,8 @@ namespace polyfem::solver
 					const bool enable_shape_derivatives,
 					const ipc::BroadPhaseMethod broad_phase_method,
 					const double ccd_tolerance,
-					const int ccd_max_iterations);
+					const int ccd_max_iterations,
+					const double dmin = 0);
 
 		std::string name() const override { return "contact"; }
 
@@ -140,6 +142,14 @@ namespace polyfem::solver
 		/// @param displaced_surface Vertex positions displaced by the current solution
 		void update_constraint_set(const Eigen::MatrixXd &displaced_surface);
 
+		/// @brief Check if the envelope candidates contain all the candidates of a configuration
+		/// @param displaced_surface Vertex positions
+		/// @return True if every vertex moved less than the envelope margin from where the envelope was built
+		bool is_inside_envelope(const Eigen::MatrixXd &displaced_surface) const;
+
+		/// @brief Candidates used during the line search
+		const ipc::Candidates &line_search_candidates() const { return line_search_in_envelope_ ? envelope_candidates_ : candidates_; }
+
 		/// @brief Collision mesh
 		const ipc::CollisionMesh &collision_mesh_;
 
@@ -147,7 +157,7 @@ namespace polyfem::solver
 		const double dhat_;
 
 		/// @brief Minimum distance between elements
-		const double dmin_ = 0;
+		const double dmin_;
 
 		/// @brief If true, use an adaptive barrier stiffness
 		const bool use_adaptive_barrier_stiffness_;
@@ -181,5 +191,18 @@ namespace polyfem::solver
 		ipc::CollisionConstraints constraint_set_;
 		/// @brief Cached candidate set for the current solution
 		ipc::Candidates candidates_;
+
+		/// @brief Displaced surface used to build the current constraint set
+		Eigen::MatrixXd cached_displaced_surface_;
+
+		/// @brief Candidates of the surface inflated by the envelope margin, valid for any displacement
+		/// within the margin (in L∞) from envelope_displaced_surface_, only the narrow phase is rebuilt
+		ipc::Candidates envelope_candidates_;
+		/// @brief Displaced surface used to build envelope_candidates_
+		Eigen::MatrixXd envelope_displaced_surface_;
+		/// @brief Maximum vertex displacement for which envelope_candidates_ is valid
+		const double envelope_margin_;
+		/// @brief If true, both ends of the line search are in the envelope and envelope_candidates_ is used
+		bool line_search_in_envelope_ = false;
 	};
 } // namespace polyfem::solver
@@ -86,6 +86,77 @@ namespace polyfem::solver
 		}
 	}
 
+	void ElasticForm::init_second_derivative_vector_product(const Eigen::VectorXd &x)
+	{
+		if (assembler_.is_linear())
+			return;
+
+		if (assembler_.has_stress_grad())
+		{
+			// the products evaluate the stress derivative per quadrature point from these gradients
+			local_hessians_.clear();
+			assembler_.assemble_displacement_gradients(
+				is_volume_, bases_, geom_bases_, ass_vals_cache_, x, displacement_gradients_);
+		}
+		else
+		{
+			// the element hessians are computed once and applied by every product
+			displacement_gradients_.clear();
+			assembler_.assemble_local_hessians(
+				is_volume_, project_to_psd_, bases_, geom_bases_,
+				ass_vals_cache_, dt_, x, x_prev_, local_hessians_);
+		}
+	}
+
+	void ElasticForm::second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		POLYFEM_SCOPED_TIMER("elastic hessian vector product");
+
+		if (assembler_.is_linear())
+		{
+			assert(cached_stiffness_.rows() == v.size() && cached_stiffness_.cols() == v.size());
+			hv = cached_stiffness_ * v;
+		}
+		else if (assembler_.has_stress_grad())
+		{
+			assert(displacement_gradients_.size() == bases_.size());
+			Eigen::MatrixXd tmp;
+			assembler_.assemble_hessian_vector_product(
+				is_volume_, n_bases_, project_to_psd_, bases_, geom_bases_,
+				ass_vals_cache_, dt_, displacement_gradients_, v, tmp);
+			hv = tmp;
+		}
+		else
+		{
+			assert(local_hessians_.size() == bases_.size());
+			Eigen::MatrixXd tmp;
+			assembler_.assemble_hessian_vector_product(
+				n_bases_, bases_, ass_vals_cache_, local_hessians_, v, tmp);
+			hv = tmp;
+		}
+	}
+
+	void ElasticForm::second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const
+	{
+		if (assembler_.is_linear())
+		{
+			diag = utils::block_diagonal(cached_stiffness_, assembler_.size());
+		}
+		else if (assembler_.has_stress_grad())
+		{
+			assert(displacement_gradients_.size() == bases_.size());
+			assembler_.assemble_hessian_block_diagonal(
+				is_volume_, n_bases_, project_to_psd_, bases_, geom_bases_,
+				ass_vals_cache_, dt_, displacement_gradients_, diag);
+		}
+		else
+		{
+			assert(local_hessians_.size() == bases_.size());
+			assembler_.assemble_hessian_block_diagonal(
+				n_bases_, bases_, ass_vals_cache_, local_hessians_, diag);
+		}
+	}
+
 	bool ElasticForm::is_step_valid(const Eigen::VectorXd &, const Eigen::VectorXd &x1) const
 	{
 		Eigen::VectorXd grad;
@@ -103,6 +174,24 @@ namespace polyfem::solver
 		return true;
 	}
 
+	double ElasticForm::value_and_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
+	{
+		Eigen::MatrixXd grad;
+		const double val = assembler_.assemble_energy_gradient(is_volume_, n_bases_, bases_, geom_bases_,
+															   ass_vals_cache_, dt_, x, x_prev_, grad);
+		gradv = weight() * grad;
+		return weight() * val;
+	}
+
+	double ElasticForm::value_with_validity(const Eigen::VectorXd &, const Eigen::VectorXd &x1, bool &valid) const
+	{
+		// same criterion as is_step_valid, the gradient is computed with the energy
+		Eigen::VectorXd grad;
+		const double val = value_and_gradient(x1, grad);
+		valid = !grad.array().isNaN().any();
+		return val;
+	}
+
 	void ElasticForm::compute_cached_stiffness()
 	{
 		if (assembler_.is_linear() && cached_stiffness_.size() == 0)
@@ -117,6 +206,8 @@ namespace polyfem::solver
 		const int dim = is_volume_ ? 3 : 2;
 
 		const int n_elements = int(bases_.size());
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = ass_vals_cache_.dof_map(bases_, tmp_dof_map);
 
 		if (assembler_.name() == "ViscousDamping")
 		{
@@ -129,16 +220,15 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
 					Eigen::MatrixXd u, grad_u, prev_u, prev_grad_u, p, grad_p;
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x, u, grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x_prev, prev_u, prev_grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, x, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, x_prev, prev_u, prev_grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, adjoint, p, grad_p);
 
 					for (int q = 0; q < local_storage.da.size(); ++q)
 					{
@@ -171,15 +261,14 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
 					Eigen::MatrixXd u, grad_u, p, grad_p;
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x, u, grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, x, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, adjoint, p, grad_p);
 
 					for (int q = 0; q < local_storage.da.size(); ++q)
 					{
@@ -208,6 +297,8 @@ namespace polyfem::solver
 		const int actual_dim = (assembler_.name() == "Laplacian") ? 1 : dim;
 
 		const int n_elements = int(bases_.size());
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = ass_vals_cache_.dof_map(bases_, tmp_dof_map);
 		term.setZero(n_verts * dim, 1);
 
 		auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
@@ -219,8 +310,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, is_volume_, vals.quadrature.points, geom_bases_[e], geom_bases_[e]);
 
@@ -228,9 +318,9 @@ namespace polyfem::solver
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
 					Eigen::MatrixXd u, grad_u, prev_u, prev_grad_u, p, grad_p;
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x, u, grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x_prev, prev_u, prev_grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, x, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, x_prev, prev_u, prev_grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, adjoint, p, grad_p);
 
 					Eigen::MatrixXd grad_u_i, grad_p_i, prev_grad_u_i;
 					Eigen::MatrixXd grad_v_i;
@@ -284,8 +374,7 @@ namespace polyfem::solver
 
 				for (int e = start; e < end; ++e)
 				{
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
+					const assembler::ElementAssemblyValues &vals = ass_vals_cache_.get(e, is_volume_, bases_[e], geom_bases_[e], local_storage.vals);
 					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, is_volume_, vals.quadrature.points, geom_bases_[e], geom_bases_[e]);
 
@@ -293,8 +382,8 @@ namespace polyfem::solver
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
 					Eigen::MatrixXd u, grad_u, p, grad_p; //, stiffnesses;
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, x, u, grad_u);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, adjoint, p, grad_p);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, x, u, grad_u);
+					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, dof_map, vals, adjoint, p, grad_p);
 					// assembler_.compute_stiffness_value(formulation_, vals, quadrature.points, x, stiffnesses);
 
 					for (int q = 0; q < local_storage.da.size(); ++q)
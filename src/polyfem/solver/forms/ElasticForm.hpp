@@ -42,13 +42,41 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative with a vector without assembling the Hessian
+		/// @param[in] v Vector to multiply
+		/// @param[out] hv Output product of the Hessian with v
+		void second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
+		/// @brief Compute the nodal block diagonal of the second derivative
+		/// @param[out] diag Output block diagonal of the Hessian
+		void second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const override;
+
 	public:
+		/// @brief Prepare the matrix-free products of the second derivative at x with vectors
+		/// @note Only the displacement gradients at the quadrature points are stored if the assembler provides the stress derivative,
+		///       the element Hessians are kept otherwise.
+		/// @param x Current solution
+		void init_second_derivative_vector_product(const Eigen::VectorXd &x) override;
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
 		/// @return True if the step is allowed
 		bool is_step_valid(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const override;
 
+		/// @brief Compute the value and the first derivative with a single pass over the elements
+		/// @param[in] x Current solution
+		/// @param[out] gradv Output gradient of the value wrt x
+		/// @return Computed value
+		double value_and_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const override;
+
+		/// @brief Compute the value at x1 and the validity of the step (finite gradient) with a single pass over the elements
+		/// @param[in] x0 Current solution
+		/// @param[in] x1 Proposed next solution
+		/// @param[out] valid True if the step is allowed
+		/// @return Computed value at x1
+		double value_with_validity(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1, bool &valid) const override;
+
 		/// @brief Update time-dependent fields
 		/// @param t Current time
 		/// @param x Current solution at time t
@@ -84,5 +112,7 @@ namespace polyfem::solver
 		void compute_cached_stiffness();
 
 		Eigen::VectorXd x_prev_;
+		std::vector<Eigen::MatrixXd> displacement_gradients_; ///< Displacement gradients at the solution given to init_second_derivative_vector_product
+		std::vector<Eigen::MatrixXd> local_hessians_;         ///< Element Hessians at that solution, for the assemblers without stress derivative
 	};
 } // namespace polyfem::solver
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 #include <filesystem>
 
@@ -34,6 +35,31 @@ namespace polyfem::solver
 			gradv *= weight();
 		}
 
+		/// @brief Compute the value and the first derivative of the form multiplied with the weigth
+		/// @note The default implementation evaluates them separately, forms can override it to share the work.
+		/// @param[in] x Current solution
+		/// @param[out] gradv Output gradient of the value wrt x
+		/// @return Computed value
+		virtual double value_and_gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
+		{
+			const double val = value(x);
+			first_derivative(x, gradv);
+			return val;
+		}
+
+		/// @brief Compute the value of the form multiplied with the weigth at x1 and if the step from x0 to x1 is allowed
+		/// @note The default implementation calls value and is_step_valid, forms can override it to share the work.
+		/// @param[in] x0 Current solution
+		/// @param[in] x1 Proposed next solution
+		/// @param[out] valid True if the step is allowed
+		/// @return Computed value at x1
+		virtual double value_with_validity(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1, bool &valid) const
+		{
+			const double val = value(x1);
+			valid = is_step_valid(x0, x1);
+			return val;
+		}
+
 		/// @brief Compute the second derivative of the value wrt x multiplied with the weigth
 		/// @note This is not marked const because ElasticForm needs to cache the matrix assembly.
 		/// @param[in] x Current solution
@@ -44,6 +70,31 @@ namespace polyfem::solver
 			hessian *= weight();
 		}
 
+		/// @brief Prepare the products of the second derivative at x with vectors
+		/// @note The default implementation assembles and stores the second derivative.
+		/// @param x Current solution
+		virtual void init_second_derivative_vector_product(const Eigen::VectorXd &x)
+		{
+			second_derivative_unweighted(x, hvp_hessian_);
+		}
+
+		/// @brief Compute the product of the second derivative (at the solution given to init_second_derivative_vector_product) with a vector multiplied with the weigth
+		/// @param[in] v Vector to multiply
+		/// @param[out] hv Output product of the Hessian with v
+		inline void second_derivative_vector_product(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+		{
+			second_derivative_vector_product_unweighted(v, hv);
+			hv *= weight();
+		}
+
+		/// @brief Compute the block diagonal of the second derivative (at the solution given to init_second_derivative_vector_product) multiplied with the weigth
+		/// @param[out] diag Output block diagonal of the Hessian
+		inline void second_derivative_block_diagonal(StiffnessMatrix &diag) const
+		{
+			second_derivative_block_diagonal_unweighted(diag);
+			diag *= weight();
+		}
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
@@ -162,5 +213,23 @@ namespace polyfem::solver
 		/// @param[in] x Current solution
 		/// @param[out] hessian Output Hessian of the value wrt x
 		virtual void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const = 0;
+
+		/// @brief Compute the product of the second derivative with a vector
+		/// @param[in] v Vector to multiply
+		/// @param[out] hv Output product of the Hessian with v
+		virtual void second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+		{
+			hv = hvp_hessian_ * v;
+		}
+
+		/// @brief Compute the block diagonal of the second derivative (only the diagonal by default)
+		/// @param[out] diag Output block diagonal of the Hessian
+		virtual void second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const
+		{
+			diag = utils::block_diagonal(hvp_hessian_, 1);
+		}
+
+	private:
+		StiffnessMatrix hvp_hessian_; ///< Second derivative used by the default Hessian-vector products
 	};
 } // namespace polyfem::solver
@@ -56,6 +56,16 @@ namespace polyfem::solver
 		hessian = mass_;
 	}
 
+	void InertiaForm::second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const
+	{
+		hv = mass_ * v;
+	}
+
+	void InertiaForm::second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const
+	{
+		diag = utils::block_diagonal(mass_, 1);
+	}
+
 	void InertiaForm::force_shape_derivative(
 		bool is_volume,
 		const int n_geom_bases,
@@ -71,6 +81,9 @@ namespace polyfem::solver
 		const int n_elements = int(bases.size());
 		term.setZero(n_geom_bases * dim, 1);
 
+		basis::ElementDofMap tmp_dof_map;
+		const basis::ElementDofMap &dof_map = ass_vals_cache.dof_map(bases, tmp_dof_map);
+
 		auto storage = utils::create_thread_storage(LocalThreadVecStorage(term.size()));
 
 		utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
@@ -78,8 +91,7 @@ namespace polyfem::solver
 
 			for (int e = start; e < end; ++e)
 			{
-				assembler::ElementAssemblyValues &vals = local_storage.vals;
-				ass_vals_cache.compute(e, is_volume, bases[e], geom_bases[e], vals);
+				const assembler::ElementAssemblyValues &vals = ass_vals_cache.get(e, is_volume, bases[e], geom_bases[e], local_storage.vals);
 				assembler::ElementAssemblyValues gvals;
 				gvals.compute(e, is_volume, vals.quadrature.points, geom_bases[e], geom_bases[e]);
 
@@ -87,8 +99,8 @@ namespace polyfem::solver
 				local_storage.da = vals.det.array() * quadrature.weights.array();
 
 				Eigen::MatrixXd vel, grad_vel, p, grad_p;
-				io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
-				io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, velocity, vel, grad_vel);
+				io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, adjoint, p, grad_p);
+				io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, velocity, vel, grad_vel);
 
 				for (int q = 0; q < local_storage.da.size(); ++q)
 				{
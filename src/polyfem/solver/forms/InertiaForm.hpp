@@ -60,6 +60,19 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) const override;
 
+		/// @brief Compute the product of the second derivative with a vector from the mass matrix without copying it
+		/// @param[in] v Vector to multiply
+		/// @param[out] hv Output product of the Hessian with v
+		void second_derivative_vector_product_unweighted(const Eigen::VectorXd &v, Eigen::VectorXd &hv) const override;
+
+		/// @brief Compute the diagonal of the second derivative
+		/// @param[out] diag Output diagonal of the Hessian
+		void second_derivative_block_diagonal_unweighted(StiffnessMatrix &diag) const override;
+
+	public:
+		/// @brief The second derivative does not depend on x, nothing to prepare
+		void init_second_derivative_vector_product(const Eigen::VectorXd &x) override {}
+
 	private:
 		const StiffnessMatrix &mass_;                                    ///< Mass matrix
 		const time_integrator::ImplicitTimeIntegrator &time_integrator_; ///< Time integrator
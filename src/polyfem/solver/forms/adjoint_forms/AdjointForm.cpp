@@ -102,8 +102,8 @@ namespace polyfem::solver
 	double MaxStressForm::value_unweighted_step(const int time_step, const Eigen::VectorXd &x) const
 	{
 		Eigen::VectorXd max_stress;
-		max_stress.setZero(state_.bases.size());
-		utils::maybe_parallel_for(state_.bases.size(), [&](int start, int end, int thread_id) {
+		max_stress.setZero(state_.bases().size());
+		utils::maybe_parallel_for(state_.bases().size(), [&](int start, int end, int thread_id) {
 			Eigen::MatrixXd local_vals;
 			assembler::ElementAssemblyValues vals;
 			for (int e = start; e < end; e++)
@@ -111,10 +111,10 @@ namespace polyfem::solver
 				if (interested_ids_.size() != 0 && interested_ids_.find(state_.mesh->get_body_id(e)) == interested_ids_.end())
 					continue;
 
-				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases()[e], state_.geom_bases()[e], vals);
 				// std::vector<assembler::Assembler::NamedMatrix> result;
-				// state_.assembler->compute_tensor_value(e, state_.bases[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step), result);
-				std::dynamic_pointer_cast<assembler::ElasticityAssembler>(state_.assembler)->compute_stress_tensor(e, state_.bases[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step), ElasticityTensorType::PK1, local_vals);
+				// state_.assembler->compute_tensor_value(e, state_.bases()[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step), result);
+				std::dynamic_pointer_cast<assembler::ElasticityAssembler>(state_.assembler)->compute_stress_tensor(e, state_.bases()[e], state_.geom_bases()[e], vals.quadrature.points, state_.diff_cached.u(time_step), ElasticityTensorType::PK1, local_vals);
 
 				Eigen::VectorXd stress_norms = local_vals.rowwise().norm();
 				max_stress(e) = std::max(max_stress(e), stress_norms.maxCoeff());
@@ -283,11 +283,14 @@ namespace polyfem::solver
 				Eigen::VectorXd term;
 				if (param_type == ParameterType::Material)
 				{
-					const auto &bases = state.bases;
+					const auto &bases = state.bases();
 					const auto &gbases = state.geom_bases();
 					term.setZero(bases.size() * 2);
 					const int dim = state.mesh->dimension();
 
+					basis::ElementDofMap tmp_dof_map;
+					const basis::ElementDofMap &dof_map = state.ass_vals_cache.dof_map(bases, tmp_dof_map);
+
 					for (int e = 0; e < bases.size(); e++)
 					{
 						assembler::ElementAssemblyValues vals;
@@ -297,7 +300,7 @@ namespace polyfem::solver
 						Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
 
 						Eigen::MatrixXd u, grad_u;
-						io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, state.diff_cached.u(time_step), u, grad_u);
+						io::Evaluator::interpolate_at_local_vals(e, dim, dim, dof_map, vals, state.diff_cached.u(time_step), u, grad_u);
 
 						Eigen::MatrixXd grad_u_q;
 						for (int q = 0; q < quadrature.weights.size(); q++)
@@ -354,7 +357,7 @@ namespace polyfem::solver
 			const int e = params["elem"];
 
 			Eigen::MatrixXd acc, grad_acc;
-			io::Evaluator::interpolate_at_local_vals(*(state.mesh), state.problem->is_scalar(), state.bases, state.geom_bases(), e, local_pts, state.diff_cached.acc(params["step"]), acc, grad_acc);
+			io::Evaluator::interpolate_at_local_vals(*(state.mesh), state.problem->is_scalar(), state.bases(), state.geom_bases(), e, local_pts, state.diff_cached.acc(params["step"]), acc, grad_acc);
 
 			val = acc.col(dim);
 		});
@@ -376,7 +379,7 @@ namespace polyfem::solver
 			const int e = params["elem"];
 
 			Eigen::MatrixXd v, grad_v;
-			io::Evaluator::interpolate_at_local_vals(*(state_.mesh), state_.problem->is_scalar(), state_.bases, state_.geom_bases(), e, local_pts, state_.diff_cached.v(params["step"]), v, grad_v);
+			io::Evaluator::interpolate_at_local_vals(*(state_.mesh), state_.problem->is_scalar(), state_.bases(), state_.geom_bases(), e, local_pts, state_.diff_cached.v(params["step"]), v, grad_v);
 
 			val.setZero(u.rows(), 1);
 			for (int q = 0; q < v.rows(); q++)
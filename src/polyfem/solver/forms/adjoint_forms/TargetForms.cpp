@@ -52,7 +52,7 @@ namespace polyfem::solver
 
 				Eigen::MatrixXd u_ref, grad_u_ref;
 				const Eigen::MatrixXd &sol_ref = target_state_->problem->is_time_dependent() ? target_state_->diff_cached.u(params["step"].get<int>()) : target_state_->diff_cached.u(0);
-				io::Evaluator::interpolate_at_local_vals(*(target_state_->mesh), target_state_->problem->is_scalar(), target_state_->bases, target_state_->geom_bases(), e_ref, local_pts, sol_ref, u_ref, grad_u_ref);
+				io::Evaluator::interpolate_at_local_vals(*(target_state_->mesh), target_state_->problem->is_scalar(), target_state_->bases(), target_state_->geom_bases(), e_ref, local_pts, sol_ref, u_ref, grad_u_ref);
 
 				for (int q = 0; q < u.rows(); q++)
 				{
@@ -76,7 +76,7 @@ namespace polyfem::solver
 
 				Eigen::MatrixXd u_ref, grad_u_ref;
 				const Eigen::MatrixXd &sol_ref = target_state_->problem->is_time_dependent() ? target_state_->diff_cached.u(params["step"].get<int>()) : target_state_->diff_cached.u(0);
-				io::Evaluator::interpolate_at_local_vals(*(target_state_->mesh), target_state_->problem->is_scalar(), target_state_->bases, target_state_->geom_bases(), e_ref, local_pts, sol_ref, u_ref, grad_u_ref);
+				io::Evaluator::interpolate_at_local_vals(*(target_state_->mesh), target_state_->problem->is_scalar(), target_state_->bases(), target_state_->geom_bases(), e_ref, local_pts, sol_ref, u_ref, grad_u_ref);
 
 				for (int q = 0; q < u.rows(); q++)
 				{
@@ -161,7 +161,7 @@ namespace polyfem::solver
 
 		std::map<int, std::vector<int>> ref_interested_body_id_to_e;
 		int ref_count = 0;
-		for (int e = 0; e < target_state_->bases.size(); ++e)
+		for (int e = 0; e < target_state_->bases().size(); ++e)
 		{
 			int body_id = target_state_->mesh->get_body_id(e);
 			if (reference_cached_body_ids.size() > 0 && reference_cached_body_ids.count(body_id) == 0)
@@ -175,7 +175,7 @@ namespace polyfem::solver
 
 		std::map<int, std::vector<int>> interested_body_id_to_e;
 		int count = 0;
-		for (int e = 0; e < state_.bases.size(); ++e)
+		for (int e = 0; e < state_.bases().size(); ++e)
 		{
 			int body_id = state_.mesh->get_body_id(e);
 			if (reference_cached_body_ids.size() > 0 && reference_cached_body_ids.count(body_id) == 0)
@@ -103,7 +103,7 @@ namespace polyfem::solver
 	{
 		for (auto state : states_)
 		{
-			const int n_elem = state->bases.size();
+			const int n_elem = state->bases().size();
 			assert(n_elem * 2 == state_variable.size());
 			state->assembler->update_lame_params(state_variable.segment(0, n_elem), state_variable.segment(n_elem, n_elem));
 		}
@@ -18,9 +18,9 @@ namespace polyfem::solver
 
 			double val = 0;
 			assembler::ElementAssemblyValues vals;
-			for (int e = 0; e < state_.bases.size(); e++)
+			for (int e = 0; e < state_.bases().size(); e++)
 			{
-				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases()[e], state_.geom_bases()[e], vals);
 				val += (vals.det.array() * vals.quadrature.weights.array()).sum() * x(e);
 			}
 			return val;
@@ -32,9 +32,9 @@ namespace polyfem::solver
 
 			gradv.setZero(x.size());
 			assembler::ElementAssemblyValues vals;
-			for (int e = 0; e < state_.bases.size(); e++)
+			for (int e = 0; e < state_.bases().size(); e++)
 			{
-				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases[e], state_.geom_bases()[e], vals);
+				state_.ass_vals_cache.compute(e, state_.mesh->is_volume(), state_.bases()[e], state_.geom_bases()[e], vals);
 				gradv(e) = (vals.det.array() * vals.quadrature.weights.array()).sum();
 			}
 		}
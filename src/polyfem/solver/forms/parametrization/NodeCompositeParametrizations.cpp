@@ -22,7 +22,7 @@ namespace polyfem::solver
     VariableToInteriorNodes::VariableToInteriorNodes(const State &state, const int volume_selection) : VariableToNodes(state)
     {
         const auto &mesh = state.mesh;
-        const auto &bases = state.bases;
+        const auto &bases = state.bases();
         const auto &gbases = state.geom_bases();
 
         std::set<int> node_ids;
@@ -46,7 +46,7 @@ namespace polyfem::solver
     VariableToBoundaryNodes::VariableToBoundaryNodes(const State &state, const int surface_selection) : VariableToNodes(state)
     {
         const auto &mesh = state.mesh;
-        const auto &bases = state.bases;
+        const auto &bases = state.bases();
         const auto &gbases = state.geom_bases();
 
         std::set<int> node_ids;
@@ -70,7 +70,7 @@ namespace polyfem::solver
     VariableToBoundaryNodesExclusive::VariableToBoundaryNodesExclusive(const State &state, const std::vector<int> &exclude_surface_selections) : VariableToNodes(state)
     {
         const auto &mesh = state.mesh;
-        const auto &bases = state.bases;
+        const auto &bases = state.bases();
         const auto &gbases = state.geom_bases();
 
         std::set<int> excluded_node_ids;
@@ -91,9 +91,14 @@ namespace polyfem
 						if (use_grad_norm)
 							f_in = grad.squaredNorm();
 
-						f = use_grad_norm ? grad.squaredNorm() : objFunc.value(x1);
+						if (use_grad_norm)
+						{
+							f = grad.squaredNorm();
+							valid = objFunc.is_step_valid(x, x1);
+						}
+						else
+							f = objFunc.value_with_validity(x, x1, valid);
 						const double Cache = c * grad.dot(searchDir);
-						valid = objFunc.is_step_valid(x, x1);
 
 						// max_step_size should return a collision free step
 						// assert(objFunc.is_step_collision_free(x, x1));
@@ -112,11 +117,10 @@ namespace polyfem
 							{
 								objFunc.gradient(x1, grad);
 								f = grad.squaredNorm();
+								valid = objFunc.is_step_valid(x, x1);
 							}
 							else
-								f = objFunc.value(x1);
-
-							valid = objFunc.is_step_valid(x, x1);
+								f = objFunc.value_with_validity(x, x1, valid);
 
 							// max_step_size should return a collision free step
 							// assert(objFunc.is_step_collision_free(x, x1));
@@ -168,11 +168,10 @@ namespace polyfem
 						{
 							objFunc.gradient(new_x, grad);
 							cur_energy = grad.squaredNorm();
+							is_step_valid = objFunc.is_step_valid(x, new_x);
 						}
 						else
-							cur_energy = objFunc.value(new_x);
-
-						is_step_valid = objFunc.is_step_valid(x, new_x);
+							cur_energy = objFunc.value_with_validity(x, new_x, is_step_valid);
 
 						logger().trace("ls it: {} delta: {} invalid: {} ", this->cur_iter, (cur_energy - old_energy), !is_step_valid);
 
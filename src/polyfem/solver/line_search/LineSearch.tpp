@@ -102,8 +102,8 @@ namespace polyfem
 				{
 					// Compute the new energy value without contacts
 					// TODO: removed only elastic
-					const double energy = objFunc.value(new_x);
-					const bool is_step_valid = objFunc.is_step_valid(x, new_x);
+					bool is_step_valid;
+					const double energy = objFunc.value_with_validity(x, new_x, is_step_valid);
 
 					if (!std::isfinite(energy) || !is_step_valid)
 					{
@@ -0,0 +1,148 @@
+#include "BatchRunner.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/Profiler.hpp>
+#include <polyfem/utils/par_for.hpp>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <thread>
+
+namespace polyfem
+{
+	BatchRunner::BatchRunner(const size_t max_threads, const spdlog::level::level_enum log_level, const bool profile)
+		: log_level_(log_level), profile_(profile)
+	{
+		n_threads_ = std::max<size_t>(1, std::min<size_t>(max_threads, std::thread::hardware_concurrency()));
+	}
+
+	int BatchRunner::add(const json &args, const bool strict_validation)
+	{
+		Run r;
+		r.args = args;
+		r.strict_validation = strict_validation;
+		runs_.push_back(std::move(r));
+
+		return runs_.size() - 1;
+	}
+
+	std::string BatchRunner::discretization_key(const State &state)
+	{
+		json key = json::object();
+		key["geometry"] = state.args["geometry"];
+		key["space"] = state.args["space"];
+		key["units"] = state.args["units"];
+		key["root_path"] = state.args["root_path"];
+		key["formulation"] = state.formulation();
+		key["optimization"] = state.optimization_enabled;
+		return key.dump();
+	}
+
+	int BatchRunner::run(const SolvedCallback &solved)
+	{
+		// the process wide settings are set once for the batch, the states leave them untouched
+		State::init_logger("", log_level_, false);
+		utils::Profiler::get().set_enabled(profile_);
+		utils::NThread::get().num_threads = n_threads_;
+		// the runs are the unit of parallelism, the dense linear algebra of each run is serial
+		Eigen::setNbThreads(1);
+
+		for (Run &r : runs_)
+		{
+			r.succeeded = false;
+			r.state = std::make_shared<State>();
+			r.state->set_global_settings = false;
+			try
+			{
+				r.state->init(r.args, r.strict_validation);
+			}
+			catch (const std::exception &e)
+			{
+				logger().error("Unable to initialize run {}: {}", &r - runs_.data(), e.what());
+				r.state = nullptr;
+			}
+		}
+
+		// the first run of each group builds the discretization, the others reuse it
+		std::vector<std::vector<int>> groups;
+		{
+			std::map<std::string, int> key_to_group;
+			for (int i = 0; i < runs_.size(); ++i)
+			{
+				if (runs_[i].state == nullptr)
+					continue;
+
+				const auto it = key_to_group.emplace(discretization_key(*runs_[i].state), groups.size()).first;
+				if (it->second == groups.size())
+					groups.emplace_back();
+				groups[it->second].push_back(i);
+			}
+		}
+		logger().info("Running {} simulations with {} discretizations on {} threads", runs_.size(), groups.size(), n_threads_);
+
+		const auto solve_group = [&](const std::vector<int> &group) {
+			Run &first = runs_[group.front()];
+			solve(first, nullptr, solved);
+			const State *source = first.succeeded ? first.state.get() : nullptr;
+
+#ifdef POLYFEM_WITH_TBB
+			tbb::parallel_for(size_t(1), group.size(), [&](const size_t i) { solve(runs_[group[i]], source, solved); });
+#else
+			for (size_t i = 1; i < group.size(); ++i)
+				solve(runs_[group[i]], source, solved);
+#endif
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::global_control limiter(tbb::global_control::max_allowed_parallelism, n_threads_);
+		tbb::task_arena arena(n_threads_);
+		arena.execute([&]() {
+			tbb::parallel_for(size_t(0), groups.size(), [&](const size_t g) { solve_group(groups[g]); });
+		});
+#else
+		for (const auto &group : groups)
+			solve_group(group);
+#endif
+
+		return std::count_if(runs_.begin(), runs_.end(), [](const Run &r) { return !r.succeeded; });
+	}
+
+	void BatchRunner::solve(Run &run, const State *source, const SolvedCallback &solved) const
+	{
+		State &state = *run.state;
+		try
+		{
+			if (source != nullptr)
+				state.share_discretization(*source);
+
+			state.load_mesh();
+			if (state.mesh == nullptr)
+				return;
+
+			state.stats.compute_mesh_stats(*state.mesh);
+
+			state.build_basis();
+			state.assemble_rhs();
+			state.assemble_mass_mat();
+
+			Eigen::MatrixXd sol, pressure;
+			state.solve_problem(sol, pressure);
+
+			run.succeeded = true;
+
+			if (solved)
+				solved(state, sol, pressure);
+		}
+		catch (const std::exception &e)
+		{
+			logger().error("Run {} failed: {}", &run - runs_.data(), e.what());
+			run.succeeded = false;
+		}
+	}
+} // namespace polyfem
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <polyfem/State.hpp>
+
+#include <Eigen/Dense>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	/// @brief Runs many forward simulations (e.g., material parameter sweeps) in one process.
+	///
+	/// All the runs are scheduled on a single thread pool (one TBB arena with work stealing) instead of
+	/// one thread limiter per State. Runs with the same geometry and space (see discretization_key) build
+	/// the bases and the assembly values once: the first run of each group builds them and the other runs
+	/// of the group reuse them with State::share_discretization. Materials, boundary conditions, and
+	/// the rest of the problem can differ between runs of the same group.
+	/// The process wide settings (threads, logger, and profiler) are set once by run, the ones of the input
+	/// jsons (solver/max_threads, output/log, output/advanced/profile) are ignored.
+	class BatchRunner
+	{
+	public:
+		/// callback called after each successful solve, it can be called concurrently from different threads
+		typedef std::function<void(State &state, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure)> SolvedCallback;
+
+		/// @param[in] max_threads total number of threads used by all the runs
+		/// @param[in] log_level level of the (stdout) logger shared by the runs
+		/// @param[in] profile enables the profiler
+		BatchRunner(const size_t max_threads = std::numeric_limits<size_t>::max(), const spdlog::level::level_enum log_level = spdlog::level::info, const bool profile = false);
+
+		/// @brief Adds a run
+		/// @param[in] args input json of the run (as for State::init)
+		/// @param[in] strict_validation strict validation of the input json
+		/// @return index of the run
+		int add(const json &args, const bool strict_validation = true);
+
+		/// @brief Initializes, discretizes, and solves all the runs
+		/// @param[in] solved callback called after each successful solve (e.g., to export the results)
+		/// @return number of runs which failed
+		int run(const SolvedCallback &solved = nullptr);
+
+		/// @brief Key of the discretization of a initialized state, runs with the same key are grouped
+		/// and share their bases if their meshes match (see State::share_discretization)
+		/// @param[in] state initialized state
+		/// @return key
+		static std::string discretization_key(const State &state);
+
+		int size() const { return runs_.size(); }
+		State &state(const int i) { return *runs_[i].state; }
+		const State &state(const int i) const { return *runs_[i].state; }
+		bool succeeded(const int i) const { return runs_[i].succeeded; }
+
+	private:
+		struct Run
+		{
+			json args;
+			bool strict_validation;
+
+			std::shared_ptr<State> state;
+			bool succeeded = false;
+		};
+
+		/// loads the mesh, builds (or reuses) the discretization, and solves one run
+		void solve(Run &run, const State *source, const SolvedCallback &solved) const;
+
+		std::vector<Run> runs_;
+		unsigned int n_threads_;
+		spdlog::level::level_enum log_level_;
+		bool profile_;
+	};
+} // namespace polyfem
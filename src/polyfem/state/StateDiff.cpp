@@ -6,6 +6,7 @@
 
 #include <polyfem/utils/BoundarySampler.hpp>
 #include <polysolve/FEMSolver.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 #include <polyfem/io/Evaluator.hpp>
@@ -62,6 +63,62 @@ namespace polyfem
 			}
 			reduced_mat.setFromTriplets(coeffs.begin(), coeffs.end());
 		}
+
+		/// Solver of a sequence of adjoint systems with several right-hand sides each.
+		/// The symbolic analysis is only redone when the sparsity pattern of the matrix changes.
+		class AdjointSolver
+		{
+		public:
+			AdjointSolver(const json &linear_args)
+				: solver_(polysolve::LinearSolver::create(linear_args["adjoint_solver"], linear_args["precond"]))
+			{
+				solver_->setParameters(linear_args);
+			}
+
+			void factorize(const StiffnessMatrix &A)
+			{
+				if (!utils::has_sparsity_pattern(A, rows_, outer_, inner_))
+				{
+					solver_->analyzePattern(A, A.rows());
+					++n_analyses_;
+
+					rows_ = A.rows();
+					utils::sparsity_pattern(A, outer_, inner_);
+				}
+
+				solver_->factorize(A);
+				++n_factorizations_;
+			}
+
+			/// Solve all the columns of b with the last factorization, the zero columns are not solved
+			void solve(const Eigen::MatrixXd &b, Eigen::MatrixXd &x) const
+			{
+				x.setZero(b.rows(), b.cols());
+				Eigen::VectorXd xi;
+				for (int i = 0; i < b.cols(); ++i)
+				{
+					if (b.col(i).isZero(0))
+						continue;
+
+					xi.setZero(b.rows());
+					solver_->solve(b.col(i), xi);
+					x.col(i) = xi;
+				}
+			}
+
+			int n_analyses() const { return n_analyses_; }
+			int n_factorizations() const { return n_factorizations_; }
+
+		private:
+			std::unique_ptr<polysolve::LinearSolver> solver_;
+
+			int rows_ = -1;
+			std::vector<StiffnessMatrix::StorageIndex> outer_;
+			std::vector<StiffnessMatrix::StorageIndex> inner_;
+
+			int n_analyses_ = 0;
+			int n_factorizations_ = 0;
+		};
 	} // namespace
 
 	void State::get_vertices(Eigen::MatrixXd &vertices) const
@@ -93,13 +150,21 @@ namespace polyfem
 	{
 		assert(vertex.size() == mesh->dimension());
 		mesh->set_point(v_id, vertex);
+		out_geom.invalidate_volume_vis_cache();
 	}
 
 	void State::cache_transient_adjoint_quantities(const int current_step, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad)
 	{
 		StiffnessMatrix gradu_h(sol.size(), sol.size());
 		if (current_step == 0)
-			diff_cached.init(ndof(), problem->is_time_dependent() ? args["time"]["time_steps"].get<int>() : 0);
+		{
+			// negative: no limit, the jacobians over the budget are written to disk until the adjoint solve
+			const double max_memory = args["solver"]["advanced"]["adjoint_jacobian_memory"].get<double>();
+			diff_cached.init(
+				ndof(), problem->is_time_dependent() ? args["time"]["time_steps"].get<int>() : 0,
+				max_memory < 0 ? -1 : max_memory * 1024 * 1024,
+				resolve_output_path(args["solver"]["advanced"]["adjoint_jacobian_dir"]));
+		}
 		if (!problem->is_time_dependent() || current_step > 0)
 			compute_force_jacobian(sol, disp_grad, gradu_h);
 
@@ -277,7 +342,7 @@ namespace polyfem
 				{
 					utils::SparseMatrixCache mat_cache;
 					StiffnessMatrix damping_hessian_prev(u.size(), u.size());
-					damping_prev_assembler->assemble_hessian(mesh->is_volume(), n_bases, false, bases, geom_bases(), ass_vals_cache, dt, u, u_prev, mat_cache, damping_hessian_prev);
+					damping_prev_assembler->assemble_hessian(mesh->is_volume(), n_bases, false, bases(), geom_bases(), ass_vals_cache, dt, u, u_prev, mat_cache, damping_hessian_prev);
 
 					hessian_prev += damping_hessian_prev;
 				}
@@ -313,16 +378,17 @@ namespace polyfem
 		adjoint.setZero(ndof(), adjoint_rhs.cols());
 		if (lin_solver_cached)
 		{
+			// linear problem: reuse the factorization of the forward solve
 			for (int i : boundary_nodes)
 				b.row(i).setZero();
 
-			StiffnessMatrix A = diff_cached.gradu_h(0);
-			const int full_size = A.rows();
-			const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
-			int precond_num = problem_dim * n_bases;
-
+			const StiffnessMatrix &A = diff_cached.gradu_h(0);
 			for (int i = 0; i < b.cols(); i++)
 			{
+				// the adjoint of an objective independent of the solution is zero
+				if (b.col(i).isZero(0))
+					continue;
+
 				Eigen::VectorXd x, tmp;
 				tmp = b.col(i);
 				dirichlet_solve_prefactorized(*lin_solver_cached, A, tmp, boundary_nodes, x);
@@ -331,43 +397,16 @@ namespace polyfem
 		}
 		else
 		{
-			auto solver = polysolve::LinearSolver::create(args["solver"]["linear"]["adjoint_solver"], args["solver"]["linear"]["precond"]);
-			solver->setParameters(args["solver"]["linear"]);
+			AdjointSolver solver(args["solver"]["linear"]);
+			solver.factorize(diff_cached.gradu_h(0));
 
-			StiffnessMatrix A = diff_cached.gradu_h(0);
-			solver->analyzePattern(A, A.rows());
-			solver->factorize(A);
-
-			if (true) // (disp_grad_.size() == 0)
-			{
-				for (int i = 0; i < b.cols(); i++)
-				{
-					Eigen::MatrixXd tmp = b.col(i);
-
-					Eigen::VectorXd x;
-					x.setZero(tmp.size());
-					solver->solve(tmp, x);
-
-					adjoint.col(i) = solve_data.nl_problem->reduced_to_full(x);
-				}
-				// NLProblem sets dirichlet values to forward BC values, but we want zero in adjoint
-				adjoint(boundary_nodes, Eigen::all).setZero();
-			}
-			else
-			{
-				adjoint.setZero(adjoint_rhs.rows(), adjoint_rhs.cols());
-				for (int i = 0; i < b.cols(); i++)
-				{
-					Eigen::MatrixXd tmp = b.col(i);
-
-					Eigen::VectorXd x;
-					x.setZero(tmp.size());
-					solver->solve(tmp, x);
-					x.conservativeResize(adjoint.rows());
+			Eigen::MatrixXd x;
+			solver.solve(b, x);
+			for (int i = 0; i < b.cols(); i++)
+				adjoint.col(i) = solve_data.nl_problem->reduced_to_full(x.col(i));
 
-					adjoint.col(i) = x;
-				}
-			}
+			// NLProblem sets dirichlet values to forward BC values, but we want zero in adjoint
+			adjoint(boundary_nodes, Eigen::all).setZero();
 		}
 
 		return adjoint;
@@ -398,6 +437,9 @@ namespace polyfem
 		StiffnessMatrix reduced_mass;
 		replace_rows_by_identity(reduced_mass, mass, boundary_nodes);
 
+		// the pattern of the jacobians only changes with the contact set, share the symbolic analysis across the steps
+		AdjointSolver solver(args["solver"]["linear"]);
+
 		Eigen::MatrixXd sum_alpha_p, sum_alpha_nu;
 		for (int i = time_steps; i >= 0; --i)
 		{
@@ -435,15 +477,15 @@ namespace polyfem
 				rhs_ += (1. / beta_dt) * (diff_cached.gradu_h(i) - reduced_mass).transpose() * sum_alpha_p;
 
 				{
-					StiffnessMatrix A = diff_cached.gradu_h(i).transpose();
-					Eigen::VectorXd b_ = rhs_;
-					b_(boundary_nodes).setZero();
-
-					auto solver = polysolve::LinearSolver::create(args["solver"]["linear"]["adjoint_solver"], args["solver"]["linear"]["precond"]);
-					solver->setParameters(args["solver"]["linear"]);
-
-					Eigen::VectorXd x;
-					dirichlet_solve(*solver, A, b_, boundary_nodes, x, A.rows(), "", false, false, false);
+					// the dirichlet columns of the transposed jacobian are already identity, the right-hand side is zero on them
+					StiffnessMatrix A;
+					replace_rows_by_identity(A, diff_cached.gradu_h(i).transpose(), boundary_nodes);
+					Eigen::MatrixXd b_ = rhs_;
+					b_(boundary_nodes, 0).setZero();
+
+					Eigen::MatrixXd x;
+					solver.factorize(A);
+					solver.solve(b_, x);
 					adjoints.col(i + cols_per_adjoint) = x;
 				}
 
@@ -464,6 +506,8 @@ namespace polyfem
 				adjoints.col(i + cols_per_adjoint) = rhs_; // adjoint_nu[0] actually stores adjoint_mu[0]
 			}
 		}
+		logger().debug("Transient adjoint: {} factorizations, {} symbolic analyses", solver.n_factorizations(), solver.n_analyses());
+
 		return adjoints;
 	}
 
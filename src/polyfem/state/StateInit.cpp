@@ -10,6 +10,7 @@
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/problem/KernelProblem.hpp>
 #include <polyfem/utils/par_for.hpp>
+#include <polyfem/utils/Profiler.hpp>
 
 #include <polysolve/LinearSolver.hpp>
 
@@ -289,13 +290,24 @@ namespace polyfem
 			out_path_log = resolve_output_path(out_path_log);
 		}
 
-		spdlog::level::level_enum log_level = this->args["output"]["log"]["level"];
-		init_logger(out_path_log, log_level, this->args["output"]["log"]["quiet"]);
+		if (set_global_settings)
+		{
+			spdlog::level::level_enum log_level = this->args["output"]["log"]["level"];
+			init_logger(out_path_log, log_level, this->args["output"]["log"]["quiet"]);
+		}
 
 		logger().info("Saving output to {}", output_dir);
 
-		const unsigned int thread_in = this->args["solver"]["max_threads"];
-		set_max_threads(thread_in <= 0 ? std::numeric_limits<unsigned int>::max() : thread_in);
+		if (set_global_settings)
+		{
+			const bool chrome_trace = !this->args["output"]["advanced"]["chrome_trace"].get<std::string>().empty();
+			utils::Profiler::get().set_enabled(
+				this->args["output"]["advanced"]["profile"].get<bool>() || chrome_trace, chrome_trace,
+				this->args["output"]["advanced"]["profile_memory"].get<bool>());
+
+			const unsigned int thread_in = this->args["solver"]["max_threads"];
+			set_max_threads(thread_in <= 0 ? std::numeric_limits<unsigned int>::max() : thread_in);
+		}
 
 		has_dhat = args_in["contact"].contains("dhat");
 
@@ -415,7 +427,17 @@ namespace polyfem
 		if (!is_param_valid(args, "time"))
 			return;
 
-		const double t0 = Units::convert(args["time"]["t0"], units.time());
+		double t0 = Units::convert(args["time"]["t0"], units.time());
+
+		// a restart from a trajectory starts at the time of the stored step
+		const std::string trajectory_path = resolve_input_path(args["input"]["data"]["trajectory"]);
+		if (!trajectory_path.empty())
+		{
+			if (!io::HDF5Trajectory::read_time(trajectory_path, args["input"]["data"]["trajectory_step"], t0))
+				log_and_throw_error("Unable to read the initial time from the trajectory ({})!", trajectory_path);
+			args["time"]["t0"] = t0;
+		}
+
 		double tend, dt;
 		int time_steps;
 
@@ -11,6 +11,7 @@
 #include <polyfem/utils/Selection.hpp>
 
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/utils/Timer.hpp>
 
 #include <igl/Timer.h>
 namespace polyfem
@@ -21,9 +22,15 @@ namespace polyfem
 
 	void State::reset_mesh()
 	{
-		bases.clear();
-		pressure_bases.clear();
-		geom_bases_.clear();
+		// new vectors, the previous ones can be shared with other states
+		bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		pressure_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		geom_bases_ = std::make_shared<std::vector<basis::ElementBases>>();
+		// the element to dof maps are identified by the address of the bases
+		ass_vals_cache.clear();
+		mass_ass_vals_cache.clear();
+		pressure_ass_vals_cache.clear();
+		out_geom.invalidate_volume_vis_cache();
 		boundary_nodes.clear();
 		local_boundary.clear();
 		local_neumann_boundary.clear();
@@ -42,6 +49,7 @@ namespace polyfem
 	{
 		reset_mesh();
 
+		POLYFEM_SCOPED_TIMER("Load mesh");
 		igl::Timer timer;
 		timer.start();
 		logger().info("Loading mesh...");
@@ -98,6 +106,7 @@ namespace polyfem
 
 		reset_mesh();
 
+		POLYFEM_SCOPED_TIMER("Load mesh");
 		igl::Timer timer;
 		timer.start();
 
@@ -157,16 +166,16 @@ namespace polyfem
 
 	void State::build_mesh_matrices(Eigen::MatrixXd &V, Eigen::MatrixXi &F)
 	{
-		assert(bases.size() == mesh->n_elements());
+		assert(bases().size() == mesh->n_elements());
 		const size_t n_vertices = n_bases - obstacle.n_vertices();
 		const int dim = mesh->dimension();
 
 		V.resize(n_vertices, dim);
-		F.resize(bases.size(), dim + 1); // TODO: this only works for triangles and tetrahedra
+		F.resize(bases().size(), dim + 1); // TODO: this only works for triangles and tetrahedra
 
-		for (int i = 0; i < bases.size(); i++)
+		for (int i = 0; i < bases().size(); i++)
 		{
-			const basis::ElementBases &element = bases[i];
+			const basis::ElementBases &element = bases()[i];
 			for (int j = 0; j < element.bases.size(); j++)
 			{
 				const basis::Basis &basis = element.bases[j];
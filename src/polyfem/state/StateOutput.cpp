@@ -1,5 +1,7 @@
 #include <polyfem/State.hpp>
 
+#include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
+
 #include <polyfem/utils/JSONUtils.hpp>
 #include <polyfem/utils/Timer.hpp>
 
@@ -19,7 +21,7 @@ namespace polyfem
 			tend = args["time"]["tend"];
 		}
 
-		stats.compute_errors(n_bases, bases, geom_bases(), *mesh, *problem, tend, sol);
+		stats.compute_errors(n_bases, bases(), geom_bases(), *mesh, *problem, tend, sol);
 	}
 
 	std::string State::root_path() const
@@ -173,6 +175,10 @@ namespace polyfem
 			stress_path,
 			mises_path,
 			is_contact_enabled(), solution_frames);
+
+		const std::string chrome_trace_path = args["output"]["advanced"]["chrome_trace"];
+		if (!chrome_trace_path.empty())
+			utils::Profiler::get().save_chrome_trace(resolve_output_path(chrome_trace_path));
 	}
 
 	void State::save_restart_json(const double t0, const double dt, const int t) const
@@ -240,16 +246,76 @@ namespace polyfem
 			restart_json["patch"] = patch;
 		}
 
-		restart_json["input"] = {{
-			"data",
+		const std::string trajectory_path = args["output"]["data"]["trajectory"];
+		if (!trajectory_path.empty())
+		{
+			// the step is stored in the trajectory, the restart reads it from there
+			restart_json["input"] = {{
+				"data",
+				{
+					{"trajectory", resolve_output_path(trajectory_path)},
+					{"trajectory_step", t},
+				},
+			}};
+		}
+		else
+		{
+			restart_json["input"] = {{
+				"data",
+				{
+					{"u_path", resolve_output_path(fmt::format(args["output"]["data"]["u_path"], t))},
+					{"v_path", resolve_output_path(fmt::format(args["output"]["data"]["v_path"], t))},
+					{"a_path", resolve_output_path(fmt::format(args["output"]["data"]["a_path"], t))},
+				},
+			}};
+		}
+
+		const auto write = [path = resolve_output_path(fmt::format(restart_json_path, t)), restart_json = std::move(restart_json)]() {
+			std::ofstream file(path);
+			file << restart_json;
+		};
+		if (output_writer)
+			output_writer->push(write);
+		else
+			write();
+	}
+
+	void State::save_trajectory(const double time, const int t, const time_integrator::ImplicitTimeIntegrator &time_integrator)
+	{
+		const std::string trajectory_path = args["output"]["data"]["trajectory"];
+		if (trajectory_path.empty())
+			return;
+
+		if (t == 0 || trajectory == nullptr)
+		{
+			const std::string path = resolve_output_path(trajectory_path);
+			const std::string input_path = resolve_input_path(args["input"]["data"]["trajectory"]);
+
+			// restarting from this trajectory: the steps up to the restart one are kept and the next ones appended
+			int n_kept_steps = 0;
+			if (!input_path.empty() && std::filesystem::exists(input_path) && std::filesystem::exists(path)
+				&& std::filesystem::equivalent(input_path, path))
 			{
-				{"u_path", resolve_output_path(fmt::format(args["output"]["data"]["u_path"], t))},
-				{"v_path", resolve_output_path(fmt::format(args["output"]["data"]["v_path"], t))},
-				{"a_path", resolve_output_path(fmt::format(args["output"]["data"]["a_path"], t))},
-			},
-		}};
-
-		std::ofstream file(resolve_output_path(fmt::format(restart_json_path, t)));
-		file << restart_json;
+				const int step = args["input"]["data"]["trajectory_step"];
+				n_kept_steps = (step < 0 ? io::HDF5Trajectory::n_steps(path) + step : step) + 1;
+			}
+
+			trajectory = std::make_shared<io::HDF5Trajectory>(
+				path, args["output"]["data"]["advanced"]["trajectory_compression"].get<int>(), n_kept_steps);
+
+			// the restart step is the last kept one
+			if (n_kept_steps > 0 && t == 0)
+				return;
+		}
+
+		// the integrator keeps its history, hence the snapshot is a copy
+		const auto append = [trajectory = trajectory, time,
+							 u = time_integrator.x_prev(), v = time_integrator.v_prev(), a = time_integrator.a_prev()]() {
+			trajectory->append(time, u, v, a);
+		};
+		if (output_writer)
+			output_writer->push(append);
+		else
+			append();
 	}
 } // namespace polyfem
@@ -1,5 +1,6 @@
 #include <polyfem/State.hpp>
 
+#include <polyfem/io/HDF5Trajectory.hpp>
 #include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/utils/Timer.hpp>
 
@@ -9,6 +10,17 @@ namespace polyfem
 	using namespace io;
 	using namespace utils;
 
+	namespace
+	{
+		/// reads an initial field from the input trajectory if any, otherwise from its own file
+		bool read_initial_data(const json &input_data, const std::string &trajectory_path, const std::string &field, const std::string &in_path, Eigen::MatrixXd &data)
+		{
+			if (!trajectory_path.empty())
+				return HDF5Trajectory::read_step(trajectory_path, field, input_data["trajectory_step"], data);
+			return read_matrix(in_path, data);
+		}
+	} // namespace
+
 	void State::init_solve(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
 	{
 		POLYFEM_SCOPED_TIMER("Setup RHS");
@@ -37,11 +49,12 @@ namespace polyfem
 	void State::initial_solution(Eigen::MatrixXd &solution) const
 	{
 		assert(solve_data.rhs_assembler != nullptr);
+		const std::string trajectory_path = resolve_input_path(args["input"]["data"]["trajectory"]);
 		const std::string in_path = resolve_input_path(args["input"]["data"]["u_path"]);
-		if (!in_path.empty())
+		if (!trajectory_path.empty() || !in_path.empty())
 		{
-			if (!read_matrix(in_path, solution))
-				log_and_throw_error("Unable to read initial solution from file ({})!", in_path);
+			if (!read_initial_data(args["input"]["data"], trajectory_path, "u", in_path, solution))
+				log_and_throw_error("Unable to read initial solution from file ({})!", trajectory_path.empty() ? in_path : trajectory_path);
 			assert(solution.cols() == 1);
 			if (args["input"]["data"]["reorder"].get<bool>())
 			{
@@ -66,11 +79,12 @@ namespace polyfem
 	void State::initial_velocity(Eigen::MatrixXd &velocity) const
 	{
 		assert(solve_data.rhs_assembler != nullptr);
+		const std::string trajectory_path = resolve_input_path(args["input"]["data"]["trajectory"]);
 		const std::string in_path = resolve_input_path(args["input"]["data"]["v_path"]);
-		if (!in_path.empty())
+		if (!trajectory_path.empty() || !in_path.empty())
 		{
-			if (!read_matrix(in_path, velocity))
-				log_and_throw_error("Unable to read initial velocity from file ({})!", in_path);
+			if (!read_initial_data(args["input"]["data"], trajectory_path, "v", in_path, velocity))
+				log_and_throw_error("Unable to read initial velocity from file ({})!", trajectory_path.empty() ? in_path : trajectory_path);
 			assert(velocity.cols() == 1);
 			if (args["input"]["data"]["reorder"].get<bool>())
 			{
@@ -87,11 +101,12 @@ namespace polyfem
 	void State::initial_acceleration(Eigen::MatrixXd &acceleration) const
 	{
 		assert(solve_data.rhs_assembler != nullptr);
+		const std::string trajectory_path = resolve_input_path(args["input"]["data"]["trajectory"]);
 		const std::string in_path = resolve_input_path(args["input"]["data"]["a_path"]);
-		if (!in_path.empty())
+		if (!trajectory_path.empty() || !in_path.empty())
 		{
-			if (!read_matrix(in_path, acceleration))
-				log_and_throw_error("Unable to read initial acceleration from file ({})!", in_path);
+			if (!read_initial_data(args["input"]["data"], trajectory_path, "a", in_path, acceleration))
+				log_and_throw_error("Unable to read initial acceleration from file ({})!", trajectory_path.empty() ? in_path : trajectory_path);
 			if (args["input"]["data"]["reorder"].get<bool>())
 			{
 				assert(acceleration.cols() == 1);
@@ -9,6 +9,7 @@
 #include <polyfem/solver/forms/BodyForm.hpp>
 #include <polyfem/solver/forms/ElasticForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
+#include <polyfem/solver/FactorizationCache.hpp>
 #include <polysolve/FEMSolver.hpp>
 
 #include <polyfem/utils/Timer.hpp>
@@ -34,9 +35,9 @@ namespace polyfem
 		{
 
 			StiffnessMatrix velocity_stiffness, mixed_stiffness, pressure_stiffness;
-			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, velocity_stiffness);
-			mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases, bases, geom_bases(), pressure_ass_vals_cache, ass_vals_cache, mixed_stiffness);
-			pressure_assembler->assemble(mesh->is_volume(), n_pressure_bases, pressure_bases, geom_bases(), pressure_ass_vals_cache, pressure_stiffness);
+			assembler->assemble(mesh->is_volume(), n_bases, bases(), geom_bases(), ass_vals_cache, velocity_stiffness);
+			mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases(), bases(), geom_bases(), pressure_ass_vals_cache, ass_vals_cache, mixed_stiffness);
+			pressure_assembler->assemble(mesh->is_volume(), n_pressure_bases, pressure_bases(), geom_bases(), pressure_ass_vals_cache, pressure_stiffness);
 
 			const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
 
@@ -46,7 +47,7 @@ namespace polyfem
 		}
 		else
 		{
-			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, stiffness);
+			assembler->assemble(mesh->is_volume(), n_bases, bases(), geom_bases(), ass_vals_cache, stiffness);
 		}
 
 		timer.stop();
@@ -105,6 +106,34 @@ namespace polyfem
 			sol_to_pressure(sol, pressure);
 	}
 
+	void State::solve_linear_prefactorized(
+		const std::unique_ptr<polysolve::LinearSolver> &solver,
+		const FactorizationCache &factorization,
+		const Eigen::VectorXd &b,
+		Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
+	{
+		assert(assembler->is_linear() && !is_contact_enabled());
+
+		Eigen::VectorXd x;
+		factorization.solve(*solver, b, x);
+		sol = x;
+
+		solver->getInfo(stats.solver_info);
+
+		// residual of the system with the Dirichlet rows replaced by the identity
+		Eigen::VectorXd residual = factorization.matrix() * x - b;
+		for (int i : boundary_nodes)
+			residual[i] = x[i] - b[i];
+		const auto error = residual.norm();
+		if (error > 1e-4)
+			logger().error("Solver error: {}", error);
+		else
+			logger().debug("Solver error: {}", error);
+
+		if (mixed_assembler != nullptr)
+			sol_to_pressure(sol, pressure);
+	}
+
 	void State::solve_linear(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure)
 	{
 		assert(!problem->is_time_dependent());
@@ -145,7 +174,7 @@ namespace polyfem
 		const int ndof = n_bases * mesh->dimension();
 
 		solve_data.elastic_form = std::make_shared<ElasticForm>(
-			n_bases, bases, geom_bases(),
+			n_bases, bases(), geom_bases(),
 			*assembler, ass_vals_cache,
 			problem->is_time_dependent() ? args["time"]["dt"].get<double>() : 0.0,
 			mesh->is_volume());
@@ -221,6 +250,8 @@ namespace polyfem
 			time_integrator->init(sol, velocity, acceleration, dt);
 		}
 
+		save_trajectory(t0, 0, *time_integrator);
+
 		// --------------------------------------------------------------------
 
 		const int n_b_samples = n_boundary_samples();
@@ -236,13 +267,21 @@ namespace polyfem
 		StiffnessMatrix stiffness;
 		build_stiffness_mat(stiffness);
 
+		// The system matrix only depends on the time integrator coefficient (which changes while the
+		// BDF order ramps up or if dt changes) and on the Dirichlet nodes, hence it is factorized once
+		// per (coefficient, Dirichlet nodes) and reused by the following steps.
+		// Mixed problems may add a pressure constraint in dirichlet_solve and are always refactorized.
+		const bool reuse_factorization = mixed_assembler == nullptr;
+		FactorizationCache factorization(
+			(problem->is_scalar() ? 1 : mesh->dimension()) * n_bases, args["output"]["data"]["stiffness_mat"]);
+
 		// --------------------------------------------------------------------
 
 		for (int t = 1; t <= time_steps; ++t)
 		{
 			const double time = t0 + t * dt;
 
-			StiffnessMatrix A;
+			double coeff;
 			Eigen::VectorXd b;
 			bool compute_spectrum = args["output"]["advanced"]["spectrum"];
 
@@ -267,7 +306,7 @@ namespace polyfem
 				}
 
 				std::shared_ptr<BDF> bdf = std::dynamic_pointer_cast<BDF>(time_integrator);
-				A = mass / bdf->beta_dt() + stiffness;
+				coeff = bdf->beta_dt();
 				b = (mass * bdf->weighted_sum_x_prevs()) / bdf->beta_dt();
 				for (int i : boundary_nodes)
 					b[i] = 0;
@@ -290,13 +329,33 @@ namespace polyfem
 				solve_data.rhs_assembler->set_bc(
 					local_boundary, boundary_nodes, n_b_samples, std::vector<LocalBoundary>(), current_rhs, sol, time);
 
-				A = stiffness * time_integrator->acceleration_scaling() + mass;
+				coeff = time_integrator->acceleration_scaling();
 				b = current_rhs;
 
 				compute_spectrum &= t == 1;
 			}
 
-			solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+			const auto build_system_matrix = [&](StiffnessMatrix &A) {
+				if (is_scalar_or_mixed)
+					A = mass / coeff + stiffness;
+				else
+					A = stiffness * coeff + mass;
+			};
+
+			if (reuse_factorization && !compute_spectrum)
+			{
+				factorization.update(*solver, coeff, boundary_nodes, build_system_matrix);
+				solve_linear_prefactorized(solver, factorization, b, sol, pressure);
+			}
+			else
+			{
+				StiffnessMatrix A;
+				build_system_matrix(A);
+				solve_linear(solver, A, b, compute_spectrum, sol, pressure);
+
+				// the solver now holds the factorization of another matrix
+				factorization.invalidate();
+			}
 
 			if (optimization_enabled)
 			{
@@ -307,8 +366,10 @@ namespace polyfem
 			time_integrator->update_quantities(sol);
 
 			save_timestep(time, t, t0, dt, sol, pressure);
+			save_trajectory(time, t, *time_integrator);
 			logger().info("{}/{}  t={}", t, time_steps, time);
 		}
+		trajectory = nullptr;
 
 		time_integrator->save_raw(
 			resolve_output_path(args["output"]["data"]["u_path"]),
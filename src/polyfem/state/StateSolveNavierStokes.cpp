@@ -32,7 +32,7 @@ namespace polyfem
 		Eigen::VectorXd x;
 		solver::NavierStokesSolver ns_solver(args["solver"]);
 		ns_solver.minimize(n_bases, n_pressure_bases,
-						   bases, pressure_bases,
+						   bases(), pressure_bases(),
 						   geom_bases(),
 						   *velocity_stokes_assembler,
 						   *dynamic_cast<assembler::NavierStokesVelocity *>(assembler.get()),
@@ -81,7 +81,7 @@ namespace polyfem
 		}
 
 		const int dim = mesh->dimension();
-		const int n_el = int(bases.size());       // number of elements
+		const int n_el = int(bases().size());     // number of elements
 		const int shape = gbases[0].bases.size(); // number of geometry vertices in an element
 		
 		double viscosity_ = std::dynamic_pointer_cast<assembler::OperatorSplitting>(assembler)->viscosity();
@@ -94,18 +94,18 @@ namespace polyfem
 		// coefficient matrix of viscosity
 		assembler::Laplacian lapl_assembler;
 		lapl_assembler.set_size(1);
-		lapl_assembler.assemble(mesh->is_volume(), n_bases, bases, gbases, ass_vals_cache, stiffness_viscosity);
+		lapl_assembler.assemble(mesh->is_volume(), n_bases, bases(), gbases, ass_vals_cache, stiffness_viscosity);
 		mass_matrix_assembler->set_size(1);
-		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, mass_ass_vals_cache, mass, true);
+		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases(), gbases, mass_ass_vals_cache, mass, true);
 
 		// coefficient matrix of pressure projection
-		lapl_assembler.assemble(mesh->is_volume(), n_pressure_bases, pressure_bases, gbases, pressure_ass_vals_cache, stiffness);
+		lapl_assembler.assemble(mesh->is_volume(), n_pressure_bases, pressure_bases(), gbases, pressure_ass_vals_cache, stiffness);
 
 		// matrix used to calculate divergence of velocity
-		mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases, bases, gbases,
+		mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases(), bases(), gbases,
 								  pressure_ass_vals_cache, ass_vals_cache, mixed_stiffness);
 		mass_matrix_assembler->set_size(mesh->dimension());
-		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, mass_ass_vals_cache, velocity_mass, true);
+		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases(), gbases, mass_ass_vals_cache, velocity_mass, true);
 		mixed_stiffness = mixed_stiffness.transpose();
 		logger().info("Matrices assembly ends!");
 
@@ -126,9 +126,9 @@ namespace polyfem
 			/* advection */
 			logger().info("Advection...");
 			if (args["space"]["advanced"]["use_particle_advection"])
-				ss.advection_FLIP(*mesh, gbases, bases, sol, dt, local_pts);
+				ss.advection_FLIP(*mesh, gbases, bases(), sol, dt, local_pts);
 			else
-				ss.advection(*mesh, gbases, bases, sol, dt, local_pts);
+				ss.advection(*mesh, gbases, bases(), sol, dt, local_pts);
 			logger().info("Advection finished!");
 
 			/* apply boundary condition */
@@ -142,13 +142,13 @@ namespace polyfem
 			logger().info("Diffusion solved!");
 
 			/* external force */
-			ss.external_force(*mesh, *assembler, gbases, bases, dt, sol, local_pts, problem, time);
+			ss.external_force(*mesh, *assembler, gbases, bases(), dt, sol, local_pts, problem, time);
 
 			/* incompressibility */
 			logger().info("Pressure projection...");
 			ss.solve_pressure(mixed_stiffness, pressure_boundary_nodes, sol, pressure);
 
-			ss.projection(n_bases, gbases, bases, pressure_bases, local_pts, pressure, sol);
+			ss.projection(n_bases, gbases, bases(), pressure_bases(), local_pts, pressure, sol);
 			// ss.projection(velocity_mass, mixed_stiffness, boundary_nodes, sol, pressure);
 			logger().info("Pressure projection finished!");
 
@@ -171,7 +171,7 @@ namespace polyfem
 		Eigen::MatrixXd current_rhs = rhs;
 
 		StiffnessMatrix velocity_mass;
-		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, mass_ass_vals_cache, velocity_mass, true);
+		mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases(), gbases, mass_ass_vals_cache, velocity_mass, true);
 
 		StiffnessMatrix velocity_stiffness, mixed_stiffness, pressure_stiffness;
 
@@ -185,10 +185,10 @@ namespace polyfem
 		std::shared_ptr<assembler::Assembler> velocity_stokes_assembler = std::make_shared<assembler::StokesVelocity>();
 		set_materials(*velocity_stokes_assembler);
 
-		velocity_stokes_assembler->assemble(mesh->is_volume(), n_bases, bases, gbases, ass_vals_cache, velocity_stiffness);
-		mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases, bases, gbases,
+		velocity_stokes_assembler->assemble(mesh->is_volume(), n_bases, bases(), gbases, ass_vals_cache, velocity_stiffness);
+		mixed_assembler->assemble(mesh->is_volume(), n_pressure_bases, n_bases, pressure_bases(), bases(), gbases,
 								  pressure_ass_vals_cache, ass_vals_cache, mixed_stiffness);
-		pressure_assembler->assemble(mesh->is_volume(), n_pressure_bases, pressure_bases, gbases, pressure_ass_vals_cache,
+		pressure_assembler->assemble(mesh->is_volume(), n_pressure_bases, pressure_bases(), gbases, pressure_ass_vals_cache,
 									 pressure_stiffness);
 
 		solver::TransientNavierStokesSolver ns_solver(args["solver"]);
@@ -219,7 +219,7 @@ namespace polyfem
 			Eigen::VectorXd tmp_sol;
 			ns_solver.minimize(
 				n_bases, n_pressure_bases,
-				bases, geom_bases(),
+				bases(), geom_bases(),
 				*dynamic_cast<assembler::NavierStokesVelocity *>(assembler.get()),
 				ass_vals_cache,
 				boundary_nodes,
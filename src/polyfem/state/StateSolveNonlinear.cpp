@@ -14,9 +14,11 @@
 #include <polyfem/solver/NonlinearSolver.hpp>
 #include <polyfem/solver/LBFGSSolver.hpp>
 #include <polyfem/solver/SparseNewtonDescentSolver.hpp>
+#include <polyfem/solver/NewtonKrylovSolver.hpp>
 #include <polyfem/solver/NLProblem.hpp>
 #include <polyfem/solver/ALSolver.hpp>
 #include <polyfem/solver/SolveData.hpp>
+#include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/io/MshWriter.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
@@ -33,6 +35,38 @@ namespace polyfem
 	using namespace io;
 	using namespace utils;
 
+	namespace
+	{
+		/// Sets the writer of the transient output (state.output_writer and the one of out_geom) for its lifetime,
+		/// they are reset even if the solve throws. The writer waits for the pending jobs when it is destroyed.
+		class ScopedOutputWriter
+		{
+		public:
+			ScopedOutputWriter(std::shared_ptr<AsyncWriter> &writer, OutGeometryData &out_geom, const int max_queue_size)
+				: writer_(writer), out_geom_(out_geom)
+			{
+				writer_ = std::make_shared<AsyncWriter>(max_queue_size);
+				out_geom_.set_async_writer(writer_);
+			}
+
+			~ScopedOutputWriter()
+			{
+				out_geom_.set_async_writer(nullptr);
+				writer_ = nullptr;
+			}
+
+			ScopedOutputWriter(const ScopedOutputWriter &) = delete;
+			ScopedOutputWriter &operator=(const ScopedOutputWriter &) = delete;
+
+			/// waits for the pending jobs, rethrows the first failure
+			void flush() { writer_->flush(); }
+
+		private:
+			std::shared_ptr<AsyncWriter> &writer_;
+			OutGeometryData &out_geom_;
+		};
+	} // namespace
+
 	template <typename ProblemType>
 	std::shared_ptr<cppoptlib::NonlinearSolver<ProblemType>> State::make_nl_solver(
 		const std::string &linear_solver_type) const
@@ -47,6 +81,11 @@ namespace polyfem
 			return std::make_shared<cppoptlib::SparseNewtonDescentSolver<ProblemType>>(
 				args["solver"]["nonlinear"], linear_solver_params, dt, units.characteristic_length());
 		}
+		else if (name == "newton_krylov" || name == "Newton-Krylov")
+		{
+			return std::make_shared<cppoptlib::NewtonKrylovSolver<ProblemType>>(
+				args["solver"]["nonlinear"], dt, units.characteristic_length());
+		}
 		else if (name == "lbfgs" || name == "LBFGS" || name == "L-BFGS")
 		{
 			return std::make_shared<cppoptlib::LBFGSSolver<ProblemType>>(args["solver"]["nonlinear"], dt, units.characteristic_length());
@@ -61,7 +100,11 @@ namespace polyfem
 	{
 		init_nonlinear_tensor_solve(sol, t0 + dt);
 
+		// the fields are evaluated in the loop, their serialization overlaps with the next steps
+		ScopedOutputWriter scoped_writer(output_writer, out_geom, args["output"]["advanced"]["async_queue_size"].get<int>());
+
 		save_timestep(t0, 0, t0, dt, sol, Eigen::MatrixXd()); // no pressure
+		save_trajectory(t0, 0, *solve_data.time_integrator);
 
 		if (optimization_enabled)
 			cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
@@ -94,19 +137,27 @@ namespace polyfem
 				Eigen::MatrixXd V;
 				Eigen::MatrixXi F;
 				build_mesh_matrices(V, F);
-				io::MshWriter::write(
-					resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], t)),
-					V, F, mesh->get_body_ids(), mesh->is_volume(), /*binary=*/true);
+				output_writer->push([path = resolve_output_path(fmt::format(args["output"]["data"]["rest_mesh"], t)),
+									 V = std::move(V), F = std::move(F), body_ids = mesh->get_body_ids(), is_volume = mesh->is_volume()]() {
+					io::MshWriter::write(path, V, F, body_ids, is_volume, /*binary=*/true);
+				});
 			}
 
 			solve_data.time_integrator->save_raw(
 				resolve_output_path(fmt::format(args["output"]["data"]["u_path"], t)),
 				resolve_output_path(fmt::format(args["output"]["data"]["v_path"], t)),
-				resolve_output_path(fmt::format(args["output"]["data"]["a_path"], t)));
+				resolve_output_path(fmt::format(args["output"]["data"]["a_path"], t)),
+				*output_writer);
+
+			save_trajectory(t0 + dt * t, t, *solve_data.time_integrator);
 
 			// save restart file
 			save_restart_json(t0, dt, t);
 		}
+
+		scoped_writer.flush();
+		// closes the file, no job is pending
+		trajectory = nullptr;
 	}
 
 	void State::init_nonlinear_tensor_solve(Eigen::MatrixXd &sol, const double t, const bool init_time_integrator)
@@ -189,7 +240,7 @@ namespace polyfem
 			units,
 			mesh->dimension(), t,
 			// Elastic form
-			n_bases, bases, geom_bases(), *assembler, ass_vals_cache, mass_ass_vals_cache,
+			n_bases, bases(), geom_bases(), *assembler, ass_vals_cache, mass_ass_vals_cache,
 			// Body form
 			n_pressure_bases, boundary_nodes, local_boundary, local_neumann_boundary,
 			n_boundary_samples(), rhs, sol, mass_matrix_assembler->density(),
@@ -236,6 +287,8 @@ namespace polyfem
 
 	void State::solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t, const bool init_lagging)
 	{
+		POLYFEM_SCOPED_TIMER("Nonlinear solve");
+
 		assert(solve_data.nl_problem != nullptr);
 		NLProblem &nl_problem = *(solve_data.nl_problem);
 
@@ -4,6 +4,7 @@
 #include <polyfem/time_integrator/ImplicitNewmark.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
 
+#include <polyfem/io/AsyncWriter.hpp>
 #include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 #include <polyfem/utils/Logger.hpp>
@@ -56,16 +57,33 @@ namespace polyfem
 			dt_ = dt;
 		}
 
-		void ImplicitTimeIntegrator::save_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path) const
+		namespace
 		{
-			if (!x_path.empty())
-				write_matrix(x_path, x_prev());
+			void write_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path,
+						   const Eigen::VectorXd &x, const Eigen::VectorXd &v, const Eigen::VectorXd &a)
+			{
+				if (!x_path.empty())
+					write_matrix(x_path, x);
 
-			if (!v_path.empty())
-				write_matrix(v_path, v_prev());
+				if (!v_path.empty())
+					write_matrix(v_path, v);
 
-			if (!a_path.empty())
-				write_matrix(a_path, a_prev());
+				if (!a_path.empty())
+					write_matrix(a_path, a);
+			}
+		} // namespace
+
+		void ImplicitTimeIntegrator::save_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path) const
+		{
+			write_raw(x_path, v_path, a_path, x_prev(), v_prev(), a_prev());
+		}
+
+		void ImplicitTimeIntegrator::save_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path, AsyncWriter &writer) const
+		{
+			// the integrator keeps updating its history, the job owns a copy of the values
+			writer.push([x_path, v_path, a_path, x = x_prev(), v = v_prev(), a = a_prev()]() {
+				write_raw(x_path, v_path, a_path, x, v, a);
+			});
 		}
 
 		std::shared_ptr<ImplicitTimeIntegrator> ImplicitTimeIntegrator::construct_time_integrator(const json &params)
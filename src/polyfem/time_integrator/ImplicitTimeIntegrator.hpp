@@ -8,6 +8,11 @@
 #include <vector>
 #include <deque>
 
+namespace polyfem::io
+{
+	class AsyncWriter;
+} // namespace polyfem::io
+
 namespace polyfem::time_integrator
 {
 	/// Implicit time integrator of a second order ODE (equivently a system of coupled first order ODEs).
@@ -76,6 +81,10 @@ namespace polyfem::time_integrator
 		/// @param a_path same as `x_path`, but for saving \f$a\f$
 		virtual void save_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path) const;
 
+		/// @brief Save a snapshot of the values of \f$x\f$, \f$v\f$, and \f$a\f$ with writer (see save_raw).
+		/// The values are copied, the integrator can be updated while the files are written in the background.
+		void save_raw(const std::string &x_path, const std::string &v_path, const std::string &a_path, io::AsyncWriter &writer) const;
+
 		/// @brief Factory method for constructing implicit time integrators from the name of the integrator.
 		/// @param name name of the type of ImplicitTimeIntegrator to construct
 		/// @return new implicit time integrator of type specfied by name
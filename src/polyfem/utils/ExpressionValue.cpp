@@ -11,6 +11,7 @@
 #include <filesystem>
 
 #include <iostream>
+#include <mutex>
 
 namespace polyfem
 {
@@ -38,6 +39,97 @@ namespace polyfem
 			return check >= 0 ? ttrue : ffalse;
 		}
 
+		namespace
+		{
+			// tinyexpr program, the variables are bound to the storage of this object
+			class CompiledExpression
+			{
+			public:
+				CompiledExpression(const std::string &expr, int &err)
+				{
+					std::vector<te_variable> vars = {
+						{"x", &x, TE_VARIABLE},
+						{"y", &y, TE_VARIABLE},
+						{"z", &z, TE_VARIABLE},
+						{"t", &t, TE_VARIABLE},
+						{"min", (const void *)min, TE_FUNCTION2},
+						{"max", (const void *)max, TE_FUNCTION2},
+						{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
+						{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
+						{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
+						{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
+						{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
+					};
+
+					expr_ = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
+				}
+
+				~CompiledExpression()
+				{
+					if (expr_)
+						te_free(expr_);
+				}
+
+				CompiledExpression(const CompiledExpression &) = delete;
+				CompiledExpression &operator=(const CompiledExpression &) = delete;
+
+				bool is_valid() const { return expr_ != nullptr; }
+
+				double operator()(const double x_, const double y_, const double z_, const double t_)
+				{
+					x = x_;
+					y = y_;
+					z = z_;
+					t = t_;
+					return te_eval(expr_);
+				}
+
+			private:
+				double x = 0, y = 0, z = 0, t = 0;
+				te_expr *expr_ = nullptr;
+			};
+		} // namespace
+
+		// Programs are compiled once and reused, a program is used by one thread at a time
+		// (its variables are shared), a new one is compiled when all of them are in use.
+		class ExpressionValue::CompiledExpressionPool
+		{
+		public:
+			explicit CompiledExpressionPool(const std::string &expr)
+				: expr_(expr)
+			{
+			}
+
+			std::unique_ptr<CompiledExpression> acquire()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					if (!free_.empty())
+					{
+						std::unique_ptr<CompiledExpression> res = std::move(free_.back());
+						free_.pop_back();
+						return res;
+					}
+				}
+
+				int err;
+				auto res = std::make_unique<CompiledExpression>(expr_, err);
+				assert(res->is_valid());
+				return res;
+			}
+
+			void release(std::unique_ptr<CompiledExpression> expr)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				free_.push_back(std::move(expr));
+			}
+
+		private:
+			const std::string expr_;
+			std::mutex mutex_;
+			std::vector<std::unique_ptr<CompiledExpression>> free_;
+		};
+
 		ExpressionValue::ExpressionValue()
 		{
 			clear();
@@ -46,6 +138,7 @@ namespace polyfem
 		void ExpressionValue::clear()
 		{
 			expr_ = "";
+			compiled_ = nullptr;
 			mat_.resize(0, 0);
 			sfunc_ = nullptr;
 			tfunc_ = nullptr;
@@ -85,31 +178,18 @@ namespace polyfem
 
 			expr_ = expr;
 
-			double x = 0, y = 0, z = 0, t = 0;
-
-			std::vector<te_variable> vars = {
-				{"x", &x, TE_VARIABLE},
-				{"y", &y, TE_VARIABLE},
-				{"z", &z, TE_VARIABLE},
-				{"t", &t, TE_VARIABLE},
-				{"min", (const void *)min, TE_FUNCTION2},
-				{"max", (const void *)max, TE_FUNCTION2},
-				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-			};
-
 			int err;
-			te_expr *tmp = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
-			if (!tmp)
+			auto tmp = std::make_unique<CompiledExpression>(expr, err);
+			if (!tmp->is_valid())
 			{
 				logger().error("Unable to parse: {}", expr);
 				logger().error("Error near here: {0: >{1}}", "^", err - 1);
 				assert(false);
+				return;
 			}
-			te_free(tmp);
+
+			compiled_ = std::make_shared<CompiledExpressionPool>(expr_);
+			compiled_->release(std::move(tmp));
 		}
 
 		void ExpressionValue::init(const json &vals)
@@ -194,37 +274,47 @@ namespace polyfem
 			}
 			else
 			{
+				assert(compiled_ != nullptr);
+				std::unique_ptr<CompiledExpression> expr = compiled_->acquire();
+				result = (*expr)(x, y, z, t);
+				compiled_->release(std::move(expr));
+			}
 
-				std::vector<te_variable> vars = {
-					{"x", &x, TE_VARIABLE},
-					{"y", &y, TE_VARIABLE},
-					{"z", &z, TE_VARIABLE},
-					{"t", &t, TE_VARIABLE},
-					{"min", (const void *)min, TE_FUNCTION2},
-					{"max", (const void *)max, TE_FUNCTION2},
-					{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-					{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-					{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-					{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-					{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-				};
+			return convert_units(result);
+		}
 
-				int err;
-				te_expr *tmp = te_compile(expr_.c_str(), vars.data(), vars.size(), &err);
-				assert(tmp != nullptr);
-				result = te_eval(tmp);
-				te_free(tmp);
-			}
+		void ExpressionValue::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val, const int index) const
+		{
+			assert(unit_type_set_);
+			assert(pts.cols() == 2 || pts.cols() == 3);
 
-			if (!unit_.base_units().empty())
-			{
-				if (!unit_.is_convertible(unit_type_))
-					log_and_throw_error(fmt::format("Cannot convert {} to {}", units::to_string(unit_), units::to_string(unit_type_)));
+			val.resize(pts.rows());
+			if (pts.rows() == 0)
+				return;
 
-				result = units::convert(result, unit_, unit_type_);
+			if (expr_.empty())
+			{
+				for (int i = 0; i < pts.rows(); ++i)
+					val(i) = (*this)(pts(i, 0), pts(i, 1), pts.cols() == 3 ? pts(i, 2) : 0, t, index);
+				return;
 			}
 
-			return result;
+			assert(compiled_ != nullptr);
+			std::unique_ptr<CompiledExpression> expr = compiled_->acquire();
+			for (int i = 0; i < pts.rows(); ++i)
+				val(i) = convert_units((*expr)(pts(i, 0), pts(i, 1), pts.cols() == 3 ? pts(i, 2) : 0, t));
+			compiled_->release(std::move(expr));
+		}
+
+		double ExpressionValue::convert_units(const double val) const
+		{
+			if (unit_.base_units().empty())
+				return val;
+
+			if (!unit_.is_convertible(unit_type_))
+				log_and_throw_error(fmt::format("Cannot convert {} to {}", units::to_string(unit_), units::to_string(unit_type_)));
+
+			return units::convert(val, unit_, unit_type_);
 		}
 	} // namespace utils
 } // namespace polyfem
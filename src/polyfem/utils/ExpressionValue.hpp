@@ -4,6 +4,8 @@
 
 #include <units/units.hpp>
 
+#include <memory>
+
 namespace polyfem
 {
 	namespace utils
@@ -33,16 +35,27 @@ namespace polyfem
 
 			double operator()(double x, double y, double z = 0, double t = 0, int index = -1) const;
 
+			// evaluates at every row of pts (x, y, and z in 3d) at time t, thread safe
+			void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &val, const int index = -1) const;
+
 			void clear();
 
 			bool is_zero() const { return expr_.empty() && fabs(value_) < 1e-10; }
+			// true if the value does not depend on the position, time, or index
+			bool is_constant() const { return expr_.empty() && mat_.size() == 0 && !sfunc_ && !tfunc_; }
 
 		private:
+			// compiled programs of expr_, shared by the copies of this value
+			class CompiledExpressionPool;
+
+			double convert_units(const double val) const;
+
 			std::function<double(double x, double y, double z, double t, int index)> sfunc_;
 			std::function<Eigen::MatrixXd(double x, double y, double z, double t)> tfunc_;
 			int tfunc_coo_;
 
 			std::string expr_;
+			std::shared_ptr<CompiledExpressionPool> compiled_;
 			double value_;
 			Eigen::MatrixXd mat_;
 
@@ -3,6 +3,8 @@
 #include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/utils/Logger.hpp>
 
+#include <algorithm>
+
 namespace polyfem::utils
 {
 	SparseMatrixCache::SparseMatrixCache(const size_t size)
@@ -211,6 +213,7 @@ namespace polyfem::utils
 						}
 					}
 
+					compute_element_colors();
 					second_cache_entries_.resize(0);
 
 					logger().trace("Second cache computed");
@@ -239,6 +242,58 @@ namespace polyfem::utils
 		return mat_;
 	}
 
+	void SparseMatrixCache::compute_element_colors()
+	{
+		// Two elements write to the same entry only if they share a row,
+		// so greedily color the element/row incidence graph.
+		const int n_elements = second_cache_entries_.size();
+
+		std::vector<std::vector<int>> element_rows(n_elements);
+		std::vector<std::vector<int>> row_elements(mat_.rows());
+		for (int e = 0; e < n_elements; ++e)
+		{
+			auto &rows = element_rows[e];
+			rows.reserve(second_cache_entries_[e].size());
+			for (const auto &p : second_cache_entries_[e])
+				rows.push_back(p.first);
+			std::sort(rows.begin(), rows.end());
+			rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+			for (const int i : rows)
+				row_elements[i].push_back(e);
+		}
+
+		element_colors_.clear();
+		std::vector<int> colors(n_elements, -1);
+		// forbidden[c] == e if color c is already used by a neighbor of e
+		std::vector<int> forbidden;
+		for (int e = 0; e < n_elements; ++e)
+		{
+			for (const int i : element_rows[e])
+			{
+				for (const int f : row_elements[i])
+				{
+					if (colors[f] >= 0)
+						forbidden[colors[f]] = e;
+				}
+			}
+
+			int c = 0;
+			while (c < forbidden.size() && forbidden[c] == e)
+				++c;
+			if (c == forbidden.size())
+			{
+				forbidden.push_back(-1);
+				element_colors_.emplace_back();
+			}
+
+			colors[e] = c;
+			element_colors_[c].push_back(e);
+		}
+
+		logger().trace("Element coloring computed with {} colors", element_colors_.size());
+	}
+
 	std::shared_ptr<MatrixCache> SparseMatrixCache::operator+(const MatrixCache &a) const
 	{
 		assert(&a == &dynamic_cast<const SparseMatrixCache &>(a));
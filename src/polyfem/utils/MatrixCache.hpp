@@ -81,6 +81,29 @@ namespace polyfem::utils
 		const StiffnessMatrix &mat() const { return mat_; }
 		const std::vector<Eigen::Triplet<double>> &entries() const { return entries_; }
 
+		/// @brief Check if the per-element scatter plan is available.
+		/// The plan is built by get_matrix() the first time the matrix is assembled through add_value.
+		/// @param n_elements Number of elements that will be assembled.
+		/// @return True if add_value_at can be used for all elements.
+		inline bool has_scatter_plan(const int n_elements) const
+		{
+			return use_second_cache_ && !mapping().empty() && second_cache().size() == size_t(n_elements) && !element_colors().empty();
+		}
+
+		/// @brief Groups of elements that do not share any entry of the matrix.
+		/// Elements of the same color can be scattered concurrently with add_value_at.
+		inline const std::vector<std::vector<int>> &element_colors() const { return main_cache()->element_colors_; }
+
+		/// @brief Add a value directly to the compressed value array using the scatter plan.
+		/// @param e Element index.
+		/// @param k Index of the value in the sequence of add_value calls of element e used to build the plan.
+		/// @param value Value to add.
+		inline void add_value_at(const int e, const int k, const double value)
+		{
+			assert(e < second_cache().size() && k < second_cache()[e].size());
+			values_[second_cache()[e][k]] += value;
+		}
+
 	private:
 		size_t size_;
 		StiffnessMatrix tmp_, mat_;
@@ -92,6 +115,7 @@ namespace polyfem::utils
 
 		std::vector<std::vector<int>> second_cache_;
 		std::vector<std::vector<std::pair<int, int>>> second_cache_entries_;
+		std::vector<std::vector<int>> element_colors_;
 		bool use_second_cache_ = true;
 		int current_e_ = -1;
 		int current_e_index_ = -1;
@@ -110,6 +134,8 @@ namespace polyfem::utils
 		{
 			return main_cache()->second_cache_;
 		}
+
+		void compute_element_colors();
 	};
 
 	class DenseMatrixCache : public MatrixCache
@@ -152,6 +152,69 @@ void polyfem::utils::full_to_reduced_matrix(
 	reduced.makeCompressed();
 }
 
+polyfem::StiffnessMatrix polyfem::utils::block_diagonal(const StiffnessMatrix &A, const int block_size)
+{
+	assert(block_size > 0);
+
+	std::vector<Eigen::Triplet<double>> entries;
+	entries.reserve(A.rows() * block_size);
+	for (int k = 0; k < A.outerSize(); ++k)
+	{
+		for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+		{
+			if (it.row() / block_size == it.col() / block_size)
+				entries.emplace_back(it.row(), it.col(), it.value());
+		}
+	}
+
+	StiffnessMatrix diag(A.rows(), A.cols());
+	diag.setFromTriplets(entries.begin(), entries.end());
+	diag.makeCompressed();
+	return diag;
+}
+
+void polyfem::utils::sparsity_pattern(
+	const StiffnessMatrix &A,
+	std::vector<StiffnessMatrix::StorageIndex> &outer,
+	std::vector<StiffnessMatrix::StorageIndex> &inner)
+{
+	outer.resize(A.outerSize() + 1);
+	inner.clear();
+	inner.reserve(A.nonZeros());
+
+	outer[0] = 0;
+	for (int k = 0; k < A.outerSize(); ++k)
+	{
+		for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+			inner.push_back(it.index());
+		outer[k + 1] = inner.size();
+	}
+}
+
+bool polyfem::utils::has_sparsity_pattern(
+	const StiffnessMatrix &A,
+	const int rows,
+	const std::vector<StiffnessMatrix::StorageIndex> &outer,
+	const std::vector<StiffnessMatrix::StorageIndex> &inner)
+{
+	if (A.rows() != rows || outer.size() != A.outerSize() + 1 || inner.size() != A.nonZeros())
+		return false;
+
+	for (int k = 0; k < A.outerSize(); ++k)
+	{
+		StiffnessMatrix::StorageIndex i = outer[k];
+		for (StiffnessMatrix::InnerIterator it(A, k); it; ++it, ++i)
+		{
+			if (i >= outer[k + 1] || inner[i] != it.index())
+				return false;
+		}
+		if (i != outer[k + 1])
+			return false;
+	}
+
+	return true;
+}
+
 Eigen::MatrixXd polyfem::utils::reorder_matrix(
 	const Eigen::MatrixXd &in,
 	const Eigen::VectorXi &in_to_out,
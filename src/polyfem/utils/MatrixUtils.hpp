@@ -107,6 +107,33 @@ namespace polyfem
 			const StiffnessMatrix &full,
 			StiffnessMatrix &reduced);
 
+		/// @brief Extract the diagonal blocks of a matrix.
+		/// @param A Input matrix.
+		/// @param block_size Size of the square blocks along the diagonal (1 extracts the diagonal).
+		/// @return Block diagonal part of A.
+		StiffnessMatrix block_diagonal(const StiffnessMatrix &A, const int block_size);
+
+		/// @brief Extract the sparsity pattern of a matrix in compressed form, without its values.
+		/// @param[in] A Input matrix, compressed or not.
+		/// @param[out] outer Outer index pointers (size A.outerSize() + 1).
+		/// @param[out] inner Inner indices of the nonzeros.
+		void sparsity_pattern(
+			const StiffnessMatrix &A,
+			std::vector<StiffnessMatrix::StorageIndex> &outer,
+			std::vector<StiffnessMatrix::StorageIndex> &inner);
+
+		/// @brief Check whether a matrix has exactly the given sparsity pattern (see sparsity_pattern).
+		/// @param A Input matrix, compressed or not.
+		/// @param rows Number of rows of the pattern.
+		/// @param outer Outer index pointers of the pattern.
+		/// @param inner Inner indices of the pattern.
+		/// @return Whether A has the same size and nonzero structure, regardless of its values.
+		bool has_sparsity_pattern(
+			const StiffnessMatrix &A,
+			const int rows,
+			const std::vector<StiffnessMatrix::StorageIndex> &outer,
+			const std::vector<StiffnessMatrix::StorageIndex> &inner);
+
 		/// @brief Reorder row blocks in a matrix.
 		/// @param in Input matrix.
 		/// @param in_to_out Mapping from input blocks to output blocks.
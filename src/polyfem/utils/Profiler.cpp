@@ -0,0 +1,281 @@
+#include "Profiler.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <map>
+
+extern "C" size_t getPeakRSS();
+
+namespace polyfem
+{
+	namespace utils
+	{
+		struct Profiler::Node
+		{
+			std::string name;
+			Node *parent = nullptr;
+			std::vector<std::unique_ptr<Node>> children;
+
+			int64_t count = 0;
+			double inclusive = 0;
+			bool has_peak_rss = false;
+			size_t peak_rss_increase = 0;
+
+			Node *child(const std::string &child_name)
+			{
+				// few children per node, a linear search is faster than a map
+				for (const auto &c : children)
+				{
+					if (c->name == child_name)
+						return c.get();
+				}
+
+				children.push_back(std::make_unique<Node>());
+				children.back()->name = child_name;
+				children.back()->parent = this;
+				return children.back().get();
+			}
+		};
+
+		struct Profiler::ThreadData
+		{
+			struct Frame
+			{
+				Node *node;
+				std::chrono::steady_clock::time_point start;
+				bool sample_rss;
+				size_t peak_rss;
+			};
+
+			struct Event
+			{
+				const Node *node;
+				double start; // us since the epoch
+				double duration;
+			};
+
+			int id;
+			Node root;
+			Node *current = &root;
+			std::vector<Frame> stack;
+			std::vector<Event> events;
+		};
+
+		namespace
+		{
+			/// node of the call tree merged over the threads
+			struct MergedNode
+			{
+				std::string name;
+				int64_t count = 0;
+				double inclusive = 0;
+				bool has_peak_rss = false;
+				size_t peak_rss_increase = 0;
+				std::map<int, double> threads;
+
+				std::vector<MergedNode> children;
+
+				MergedNode &child(const std::string &child_name)
+				{
+					for (auto &c : children)
+					{
+						if (c.name == child_name)
+							return c;
+					}
+					children.emplace_back();
+					children.back().name = child_name;
+					return children.back();
+				}
+
+				json to_json() const
+				{
+					double children_time = 0;
+					json j_children = json::array();
+					for (const auto &c : children)
+					{
+						children_time += c.inclusive;
+						j_children.push_back(c.to_json());
+					}
+
+					json j_threads = json::object();
+					for (const auto &[id, t] : threads)
+						j_threads[std::to_string(id)] = t;
+
+					json j = {
+						{"name", name},
+						{"count", count},
+						{"inclusive", inclusive},
+						{"exclusive", std::max(inclusive - children_time, 0.0)},
+						{"threads", j_threads},
+						{"children", j_children},
+					};
+					if (has_peak_rss)
+						j["peak_memory_increase"] = peak_rss_increase / (1024. * 1024.);
+					return j;
+				}
+			};
+
+			template <typename NodeT>
+			void merge(const NodeT &src, const int thread_id, MergedNode &dst)
+			{
+				for (const auto &c : src.children)
+				{
+					MergedNode &m = dst.child(c->name);
+					m.count += c->count;
+					m.inclusive += c->inclusive;
+					m.has_peak_rss = m.has_peak_rss || c->has_peak_rss;
+					m.peak_rss_increase = std::max(m.peak_rss_increase, c->peak_rss_increase);
+					m.threads[thread_id] += c->inclusive;
+					merge(*c, thread_id, m);
+				}
+			}
+		} // namespace
+
+		Profiler &Profiler::get()
+		{
+			static Profiler instance;
+			return instance;
+		}
+
+		Profiler::Profiler()
+			: epoch_(std::chrono::steady_clock::now())
+		{
+		}
+
+		Profiler::~Profiler() = default;
+
+		void Profiler::set_enabled(const bool enabled, const bool trace, const bool memory)
+		{
+			enabled_.store(enabled, std::memory_order_relaxed);
+			trace_.store(enabled && trace, std::memory_order_relaxed);
+			memory_.store(enabled && memory, std::memory_order_relaxed);
+		}
+
+		void Profiler::reset()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (auto &t : threads_)
+			{
+				assert(t->stack.empty());
+				t->root.children.clear();
+				t->current = &t->root;
+				t->events.clear();
+			}
+			epoch_ = std::chrono::steady_clock::now();
+		}
+
+		Profiler::ThreadData &Profiler::thread_data()
+		{
+			// the data is owned by the profiler, hence it outlives the (e.g., TBB worker) threads
+			thread_local ThreadData *data = nullptr;
+			if (data == nullptr)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				threads_.push_back(std::make_unique<ThreadData>());
+				data = threads_.back().get();
+				data->id = threads_.size() - 1;
+			}
+			return *data;
+		}
+
+		void *Profiler::begin(const std::string &name)
+		{
+			ThreadData &data = thread_data();
+			Node *node = data.current->child(name);
+			const bool sample_rss = data.stack.empty() || memory_.load(std::memory_order_relaxed);
+			data.stack.push_back({node, std::chrono::steady_clock::now(), sample_rss, sample_rss ? getPeakRSS() : 0});
+			data.current = node;
+			return node;
+		}
+
+		void Profiler::end(void *token)
+		{
+			ThreadData &data = thread_data();
+			const auto now = std::chrono::steady_clock::now();
+
+			// scopes not closed in order (e.g., a timer stopped by hand) are closed with this one
+			if (std::none_of(data.stack.begin(), data.stack.end(), [token](const ThreadData::Frame &f) { return f.node == token; }))
+				return;
+
+			// read at most once, and only if one of the closed scopes sampled it
+			size_t peak_rss = 0;
+
+			while (!data.stack.empty())
+			{
+				const ThreadData::Frame frame = data.stack.back();
+				data.stack.pop_back();
+
+				Node &node = *frame.node;
+				const double duration = std::chrono::duration<double>(now - frame.start).count();
+				++node.count;
+				node.inclusive += duration;
+				if (frame.sample_rss)
+				{
+					if (peak_rss == 0)
+						peak_rss = getPeakRSS();
+					node.has_peak_rss = true;
+					node.peak_rss_increase = std::max(node.peak_rss_increase, peak_rss - frame.peak_rss);
+				}
+				data.current = node.parent;
+
+				if (trace_.load(std::memory_order_relaxed))
+				{
+					const double start = std::chrono::duration<double, std::micro>(frame.start - epoch_).count();
+					data.events.push_back({&node, start, duration * 1e6});
+				}
+
+				if (frame.node == token)
+					break;
+			}
+		}
+
+		json Profiler::to_json() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			MergedNode root;
+			for (const auto &t : threads_)
+				merge(t->root, t->id, root);
+
+			json j;
+			j["threads"] = threads_.size();
+			j["peak_memory"] = getPeakRSS() / (1024. * 1024.);
+			j["tree"] = root.to_json()["children"];
+			return j;
+		}
+
+		bool Profiler::save_chrome_trace(const std::string &path) const
+		{
+			std::ofstream out(path);
+			if (!out.good())
+			{
+				logger().error("Failed to write to file: {}", path);
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			json events = json::array();
+			for (const auto &t : threads_)
+			{
+				for (const auto &e : t->events)
+				{
+					events.push_back({
+						{"name", e.node->name},
+						{"ph", "X"},
+						{"ts", e.start},
+						{"dur", e.duration},
+						{"pid", 0},
+						{"tid", t->id},
+					});
+				}
+			}
+
+			out << json({{"traceEvents", events}, {"displayTimeUnit", "ms"}});
+			return true;
+		}
+	} // namespace utils
+} // namespace polyfem
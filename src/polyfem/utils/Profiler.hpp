@@ -0,0 +1,79 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	namespace utils
+	{
+		/// @brief Hierarchical profiler fed by the named utils::Timer (i.e., POLYFEM_SCOPED_TIMER).
+		///
+		/// Every thread builds its own call tree of the nested timers (no locking on the hot path).
+		/// The export merges the trees: each node has its count, inclusive and exclusive time,
+		/// the inclusive time per thread, and the growth of the peak RSS while it was open.
+		/// Timers opened on a worker thread outside any other timer of that thread are roots of the tree.
+		/// Reading the peak RSS is a system call, by default it is only sampled at the roots.
+		/// Optionally every scope is also recorded as a Chrome trace event (chrome://tracing, Perfetto).
+		class Profiler
+		{
+		public:
+			static Profiler &get();
+
+			/// @brief Enables or disables the profiling, disabling keeps the collected data
+			/// @param[in] enabled enables the call tree
+			/// @param[in] trace also records every scope for the Chrome trace
+			/// @param[in] memory samples the peak RSS at every scope, not only at the roots
+			void set_enabled(const bool enabled, const bool trace = false, const bool memory = false);
+			inline bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+			/// discards the collected data, no scope should be open
+			void reset();
+
+			/// @brief Opens a scope on the current thread
+			/// @param[in] name name of the scope, the children of a scope are identified by their name
+			/// @return token to pass to end
+			void *begin(const std::string &name);
+
+			/// @brief Closes the scope opened by begin on the current thread
+			/// @param[in] token value returned by begin
+			void end(void *token);
+
+			/// @brief Merged call tree, to be called when no profiled code is running
+			/// @return {"threads", "peak_memory", "tree": [{"name", "count", "inclusive", "exclusive", "peak_memory_increase", "threads", "children"}]},
+			/// peak_memory_increase is only present for the sampled scopes
+			json to_json() const;
+
+			/// @brief Writes the recorded scopes as Chrome trace events, to be called when no profiled code is running
+			/// @param[in] path path of the trace file
+			/// @return true if the file has been written
+			bool save_chrome_trace(const std::string &path) const;
+
+		private:
+			Profiler();
+			~Profiler();
+
+			struct Node;
+			struct ThreadData;
+
+			/// call tree of the current thread, created on first use
+			ThreadData &thread_data();
+
+			// read by every timer, possibly while another State (e.g., in a batch) sets them
+			std::atomic<bool> enabled_{false};
+			std::atomic<bool> trace_{false};
+			std::atomic<bool> memory_{false};
+
+			std::chrono::steady_clock::time_point epoch_;
+
+			mutable std::mutex mutex_;
+			std::vector<std::unique_ptr<ThreadData>> threads_;
+		};
+	} // namespace utils
+} // namespace polyfem
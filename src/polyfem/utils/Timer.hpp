@@ -5,6 +5,8 @@
 #include <polyfem/utils/Logger.hpp>
 // clang-format on
 
+#include <polyfem/utils/Profiler.hpp>
+
 #include <igl/Timer.h>
 
 #define POLYFEM_SCOPED_TIMER(...) polyfem::utils::Timer __polyfem_timer(__VA_ARGS__)
@@ -48,6 +50,8 @@ namespace polyfem
 			inline void start()
 			{
 				is_running = true;
+				if (!m_name.empty() && Profiler::get().is_enabled())
+					m_profiler_token = Profiler::get().begin(m_name);
 				m_timer.start();
 			}
 
@@ -57,6 +61,11 @@ namespace polyfem
 					return;
 				m_timer.stop();
 				is_running = false;
+				if (m_profiler_token)
+				{
+					Profiler::get().end(m_profiler_token);
+					m_profiler_token = nullptr;
+				}
 				log_msg();
 				if (m_total_time)
 				{
@@ -90,6 +99,8 @@ namespace polyfem
 			igl::Timer m_timer;
 			double *m_total_time;
 			bool is_running = false;
+			/// open scope of the profiler, nullptr if not profiled
+			void *m_profiler_token = nullptr;
 		};
 	} // namespace utils
 } // namespace polyfem
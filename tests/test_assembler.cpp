@@ -2,6 +2,11 @@
 
 #include <polyfem/assembler/NeoHookeanElasticity.hpp>
 #include <polyfem/assembler/NeoHookeanElasticityAutodiff.hpp>
+#include <polyfem/assembler/Laplacian.hpp>
+#include <polyfem/assembler/LinearElasticity.hpp>
+#include <polyfem/assembler/Mass.hpp>
+#include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/mesh/mesh3D/Mesh3D.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
@@ -52,7 +57,7 @@ TEST_CASE("hessian_lin", "[assembler]")
 	for (int rand = 0; rand < 10; ++rand)
 	{
 		state.assembler->assemble_hessian(false, state.n_bases, false,
-										  state.bases, state.bases, state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+										  state.bases(), state.bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
 
 		const StiffnessMatrix tmp = stiffness - hessian;
 		const auto val = Catch::Approx(0).margin(1e-8);
@@ -107,7 +112,7 @@ TEST_CASE("hessian_hooke", "[assembler]")
 	for (int rand = 0; rand < 10; ++rand)
 	{
 		state.assembler->assemble_hessian(false, state.n_bases, false,
-										  state.bases, state.bases, state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+										  state.bases(), state.bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
 
 		const StiffnessMatrix tmp = stiffness - hessian;
 		const auto val = Catch::Approx(0).margin(1e-8);
@@ -161,7 +166,7 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 	real.add_multimaterial(0, in_args["materials"], state.units);
 
 	const int el_id = 0;
-	const auto &bs = state.bases[el_id];
+	const auto &bs = state.bases()[el_id];
 	Eigen::MatrixXd local_pts;
 	Eigen::MatrixXi f;
 	regular_2d_grid(10, true, local_pts, f);
@@ -284,3 +289,395 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 		}
 	}
 }
+
+namespace
+{
+	// same assembler without the sum-factorized kernel, i.e., using the generic (i,j) loop
+	template <typename T>
+	class NoTensorProduct : public T
+	{
+	public:
+		bool has_tensor_product_kernel() const override { return false; }
+	};
+
+	template <typename T>
+	void check_tensor_product_assembly(
+		const std::vector<ElementBases> &bases,
+		const int n_bases,
+		const int size,
+		const bool is_mass)
+	{
+		const json params = {{"E", 1e5}, {"nu", 0.3}, {"rho", 2}};
+		const std::vector<int> body_ids(bases.size(), 0);
+
+		T assembler;
+		assembler.set_size(size);
+		assembler.set_materials(body_ids, params, Units());
+
+		NoTensorProduct<T> reference;
+		reference.set_size(size);
+		reference.set_materials(body_ids, params, Units());
+
+		REQUIRE(assembler.has_tensor_product_kernel());
+
+		AssemblyValsCache cache;
+		cache.init(true, bases, bases, is_mass);
+
+		StiffnessMatrix stiffness, expected;
+		assembler.assemble(true, n_bases, bases, bases, cache, stiffness, is_mass);
+		reference.assemble(true, n_bases, bases, bases, cache, expected, is_mass);
+
+		REQUIRE(stiffness.rows() == expected.rows());
+		const StiffnessMatrix tmp = stiffness - expected;
+		const auto val = Catch::Approx(0).margin(1e-8 * std::max(1., expected.norm()));
+
+		for (int k = 0; k < tmp.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(tmp, k); it; ++it)
+			{
+				REQUIRE(it.value() == val);
+			}
+		}
+	}
+
+	// same assembler without the batched kernel, i.e., evaluating one element at a time
+	template <typename T>
+	class NoBatch : public T
+	{
+	public:
+		bool has_batched_kernel() const override { return false; }
+	};
+
+	template <typename T>
+	void check_batched_assembly(
+		const bool is_volume,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const int n_bases,
+		const double scale = 0.05)
+	{
+		const int dim = is_volume ? 3 : 2;
+		const json params = {{"E", 1e5}, {"nu", 0.3}, {"rho", 2}};
+		const std::vector<int> body_ids(bases.size(), 0);
+
+		T assembler;
+		assembler.set_size(dim);
+		assembler.set_materials(body_ids, params, Units());
+
+		NoBatch<T> reference;
+		reference.set_size(dim);
+		reference.set_materials(body_ids, params, Units());
+
+		REQUIRE(assembler.has_batched_kernel());
+
+		AssemblyValsCache cache;
+		cache.init(is_volume, bases, gbases);
+
+		Eigen::MatrixXd displacement(n_bases * dim, 1);
+		for (int rand = 0; rand < 5; ++rand)
+		{
+			// small enough to keep the elements non inverted
+			displacement.setRandom();
+			displacement *= scale;
+
+			const double energy = assembler.assemble_energy(is_volume, bases, gbases, cache, 0, displacement, displacement);
+			const double expected_energy = reference.assemble_energy(is_volume, bases, gbases, cache, 0, displacement, displacement);
+			REQUIRE(energy == Catch::Approx(expected_energy).epsilon(1e-10));
+
+			Eigen::MatrixXd grad, expected_grad;
+			assembler.assemble_gradient(is_volume, n_bases, bases, gbases, cache, 0, displacement, displacement, grad);
+			reference.assemble_gradient(is_volume, n_bases, bases, gbases, cache, 0, displacement, displacement, expected_grad);
+			REQUIRE(grad.size() == expected_grad.size());
+			REQUIRE((grad - expected_grad).norm() <= 1e-10 * std::max(1., expected_grad.norm()));
+		}
+	}
+
+	// 2x2x2 grid of distorted hexes (non-affine geometric mapping)
+	std::unique_ptr<Mesh> distorted_hex_grid()
+	{
+		const int n = 3;
+		Eigen::MatrixXd V(n * n * n, 3);
+		for (int z = 0; z < n; ++z)
+			for (int y = 0; y < n; ++y)
+				for (int x = 0; x < n; ++x)
+					V.row(x + n * (y + n * z)) << x + 0.1 * y * z, y, z + 0.2 * x * y;
+
+		Eigen::MatrixXi F((n - 1) * (n - 1) * (n - 1), 8);
+		for (int z = 0, c = 0; z < n - 1; ++z)
+		{
+			for (int y = 0; y < n - 1; ++y)
+			{
+				for (int x = 0; x < n - 1; ++x, ++c)
+				{
+					const auto v = [n](int x, int y, int z) { return x + n * (y + n * z); };
+					F.row(c) << v(x, y, z), v(x + 1, y, z), v(x + 1, y + 1, z), v(x, y + 1, z),
+						v(x, y, z + 1), v(x + 1, y, z + 1), v(x + 1, y + 1, z + 1), v(x, y + 1, z + 1);
+				}
+			}
+		}
+
+		return Mesh::create(V, F);
+	}
+
+	int build_hex_bases(const Mesh &mesh, const int discr_order, std::vector<ElementBases> &bases)
+	{
+		std::vector<LocalBoundary> local_boundary;
+		std::map<int, InterfaceData> poly_face_to_data;
+		std::shared_ptr<MeshNodes> mesh_nodes;
+		return LagrangeBasis3d::build_bases(dynamic_cast<const Mesh3D &>(mesh), "LinearElasticity", -1, -1, discr_order, false, false, false, bases, local_boundary, poly_face_to_data, mesh_nodes);
+	}
+} // namespace
+
+TEST_CASE("tensor_product_hex_assembly", "[assembler]")
+{
+	const std::unique_ptr<Mesh> mesh = distorted_hex_grid();
+
+	for (int discr_order = 1; discr_order <= 3; ++discr_order)
+	{
+		std::vector<ElementBases> bases;
+		const int n_bases = build_hex_bases(*mesh, discr_order, bases);
+
+		for (const auto &b : bases)
+			REQUIRE(b.tensor_product_order == discr_order);
+
+		check_tensor_product_assembly<Laplacian>(bases, n_bases, 1, false);
+		check_tensor_product_assembly<LinearElasticity>(bases, n_bases, 3, false);
+		check_tensor_product_assembly<Mass>(bases, n_bases, 3, true);
+	}
+}
+
+TEST_CASE("element_dof_map", "[assembler][dof_map]")
+{
+	const std::unique_ptr<Mesh> mesh = distorted_hex_grid();
+
+	for (int discr_order = 1; discr_order <= 3; ++discr_order)
+	{
+		std::vector<ElementBases> bases;
+		build_hex_bases(*mesh, discr_order, bases);
+
+		ElementDofMap dof_map;
+		dof_map.build(bases);
+		REQUIRE(dof_map.is_built_for(bases));
+		REQUIRE(dof_map.n_elements() == bases.size());
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			REQUIRE(dof_map.n_local_bases(e) == bases[e].bases.size());
+			for (int i = 0; i < bases[e].bases.size(); ++i)
+			{
+				const auto &global = bases[e].bases[i].global();
+				REQUIRE(dof_map.end(e, i) - dof_map.begin(e, i) == global.size());
+				for (int k = 0; k < global.size(); ++k)
+				{
+					REQUIRE(dof_map.index(dof_map.begin(e, i) + k) == global[k].index);
+					REQUIRE(dof_map.weight(dof_map.begin(e, i) + k) == global[k].val);
+				}
+			}
+		}
+
+		// the map is only reused for the bases it was built from, but it is valid for any bases with the same connectivity
+		std::vector<ElementBases> other_bases = bases;
+		REQUIRE(!dof_map.is_built_for(other_bases));
+		REQUIRE(dof_map.has_same_connectivity(other_bases));
+		other_bases.back().bases.back().global().back().index += 1;
+		REQUIRE(!dof_map.has_same_connectivity(other_bases));
+		other_bases.pop_back();
+		REQUIRE(!dof_map.has_same_connectivity(other_bases));
+
+		dof_map.clear();
+		REQUIRE(!dof_map.is_built_for(bases));
+	}
+}
+
+TEST_CASE("shared_assembly_vals_cache", "[assembler][batch]")
+{
+	const std::unique_ptr<Mesh> mesh = distorted_hex_grid();
+
+	for (int discr_order = 1; discr_order <= 3; ++discr_order)
+	{
+		std::vector<ElementBases> bases;
+		build_hex_bases(*mesh, discr_order, bases);
+
+		// values shared with a copy of the bases (as between batch runs)
+		const std::vector<ElementBases> bases_copy = bases;
+		AssemblyValsCache cache, shared;
+		cache.init(true, bases, bases);
+		shared.init(cache, bases_copy);
+		REQUIRE(shared.dof_map().is_built_for(bases_copy));
+		REQUIRE(!shared.dof_map().is_built_for(bases));
+		REQUIRE(shared.dof_map().has_same_connectivity(bases));
+
+		ElementAssemblyValues vals, shared_vals;
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			cache.compute(e, true, bases[e], bases[e], vals);
+			shared.compute(e, true, bases_copy[e], bases_copy[e], shared_vals);
+			REQUIRE(vals.det.size() == shared_vals.det.size());
+			REQUIRE((vals.det - shared_vals.det).norm() == 0);
+		}
+	}
+}
+
+namespace
+{
+	void check_same_values(const ElementAssemblyValues &expected, const ElementAssemblyValues &vals)
+	{
+		REQUIRE(vals.element_id == expected.element_id);
+		REQUIRE(vals.has_parameterization == expected.has_parameterization);
+		REQUIRE(vals.quadrature.weights == expected.quadrature.weights);
+		REQUIRE(vals.val == expected.val);
+		REQUIRE(vals.det == expected.det);
+		REQUIRE(vals.jac_it.size() == expected.jac_it.size());
+		for (int k = 0; k < vals.jac_it.size(); ++k)
+			REQUIRE(vals.jac_it[k] == expected.jac_it[k]);
+
+		REQUIRE(vals.basis_values.size() == expected.basis_values.size());
+		for (int i = 0; i < vals.basis_values.size(); ++i)
+		{
+			REQUIRE(vals.basis_values[i].global.size() == expected.basis_values[i].global.size());
+			REQUIRE(vals.basis_values[i].val == expected.basis_values[i].val);
+			REQUIRE(vals.basis_values[i].grad == expected.basis_values[i].grad);
+			REQUIRE(vals.basis_values[i].grad_t_m == expected.basis_values[i].grad_t_m);
+		}
+	}
+
+	void check_memory_budget(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
+	{
+		std::vector<ElementAssemblyValues> expected(bases.size());
+		size_t full_size = 0;
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			expected[e].compute(e, is_volume, bases[e], gbases[e]);
+			expected[e].release_scratch();
+			full_size += expected[e].memory_size();
+		}
+
+		// the elements share the reference values, the compact layout is used by default and until it exceeds the budget,
+		// the values of the other elements are computed on demand
+		AssemblyValsCache compact, bounded;
+		compact.init(is_volume, bases, gbases);
+		REQUIRE(compact.is_compact());
+		REQUIRE(compact.n_cached() == bases.size());
+		REQUIRE(compact.n_reference_elements() == 1);
+		REQUIRE(compact.memory_size() <= full_size / 2);
+
+		bounded.init(is_volume, bases, gbases, false, true, compact.memory_size() / 2);
+		REQUIRE(bounded.is_compact());
+		REQUIRE(bounded.n_cached() < bases.size());
+		REQUIRE(bounded.memory_size() <= compact.memory_size() / 2);
+
+		// the reference values are only copied in tmp when they change
+		ElementAssemblyValues compact_tmp, bounded_tmp;
+		for (int e = 0; e < bases.size(); ++e)
+		{
+			const ElementAssemblyValues &compact_vals = compact.get(e, is_volume, bases[e], gbases[e], compact_tmp);
+			const ElementAssemblyValues &bounded_vals = bounded.get(e, is_volume, bases[e], gbases[e], bounded_tmp);
+			REQUIRE(&compact_vals == &compact_tmp);
+			REQUIRE(&bounded_vals == &bounded_tmp);
+
+			check_same_values(expected[e], compact_vals);
+			check_same_values(expected[e], bounded_vals);
+		}
+
+		// computing other values in tmp invalidates its reference values
+		const Eigen::MatrixXd pts = expected[0].quadrature.points.topRows(1);
+		compact_tmp.compute(0, is_volume, pts, bases[0], gbases[0]);
+		check_same_values(expected[1], compact.get(1, is_volume, bases[1], gbases[1], compact_tmp));
+
+		ElementAssemblyValues vals;
+		compact.compute(1, is_volume, bases[1], gbases[1], vals);
+		check_same_values(expected[1], vals);
+	}
+} // namespace
+
+TEST_CASE("assembly_vals_cache_memory_budget", "[assembler][memory]")
+{
+	const std::unique_ptr<Mesh> mesh = distorted_hex_grid();
+
+	// curved elements, one jacobian per quadrature point
+	for (int discr_order = 1; discr_order <= 3; ++discr_order)
+	{
+		std::vector<ElementBases> bases;
+		build_hex_bases(*mesh, discr_order, bases);
+		check_memory_budget(true, bases, bases);
+	}
+
+	// affine triangles, one jacobian per element
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+	in_args["space"] = {};
+	in_args["space"]["discr_order"] = 2;
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "LinearElasticity";
+
+	State state;
+	state.init_logger("", spdlog::level::err, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	check_memory_budget(false, state.bases(), state.geom_bases());
+}
+
+TEST_CASE("batched_assembly", "[assembler][batched]")
+{
+	const std::unique_ptr<Mesh> mesh = distorted_hex_grid();
+
+	for (int discr_order = 1; discr_order <= 3; ++discr_order)
+	{
+		std::vector<ElementBases> bases;
+		const int n_bases = build_hex_bases(*mesh, discr_order, bases);
+
+		check_batched_assembly<LinearElasticity>(true, bases, bases, n_bases);
+		check_batched_assembly<NeoHookeanElasticity>(true, bases, bases, n_bases);
+	}
+
+	// 4x4 grid of distorted quads (non-affine geometric mapping)
+	const int n = 5;
+	Eigen::MatrixXd V(n * n, 2);
+	for (int y = 0; y < n; ++y)
+		for (int x = 0; x < n; ++x)
+			V.row(x + n * y) << x + 0.1 * y * y, y + 0.05 * x * y;
+
+	Eigen::MatrixXi F((n - 1) * (n - 1), 4);
+	for (int y = 0, c = 0; y < n - 1; ++y)
+		for (int x = 0; x < n - 1; ++x, ++c)
+			F.row(c) << x + n * y, x + 1 + n * y, x + 1 + n * (y + 1), x + n * (y + 1);
+
+	// affine triangles
+	const std::string path = POLYFEM_DATA_DIR;
+
+	for (const bool quads : {true, false})
+	{
+		for (int discr_order = 1; discr_order <= 2; ++discr_order)
+		{
+			json in_args = json({});
+			in_args["space"] = {};
+			in_args["space"]["discr_order"] = discr_order;
+			in_args["materials"] = {};
+			in_args["materials"]["type"] = "LinearElasticity";
+			if (!quads)
+			{
+				in_args["geometry"] = {};
+				in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+			}
+
+			State state;
+			state.init_logger("", spdlog::level::err, false);
+			state.init(in_args, true);
+			if (quads)
+				state.load_mesh(V, F);
+			else
+				state.load_mesh();
+			state.build_basis();
+
+			// a few percents of the average element size, to keep the elements non inverted
+			RowVectorNd min, max;
+			state.mesh->bounding_box(min, max);
+			const double scale = 0.05 * (max - min).maxCoeff() / std::sqrt(double(state.mesh->n_elements()));
+			check_batched_assembly<LinearElasticity>(false, state.bases(), state.geom_bases(), state.n_bases, scale);
+			check_batched_assembly<NeoHookeanElasticity>(false, state.bases(), state.geom_bases(), state.n_bases, scale);
+		}
+	}
+}
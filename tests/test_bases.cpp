@@ -7,6 +7,7 @@
 #include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/basis/TensorProductHexBasis.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -1047,6 +1048,65 @@ TEST_CASE("Qk_3d", "[bases]")
 	}
 }
 
+TEST_CASE("Qk_3d_tensor_product", "[bases]")
+{
+	for (int k = 1; k <= 3; ++k)
+	{
+		HexQuadrature rule;
+		Quadrature quad;
+		rule.get_quadrature(2 * k + 1, quad);
+
+		const auto tp = TensorProductHexBasis::get(k, quad);
+		REQUIRE(tp != nullptr);
+		REQUIRE(tp->n_points() == quad.points.rows());
+
+		const Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(tp->n_bases(), 2);
+		Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(quad.points.rows(), 2);
+		std::array<Eigen::MatrixXd, 3> expected_der;
+		expected_der.fill(expected);
+
+		Eigen::MatrixXd val, grad, tp_grad;
+		Eigen::VectorXd tp_val;
+		for (int i = 0; i < tp->n_bases(); ++i)
+		{
+			polyfem::autogen::q_basis_value_3d(k, i, quad.points, val);
+			polyfem::autogen::q_grad_basis_value_3d(k, i, quad.points, grad);
+
+			tp->eval_basis(i, tp_val);
+			tp->eval_grad(i, tp_grad);
+
+			for (int j = 0; j < val.size(); ++j)
+				REQUIRE(tp_val(j) == Catch::Approx(val(j)).margin(1e-10));
+			for (int j = 0; j < grad.size(); ++j)
+				REQUIRE(tp_grad(j) == Catch::Approx(grad(j)).margin(1e-10));
+
+			expected += val * coeffs.row(i);
+			for (int d = 0; d < 3; ++d)
+				expected_der[d] += grad.col(d) * coeffs.row(i);
+		}
+
+		// sum factorized interpolation
+		tp->interpolate(coeffs, val);
+		REQUIRE((val - expected).norm() == Catch::Approx(0).margin(1e-10));
+		for (int d = 0; d < 3; ++d)
+		{
+			tp->interpolate_derivative(coeffs, d, val);
+			REQUIRE((val - expected_der[d]).norm() == Catch::Approx(0).margin(1e-10));
+		}
+
+		// integration is the transpose of the interpolation
+		const Eigen::MatrixXd f = Eigen::MatrixXd::Random(tp->n_points(), 2);
+		Eigen::MatrixXd res;
+		tp->integrate(f, res);
+		REQUIRE((coeffs.array() * res.array()).sum() == Catch::Approx((expected.array() * f.array()).sum()).margin(1e-10));
+		for (int d = 0; d < 3; ++d)
+		{
+			tp->integrate_derivative(f, d, res);
+			REQUIRE((coeffs.array() * res.array()).sum() == Catch::Approx((expected_der[d].array() * f.array()).sum()).margin(1e-10));
+		}
+	}
+}
+
 TEST_CASE("MV_2d", "[bases]")
 {
 	Eigen::MatrixXd b, b_prime, b_dx, b_dy;
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/State.hpp>
+#include <polyfem/state/BatchRunner.hpp>
+#include <polyfem/utils/par_for.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include <map>
+#include <mutex>
+#include <thread>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+
+TEST_CASE("batch_runner", "[batch]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+	{
+		"materials": {
+			"type": "LinearElasticity",
+			"E": 20000,
+			"nu": 0.3
+		},
+
+		"geometry": [{
+			"mesh": "",
+			"enabled": true,
+			"type": "mesh",
+			"surface_selection": 7
+		}],
+
+		"boundary_conditions": {
+			"dirichlet_boundary": [{
+				"id": "all",
+				"value": [0, 0]
+			}],
+			"rhs": [10, 10]
+		},
+
+		"solver": {
+			"max_threads": 1
+		},
+
+		"output": {
+			"log": {
+				"level": "warning"
+			}
+		}
+	})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	json stiffer = in_args;
+	stiffer["materials"]["E"] = 40000;
+
+	json missing_mesh = in_args;
+	missing_mesh["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/missing.obj";
+
+	BatchRunner runner(2, spdlog::level::warn);
+	REQUIRE(runner.add(in_args) == 0);
+	REQUIRE(runner.add(stiffer) == 1);
+	REQUIRE(runner.add(missing_mesh) == 2);
+
+	// the callback can be called concurrently
+	std::mutex mutex;
+	std::map<double, double> sol_norms;
+	const int n_failed = runner.run([&](State &state, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &pressure) {
+		std::lock_guard<std::mutex> lock(mutex);
+		sol_norms[state.args["materials"]["E"].get<double>()] = sol.norm();
+	});
+
+	REQUIRE(n_failed == 1);
+
+	// the threads are set once by the runner, the max_threads of the runs are ignored
+	CHECK(utils::NThread::get().num_threads == std::min(2u, std::max(1u, std::thread::hardware_concurrency())));
+	CHECK(runner.succeeded(0));
+	CHECK(runner.succeeded(1));
+	CHECK(!runner.succeeded(2));
+
+	// called once per successful run
+	REQUIRE(sol_norms.size() == 2);
+	REQUIRE(sol_norms.count(20000) == 1);
+	REQUIRE(sol_norms.count(40000) == 1);
+
+	// the two valid runs are in the same group, the second one reuses the bases of the first
+	CHECK(BatchRunner::discretization_key(runner.state(0)) == BatchRunner::discretization_key(runner.state(1)));
+	CHECK(&runner.state(0).bases() == &runner.state(1).bases());
+
+	// linear problem with zero Dirichlet conditions, the displacement scales with 1 / E
+	CHECK(sol_norms[20000] == Catch::Approx(2 * sol_norms[40000]).epsilon(1e-8));
+}
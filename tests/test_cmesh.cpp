@@ -1,10 +1,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/mesh/mesh2D/CMesh2D.hpp>
 #include <polyfem/State.hpp>
+#include <polyfem/io/BinaryMesh.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <limits>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -21,3 +24,56 @@ TEST_CASE("append_2d", "[mesh_test]")
 
 	m1->append(m2);
 }
+
+TEST_CASE("binary_mesh", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	Eigen::MatrixXd V(4, 2);
+	V << 0, 0,
+		1, 0,
+		1, 1,
+		0, 1;
+	Eigen::MatrixXi F(2, 3);
+	F << 0, 1, 2,
+		0, 2, 3;
+	const std::vector<int> body_ids = {3, 7};
+	const std::map<std::string, Eigen::MatrixXd> fields = {{"u", Eigen::MatrixXd::Random(8, 1)}};
+
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_binary_mesh.pfmesh").string();
+	REQUIRE(io::BinaryMesh::write(path, V, F, {}, {}, body_ids, {}, fields));
+
+	const auto mesh = Mesh::create(path);
+	REQUIRE(mesh != nullptr);
+	CHECK(mesh->n_vertices() == V.rows());
+	CHECK(mesh->n_elements() == F.rows());
+	CHECK(mesh->get_body_ids() == body_ids);
+	for (int v = 0; v < V.rows(); ++v)
+		CHECK(mesh->point(v) == V.row(v));
+
+	io::BinaryMesh file;
+	REQUIRE(file.open(path));
+	CHECK(file.doubles("u") == fields.at("u"));
+	CHECK(file.ints("cells") == F);
+	CHECK(!file.has("element_nodes"));
+	file.close();
+
+	// corrupted files are rejected
+	const auto corrupt = [&](const size_t position, const auto value) {
+		REQUIRE(io::BinaryMesh::write(path, V, F, {}, {}, body_ids, {}, fields));
+		std::fstream out(path, std::ios::in | std::ios::out | std::ios::binary);
+		out.seekp(position);
+		out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+	};
+
+	// byte order mark of the header
+	corrupt(12, uint32_t(0x04030201));
+	CHECK(!file.open(path));
+
+	// rows of the first array, the size in bytes overflows
+	corrupt(24 + 56, std::numeric_limits<uint64_t>::max() / 2);
+	CHECK(!file.open(path));
+
+	std::filesystem::remove(path);
+}
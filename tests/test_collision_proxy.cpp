@@ -97,7 +97,7 @@ TEST_CASE("build collision proxy", "[build_collision_proxy]")
 	Eigen::MatrixXi proxy_faces;
 	std::vector<Eigen::Triplet<double>> displacement_map_entries;
 	build_collision_proxy(
-		state->bases, state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
+		state->bases(), state->geom_bases(), state->total_local_boundary, state->n_bases, state->mesh->dimension(),
 		/*max_edge_length=*/0.1, proxy_vertices, proxy_faces, displacement_map_entries, tessellation);
 
 	if (tessellation == CollisionProxyTessellation::REGULAR)
@@ -160,7 +160,7 @@ TEST_CASE("build collision proxy displacement map", "[build_collision_proxy]")
 
 	std::vector<Eigen::Triplet<double>> displacement_map_entries;
 	polyfem::mesh::build_collision_proxy_displacement_maps(
-		state->bases, state->geom_bases(), state->total_local_boundary,
+		state->bases(), state->geom_bases(), state->total_local_boundary,
 		state->n_bases, state->mesh->dimension(), vertices,
 		displacement_map_entries);
 
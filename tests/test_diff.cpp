@@ -325,7 +325,7 @@ TEST_CASE("topology-compliance", "[test_adjoint]")
 	std::shared_ptr<State> state_ptr = create_state_and_solve(in_args);
 	State &state = *state_ptr;
 
-	std::vector<std::shared_ptr<Parametrization>> map_list = {std::make_shared<PowerMap>(5), std::make_shared<InsertConstantMap>(state.bases.size(), state.args["materials"]["nu"]), std::make_shared<ENu2LambdaMu>(state.mesh->is_volume())};
+	std::vector<std::shared_ptr<Parametrization>> map_list = {std::make_shared<PowerMap>(5), std::make_shared<InsertConstantMap>(state.bases().size(), state.args["materials"]["nu"]), std::make_shared<ENu2LambdaMu>(state.mesh->is_volume())};
 	CompositeParametrization composite_map(map_list);
 
 	std::vector<std::shared_ptr<VariableToSimulation>> variable_to_simulations;
@@ -334,8 +334,8 @@ TEST_CASE("topology-compliance", "[test_adjoint]")
 	std::vector<std::shared_ptr<State>> states({state_ptr});
 	auto obj = AdjointOptUtils::create_form(opt_args["functionals"], variable_to_simulations, states);
 
-	Eigen::MatrixXd theta(state.bases.size(), 1);
-	for (int e = 0; e < state.bases.size(); e++)
+	Eigen::MatrixXd theta(state.bases().size(), 1);
+	for (int e = 0; e < state.bases().size(); e++)
 		theta(e) = (rand() % 1000) / 1000.0;
 
 	Eigen::VectorXd x = variable_to_simulations[0]->inverse_eval();
@@ -421,7 +421,7 @@ TEST_CASE("shape-neumann-nodes", "[test_adjoint]")
 	int dim;
 	{
 		const auto &mesh = state.mesh;
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
 		const auto &gbases = state.geom_bases();
 		dim = mesh->dimension();
 
@@ -487,7 +487,7 @@ TEST_CASE("shape-neumann-nodes", "[test_adjoint]")
 // 	int dim;
 // 	{
 // 		const auto &mesh = state.mesh;
-// 		const auto &bases = state.bases;
+// 		const auto &bases = state.bases();
 // 		const auto &gbases = state.geom_bases();
 // 		dim = mesh->dimension();
 
@@ -699,7 +699,7 @@ TEST_CASE("shape-pressure-neumann-nodes", "[test_adjoint]")
 	int dim;
 	{
 		const auto &mesh = state.mesh;
-		const auto &bases = state.bases;
+		const auto &bases = state.bases();
 		const auto &gbases = state.geom_bases();
 		dim = mesh->dimension();
 
@@ -773,7 +773,7 @@ TEST_CASE("shape-pressure-neumann-nodes", "[test_adjoint]")
 // 	int dim;
 // 	{
 // 		const auto &mesh = state.mesh;
-// 		const auto &bases = state.bases;
+// 		const auto &bases = state.bases();
 // 		const auto &gbases = state.geom_bases();
 // 		dim = mesh->dimension();
 
@@ -907,6 +907,49 @@ TEST_CASE("damping-transient", "[test_adjoint]")
 	verify_adjoint(variable_to_simulations, *obj, state, x, velocity_discrete, opt_args["solver"]["nonlinear"]["debug_fd_eps"], 1e-4);
 }
 
+TEST_CASE("damping-transient-jacobians-on-disk", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DATA_DIR + std::string("/differentiable/input/");
+	json in_args;
+	load_json(path + "damping-transient.json", in_args);
+
+	json opt_args;
+	load_json(path + "damping-transient-opt.json", opt_args);
+	opt_args = AdjointOptUtils::apply_opt_json_spec(opt_args, false);
+
+	json in_args_ref;
+	load_json(path + "damping-transient-target.json", in_args_ref);
+	std::shared_ptr<State> state_reference = create_state_and_solve(in_args_ref);
+
+	// same adjoint gradient with the Jacobians kept in memory and all written to disk
+	Eigen::VectorXd grads[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		json args = in_args;
+		args["solver"]["advanced"]["adjoint_jacobian_memory"] = i == 0 ? -1 : 0;
+		std::shared_ptr<State> state_ptr = create_state_and_solve(args);
+		State &state = *state_ptr;
+
+		CHECK((state.diff_cached.n_jacobians_on_disk() > 0) == (i == 1));
+
+		std::vector<std::shared_ptr<VariableToSimulation>> variable_to_simulations;
+		variable_to_simulations.push_back(std::make_shared<DampingCoeffientVariableToSimulation>(state_ptr, CompositeParametrization()));
+
+		std::vector<std::shared_ptr<State>> states = {state_ptr, state_reference};
+		auto obj = AdjointOptUtils::create_form(opt_args["functionals"], variable_to_simulations, states);
+
+		Eigen::VectorXd x(2);
+		x << state.args["materials"]["psi"], state.args["materials"]["phi"];
+
+		obj->solution_changed(x);
+		state.solve_adjoint_cached(obj->compute_adjoint_rhs(x, state));
+		obj->first_derivative(x, grads[i]);
+	}
+
+	REQUIRE(grads[0].size() == grads[1].size());
+	CHECK((grads[0] - grads[1]).norm() <= 1e-10 * std::max(1.0, grads[0].norm()));
+}
+
 TEST_CASE("material-transient", "[test_adjoint]")
 {
 	const std::string path = POLYFEM_DATA_DIR + std::string("/differentiable/input/");
@@ -932,7 +975,7 @@ TEST_CASE("material-transient", "[test_adjoint]")
 	auto obj = AdjointOptUtils::create_form(opt_args["functionals"], variable_to_simulations, states);
 
 	Eigen::VectorXd velocity_discrete;
-	velocity_discrete.setOnes(state.bases.size() * 2);
+	velocity_discrete.setOnes(state.bases().size() * 2);
 	velocity_discrete *= 1e3;
 
 	Eigen::VectorXd x = variable_to_simulations[0]->inverse_eval();
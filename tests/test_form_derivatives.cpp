@@ -20,6 +20,7 @@
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/generators/catch_generators.hpp>
 
 #include <iostream>
@@ -198,6 +199,21 @@ void test_form(Form &form, const State &state)
 			CHECK(fd::compare_gradient(grad, fgrad));
 		}
 
+		// Test the fused evaluations against the separate ones
+		{
+			Eigen::VectorXd grad, fused_grad;
+			form.first_derivative(x, grad);
+			const double fused_value = form.value_and_gradient(x, fused_grad);
+
+			CHECK(fused_value == Catch::Approx(form.value(x)).epsilon(1e-12));
+			CHECK((fused_grad - grad).norm() <= 1e-12 * std::max(1.0, grad.norm()));
+
+			bool valid;
+			const double value = form.value_with_validity(Eigen::VectorXd::Zero(x.size()), x, valid);
+			CHECK(value == Catch::Approx(form.value(x)).epsilon(1e-12));
+			CHECK(valid == form.is_step_valid(Eigen::VectorXd::Zero(x.size()), x));
+		}
+
 		// Test hessian with finite differences
 		{
 			StiffnessMatrix hess;
@@ -221,6 +237,15 @@ void test_form(Form &form, const State &state)
 			}
 
 			CHECK(fd::compare_hessian(Eigen::MatrixXd(hess), fhess));
+
+			// Test hessian-vector product against the assembled hessian
+			Eigen::VectorXd v, hv;
+			v.setRandom(x.size());
+			form.init_second_derivative_vector_product(x);
+			form.second_derivative_vector_product(v, hv);
+
+			const Eigen::VectorXd ref_hv = hess * v;
+			CHECK((hv - ref_hv).norm() <= 1e-8 * std::max(1.0, ref_hv.norm()));
 		}
 
 		x.setRandom();
@@ -302,18 +327,71 @@ TEST_CASE("contact form derivatives", "[form][form_derivatives][contact_form]")
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("contact form envelope with dmin", "[form][contact_form]")
+{
+	const double dhat = 1e-3;
+	const double dmin = 1e-2;
+	const ipc::BroadPhaseMethod broad_phase_method = ipc::BroadPhaseMethod::HASH_GRID;
+
+	// Two parallel edges, separated by more than dmin + dhat
+	Eigen::MatrixXd V(4, 2);
+	V << 0, 0,
+		1, 0,
+		0, dmin + 1.5 * dhat,
+		1, dmin + 1.5 * dhat;
+	Eigen::MatrixXi E(2, 2);
+	E << 0, 1,
+		2, 3;
+	const ipc::CollisionMesh collision_mesh(V, E);
+
+	ContactForm form(
+		collision_mesh, dhat, /*avg_mass=*/1, /*use_convergent_formulation=*/false,
+		/*use_adaptive_barrier_stiffness=*/false, /*is_time_dependent=*/false, false,
+		broad_phase_method, /*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/static_cast<int>(1e6), dmin);
+
+	Eigen::VectorXd x = Eigen::VectorXd::Zero(V.size());
+	form.init(x);
+	REQUIRE(form.get_constraint_set().size() == 0);
+
+	// Move the top edge down within the envelope margin, into the activation distance
+	x(5) = x(7) = -0.9 * dhat;
+	form.solution_changed(x);
+
+	const Eigen::MatrixXd displaced = collision_mesh.displace_vertices(utils::unflatten(x, 2));
+	ipc::CollisionConstraints full;
+	full.build(collision_mesh, displaced, dhat, dmin, broad_phase_method);
+	REQUIRE(full.size() > 0);
+
+	const ipc::CollisionConstraints envelope = form.get_constraint_set();
+	CHECK(envelope.size() == full.size());
+	CHECK(envelope.compute_potential(collision_mesh, displaced, dhat) == Catch::Approx(full.compute_potential(collision_mesh, displaced, dhat)));
+}
+
 TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 {
 	const auto state_ptr = get_state_2d();
 	ElasticForm form(
 		state_ptr->n_bases,
-		state_ptr->bases,
+		state_ptr->bases(),
 		state_ptr->geom_bases(),
 		*state_ptr->assembler,
 		state_ptr->ass_vals_cache,
 		state_ptr->args["time"]["dt"],
 		state_ptr->mesh->is_volume());
 	test_form(form, *state_ptr);
+
+	// The nodal blocks computed from the displacement gradients match the assembled hessian
+	Eigen::VectorXd x;
+	x.setRandom(state_ptr->n_bases * 2);
+	x /= 100;
+
+	StiffnessMatrix hess, diag;
+	form.second_derivative(x, hess);
+	form.init_second_derivative_vector_product(x);
+	form.second_derivative_block_diagonal(diag);
+
+	const StiffnessMatrix ref_diag = utils::block_diagonal(hess, 2);
+	CHECK((Eigen::MatrixXd(diag) - Eigen::MatrixXd(ref_diag)).norm() <= 1e-8 * std::max(1.0, ref_diag.norm()));
 }
 
 TEST_CASE("friction form derivatives", "[form][form_derivatives][friction_form]")
@@ -353,7 +431,7 @@ TEST_CASE("damping form derivatives", "[form][form_derivatives][damping_form]")
 
 	ElasticForm form(
 		state_ptr->n_bases,
-		state_ptr->bases,
+		state_ptr->bases(),
 		state_ptr->geom_bases(),
 		*damping_assembler,
 		state_ptr->ass_vals_cache,
@@ -396,7 +474,7 @@ TEST_CASE("Rayleigh damping form derivatives", "[form][form_derivatives][rayleig
 	const auto state_ptr = get_state_2d();
 	ElasticForm elastic_form(
 		state_ptr->n_bases,
-		state_ptr->bases,
+		state_ptr->bases(),
 		state_ptr->geom_bases(),
 		*state_ptr->assembler,
 		state_ptr->ass_vals_cache,
@@ -431,7 +509,7 @@ TEST_CASE("BC lagrangian form derivatives", "[form][form_derivatives][bc_lagr_fo
 	StiffnessMatrix mass_tmp;
 	state_ptr->mass_matrix_assembler->assemble(dim == 3,
 											   state_ptr->n_bases,
-											   state_ptr->bases,
+											   state_ptr->bases(),
 											   state_ptr->geom_bases(),
 											   state_ptr->mass_ass_vals_cache,
 											   mass_tmp,
@@ -482,7 +560,7 @@ TEST_CASE("BC penalty form derivatives", "[form][form_derivatives][bc_penalty_fo
 	StiffnessMatrix mass_tmp;
 	state_ptr->mass_matrix_assembler->assemble(dim == 3,
 											   state_ptr->n_bases,
-											   state_ptr->bases,
+											   state_ptr->bases(),
 											   state_ptr->geom_bases(),
 											   state_ptr->mass_ass_vals_cache,
 											   mass_tmp,
@@ -4,6 +4,10 @@
 
 #include <h5pp/h5pp.h>
 
+#include <polyfem/io/HDF5Trajectory.hpp>
+
+#include <filesystem>
+
 TEST_CASE("HDF5", "[hdf5]")
 {
 	using MatrixXl = Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic>;
@@ -28,4 +32,75 @@ TEST_CASE("HDF5", "[hdf5]")
 		cells[i] = file.readDataset<MatrixXl>("/meshes/" + name + "/c").cast<int>();
 		vertices[i] = file.readDataset<Eigen::MatrixXd>("/meshes/" + name + "/v");
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("HDF5 trajectory", "[hdf5]")
+{
+	using namespace polyfem::io;
+
+	const std::string path = (std::filesystem::temp_directory_path() / "polyfem_trajectory.hdf5").string();
+	const int n_steps = 5;
+	const int ndof = 7;
+
+	std::vector<Eigen::VectorXd> us, vs, as;
+	{
+		HDF5Trajectory trajectory(path, 4);
+		for (int i = 0; i < n_steps; ++i)
+		{
+			us.push_back(Eigen::VectorXd::Random(ndof));
+			vs.push_back(Eigen::VectorXd::Random(ndof));
+			as.push_back(Eigen::VectorXd::Random(ndof));
+			trajectory.append(0.1 * i, us.back(), vs.back(), as.back());
+		}
+		CHECK(trajectory.n_steps() == n_steps);
+	}
+
+	CHECK(HDF5Trajectory::n_steps(path) == n_steps);
+
+	for (int i = 0; i < n_steps; ++i)
+	{
+		Eigen::MatrixXd u, v, a;
+		REQUIRE(HDF5Trajectory::read_step(path, "u", i, u));
+		REQUIRE(HDF5Trajectory::read_step(path, "v", i, v));
+		REQUIRE(HDF5Trajectory::read_step(path, "a", i, a));
+		CHECK(u == us[i]);
+		CHECK(v == vs[i]);
+		CHECK(a == as[i]);
+
+		double t;
+		REQUIRE(HDF5Trajectory::read_time(path, i, t));
+		CHECK(t == 0.1 * i);
+	}
+
+	// negative steps count from the end
+	Eigen::MatrixXd u;
+	REQUIRE(HDF5Trajectory::read_step(path, "u", -1, u));
+	CHECK(u == us.back());
+	CHECK(!HDF5Trajectory::read_step(path, "u", n_steps, u));
+
+	// restarting after step 2 keeps the first 3 steps and appends after them
+	{
+		HDF5Trajectory trajectory(path, 4, 3);
+		CHECK(trajectory.n_steps() == 3);
+		CHECK(HDF5Trajectory::n_steps(path) == 3);
+
+		us.resize(3);
+		us.push_back(Eigen::VectorXd::Random(ndof));
+		trajectory.append(0.3, us.back(), vs[0], as[0]);
+
+		// the step is flushed to the file
+		CHECK(HDF5Trajectory::n_steps(path) == 4);
+	}
+
+	CHECK(HDF5Trajectory::n_steps(path) == 4);
+	for (int i = 0; i < 4; ++i)
+	{
+		REQUIRE(HDF5Trajectory::read_step(path, "u", i, u));
+		CHECK(u == us[i]);
+	}
+
+	// more kept steps than stored ones
+	CHECK_THROWS(HDF5Trajectory(path, 4, 5));
+
+	std::filesystem::remove(path);
+}
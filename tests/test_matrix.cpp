@@ -1,11 +1,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/utils/MatrixCache.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/solver/CompositeHessian.hpp>
 #include <polyfem/autogen/auto_eigs.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
 
 #include <iostream>
 #include <cmath>
+#include <random>
+#include <algorithm>
 
 #include <Eigen/Dense>
 
@@ -247,3 +250,135 @@ TEST_CASE("cache", "[matrix]")
 	REQUIRE(tmp2.coeff(9, 4) == 6);
 	REQUIRE(tmp2.coeff(9, 9) == 4);
 }
+
+TEST_CASE("sparsity_pattern", "[matrix]")
+{
+	StiffnessMatrix A(4, 4);
+	A.insert(0, 0) = 1;
+	A.insert(2, 1) = 2;
+	A.insert(3, 3) = 3;
+	A.makeCompressed();
+
+	std::vector<StiffnessMatrix::StorageIndex> outer, inner;
+	sparsity_pattern(A, outer, inner);
+	REQUIRE(has_sparsity_pattern(A, A.rows(), outer, inner));
+
+	// values and compression do not matter
+	StiffnessMatrix B = 5 * A;
+	B.uncompress();
+	REQUIRE(has_sparsity_pattern(B, A.rows(), outer, inner));
+
+	// same number of nonzeros in a different position
+	StiffnessMatrix C(4, 4);
+	C.insert(0, 0) = 1;
+	C.insert(1, 1) = 2;
+	C.insert(3, 3) = 3;
+	REQUIRE(!has_sparsity_pattern(C, A.rows(), outer, inner));
+
+	// explicit zeros are part of the pattern
+	StiffnessMatrix D = A;
+	D.coeffRef(1, 2) = 0;
+	REQUIRE(!has_sparsity_pattern(D, A.rows(), outer, inner));
+
+	StiffnessMatrix E(5, 4);
+	REQUIRE(!has_sparsity_pattern(E, A.rows(), outer, inner));
+}
+
+TEST_CASE("composite_hessian", "[matrix]")
+{
+	const int n = 30;
+	const std::vector<int> removed = {0, 7, 29};
+
+	std::mt19937 gen(42);
+	const auto random_sparse = [n, &gen](const double density) {
+		std::uniform_real_distribution<double> dist(0, 1);
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < n; ++i)
+			for (int j = 0; j <= i; ++j)
+				if (dist(gen) < density)
+				{
+					const double val = 2 * dist(gen) - 1;
+					entries.emplace_back(i, j, val);
+					if (i != j)
+						entries.emplace_back(j, i, val);
+				}
+
+		StiffnessMatrix mat(n, n);
+		mat.setFromTriplets(entries.begin(), entries.end());
+		return mat;
+	};
+
+	const auto pattern = [n](const std::vector<StiffnessMatrix> &terms) {
+		Eigen::MatrixXi pattern = Eigen::MatrixXi::Zero(n, n);
+		for (const StiffnessMatrix &term : terms)
+			for (int k = 0; k < term.outerSize(); ++k)
+				for (StiffnessMatrix::InnerIterator it(term, k); it; ++it)
+					pattern(it.row(), it.col()) = 1;
+		return pattern;
+	};
+
+	// symmetric entry outside of the union pattern (and not removed), so that the term does not fit in it
+	const auto add_missing_entry = [n, &removed](const Eigen::MatrixXi &union_pattern, StiffnessMatrix &term) {
+		const auto is_removed = [&removed](const int i) { return std::find(removed.begin(), removed.end(), i) != removed.end(); };
+		for (int i = 0; i < n; ++i)
+			for (int j = 0; j < i; ++j)
+				if (union_pattern(i, j) == 0 && !is_removed(i) && !is_removed(j))
+				{
+					term.coeffRef(i, j) = 1;
+					term.coeffRef(j, i) = 1;
+					term.makeCompressed();
+					return;
+				}
+		FAIL("The union pattern is full");
+	};
+
+	solver::CompositeHessian composite;
+	StiffnessMatrix result;
+
+	for (const bool remove : {false, true})
+	{
+		std::vector<StiffnessMatrix> terms = {random_sparse(0.3), random_sparse(0.1)};
+		REQUIRE(terms[0].nonZeros() > 0);
+		REQUIRE(terms[1].nonZeros() > 0);
+
+		const Eigen::MatrixXi union_pattern = pattern(terms);
+
+		composite.set_removed_dofs(n, remove ? removed : std::vector<int>());
+
+		for (int iter = 0; iter < 5; ++iter)
+		{
+			const int builds = composite.n_pattern_builds();
+
+			// same patterns, new values
+			for (StiffnessMatrix &term : terms)
+				for (int k = 0; k < term.nonZeros(); ++k)
+					term.valuePtr()[k] = k % 3 - 1.5 * iter;
+
+			bool new_pattern = iter == 0;
+			if (iter == 2)
+			{
+				// smaller pattern of the second term, it fits in the union
+				terms[1].prune([](const int row, const int col, const double) { return (row + col) % 2 == 0; });
+			}
+			else if (iter == 3)
+			{
+				// new entry in the second term (e.g., new contacts), the union is rebuilt
+				add_missing_entry(union_pattern, terms[1]);
+				new_pattern = true;
+			}
+
+			composite.assemble(terms, result);
+			REQUIRE(result.nonZeros() > 0);
+
+			// the union is only built at the first call and when a term does not fit in it
+			REQUIRE(composite.n_pattern_builds() - builds == (new_pattern ? 1 : 0));
+
+			StiffnessMatrix expected;
+			full_to_reduced_matrix(n, remove ? n - removed.size() : n, removed, StiffnessMatrix(terms[0] + terms[1]), expected);
+
+			REQUIRE(result.rows() == expected.rows());
+			REQUIRE(result.cols() == expected.cols());
+			REQUIRE((Eigen::MatrixXd(result) - Eigen::MatrixXd(expected)).norm() == Catch::Approx(0).margin(1e-12));
+		}
+	}
+}
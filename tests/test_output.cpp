@@ -5,9 +5,15 @@
 #include <polyfem/State.hpp>
 #include <polyfem/Common.hpp>
 #include <polyfem/utils/JSONUtils.hpp>
+#include <polyfem/io/AsyncWriter.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -82,3 +88,82 @@ TEST_CASE("full sim", "[.][full_sim]")
 
 	std::filesystem::remove_all(outdir);
 }
+
+TEST_CASE("async_writer", "[output]")
+{
+	using polyfem::io::AsyncWriter;
+
+	const int max_queue_size = GENERATE(0, 1, 3);
+	AsyncWriter writer(max_queue_size);
+	REQUIRE(writer.is_async() == (max_queue_size > 0));
+
+	SECTION("Ordering")
+	{
+		// the jobs run on a single thread, the vector needs no lock
+		std::vector<int> order;
+		for (int i = 0; i < 100; ++i)
+			writer.push([&order, i]() { order.push_back(i); });
+		writer.flush();
+
+		REQUIRE(order.size() == 100);
+		for (int i = 0; i < 100; ++i)
+			CHECK(order[i] == i);
+	}
+
+	SECTION("Backpressure")
+	{
+		if (writer.is_async())
+		{
+			// the first job blocks the writer until released
+			std::atomic<bool> started(false), released(false);
+			writer.push([&started, &released]() {
+				started = true;
+				while (!released)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			});
+			while (!started)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			for (int i = 0; i < max_queue_size; ++i)
+				writer.push([]() {});
+
+			// the queue is full, push blocks
+			std::atomic<bool> pushed(false);
+			std::thread producer([&writer, &pushed]() {
+				writer.push([]() {});
+				pushed = true;
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			CHECK(!pushed);
+
+			released = true;
+			producer.join();
+			CHECK(pushed);
+			writer.flush();
+		}
+	}
+
+	SECTION("Error propagation")
+	{
+		// rethrown by push (directly if synchronous) or flush
+		CHECK_THROWS_AS(([&writer]() {
+							writer.push([]() { throw std::runtime_error("write failed"); });
+							writer.push([]() { throw std::logic_error("second failure"); });
+							writer.flush();
+						}()),
+						std::runtime_error);
+
+		// not an std::exception
+		CHECK_THROWS_AS(([&writer]() {
+							writer.push([]() { throw 1; });
+							writer.flush();
+						}()),
+						int);
+
+		// the error is only reported once, the later jobs are executed
+		int n_done = 0;
+		writer.push([&n_done]() { ++n_done; });
+		writer.flush();
+		CHECK(n_done == 1);
+	}
+}
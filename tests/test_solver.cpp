@@ -2,6 +2,9 @@
 
 #include <polyfem/quadrature/TriQuadrature.hpp>
 #include <polyfem/basis/LagrangeBasis2d.hpp>
+#include <polyfem/State.hpp>
+#include <polyfem/solver/NLProblem.hpp>
+#include <polyfem/solver/FactorizationCache.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
@@ -43,3 +46,177 @@ TEST_CASE("solver", "[solver]")
 	std::cout << "f in argmin " << f(x) << std::endl;
 	REQUIRE(f(x) < 1e-10);
 }
+
+namespace
+{
+	Eigen::MatrixXd solve_neo_hookean(const std::string &nl_solver)
+	{
+		const std::string path = POLYFEM_DATA_DIR;
+		json in_args = json({});
+		in_args["geometry"] = {};
+		in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+		in_args["geometry"]["surface_selection"] = 7;
+
+		in_args["preset_problem"] = {};
+		in_args["preset_problem"]["type"] = "ElasticExact";
+
+		in_args["materials"] = {};
+		in_args["materials"]["type"] = "NeoHookean";
+		in_args["materials"]["E"] = 1e5;
+		in_args["materials"]["nu"] = 0.3;
+
+		in_args["solver"]["nonlinear"]["solver"] = nl_solver;
+		in_args["solver"]["nonlinear"]["grad_norm"] = 1e-10;
+		in_args["solver"]["nonlinear"]["krylov"]["tolerance"] = 1e-8;
+
+		State state;
+		state.init_logger("", spdlog::level::err, false);
+		state.init(in_args, true);
+		state.load_mesh();
+		state.build_basis();
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+
+		Eigen::MatrixXd sol, pressure;
+		state.solve_problem(sol, pressure);
+		return sol;
+	}
+} // namespace
+
+TEST_CASE("newton_krylov", "[solver]")
+{
+	const Eigen::MatrixXd newton_sol = solve_neo_hookean("newton");
+	const Eigen::MatrixXd krylov_sol = solve_neo_hookean("newton_krylov");
+
+	REQUIRE(newton_sol.size() == krylov_sol.size());
+	REQUIRE(newton_sol.norm() > 0);
+	CHECK((newton_sol - krylov_sol).norm() <= 1e-6 * newton_sol.norm());
+}
+
+namespace
+{
+	// counts the evaluations of the Dirichlet values, bc_value at every dof
+	class CountingNLProblem : public solver::NLProblem
+	{
+	public:
+		CountingNLProblem(const int full_size, const std::vector<int> &boundary_nodes)
+			: NLProblem(full_size, boundary_nodes, std::vector<std::shared_ptr<solver::Form>>())
+		{
+		}
+
+		double bc_value = 1;
+		mutable int n_evaluations = 0;
+
+	protected:
+		Eigen::MatrixXd compute_boundary_values() const override
+		{
+			++n_evaluations;
+			return Eigen::MatrixXd::Constant(full_size(), 1, bc_value);
+		}
+	};
+} // namespace
+
+TEST_CASE("nl_problem_boundary_values", "[solver]")
+{
+	std::vector<int> boundary_nodes = {0, 3};
+	CountingNLProblem problem(5, boundary_nodes);
+
+	Eigen::VectorXd reduced(3);
+	reduced << 0.1, 0.2, 0.3;
+
+	Eigen::VectorXd expected(5);
+	expected << 1, 0.1, 0.2, 1, 0.3;
+	CHECK(problem.reduced_to_full(reduced) == expected);
+	CHECK(problem.full_to_reduced(expected) == reduced);
+	CHECK(problem.n_evaluations == 1);
+
+	// reused by the evaluations at the same time
+	Eigen::VectorXd grad;
+	problem.value(reduced);
+	problem.gradient(reduced, grad);
+	CHECK(problem.is_step_valid(reduced, reduced));
+	problem.max_step_size(reduced, reduced);
+	CHECK(problem.n_evaluations == 1);
+
+	// recomputed after moving to a new time, not needed for full size vectors
+	problem.bc_value = 2;
+	problem.update_quantities(1, expected);
+	CHECK(problem.n_evaluations == 1);
+
+	expected << 2, 0.1, 0.2, 2, 0.3;
+	CHECK(problem.reduced_to_full(reduced) == expected);
+	CHECK(problem.n_evaluations == 2);
+
+	// the free dofs and the Dirichlet values follow the boundary nodes
+	boundary_nodes = {1, 4};
+	expected << 0.1, 2, 0.2, 0.3, 2;
+	CHECK(problem.reduced_to_full(reduced) == expected);
+	CHECK(problem.full_to_reduced(expected) == reduced);
+	CHECK(problem.n_evaluations == 3);
+
+	// the reduced size is fixed
+	boundary_nodes = {1, 2, 4};
+	CHECK_THROWS(problem.reduced_to_full(reduced));
+}
+
+TEST_CASE("transient_linear_factorization", "[solver]")
+{
+	// 1D Laplacian and lumped mass, the system of a step of implicit Euler is dt * K + M
+	const int n = 20;
+	std::vector<Eigen::Triplet<double>> entries;
+	for (int i = 0; i < n; ++i)
+	{
+		entries.emplace_back(i, i, 2);
+		if (i > 0)
+			entries.emplace_back(i, i - 1, -1);
+		if (i < n - 1)
+			entries.emplace_back(i, i + 1, -1);
+	}
+	StiffnessMatrix K(n, n), M(n, n);
+	K.setFromTriplets(entries.begin(), entries.end());
+	M.setIdentity();
+	M *= 0.5;
+
+	auto linear_solver = polysolve::LinearSolver::create("Eigen::SparseLU", "");
+	solver::FactorizationCache factorization(n);
+
+	const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, 1, 2);
+	const auto step = [&](const double dt, const std::vector<int> &boundary_nodes) {
+		const bool factorized = factorization.update(
+			*linear_solver, dt, boundary_nodes, [&](StiffnessMatrix &A) { A = K * dt + M; });
+
+		Eigen::VectorXd x;
+		factorization.solve(*linear_solver, b, x);
+
+		// solution of the system with the Dirichlet rows replaced by the identity
+		Eigen::MatrixXd A = Eigen::MatrixXd(K * dt + M);
+		for (int i : boundary_nodes)
+		{
+			A.row(i).setZero();
+			A(i, i) = 1;
+		}
+		CHECK((A * x - b).norm() < 1e-10);
+
+		return factorized;
+	};
+
+	std::vector<int> boundary_nodes = {0};
+	CHECK(step(0.1, boundary_nodes));
+	CHECK(!step(0.1, boundary_nodes));
+	CHECK(!step(0.1, boundary_nodes));
+
+	// dt changed
+	CHECK(step(0.05, boundary_nodes));
+	CHECK(!step(0.05, boundary_nodes));
+
+	// boundary nodes changed
+	boundary_nodes.push_back(n - 1);
+	CHECK(step(0.05, boundary_nodes));
+	CHECK(!step(0.05, boundary_nodes));
+
+	// the solver factorized another system
+	factorization.invalidate();
+	CHECK(step(0.05, boundary_nodes));
+
+	CHECK(factorization.n_factorizations() == 4);
+}
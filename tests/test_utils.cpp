@@ -6,6 +6,7 @@
 #include <polyfem/io/MshReader.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/Timer.hpp>
 
 #ifdef POLYFEM_WITH_REMESHING
 #include <wmtk/TriMesh.h>
@@ -107,6 +108,19 @@ TEST_CASE("expression", "[utils]")
 	REQUIRE(expr(2, 3, 4) == Catch::Approx(2. * 2. + sqrt(2. * 3.) + sin(4.) * 2.).margin(1e-10));
 	REQUIRE(expr2d(2, 3) == Catch::Approx(2. * 2. + sqrt(2. * 3.)).margin(1e-10));
 	REQUIRE(val(2, 3, 4) == Catch::Approx(1).margin(1e-16));
+
+	// batched evaluation, also through a copy sharing the compiled expression
+	const Eigen::MatrixXd pts = Eigen::MatrixXd::Random(20, 3).array().abs();
+	const utils::ExpressionValue expr_copy = expr;
+	Eigen::VectorXd batch, batch_copy;
+	expr.eval(pts, 0.5, batch);
+	expr_copy.eval(pts, 0.5, batch_copy);
+	REQUIRE(batch.size() == pts.rows());
+	for (int i = 0; i < pts.rows(); ++i)
+	{
+		REQUIRE(batch(i) == Catch::Approx(expr(pts(i, 0), pts(i, 1), pts(i, 2), 0.5)).margin(1e-10));
+		REQUIRE(batch_copy(i) == Catch::Approx(batch(i)).margin(1e-14));
+	}
 }
 
 TEST_CASE("mshreader", "[utils]")
@@ -132,6 +146,65 @@ TEST_CASE("inverse", "[utils]")
 	REQUIRE(((utils::inverse(mat3) - mat3_inv)).norm() == Catch::Approx(0).margin(1e-12));
 }
 
+TEST_CASE("profiler", "[utils]")
+{
+	Profiler &profiler = Profiler::get();
+	profiler.reset();
+	profiler.set_enabled(true);
+
+	{
+		POLYFEM_SCOPED_TIMER("outer");
+		for (int i = 0; i < 3; ++i)
+		{
+			POLYFEM_SCOPED_TIMER("inner");
+		}
+	}
+	{
+		Timer not_named;
+	}
+
+	profiler.set_enabled(false);
+	{
+		POLYFEM_SCOPED_TIMER("disabled");
+	}
+
+	const json profile = profiler.to_json();
+	REQUIRE(profile["tree"].size() == 1);
+
+	const json &outer = profile["tree"][0];
+	CHECK(outer["name"] == "outer");
+	CHECK(outer["count"] == 1);
+	REQUIRE(outer["children"].size() == 1);
+
+	const json &inner = outer["children"][0];
+	CHECK(inner["name"] == "inner");
+	CHECK(inner["count"] == 3);
+	CHECK(inner["inclusive"].get<double>() <= outer["inclusive"].get<double>());
+	CHECK(outer["exclusive"].get<double>() == Catch::Approx(outer["inclusive"].get<double>() - inner["inclusive"].get<double>()));
+
+	// by default the peak memory is only sampled at the top-level scopes
+	CHECK(outer.contains("peak_memory_increase"));
+	CHECK(!inner.contains("peak_memory_increase"));
+
+	profiler.reset();
+	profiler.set_enabled(true, false, true);
+	{
+		POLYFEM_SCOPED_TIMER("outer");
+		{
+			POLYFEM_SCOPED_TIMER("inner");
+		}
+	}
+	profiler.set_enabled(false);
+
+	const json profile_memory = profiler.to_json();
+	REQUIRE(profile_memory["tree"].size() == 1);
+	REQUIRE(profile_memory["tree"][0]["children"].size() == 1);
+	CHECK(profile_memory["tree"][0].contains("peak_memory_increase"));
+	CHECK(profile_memory["tree"][0]["children"][0].contains("peak_memory_increase"));
+
+	profiler.reset();
+}
+
 #ifdef POLYFEM_WITH_REMESHING
 TEST_CASE("wmtk_instatiation", "[utils]")
 {